@@ -38,11 +38,16 @@ Gallery::Gallery(int argc, char* argv[])
 
     char file[128];
     ImageWidget* widget;
+    Image* image;
     for (int i = 0; i < 16; ++i)
     {
         sprintf(file, "%sgallery/%d.jpg\0", ILIXI_DATADIR, i % 5);
         widget = new ImageWidget(file);
-        widget->setImage(new Image(file, 300, 300));
+        // decode thumbnails in background, first frame shows placeholders.
+        image = new Image(file, 300, 300);
+        image->setLoadMode(Image::Asynchronous);
+        image->setPlaceholder(Color(0x33, 0x33, 0x33));
+        widget->setImage(image);
         widget->sigPressed.connect(
                 sigc::bind<std::string>(
                         sigc::mem_fun(this, &Gallery::showImage), file));
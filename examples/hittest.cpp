@@ -0,0 +1,86 @@
+#include <core/Application.h>
+#include <lib/Timer.h>
+#include <ui/GridLayout.h>
+#include <ui/HitTestGrid.h>
+#include <ui/ToolButton.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace ilixi;
+
+//! Compares pointer hit-testing using HitTestGrid against scanning children.
+class HitTestBenchmark : public Application
+{
+public:
+    HitTestBenchmark(int *argc, char ***argv, int rows, int columns, int events)
+            : Application(argc, argv),
+              _events(events),
+              _done(false)
+    {
+        setMargin(10);
+        setLayout(new GridLayout(rows, columns));
+        for (int i = 0; i < rows * columns; ++i)
+            addWidget(new ToolButton(PrintF("%d", i)));
+
+        // geometry of widgets is valid once window is painted.
+        _timer.sigExec.connect(sigc::mem_fun(this, &HitTestBenchmark::run));
+        sigVisible.connect(sigc::mem_fun(this, &HitTestBenchmark::startTimer));
+    }
+
+    void
+    startTimer()
+    {
+        _timer.start(500, 1);
+    }
+
+    void
+    run()
+    {
+        if (_done)
+            return;
+        _done = true;
+
+        unsigned int threshold = HitTestGrid::threshold();
+
+        // both paths are timed after a warm-up pass, first grid pass also builds grids.
+        HitTestGrid::setThreshold(0);
+        dispatch();
+        long long scan = dispatch();
+
+        HitTestGrid::setThreshold(threshold ? threshold : 16);
+        dispatch();
+        long long grid = dispatch();
+
+        printf("%d motion events, scan: %lld us (%.2f us/event), grid: %lld us (%.2f us/event)\n", _events, scan, (double) scan / _events, grid, (double) grid / _events);
+        HitTestGrid::setThreshold(threshold);
+        quit();
+    }
+
+private:
+    Timer _timer;
+    int _events;
+    bool _done;
+
+    //! Sends same pseudo random motion events to window and returns elapsed time in microseconds.
+    long long
+    dispatch()
+    {
+        srand(1);
+        Widget* window = appWindow();
+        long long start = direct_clock_get_micros();
+        for (int i = 0; i < _events; ++i)
+            window->consumePointerEvent(PointerEvent(PointerMotion, rand() % window->width(), rand() % window->height()));
+        return direct_clock_get_micros() - start;
+    }
+};
+
+int
+main(int argc, char* argv[])
+{
+    int rows = argc > 1 ? atoi(argv[1]) : 32;
+    int columns = argc > 2 ? atoi(argv[2]) : 32;
+    int events = argc > 3 ? atoi(argv[3]) : 100000;
+    HitTestBenchmark app(&argc, &argv, rows, columns, events);
+    app.exec();
+    return 0;
+}
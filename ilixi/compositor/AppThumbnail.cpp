@@ -71,7 +71,14 @@ AppThumbnail::addWindow(IDirectFBWindow* window, bool eventHandling, bool blocki
 {
     ILOG_TRACE_W(ILX_APPTHUMB);
     AppCompositor::addWindow(window, eventHandling, blocking);
-    _close->bringToFront();
+    for (WidgetList::iterator it = _children.begin(); it != _children.end(); ++it)
+    {
+        SurfaceView* view = dynamic_cast<SurfaceView*>(*it);
+        if (view)
+            view->setMaxUpdateRate(_compositor->settings.thumbnailFPS);
+    }
+    if (_close)
+        _close->bringToFront();
 }
 
 void
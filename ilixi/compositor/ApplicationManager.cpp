@@ -23,11 +23,15 @@
 
 #include <compositor/ApplicationManager.h>
 #include <compositor/Compositor.h>
+#include <core/Engine.h>
 #include <core/Logger.h>
 #include <lib/FileSystem.h>
 #include <lib/Notify.h>
 #include <lib/XMLReader.h>
+#include <types/ImageCache.h>
 
+#include <errno.h>
+#include <fcntl.h>
 #include <string.h>
 #include <signal.h>
 #include <stdexcept>
@@ -35,6 +39,7 @@
 #include <sys/wait.h>
 #include <unistd.h>
 #include <sstream>
+#include <vector>
 
 namespace ilixi
 {
@@ -61,36 +66,78 @@ app_sort(AppInfo* app1, AppInfo* app2)
 
 //*********************************************************************
 static ApplicationManager* __appMan = NULL;
+//! Signal handler writes ChildEvents to this pipe, read end is drained by __childThread.
+static int __childPipe[2] = { -1, -1 };
+static pthread_t __childThread;
+
+//! State change of a child process, passed from signal handler to main loop.
+struct ChildEvent
+{
+    pid_t pid;
+    int code;
+};
 
 void
 sigchild_handler(int sig, siginfo_t *siginfo, void *context)
 {
+    // only async-signal-safe calls here, instance lookup is done by main loop.
+    if (sig != SIGCHLD || __childPipe[1] == -1)
+        return;
+
+    int err = errno;
+    ChildEvent event;
+    event.pid = siginfo->si_pid;
+    event.code = siginfo->si_code;
+    // event is lost if pipe is full.
+    write(__childPipe[1], &event, sizeof(ChildEvent));
+    errno = err;
+}
+
+//! Handles a child event in main loop.
+void
+child_changed(void* data)
+{
+    ChildEvent* event = (ChildEvent*) data;
     ILOG_TRACE_F(ILX_APPLICATIONMANAGER);
-    ILOG_DEBUG(ILX_APPLICATIONMANAGER, " -> si_code: %d\n", siginfo->si_code);
+    ILOG_DEBUG(ILX_APPLICATIONMANAGER, " -> pid: %d si_code: %d\n", event->pid, event->code);
     if (__appMan != NULL)
     {
-        if (siginfo->si_code == CLD_DUMPED || siginfo->si_code == CLD_KILLED)
+        if (event->code == CLD_DUMPED || event->code == CLD_KILLED)
         {
-            AppInstance* instance = __appMan->instanceByPID(siginfo->si_pid);
-            ILOG_DEBUG(ILX_APPLICATIONMANAGER, " -> pid: %d instance: %p (CLD_KILLED || CLD_DUMPED)\n", siginfo->si_pid, instance);
-            if (!instance)
-                return;
-
-            if (instance->view())
-                return;
-
-            __appMan->processTerminated(instance);
-        } else if (siginfo->si_code == CLD_EXITED)
+            AppInstance* instance = __appMan->instanceByOwnPID(event->pid);
+            ILOG_DEBUG(ILX_APPLICATIONMANAGER, " -> pid: %d instance: %p (CLD_KILLED || CLD_DUMPED)\n", event->pid, instance);
+            if (instance && !instance->view())
+                __appMan->processTerminated(instance);
+        } else if (event->code == CLD_EXITED)
         {
-            AppInstance* instance = __appMan->instanceByPID(siginfo->si_pid);
-            ILOG_DEBUG(ILX_APPLICATIONMANAGER, " -> pid: %d instance: %p (CLD_EXITED)\n", siginfo->si_pid, instance);
+            AppInstance* instance = __appMan->instanceByOwnPID(event->pid);
+            ILOG_DEBUG(ILX_APPLICATIONMANAGER, " -> pid: %d instance: %p (CLD_EXITED)\n", event->pid, instance);
+            if (instance)
+                __appMan->processRemoved(instance);
+        }
+    }
+    delete event;
+}
 
-            if (!instance)
-                return;
+//! Reads child events written by signal handler and posts them to main loop.
+static void*
+child_thread(void* arg)
+{
+    ChildEvent event;
+    while (true)
+    {
+        ssize_t bytes = read(__childPipe[0], &event, sizeof(ChildEvent));
+        if (bytes == -1 && errno == EINTR)
+            continue;
+        // write end is closed by ApplicationManager destructor.
+        if (bytes != sizeof(ChildEvent))
+            break;
 
-            __appMan->processRemoved(instance);
-        }
+        ChildEvent* posted = new ChildEvent(event);
+        while (!Engine::instance().post(child_changed, posted))
+            usleep(1000);
     }
+    return NULL;
 }
 
 DirectResult
@@ -115,6 +162,16 @@ process_added(void *context, SaWManProcess *process)
     return appMan->processAdded(process);
 }
 
+DirectResult
+process_removed(void *context, SaWManProcess *process)
+{
+    ApplicationManager* appMan = (ApplicationManager*) context;
+    pthread_mutex_lock(&appMan->_mutex);
+    appMan->invalidatePIDCache();
+    pthread_mutex_unlock(&appMan->_mutex);
+    return DR_OK;
+}
+
 DirectResult
 window_preconfig(void *context, SaWManWindowConfig *config)
 {
@@ -154,6 +211,7 @@ window_restack(void *context, SaWManWindowHandle handle, SaWManWindowHandle rela
 
 ApplicationManager::ApplicationManager(ILXCompositor* compositor)
         : _compositor(compositor),
+          _pidCacheSerial(0),
           _monitor(NULL)
 {
     ILOG_TRACE_F(ILX_APPLICATIONMANAGER);
@@ -161,6 +219,15 @@ ApplicationManager::ApplicationManager(ILXCompositor* compositor)
 
     __appMan = this;
 
+    if (pipe(__childPipe) == -1)
+        ILOG_THROW(ILX_APPLICATIONMANAGER, "Unable to create pipe for child processes!\n");
+    // signal handler must not block and applications must not inherit pipe.
+    fcntl(__childPipe[0], F_SETFD, FD_CLOEXEC);
+    fcntl(__childPipe[1], F_SETFD, FD_CLOEXEC);
+    fcntl(__childPipe[1], F_SETFL, O_NONBLOCK);
+    if (pthread_create(&__childThread, NULL, child_thread, NULL) != 0)
+        ILOG_THROW(ILX_APPLICATIONMANAGER, "Unable to create thread for child processes!\n");
+
     memset(&_act, 0, sizeof(_act));
     _act.sa_sigaction = &sigchild_handler;
     _act.sa_flags = SA_SIGINFO | SA_NOCLDWAIT;
@@ -190,7 +257,7 @@ ApplicationManager::ApplicationManager(ILXCompositor* compositor)
     _callbacks.Start = start_request;
     _callbacks.Stop = stop_request;
     _callbacks.ProcessAdded = process_added;
-    _callbacks.ProcessRemoved = NULL;
+    _callbacks.ProcessRemoved = process_removed;
     _callbacks.InputFilter = NULL;
     _callbacks.WindowPreConfig = window_preconfig;
     _callbacks.WindowAdded = window_added;
@@ -230,6 +297,14 @@ ApplicationManager::~ApplicationManager()
     __appMan = NULL;
     stopAll();
 
+    // reader thread exits once write end is closed, child events posted earlier are ignored.
+    int fd = __childPipe[1];
+    __childPipe[1] = -1;
+    ::close(fd);
+    pthread_join(__childThread, NULL);
+    ::close(__childPipe[0]);
+    __childPipe[0] = -1;
+
     if (_manager)
         _manager->Release(_manager);
 
@@ -249,22 +324,18 @@ ApplicationManager::~ApplicationManager()
 AppInfo*
 ApplicationManager::infoByName(const std::string& name)
 {
-    for (AppInfoList::iterator it = _infos.begin(); it != _infos.end(); ++it)
-    {
-        if (((AppInfo*) (*it))->name() == name)
-            return ((AppInfo*) (*it));
-    }
+    AppInfoNameMap::iterator it = _infoNames.find(name);
+    if (it != _infoNames.end())
+        return it->second;
     return NULL;
 }
 
 AppInfo*
 ApplicationManager::infoByAppID(unsigned long appID)
 {
-    for (AppInfoList::iterator it = _infos.begin(); it != _infos.end(); ++it)
-    {
-        if (((AppInfo*) (*it))->appID() == appID)
-            return ((AppInfo*) (*it));
-    }
+    AppInfoIDMap::iterator it = _infoIDs.find(appID);
+    if (it != _infoIDs.end())
+        return it->second;
     return NULL;
 }
 
@@ -289,45 +360,93 @@ ApplicationManager::infoByPID(const pid_t pid)
 AppInstance*
 ApplicationManager::instanceByAppID(unsigned long appID)
 {
-    for (AppInstanceList::iterator it = _instances.begin(); it != _instances.end(); ++it)
-    {
-        if (((AppInstance*) (*it))->appID() == appID)
-            return ((AppInstance*) (*it));
-    }
-    return NULL;
+    AppInstance* instance = NULL;
+    pthread_mutex_lock(&_mutex);
+    AppInstanceAppIDMap::iterator it = _instanceAppIDs.find(appID);
+    if (it != _instanceAppIDs.end())
+        instance = it->second;
+    pthread_mutex_unlock(&_mutex);
+    return instance;
 }
 
 AppInstance*
 ApplicationManager::instanceByInstanceID(unsigned int instanceID)
 {
-    for (AppInstanceList::iterator it = _instances.begin(); it != _instances.end(); ++it)
-    {
-        if (((AppInstance*) (*it))->instanceID() == instanceID)
-            return ((AppInstance*) (*it));
-    }
-    return NULL;
+    AppInstance* instance = NULL;
+    pthread_mutex_lock(&_mutex);
+    AppInstanceIDMap::iterator it = _instanceIDs.find(instanceID);
+    if (it != _instanceIDs.end())
+        instance = it->second;
+    pthread_mutex_unlock(&_mutex);
+    return instance;
 }
 
 AppInstance*
 ApplicationManager::instanceByPID(const pid_t pid)
 {
-    pid_t p = pid;
-    do
+    pthread_mutex_lock(&_mutex);
+    AppInstancePIDMap::iterator it = _pidCache.find(pid);
+    if (it != _pidCache.end())
     {
-        for (AppInstanceList::iterator it = _instances.begin(); it != _instances.end(); ++it)
-        {
-            if (((AppInstance*) (*it))->pid() == p)
-                return ((AppInstance*) (*it));
-        }
+        AppInstance* instance = it->second;
+        pthread_mutex_unlock(&_mutex);
+        return instance;
+    }
+
+    AppInstancePIDMap::iterator own = _instancePIDs.find(pid);
+    if (own != _instancePIDs.end())
+    {
+        AppInstance* instance = own->second;
+        _pidCache[pid] = instance;
+        pthread_mutex_unlock(&_mutex);
+        return instance;
+    }
+    unsigned int serial = _pidCacheSerial;
+    pthread_mutex_unlock(&_mutex);
 
+    // read process tree without holding lock, getParentPID() may throw.
+    std::vector<pid_t> ancestors;
+    pid_t p = pid;
+    while (p > 0)
+    {
+        ancestors.push_back(p);
         p = getParentPID(p);
+    }
 
-        if (p == -1)
-            return NULL;
+    // each process resolves to its closest ancestor which is an instance.
+    AppInstance* instance = NULL;
+    pthread_mutex_lock(&_mutex);
+    std::vector<AppInstance*> resolved(ancestors.size(), (AppInstance*) NULL);
+    for (int i = ancestors.size() - 1; i >= 0; --i)
+    {
+        AppInstancePIDMap::iterator own = _instancePIDs.find(ancestors[i]);
+        if (own != _instancePIDs.end())
+            instance = own->second;
+        resolved[i] = instance;
+    }
+    instance = resolved.empty() ? NULL : resolved[0];
 
-    } while (p != 0);
+    // instances changed while reading process tree.
+    if (serial == _pidCacheSerial)
+    {
+        for (unsigned int i = 0; i < ancestors.size(); ++i)
+            _pidCache[ancestors[i]] = resolved[i];
+    }
+    ILOG_DEBUG(ILX_APPLICATIONMANAGER, "%s( %d ) resolved to %p using %d processes\n", __FUNCTION__, pid, instance, (int) ancestors.size());
+    pthread_mutex_unlock(&_mutex);
+    return instance;
+}
 
-    return NULL;
+AppInstance*
+ApplicationManager::instanceByOwnPID(const pid_t pid)
+{
+    AppInstance* instance = NULL;
+    pthread_mutex_lock(&_mutex);
+    AppInstancePIDMap::iterator it = _instancePIDs.find(pid);
+    if (it != _instancePIDs.end())
+        instance = it->second;
+    pthread_mutex_unlock(&_mutex);
+    return instance;
 }
 
 pid_t
@@ -476,7 +595,7 @@ ApplicationManager::startApplication(const std::string& name, bool showInstance)
         instance->setAppInfo(appInfo);
         instance->setStarted(direct_clock_get_millis());
         instance->setPid(pid);
-        _instances.push_back(instance);
+        addInstance(instance);
         pthread_mutex_unlock(&_mutex);
         _compositor->_compComp->signalAppStart(instance);
         break;
@@ -494,15 +613,7 @@ ApplicationManager::stopApplication(pid_t pid)
     {
         pthread_mutex_lock(&_mutex);
         kill(instance->pid(), SIGKILL);
-        for (AppInstanceList::iterator it = _instances.begin(); it != _instances.end(); ++it)
-        {
-            if (((AppInstance*) *it)->pid() == pid)
-            {
-                _instances.erase(it);
-                break;
-            }
-        }
-
+        removeInstance(instance);
         delete instance;
         ILOG_DEBUG(ILX_APPLICATIONMANAGER, " -> Application is killed and instance is removed.\n");
         pthread_mutex_unlock(&_mutex);
@@ -529,6 +640,10 @@ ApplicationManager::stopAll()
         delete instance;
         _instances.pop_front();
     }
+    _instanceAppIDs.clear();
+    _instanceIDs.clear();
+    _instancePIDs.clear();
+    invalidatePIDCache();
     pthread_mutex_unlock(&_mutex);
 }
 
@@ -575,6 +690,11 @@ ApplicationManager::processAdded(SaWManProcess *process)
     if (process->fusion_id == 1)
         return DR_OK;
 
+    // process ID may be reused.
+    pthread_mutex_lock(&_mutex);
+    invalidatePIDCache();
+    pthread_mutex_unlock(&_mutex);
+
     AppInstance* instance = instanceByPID(process->pid);
     if (instance)
         return DR_OK;
@@ -588,17 +708,8 @@ ApplicationManager::processRemoved(AppInstance* instance)
 {
     ILOG_TRACE_F(ILX_APPLICATIONMANAGER);
     _compositor->processRemoved(instance);
-    AppInstance* ins;
     pthread_mutex_lock(&_mutex);
-    for (AppInstanceList::iterator it = _instances.begin(); it != _instances.end(); ++it)
-    {
-        ins = ((AppInstance*) *it);
-        if (instance == ins)
-        {
-            it = _instances.erase(it);
-            break;
-        }
-    }
+    removeInstance(instance);
     pthread_mutex_unlock(&_mutex);
     return DR_OK;
 }
@@ -608,17 +719,8 @@ ApplicationManager::processTerminated(AppInstance* instance)
 {
     ILOG_TRACE_F(ILX_APPLICATIONMANAGER);
     _compositor->processTerminated(instance);
-    AppInstance* ins;
     pthread_mutex_lock(&_mutex);
-    for (AppInstanceList::iterator it = _instances.begin(); it != _instances.end(); ++it)
-    {
-        ins = ((AppInstance*) *it);
-        if (instance == ins)
-        {
-            it = _instances.erase(it);
-            break;
-        }
-    }
+    removeInstance(instance);
     pthread_mutex_unlock(&_mutex);
     return DR_OK;
 }
@@ -887,6 +989,49 @@ ApplicationManager::addApplication(const char* name, const char* author, const c
     if (depFlags)
         app->setDepFlags(depFlags);
     _infos.push_back(app);
+    _infoNames.insert(std::make_pair(app->name(), app));
+    _infoIDs.insert(std::make_pair(app->appID(), app));
+}
+
+void
+ApplicationManager::addInstance(AppInstance* instance)
+{
+    _instances.push_back(instance);
+    _instanceAppIDs.insert(std::make_pair(instance->appID(), instance));
+    _instanceIDs[instance->instanceID()] = instance;
+    _instancePIDs[instance->pid()] = instance;
+    invalidatePIDCache();
+}
+
+void
+ApplicationManager::removeInstance(AppInstance* instance)
+{
+    _instances.remove(instance);
+
+    std::pair<AppInstanceAppIDMap::iterator, AppInstanceAppIDMap::iterator> range = _instanceAppIDs.equal_range(instance->appID());
+    for (AppInstanceAppIDMap::iterator it = range.first; it != range.second; ++it)
+    {
+        if (it->second == instance)
+        {
+            _instanceAppIDs.erase(it);
+            break;
+        }
+    }
+
+    _instanceIDs.erase(instance->instanceID());
+
+    AppInstancePIDMap::iterator it = _instancePIDs.find(instance->pid());
+    if (it != _instancePIDs.end() && it->second == instance)
+        _instancePIDs.erase(it);
+
+    invalidatePIDCache();
+}
+
+void
+ApplicationManager::invalidatePIDCache()
+{
+    _pidCache.clear();
+    ++_pidCacheSerial;
 }
 
 bool
@@ -974,6 +1119,7 @@ ApplicationManager::handleMemoryState(MemoryMonitor::MemoryState state)
         {
             // kill a non-system app.
             ILOG_WARNING(ILX_APPLICATIONMANAGER, "MemoryMonitor reports Critical.\n");
+            ImageCache::instance().releaseUnused();
             AppInstance* instance = NULL;
             AppInstance* match = NULL;
             AppInfo* info;
@@ -1003,6 +1149,7 @@ ApplicationManager::handleMemoryState(MemoryMonitor::MemoryState state)
     case MemoryMonitor::Low:
         {
             ILOG_WARNING(ILX_APPLICATIONMANAGER, "MemoryMonitor reports Low.\n");
+            ImageCache::instance().releaseUnused();
             // kill an invisible and non-system app.
             AppInstance* instance = NULL;
             AppInstance* match = NULL;
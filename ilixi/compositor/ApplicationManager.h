@@ -28,6 +28,7 @@
 #include <compositor/AppInstance.h>
 #include <compositor/MemoryMonitor.h>
 #include <sys/types.h>
+#include <map>
 
 namespace ilixi
 {
@@ -39,6 +40,10 @@ typedef std::list<AppInstance*> AppInstanceList;
 //! Manages registered applications.
 /*!
  * Application manager keeps a track of installed applications and their running instances.
+ *
+ * Applications and instances are indexed by name, application ID, instance ID and process ID.
+ * Processes which are resolved to an instance by walking the process tree are cached until
+ * a process is added or removed, so window callbacks do not read /proc.
  */
 class ApplicationManager
 {
@@ -114,6 +119,8 @@ public:
     /*!
      * Returns an AppInstance given a process ID.
      *
+     * If pid does not belong to an instance, its ancestors are checked.
+     *
      * @param pid Process ID.
      * @return NULL if an AppInstance is not found with given process ID.
      */
@@ -234,6 +241,12 @@ protected:
     windowRestack(SaWManWindowHandle handle, SaWManWindowHandle relative, SaWManWindowRelation relation);
 
 private:
+    typedef std::map<std::string, AppInfo*> AppInfoNameMap;
+    typedef std::map<AppID, AppInfo*> AppInfoIDMap;
+    typedef std::multimap<AppID, AppInstance*> AppInstanceAppIDMap;
+    typedef std::map<InstanceID, AppInstance*> AppInstanceIDMap;
+    typedef std::map<pid_t, AppInstance*> AppInstancePIDMap;
+
     //! Owner.
     ILXCompositor* _compositor;
     //! List of registered applications.
@@ -241,6 +254,21 @@ private:
     //! List of running application instances.
     AppInstanceList _instances;
 
+    //! Indexes registered applications by name.
+    AppInfoNameMap _infoNames;
+    //! Indexes registered applications by application ID.
+    AppInfoIDMap _infoIDs;
+    //! Indexes instances by application ID, in start order.
+    AppInstanceAppIDMap _instanceAppIDs;
+    //! Indexes instances by instance ID.
+    AppInstanceIDMap _instanceIDs;
+    //! Indexes instances by their own process ID.
+    AppInstancePIDMap _instancePIDs;
+    //! Caches resolved process IDs, NULL if process does not belong to an instance.
+    AppInstancePIDMap _pidCache;
+    //! Incremented each time _pidCache is cleared.
+    unsigned int _pidCacheSerial;
+
     //! SaWMan interface.
     ISaWMan *_saw;
     //! SaWMan manager interface.
@@ -251,7 +279,7 @@ private:
     //! Memory Monitor.
     MemoryMonitor* _monitor;
 
-    //! This locks application instance list.
+    //! This locks application instance list and indexes.
     pthread_mutex_t _mutex;
     //! Registers signal handler.
     struct sigaction _act;
@@ -268,12 +296,28 @@ private:
     bool
     searchExec(const char* exec, std::string& path);
 
+    //! Adds instance to list and indexes, caller must hold lock.
+    void
+    addInstance(AppInstance* instance);
+
+    //! Removes instance from list and indexes, caller must hold lock.
+    void
+    removeInstance(AppInstance* instance);
+
+    //! Returns instance whose own process ID is pid without checking ancestors.
+    AppInstance*
+    instanceByOwnPID(const pid_t pid);
+
+    //! Clears resolved process IDs, caller must hold lock.
+    void
+    invalidatePIDCache();
+
     //! Slot, handles a memory state change.
     void
     handleMemoryState(MemoryMonitor::MemoryState state);
 
     friend void
-    sigchild_handler(int sig, siginfo_t *siginfo, void *context);
+    child_changed(void* data);
 
     // SaWMan callbacks...
     friend DirectResult
@@ -285,6 +329,9 @@ private:
     friend DirectResult
     process_added(void *context, SaWManProcess *process);
 
+    friend DirectResult
+    process_removed(void *context, SaWManProcess *process);
+
     friend DirectResult
     window_preconfig(void *context, SaWManWindowConfig *config);
 
@@ -929,6 +929,13 @@ ILXCompositor::parseSettings()
             xmlChar* duration = xmlNodeGetContent(element);
             settings.notificationTimeout = atoi((char*) duration);
             xmlFree(duration);
+        } else if (xmlStrcmp(group->name, (xmlChar*) "thumbnails") == 0)
+        {
+            element = group->children;
+            xmlChar* fps = xmlNodeGetContent(element);
+            settings.thumbnailFPS = atoi((char*) fps);
+            ILOG_DEBUG(ILX_COMPOSITOR, "    -> thumbnailFPS: %u\n", settings.thumbnailFPS);
+            xmlFree(fps);
         }
         group = group->next;
     }
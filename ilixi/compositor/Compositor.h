@@ -48,6 +48,7 @@ class ILXCompositor : public Application
     friend class CompositorComponent;
     friend class NotificationManager;
     friend class OSKComponent;
+    friend class AppThumbnail;
     friend class AppView;
     friend class Notification;
 
@@ -262,7 +263,8 @@ private:
                   memCritical(0.2),
                   memLow(0.5),
                   pgCritical(30),
-                  pgLow(10)
+                  pgLow(10),
+                  thumbnailFPS(5)
         {
         }
 
@@ -280,6 +282,7 @@ private:
         double memLow;
         int pgCritical;
         int pgLow;
+        unsigned int thumbnailFPS;                  //!< Maximum refresh rate of thumbnails, 0 means every frame.
     };
 
     //! This property is used by compositor components.
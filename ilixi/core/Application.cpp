@@ -28,6 +28,7 @@
 #include <core/PlatformManager.h>
 
 #include <graphics/Stylist.h>
+#include <lib/FrameStats.h>
 
 #include <directfb_util.h>
 #include <algorithm>
@@ -167,11 +168,15 @@ Application::exec()
             break;
         else
         {
+            FrameStats::instance().beginFrame();
             __instance->handleEvents(Engine::instance().cycle());
             updateWindows();
+            FrameStats::instance().endFrame();
         }
     }
 
+    FrameStats::instance().report();
+
     hide();
 
     ILOG_INFO(ILX_APPLICATION, "Stopping...\n");
@@ -334,6 +339,7 @@ Application::setFrameTime(long long micros)
 {
     if (__instance)
         __instance->_frameTime = micros;
+    Engine::instance().setFrameTime(micros);
 }
 #endif
 
@@ -396,9 +402,15 @@ Application::handleEvents(int32_t timeout, bool forceWait)
         }
     }
 
+    FrameStats& stats = FrameStats::instance();
     if (wait)
+    {
+        stats.begin(FrameStats::Wait);
         Engine::instance().waitForEvents(timeout);
+        stats.end(FrameStats::Wait);
+    }
 
+    stats.begin(FrameStats::Events);
     DFBEvent event;
 #if ILIXI_HAVE_MOTION_COMPRESSION
     DFBWindowEvent lastMotion; // Used for compressing motion events.
@@ -422,14 +434,17 @@ Application::handleEvents(int32_t timeout, bool forceWait)
                 break;
 
             case DIET_BUTTONPRESS:
+                stats.addPointerEvent(event.input.timestamp);
                 handleButtonInputEvent((const DFBInputEvent&) event, DWET_BUTTONDOWN);
                 break;
 
             case DIET_BUTTONRELEASE:
+                stats.addPointerEvent(event.input.timestamp);
                 handleButtonInputEvent((const DFBInputEvent&) event, DWET_BUTTONUP);
                 break;
 
             case DIET_AXISMOTION:
+                stats.addPointerEvent(event.input.timestamp);
                 handleAxisMotion((const DFBInputEvent&) event);
                 break;
 
@@ -442,6 +457,8 @@ Application::handleEvents(int32_t timeout, bool forceWait)
         case DFEC_WINDOW:
             if (!(PlatformManager::instance().appOptions() & OptExclusive) && event.window.type != DWET_UPDATE)
             {
+                if (event.window.type & (DWET_BUTTONDOWN | DWET_BUTTONUP | DWET_MOTION | DWET_WHEEL))
+                    stats.addPointerEvent(event.window.timestamp);
 #if ILIXI_HAVE_MOTION_COMPRESSION
                 if (event.window.type == DWET_MOTION && event.window.buttons == 0)
                     lastMotion = event.window;
@@ -488,6 +505,7 @@ Application::handleEvents(int32_t timeout, bool forceWait)
         if (!windowPreEventFilter((const DFBWindowEvent&) lastMotion))
             handleWindowEvents((const DFBWindowEvent&) lastMotion);
 #endif
+    stats.end(FrameStats::Events);
     ILOG_DEBUG(ILX_APPLICATION_EVENTS, " -> end handle events \n");
 }
 
@@ -30,9 +30,11 @@
 namespace ilixi
 {
 
-Callback::Callback(Functionoid* funck)
+Callback::Callback(Functionoid* funck, unsigned int interval)
         : _funck(funck),
-          _running(false)
+          _running(false),
+          _interval(interval),
+          _next(0)
 {
 }
 
@@ -55,4 +57,16 @@ Callback::stop()
     Engine::instance().removeCallback(this);
 }
 
+unsigned int
+Callback::interval() const
+{
+    return _interval;
+}
+
+void
+Callback::setInterval(unsigned int msec)
+{
+    _interval = msec;
+}
+
 } /* namespace ilixi */
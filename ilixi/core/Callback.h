@@ -24,6 +24,8 @@
 #ifndef ILIXI_CALLBACK_H_
 #define ILIXI_CALLBACK_H_
 
+#include <stdint.h>
+
 namespace ilixi
 {
 
@@ -32,7 +34,9 @@ class Functionoid
 {
 public:
     /*!
-     * This method is executed at each iteration of application main loop.
+     * This method is executed by application main loop at intervals of its Callback.
+     *
+     * Returning false removes callback from main loop.
      */
     virtual bool
     funck() = 0;
@@ -47,6 +51,10 @@ Functionoid::~Functionoid()
 }
 
 //! Inserts/removes Functionoids to/from main loop.
+/*!
+ * A callback runs once per frame by default, see Engine::frameInterval(). Main loop
+ * sleeps until next callback is due or an event arrives.
+ */
 class Callback
 {
     friend class Engine;
@@ -54,8 +62,11 @@ class Callback
 public:
     /*!
      * Constructor.
+     *
+     * @param funck executed by main loop.
+     * @param interval in milliseconds, 0 runs funck once per frame.
      */
-    Callback(Functionoid* funck);
+    Callback(Functionoid* funck, unsigned int interval = 0);
 
     /*!
      * Destructor.
@@ -75,11 +86,29 @@ public:
     void
     stop();
 
+    /*!
+     * Returns interval in milliseconds, 0 if callback runs once per frame.
+     */
+    unsigned int
+    interval() const;
+
+    /*!
+     * Sets interval in milliseconds.
+     *
+     * @param msec 0 runs callback once per frame.
+     */
+    void
+    setInterval(unsigned int msec);
+
 private:
     //! Managed.
     Functionoid* _funck;
     //! This flag specifies whether callback is actively running.
     bool _running;
+    //! This property stores interval in milliseconds.
+    unsigned int _interval;
+    //! Time when callback is due in milliseconds, 0 runs it at next cycle.
+    int64_t _next;
 };
 }
 
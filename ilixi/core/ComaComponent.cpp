@@ -24,6 +24,7 @@
 #include <core/ComaComponent.h>
 #include <core/Logger.h>
 #include <core/DaleDFB.h>
+#include <core/ComponentData.h>
 
 namespace ilixi
 {
@@ -35,7 +36,11 @@ ComaComponentMethod(void *ctx, ComaMethodID method, void *arg, unsigned int magi
 {
     ILOG_TRACE_F(ILX_COMACOMP);
     ComaComponent* comp = (ComaComponent*) ctx;
-    DirectResult ret = comp->comaMethod(method, arg);
+    DirectResult ret;
+    if (method == ILX_COMA_BATCH_METHOD)
+        ret = comp->comaBatch(arg);
+    else
+        ret = comp->comaMethod(method, arg);
     comp->_component->Return(comp->_component, ret, magic);
 }
 
@@ -91,6 +96,33 @@ ComaComponent::comaMethod(ComaMethodID method, void* arg)
     return DR_NOIMPL;
 }
 
+DirectResult
+ComaComponent::comaBatch(void* arg)
+{
+    ILOG_TRACE_F(ILX_COMACOMP);
+    if (!arg)
+        return DR_INVARG;
+
+    // layout must match ComaDispatcher::queueBatches().
+    const unsigned int align = 8;
+    char* ptr = (char*) arg;
+    unsigned int count = ((ComaBatchHeader*) ptr)->count;
+    ptr += (sizeof(ComaBatchHeader) + align - 1) & ~(align - 1);
+    ILOG_DEBUG(ILX_COMACOMP, " -> %s batch of %u calls\n", _name.c_str(), count);
+
+    DirectResult ret = DR_OK;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        ComaBatchCall* call = (ComaBatchCall*) ptr;
+        ptr += (sizeof(ComaBatchCall) + align - 1) & ~(align - 1);
+        DirectResult res = comaMethod(call->method, call->bytes ? ptr : NULL);
+        if (res && !ret)
+            ret = res;
+        ptr += (call->bytes + align - 1) & ~(align - 1);
+    }
+    return ret;
+}
+
 void
 ComaComponent::createNotification(ComaNotificationID id, ComaNotifyFunc func, ComaNotificationFlags flags)
 {
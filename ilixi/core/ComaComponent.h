@@ -100,6 +100,14 @@ protected:
     virtual DirectResult
     comaMethod(ComaMethodID method, void* arg);
 
+    /*!
+     * Executes comaMethod() for each call in a batch sent by ComaDispatcher.
+     *
+     * Returns the first error, if any.
+     */
+    DirectResult
+    comaBatch(void* arg);
+
     /*!
      * Setup a notification.
      *
@@ -0,0 +1,333 @@
+/*
+ Copyright 2010-2015 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <core/ComaDispatcher.h>
+#include <core/ComponentData.h>
+#include <core/DaleDFB.h>
+#include <core/Engine.h>
+#include <core/Logger.h>
+#include <direct/clock.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace ilixi
+{
+
+D_DEBUG_DOMAIN(ILX_COMADISPATCHER, "ilixi/core/ComaDispatcher", "ComaDispatcher");
+
+// arguments in a batch are aligned to this many bytes.
+static const unsigned int ILX_COMA_BATCH_ALIGN = 8;
+
+ComaDispatcher&
+ComaDispatcher::instance()
+{
+    static ComaDispatcher instance;
+    return instance;
+}
+
+ComaDispatcher::ComaDispatcher()
+        : _flushPosted(false),
+          _running(false),
+          _quit(false)
+{
+    pthread_mutex_init(&_lock, NULL);
+    pthread_cond_init(&_cond, NULL);
+}
+
+ComaDispatcher::~ComaDispatcher()
+{
+    stop();
+    pthread_cond_destroy(&_cond);
+    pthread_mutex_destroy(&_lock);
+}
+
+bool
+ComaDispatcher::call(IComaComponent* component, ComaMethodID method, const void* arg, unsigned int bytes, CompletionFunc func, void* ctx)
+{
+    if (!component)
+        return false;
+
+    Request request;
+    request.component = component;
+    request.method = method;
+    if (arg && bytes)
+        request.data.assign((const char*) arg, (const char*) arg + bytes);
+    request.queued.push_back(direct_clock_get_micros());
+    request.func = func;
+    request.ctx = ctx;
+
+    pthread_mutex_lock(&_lock);
+    if (_quit || !startThread())
+    {
+        pthread_mutex_unlock(&_lock);
+        return false;
+    }
+    _queue.push_back(request);
+    ILOG_DEBUG(ILX_COMADISPATCHER, "[%p] Queued method %lu bytes: %u\n", component, (unsigned long) method, bytes);
+    pthread_cond_signal(&_cond);
+    pthread_mutex_unlock(&_lock);
+    return true;
+}
+
+bool
+ComaDispatcher::post(IComaComponent* component, ComaMethodID method, const void* arg, unsigned int bytes)
+{
+    if (!component)
+        return false;
+
+    Request request;
+    request.component = component;
+    request.method = method;
+    if (arg && bytes)
+        request.data.assign((const char*) arg, (const char*) arg + bytes);
+    request.queued.push_back(direct_clock_get_micros());
+    request.func = NULL;
+    request.ctx = NULL;
+
+    pthread_mutex_lock(&_lock);
+    if (_quit)
+    {
+        pthread_mutex_unlock(&_lock);
+        return false;
+    }
+    _batches[component].push_back(request);
+    ILOG_DEBUG(ILX_COMADISPATCHER, "[%p] Batched method %lu bytes: %u\n", component, (unsigned long) method, bytes);
+
+    bool flush = !_flushPosted;
+    _flushPosted = true;
+    pthread_mutex_unlock(&_lock);
+
+    // batches are sent once current loop iteration is done.
+    if (flush && !Engine::instance().post(flushBatches, this))
+        flushBatches(this);
+    return true;
+}
+
+ComaDispatcher::Stats
+ComaDispatcher::stats() const
+{
+    pthread_mutex_lock(&_lock);
+    Stats stats = _stats;
+    pthread_mutex_unlock(&_lock);
+    return stats;
+}
+
+void
+ComaDispatcher::resetStats()
+{
+    pthread_mutex_lock(&_lock);
+    _stats = Stats();
+    pthread_mutex_unlock(&_lock);
+}
+
+void
+ComaDispatcher::stop()
+{
+    pthread_mutex_lock(&_lock);
+    _quit = true;
+    _queue.clear();
+    _batches.clear();
+    pthread_cond_broadcast(&_cond);
+    bool join = _running;
+    _running = false;
+    pthread_mutex_unlock(&_lock);
+
+    if (join)
+        pthread_join(_thread, NULL);
+    ILOG_DEBUG(ILX_COMADISPATCHER, "Stopped, calls: %u messages: %u failures: %u\n", _stats.calls, _stats.messages, _stats.failures);
+}
+
+bool
+ComaDispatcher::startThread()
+{
+    if (_running)
+        return true;
+
+    if (pthread_create(&_thread, NULL, workerLoop, this) != 0)
+    {
+        ILOG_ERROR(ILX_COMADISPATCHER, "Cannot create worker thread!\n");
+        return false;
+    }
+    _running = true;
+    return true;
+}
+
+void
+ComaDispatcher::flushBatches(void* arg)
+{
+    ComaDispatcher* dispatcher = (ComaDispatcher*) arg;
+    pthread_mutex_lock(&dispatcher->_lock);
+    dispatcher->_flushPosted = false;
+    if (!dispatcher->_quit && dispatcher->startThread())
+    {
+        dispatcher->queueBatches();
+        pthread_cond_signal(&dispatcher->_cond);
+    }
+    pthread_mutex_unlock(&dispatcher->_lock);
+}
+
+void
+ComaDispatcher::queueBatches()
+{
+    for (BatchMap::iterator it = _batches.begin(); it != _batches.end(); ++it)
+    {
+        RequestList& calls = it->second;
+        if (calls.size() == 1)
+        {
+            _queue.push_back(calls.front());
+            continue;
+        }
+
+        Request batch;
+        batch.component = it->first;
+        batch.method = ILX_COMA_BATCH_METHOD;
+        batch.func = NULL;
+        batch.ctx = NULL;
+
+        ComaBatchHeader header;
+        header.count = calls.size();
+        batch.data.assign((const char*) &header, (const char*) &header + sizeof(header));
+        batch.data.resize((sizeof(header) + ILX_COMA_BATCH_ALIGN - 1) & ~(ILX_COMA_BATCH_ALIGN - 1));
+
+        for (RequestList::iterator call = calls.begin(); call != calls.end(); ++call)
+        {
+            ComaBatchCall entry;
+            entry.method = call->method;
+            entry.bytes = call->data.size();
+            batch.data.insert(batch.data.end(), (const char*) &entry, (const char*) &entry + sizeof(entry));
+            batch.data.resize((batch.data.size() + ILX_COMA_BATCH_ALIGN - 1) & ~(ILX_COMA_BATCH_ALIGN - 1));
+            batch.data.insert(batch.data.end(), call->data.begin(), call->data.end());
+            batch.data.resize((batch.data.size() + ILX_COMA_BATCH_ALIGN - 1) & ~(ILX_COMA_BATCH_ALIGN - 1));
+            batch.queued.push_back(call->queued.front());
+        }
+        ILOG_DEBUG(ILX_COMADISPATCHER, "[%p] Batch of %u calls, %d bytes\n", it->first, header.count, (int) batch.data.size());
+        _queue.push_back(batch);
+    }
+    _batches.clear();
+}
+
+void*
+ComaDispatcher::workerLoop(void* arg)
+{
+    ComaDispatcher* dispatcher = (ComaDispatcher*) arg;
+    IComa* coma = DaleDFB::getComa();
+    // shared memory returned by GetLocal() belongs to this thread, so it is reused.
+    void* local = NULL;
+    unsigned int localSize = 0;
+
+    while (true)
+    {
+        pthread_mutex_lock(&dispatcher->_lock);
+        while (dispatcher->_queue.empty() && !dispatcher->_quit)
+            pthread_cond_wait(&dispatcher->_cond, &dispatcher->_lock);
+
+        if (dispatcher->_quit)
+        {
+            pthread_mutex_unlock(&dispatcher->_lock);
+            break;
+        }
+
+        Request request = dispatcher->_queue.front();
+        dispatcher->_queue.pop_front();
+        pthread_mutex_unlock(&dispatcher->_lock);
+
+        DFBResult result = DFB_OK;
+        if (request.data.size() > localSize)
+        {
+            if (coma->GetLocal(coma, request.data.size(), &local) == DR_OK)
+                localSize = request.data.size();
+            else
+            {
+                ILOG_ERROR(ILX_COMADISPATCHER, "GetLocal( %d ) failed!\n", (int) request.data.size());
+                local = NULL;
+                localSize = 0;
+                result = DFB_NOSHAREDMEMORY;
+            }
+        }
+
+        if (result == DFB_OK)
+        {
+            if (request.data.size())
+                memcpy(local, &request.data[0], request.data.size());
+
+            int retVal = DR_OK;
+            DirectResult ret = request.component->Call(request.component, request.method, request.data.size() ? local : NULL, &retVal);
+            if (ret)
+                result = (DFBResult) ret;
+            else if (retVal)
+                result = (DFBResult) retVal;
+        }
+
+        long long now = direct_clock_get_micros();
+        pthread_mutex_lock(&dispatcher->_lock);
+        dispatcher->_stats.messages++;
+        for (unsigned int i = 0; i < request.queued.size(); ++i)
+        {
+            long long latency = now - request.queued[i];
+            dispatcher->_stats.calls++;
+            dispatcher->_stats.totalLatency += latency;
+            if (latency > dispatcher->_stats.maxLatency)
+                dispatcher->_stats.maxLatency = latency;
+            if (result)
+                dispatcher->_stats.failures++;
+        }
+        pthread_mutex_unlock(&dispatcher->_lock);
+
+        if (result)
+            ILOG_ERROR(ILX_COMADISPATCHER, "[%p] Method %lu failed: %s\n", request.component, (unsigned long) request.method, DirectFBErrorString(result));
+        else
+            ILOG_DEBUG(ILX_COMADISPATCHER, "[%p] Method %lu done, calls: %d latency: %lld us\n", request.component, (unsigned long) request.method, (int) request.queued.size(), now - request.queued[0]);
+
+        if (request.func)
+        {
+            Completion* completion = new Completion;
+            completion->func = request.func;
+            completion->ctx = request.ctx;
+            completion->result = result;
+            if (result == DFB_OK && request.data.size())
+                completion->data.assign((const char*) local, (const char*) local + request.data.size());
+
+            while (!Engine::instance().post(deliver, completion))
+            {
+                if (dispatcher->_quit)
+                {
+                    delete completion;
+                    break;
+                }
+                usleep(1000);
+            }
+        }
+    }
+    return NULL;
+}
+
+void
+ComaDispatcher::deliver(void* arg)
+{
+    Completion* completion = (Completion*) arg;
+    completion->func(completion->ctx, completion->result, completion->data.size() ? &completion->data[0] : NULL, completion->data.size());
+    delete completion;
+}
+
+} /* namespace ilixi */
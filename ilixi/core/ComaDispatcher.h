@@ -0,0 +1,207 @@
+/*
+ Copyright 2010-2015 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef ILIXI_COMADISPATCHER_H_
+#define ILIXI_COMADISPATCHER_H_
+
+#include <directfb.h>
+extern "C"
+{
+#include <fusiondale.h>
+}
+#include <pthread.h>
+#include <list>
+#include <map>
+#include <vector>
+
+namespace ilixi
+{
+//! Performs Coma calls on a worker thread.
+/*!
+ * IComaComponent::Call() blocks until the component returns. ComaDispatcher queues
+ * calls and makes them from its own thread, so the UI thread does not wait for
+ * round trips.
+ *
+ * Calls made with call() are sent one by one and their completion function is
+ * executed by the main loop. Fire-and-forget calls made with post() are collected
+ * per component and sent as a single ILX_COMA_BATCH_METHOD call once per main
+ * loop iteration. ComaComponent unpacks batches on the receiving side.
+ *
+ * Calls are sent in queue order. Posted calls are queued when their batch is flushed.
+ */
+class ComaDispatcher
+{
+    friend class DaleDFB;
+
+public:
+    /*!
+     * This function is executed by main loop once an asynchronous call completes.
+     *
+     * @param ctx given to call().
+     * @param result of call.
+     * @param arg copy of argument after call, e.g. to read values returned by component.
+     * @param bytes size of arg.
+     */
+    typedef void
+    (*CompletionFunc)(void* ctx, DFBResult result, const void* arg, unsigned int bytes);
+
+    //! Counters for calls made by dispatcher.
+    struct Stats
+    {
+        Stats()
+                : calls(0),
+                  messages(0),
+                  failures(0),
+                  totalLatency(0),
+                  maxLatency(0)
+        {
+        }
+
+        unsigned int calls;         //!< Number of calls, including the ones in batches.
+        unsigned int messages;      //!< Number of IComaComponent::Call() invocations.
+        unsigned int failures;      //!< Number of failed calls.
+        long long totalLatency;     //!< Sum of time from queuing until completion of calls in microseconds.
+        long long maxLatency;       //!< Largest latency of a call in microseconds.
+    };
+
+    /*!
+     * Returns the instance.
+     */
+    static ComaDispatcher&
+    instance();
+
+    /*!
+     * Queues an asynchronous call.
+     *
+     * @param component target component.
+     * @param method to invoke.
+     * @param arg is copied into shared memory, may be NULL.
+     * @param bytes size of arg.
+     * @param func executed by main loop once call completes, may be NULL.
+     * @param ctx passed to func.
+     *
+     * Returns false if dispatcher is stopped.
+     */
+    bool
+    call(IComaComponent* component, ComaMethodID method, const void* arg, unsigned int bytes, CompletionFunc func = NULL, void* ctx = NULL);
+
+    /*!
+     * Adds a fire-and-forget call to the batch of component.
+     *
+     * @param component target component.
+     * @param method to invoke.
+     * @param arg is copied into shared memory, may be NULL.
+     * @param bytes size of arg.
+     *
+     * Returns false if dispatcher is stopped.
+     */
+    bool
+    post(IComaComponent* component, ComaMethodID method, const void* arg, unsigned int bytes);
+
+    /*!
+     * Returns counters.
+     */
+    Stats
+    stats() const;
+
+    /*!
+     * Resets counters.
+     */
+    void
+    resetStats();
+
+private:
+    struct Request
+    {
+        IComaComponent* component;
+        ComaMethodID method;
+        //! Argument, or packed calls for a batch.
+        std::vector<char> data;
+        //! Queue time of each call in microseconds.
+        std::vector<long long> queued;
+        CompletionFunc func;
+        void* ctx;
+    };
+
+    struct Completion
+    {
+        CompletionFunc func;
+        void* ctx;
+        DFBResult result;
+        std::vector<char> data;
+    };
+
+    typedef std::list<Request> RequestList;
+    typedef std::map<IComaComponent*, RequestList> BatchMap;
+
+    //! This mutex serialises access to queue, batches and counters.
+    mutable pthread_mutex_t _lock;
+    //! This condition is signalled once a request is queued.
+    pthread_cond_t _cond;
+    //! Requests waiting for worker.
+    RequestList _queue;
+    //! Batches which are not flushed yet.
+    BatchMap _batches;
+    //! True if flushBatches() is posted to main loop.
+    bool _flushPosted;
+    //! Worker thread.
+    pthread_t _thread;
+    //! True if worker thread is created.
+    bool _running;
+    //! Set to stop worker thread.
+    bool _quit;
+    //! Counters.
+    Stats _stats;
+
+    ComaDispatcher();
+
+    ~ComaDispatcher();
+
+    //! Stops worker thread and drops queued calls, e.g. before components are released.
+    void
+    stop();
+
+    //! Creates worker thread if necessary, caller must hold lock.
+    bool
+    startThread();
+
+    //! Moves batches to queue, executed by main loop.
+    static void
+    flushBatches(void* arg);
+
+    //! Moves batches to queue, caller must hold lock.
+    void
+    queueBatches();
+
+    //! Worker thread.
+    static void*
+    workerLoop(void* arg);
+
+    //! Executes completion function in main loop.
+    static void
+    deliver(void* arg);
+};
+
+} /* namespace ilixi */
+#endif /* ILIXI_COMADISPATCHER_H_ */
@@ -30,6 +30,27 @@
 #ifdef __cplusplus
 namespace ilixi
 {
+#endif
+//****************************************************************************
+// Batched calls
+//****************************************************************************
+//! This method ID is reserved for a batch of calls to a component, see ComaComponent.
+#define ILX_COMA_BATCH_METHOD 0x7fffffff
+
+//! This structure is at the start of a batch argument and it is followed by calls.
+typedef struct
+{
+    unsigned int count;     //!< Number of calls in batch.
+} ComaBatchHeader;
+
+//! This structure is followed by argument of call, padded to 8 bytes.
+typedef struct
+{
+    unsigned long method;   //!< Method ID of call, i.e. ComaMethodID.
+    unsigned int bytes;     //!< Size of argument, 0 if argument is NULL.
+} ComaBatchCall;
+
+#ifdef __cplusplus
 //****************************************************************************
 // ilixi::OSK (On-Screen-Keyboard)
 //****************************************************************************
@@ -26,6 +26,7 @@
 #include <core/Logger.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <string.h>
 
 namespace ilixi
 {
@@ -106,6 +107,25 @@ DaleDFB::comaCallComponent(IComaComponent* component, ComaMethodID method, void*
     }
     return DFB_FAILURE;
 }
+
+DFBResult
+DaleDFB::comaCallAsync(IComaComponent* component, ComaMethodID method, const void* arg, unsigned int bytes, ComaDispatcher::CompletionFunc func, void* ctx)
+{
+    ILOG_TRACE_F(ILX_DALEDFB);
+    if (!__coma || !component)
+        return DFB_FAILURE;
+    return ComaDispatcher::instance().call(component, method, arg, bytes, func, ctx) ? DFB_OK : DFB_FAILURE;
+}
+
+DFBResult
+DaleDFB::comaPost(IComaComponent* component, ComaMethodID method, const void* arg, unsigned int bytes)
+{
+    ILOG_TRACE_F(ILX_DALEDFB);
+    if (!__coma || !component)
+        return DFB_FAILURE;
+    return ComaDispatcher::instance().post(component, method, arg, bytes) ? DFB_OK : DFB_FAILURE;
+}
+
 #if ILIXI_HAVE_COMPOSITOR
 DFBResult
 DaleDFB::showOSK(const Rectangle& rect, TextInputMode mode)
@@ -120,19 +140,7 @@ DaleDFB::showOSK(const Rectangle& rect, TextInputMode mode)
     request.mode = mode;
     request.process = getpid();
 
-    void *ptr;
-    __coma->GetLocal(__coma, sizeof(OSKRequest), &ptr);
-    OSKRequest* req = (OSKRequest*) ptr;
-    *req = request;
-
-    int ret_val;
-    DirectResult ret = __oskComp->Call(__oskComp, 0, (void*) req, &ret_val);
-    if (ret)
-    {
-        D_DERROR(ret, "WebKit/DFB: %s() failed!\n", __FUNCTION__);
-        return (DFBResult) ret;
-    }
-    return DFB_OK;
+    return ComaDispatcher::instance().post(__oskComp, 0, &request, sizeof(request)) ? DFB_OK : DFB_FAILURE;
 }
 
 DFBResult
@@ -143,14 +151,7 @@ DaleDFB::hideOSK()
     if (getOSKComp() == DFB_FAILURE)
         return DFB_FAILURE;
 
-    int ret_val;
-    DirectResult ret = __oskComp->Call(__oskComp, 1, NULL, &ret_val);
-    if (ret)
-    {
-        D_DERROR(ret, "WebKit/DFB: %s() failed!\n", __FUNCTION__);
-        return (DFBResult) ret;
-    }
-    return DFB_OK;
+    return ComaDispatcher::instance().post(__oskComp, 1, NULL, 0) ? DFB_OK : DFB_FAILURE;
 }
 #endif
 
@@ -191,6 +192,8 @@ void
 DaleDFB::releaseDale()
 {
     ILOG_TRACE_F(ILX_DALEDFB);
+    // worker thread must not use components once they are released.
+    ComaDispatcher::instance().stop();
 #if ILIXI_HAVE_COMPOSITOR
     if (__soundComp)
     {
@@ -300,12 +303,12 @@ DaleDFB::getSoundComp()
 }
 
 DFBResult
-DaleDFB::addNotification(Notify* n, void* data)
+DaleDFB::addNotification(Notify* n, const void* data)
 {
     if (getCompComp() == DFB_FAILURE)
         return DFB_FAILURE;
 
-    if (comaCallComponent(__compComp, Compositor::AddNotification, data) == DFB_OK)
+    if (ComaDispatcher::instance().post(__compComp, Compositor::AddNotification, data, sizeof(Compositor::NotificationData)))
     {
         __nots.push_back(n);
         __nots.sort();
@@ -361,10 +364,9 @@ DaleDFB::playSoundEffect(const std::string& id)
     if (getSoundComp() == DFB_FAILURE)
         return DFB_FAILURE;
 
-    void *ptr;
-    comaGetLocal(128, &ptr);
-    snprintf((char*) ptr, 128, "%s", id.c_str());
-    return comaCallComponent(__soundComp, SoundMixer::PlaySoundEffect, ptr);
+    char buffer[128];
+    snprintf(buffer, 128, "%s", id.c_str());
+    return ComaDispatcher::instance().post(__soundComp, SoundMixer::PlaySoundEffect, buffer, strlen(buffer) + 1) ? DFB_OK : DFB_FAILURE;
 }
 
 DFBResult
@@ -373,11 +375,7 @@ DaleDFB::setSoundEffectLevel(float level)
     if (getSoundComp() == DFB_FAILURE)
         return DFB_FAILURE;
 
-    void *ptr;
-    DaleDFB::comaGetLocal(sizeof(float), &ptr);
-    float* vol = (float*) ptr;
-    *vol = level;
-    return DaleDFB::comaCallComponent(__soundComp, SoundMixer::SetSoundEffectVolume, (void*) vol);
+    return ComaDispatcher::instance().post(__soundComp, SoundMixer::SetSoundEffectVolume, &level, sizeof(float)) ? DFB_OK : DFB_FAILURE;
 }
 #endif
 } /* namespace ilixi */
@@ -30,6 +30,7 @@ extern "C"
 #include <fusiondale.h>
 }
 #include <ilixiConfig.h>
+#include <core/ComaDispatcher.h>
 #if ILIXI_HAVE_COMPOSITOR
 #include <lib/Notify.h>
 #endif
@@ -75,6 +76,27 @@ public:
      */
     static DFBResult
     comaCallComponent(IComaComponent* component, ComaMethodID method, void* arg);
+
+    /*!
+     * Performs method invocation without blocking, see ComaDispatcher::call().
+     *
+     * @param component target component.
+     * @param method to invoke.
+     * @param arg is copied, may be NULL.
+     * @param bytes size of arg.
+     * @param func executed by main loop once call completes, may be NULL.
+     * @param ctx passed to func.
+     */
+    static DFBResult
+    comaCallAsync(IComaComponent* component, ComaMethodID method, const void* arg, unsigned int bytes, ComaDispatcher::CompletionFunc func = NULL, void* ctx = NULL);
+
+    /*!
+     * Queues a fire-and-forget method invocation, see ComaDispatcher::post().
+     *
+     * Calls posted to a component during a main loop iteration are sent in a single message.
+     */
+    static DFBResult
+    comaPost(IComaComponent* component, ComaMethodID method, const void* arg, unsigned int bytes);
 #if ILIXI_HAVE_COMPOSITOR
     /*!
      * Shows on-screen-keyboard.
@@ -151,9 +173,11 @@ private:
 
     /*!
      * Sends a notification to compositor via Compositor Component.
+     *
+     * @param data points to a Compositor::NotificationData which is copied.
      */
     static DFBResult
-    addNotification(Notify*, void* data);
+    addNotification(Notify*, const void* data);
 
     static DFBResult
     removeNotification(Notify*);
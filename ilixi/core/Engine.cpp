@@ -25,6 +25,9 @@
 
 #include <core/Logger.h>
 #include <core/PlatformManager.h>
+#include <lib/AnimationClock.h>
+#include <lib/FrameStats.h>
+#include <ui/Widget.h>
 
 #include <algorithm>
 
@@ -37,12 +40,6 @@ D_DEBUG_DOMAIN(ILX_ENGINE, "ilixi/core/Engine", "Engine");
 D_DEBUG_DOMAIN(ILX_ENGINE_LOOP, "ilixi/core/Engine_Cycle", "Engine cycle");
 D_DEBUG_DOMAIN(ILX_ENGINE_UPDATES, "ilixi/core/Engine/Updates", "Engine Updates");
 
-static bool
-timerSort(const Timer* first, const Timer* second)
-{
-    return first->expiry() < second->expiry();
-}
-
 Engine&
 Engine::instance()
 {
@@ -52,9 +49,22 @@ Engine::instance()
 
 Engine::Engine()
         : __buffer(NULL),
-          _terminate(false)
+          _terminate(false),
+          __cbDepth(0),
+          __cbRemoved(false),
+          _frameInterval(0),
+          _framePhase(0),
+          __postPending(0),
+          _animationClock(NULL),
+          _timerSlack(1)
 {
     ILOG_TRACE(ILX_ENGINE);
+    char* var = getenv("ILX_TIMERSLACK");
+    if (var)
+        _timerSlack = atoi(var);
+    var = getenv("ILX_FRAMEINTERVAL");
+    if (var)
+        _frameInterval = atoi(var);
 }
 
 Engine::~Engine()
@@ -77,6 +87,10 @@ Engine::initialise()
     pthread_mutexattr_destroy(&attr);
 
     initEventBuffer();
+    if (!_frameInterval)
+        detectFrameInterval();
+    _animationClock = new AnimationClock();
+    _animationClock->setInterval(_frameInterval);
 
 }
 
@@ -85,6 +99,8 @@ Engine::release()
 {
     ILOG_TRACE(ILX_ENGINE);
     stop();
+    delete _animationClock;
+    _animationClock = NULL;
     releaseEventBuffer();
     pthread_mutex_destroy(&__cbMutex);
     pthread_mutex_destroy(&__timerMutex);
@@ -96,9 +112,25 @@ Engine::release()
 int32_t
 Engine::cycle()
 {
+    FrameStats& stats = FrameStats::instance();
+    stats.begin(FrameStats::Posted);
+    runPosted();
+    stats.end(FrameStats::Posted);
+
+    stats.begin(FrameStats::Callbacks);
     runCallbacks();
     sigPerformWork();
-    return runTimers();
+    stats.end(FrameStats::Callbacks);
+
+    stats.begin(FrameStats::Timers);
+    int32_t timeout = runTimers();
+    stats.end(FrameStats::Timers);
+
+    // callbacks may be added by timers, so check them last.
+    int32_t next = nextCallback();
+    if (next >= 0 && next < timeout)
+        timeout = next;
+    return timeout;
 }
 
 void
@@ -130,17 +162,21 @@ Engine::addCallback(Callback* cb)
     {
         pthread_mutex_lock(&__cbMutex);
 
-        CallbackList::iterator it = std::find(__callbacks.begin(), __callbacks.end(), cb);
-        if (cb == *it)
+        if (std::find(__callbacks.begin(), __callbacks.end(), cb) != __callbacks.end())
         {
-        	cb->_running = true;
+            cb->_running = true;
             pthread_mutex_unlock(&__cbMutex);
             ILOG_DEBUG(ILX_ENGINE, "Callback %p already added!\n", cb);
             return false;
         }
+        cb->_running = true;
+        cb->_next = 0;
         __callbacks.push_back(cb);
 
         pthread_mutex_unlock(&__cbMutex);
+        // main loop may be sleeping until next frame.
+        if (__buffer)
+            __buffer->WakeUp(__buffer);
         ILOG_DEBUG(ILX_ENGINE, "Callback %p is added.\n", cb);
         return true;
     }
@@ -155,16 +191,20 @@ Engine::removeCallback(Callback* cb)
     {
         pthread_mutex_lock(&__cbMutex);
 
-        for (CallbackList::iterator it = __callbacks.begin(); it != __callbacks.end(); ++it)
+        CallbackVector::iterator it = std::find(__callbacks.begin(), __callbacks.end(), cb);
+        if (it != __callbacks.end())
         {
-            if (cb == *it)
+            cb->_running = false;
+            // keep indices valid while runCallbacks() iterates.
+            if (__cbDepth)
             {
-            	cb->_running = false;
+                *it = NULL;
+                __cbRemoved = true;
+            } else
                 __callbacks.erase(it);
-                pthread_mutex_unlock(&__cbMutex);
-                ILOG_DEBUG(ILX_ENGINE, "Callback %p is removed.\n", cb);
-                return true;
-            }
+            pthread_mutex_unlock(&__cbMutex);
+            ILOG_DEBUG(ILX_ENGINE, "Callback %p is removed.\n", cb);
+            return true;
         }
 
         pthread_mutex_unlock(&__cbMutex);
@@ -185,15 +225,15 @@ Engine::addTimer(Timer* timer)
     if (timer)
     {
         pthread_mutex_lock(&__timerMutex);
-        TimerList::iterator it = std::find(_timers.begin(), _timers.end(), timer);
-        if (timer == *it)
+        if (timer->_heapIndex != -1)
         {
             pthread_mutex_unlock(&__timerMutex);
             ILOG_DEBUG(ILX_ENGINE, "Timer %p already added!\n", timer);
             return false;
         }
-        _timers.push_back(timer);
-        _timers.sort(timerSort);
+        // timer is scheduled now, so it is not scheduled again by runTimers().
+        dropFiredTimer(timer);
+        pushTimer(timer);
         pthread_mutex_unlock(&__timerMutex);
         __buffer->WakeUp(__buffer);
         ILOG_DEBUG(ILX_ENGINE, "Timer %p is added.\n", timer);
@@ -209,16 +249,27 @@ Engine::removeTimer(Timer* timer)
     if (timer)
     {
         pthread_mutex_lock(&__timerMutex);
-        for (TimerList::iterator it = _timers.begin(); it != _timers.end(); ++it)
+        TimerHeap::iterator it = std::find(_firingTimers.begin(), _firingTimers.end(), timer);
+        if (it != _firingTimers.end())
         {
-            if (timer == *it)
-            {
-                _timers.erase(it);
-                _timers.sort(timerSort);
-                pthread_mutex_unlock(&__timerMutex);
-                ILOG_DEBUG(ILX_ENGINE, "Timer %p is removed.\n", timer);
-                return true;
-            }
+            // stopped or deleted inside a callback, runTimers() should not schedule it again.
+            *it = NULL;
+            pthread_mutex_unlock(&__timerMutex);
+            ILOG_DEBUG(ILX_ENGINE, "Timer %p is removed while firing.\n", timer);
+            return true;
+        }
+        if (dropFiredTimer(timer))
+        {
+            pthread_mutex_unlock(&__timerMutex);
+            ILOG_DEBUG(ILX_ENGINE, "Timer %p is removed before it is scheduled again.\n", timer);
+            return true;
+        }
+        if (timer->_heapIndex != -1)
+        {
+            eraseTimer(timer->_heapIndex);
+            pthread_mutex_unlock(&__timerMutex);
+            ILOG_DEBUG(ILX_ENGINE, "Timer %p is removed.\n", timer);
+            return true;
         }
         pthread_mutex_unlock(&__timerMutex);
         ILOG_DEBUG(ILX_ENGINE, "Could not remove Timer %p, not found!\n", timer);
@@ -226,10 +277,81 @@ Engine::removeTimer(Timer* timer)
     return false;
 }
 
+unsigned int
+Engine::frameInterval() const
+{
+    return _frameInterval;
+}
+
+void
+Engine::setFrameInterval(unsigned int msec)
+{
+    _frameInterval = msec ? msec : 1;
+}
+
+AnimationClock*
+Engine::animationClock() const
+{
+    return _animationClock;
+}
+
+unsigned int
+Engine::timerSlack() const
+{
+    return _timerSlack;
+}
+
+void
+Engine::setTimerSlack(unsigned int msec)
+{
+    _timerSlack = msec;
+}
+
+bool
+Engine::post(void (*func)(void*), void* data)
+{
+    if (!func)
+        return false;
+
+    PostedItem item;
+    item.func = func;
+    item.data = data;
+    item.target = NULL;
+    item.type = 0;
+    if (!__posted.push(item))
+    {
+        ILOG_ERROR(ILX_ENGINE, "Cannot post %p, queue is full!\n", func);
+        return false;
+    }
+    // items posted before initialise() are run at first cycle.
+    if (__sync_lock_test_and_set(&__postPending, 1) == 0 && __buffer)
+        __buffer->WakeUp(__buffer);
+    return true;
+}
+
 void
 Engine::postUniversalEvent(Widget* target, unsigned int type, void* data)
 {
     ILOG_TRACE(ILX_ENGINE);
+    PostedItem item;
+    item.func = NULL;
+    item.data = data;
+    item.target = target;
+    item.type = type;
+    if (__posted.push(item))
+    {
+        if (__sync_lock_test_and_set(&__postPending, 1) == 0 && __buffer)
+            __buffer->WakeUp(__buffer);
+        return;
+    }
+
+    if (!__buffer)
+    {
+        ILOG_ERROR(ILX_ENGINE, "Cannot post UniversalEvent, queue is full and engine is not initialised!\n");
+        return;
+    }
+
+    ILOG_DEBUG(ILX_ENGINE, "Queue is full, using event buffer.\n");
     UniversalEvent event(target, type, data);
     DFBResult ret = __buffer->PostEvent(__buffer, DFB_EVENT(&event) );
     if (ret != DFB_OK)
@@ -264,24 +386,81 @@ Engine::runCallbacks()
     ILOG_TRACE(ILX_ENGINE_LOOP);
 
     pthread_mutex_lock(&__cbMutex);
-    std::vector<Callback*> list_copy;
-    CallbackList::iterator it = __callbacks.begin();
-    while (it != __callbacks.end())
+    ++__cbDepth;
+    int64_t now = direct_clock_get_millis();
+    int64_t frame = nextFrame(now);
+    // callbacks added while running are executed at next cycle.
+    unsigned int size = __callbacks.size();
+    for (unsigned int i = 0; i < size; ++i)
     {
-        list_copy.push_back(*it);
-        ++it;
+        Callback* cb = __callbacks[i];
+        if (!cb || cb->_next > now + _timerSlack)
+            continue;
+
+        // scheduled before running, so funck may restart callback.
+        cb->_next = cb->_interval ? now + cb->_interval : frame;
+        if (cb->_funck->funck() == 0)
+        {
+            ILOG_DEBUG(ILX_ENGINE_LOOP, " -> Callback %p is removed.\n", cb);
+            removeCallback(cb);
+        }
     }
-    std::vector<Callback*>::iterator it2 = list_copy.begin();
-    while (it2 != list_copy.end())
+    if (--__cbDepth == 0 && __cbRemoved)
+    {
+        __callbacks.erase(std::remove(__callbacks.begin(), __callbacks.end(), (Callback*) NULL), __callbacks.end());
+        __cbRemoved = false;
+    }
+    pthread_mutex_unlock(&__cbMutex);
+}
+
+int32_t
+Engine::nextCallback()
+{
+    int32_t timeout = -1;
+    pthread_mutex_lock(&__cbMutex);
+    if (__callbacks.size())
     {
-        if (((Callback*) *it2)->_funck->funck() == 0)
+        int64_t now = direct_clock_get_millis();
+        for (CallbackVector::iterator it = __callbacks.begin(); it != __callbacks.end(); ++it)
         {
-            ILOG_DEBUG(ILX_ENGINE_LOOP, " -> Callback %p is removed.\n", ((Callback*) *it2));
-            removeCallback(*it2);
+            if (!*it)
+                continue;
+
+            int64_t due = (*it)->_next - now;
+            if (due <= 0)
+            {
+                timeout = 0;
+                break;
+            }
+            if (timeout < 0 || due < timeout)
+                timeout = due;
         }
-        ++it2;
     }
     pthread_mutex_unlock(&__cbMutex);
+    ILOG_DEBUG(ILX_ENGINE_LOOP, " -> next callback in %d ms\n", timeout);
+    return timeout;
+}
+
+void
+Engine::runPosted()
+{
+    ILOG_TRACE(ILX_ENGINE_LOOP);
+    // items posted after this point wake up main loop again.
+    __sync_lock_release(&__postPending);
+
+    // do not starve main loop if producers are faster.
+    unsigned int count = __posted.capacity();
+    PostedItem item;
+    while (count-- && __posted.pop(item))
+    {
+        if (item.func)
+            item.func(item.data);
+        else if (item.target)
+        {
+            UniversalEvent event(item.target, item.type, item.data);
+            item.target->universalEvent(&event);
+        }
+    }
 }
 
 int32_t
@@ -295,32 +474,40 @@ Engine::runTimers()
     if (_timers.size())
     {
         int64_t now = direct_clock_get_millis();
-        int64_t expiry = _timers.front()->expiry();
+        int64_t deadline = now + _timerSlack;
+        // timers firing again are scheduled after this pass, so each timer fires at most once.
+        // callbacks may run a nested loop, so this pass only owns entries after base.
+        size_t base = _firedTimers.size();
 
-        ILOG_DEBUG(ILX_ENGINE_LOOP, "  -> Timers front %p, expiry %lld, now %lld (%lld ahead)\n", _timers.front(), expiry, now, expiry - now);
-
-        if (expiry <= now)
+        while (_timers.size() && _timers.front()->expiry() <= deadline)
         {
-            ILOG_DEBUG(ILX_ENGINE_LOOP, "  -> Timer calling %p\n", _timers.front());
-            if (!_timers.front()->funck()) {
-                ILOG_DEBUG(ILX_ENGINE_LOOP, "  -> Timer %p returned false\n", _timers.front());
-                _timers.pop_front();
-            }
+            Timer* timer = _timers.front();
+            eraseTimer(0);
+            ILOG_DEBUG(ILX_ENGINE_LOOP, "  -> Timer calling %p, expiry %lld, now %lld\n", timer, timer->expiry(), now);
+
+            // a stack since callbacks may run a nested loop, e.g. a modal dialog.
+            _firingTimers.push_back(timer);
+            bool repeat = timer->funck();
+            // entry is reset if timer is stopped, restarted or deleted by callback.
+            if (_firingTimers.back() == timer && repeat)
+                _firedTimers.push_back(timer);
             else
-                ILOG_DEBUG(ILX_ENGINE_LOOP, "  -> Timer %p returned true\n", _timers.front());
-
-            _timers.sort(timerSort);
-
+                ILOG_DEBUG(ILX_ENGINE_LOOP, "  -> Timer %p is done\n", timer);
+            _firingTimers.pop_back();
+        }
 
-            if (_timers.size()) {
-                now    = direct_clock_get_millis();
-                expiry = _timers.front()->expiry();
+        // entries are reset by dropFiredTimer() if timer is stopped, restarted or deleted.
+        for (size_t i = base; i < _firedTimers.size(); ++i)
+            if (_firedTimers[i])
+                pushTimer(_firedTimers[i]);
+        _firedTimers.resize(base);
 
-                ILOG_DEBUG(ILX_ENGINE_LOOP, "  --> Timers front %p, expiry %lld, now %lld (%lld ahead)\n", _timers.front(), expiry, now, expiry - now);
-                timeout = _timers.front()->expiry() - now;
-            }
-        } else
-            timeout = expiry - now;
+        if (_timers.size())
+        {
+            now = direct_clock_get_millis();
+            ILOG_DEBUG(ILX_ENGINE_LOOP, "  --> Timers front %p, expiry %lld, now %lld (%lld ahead)\n", _timers.front(), _timers.front()->expiry(), now, _timers.front()->expiry() - now);
+            timeout = _timers.front()->expiry() - now;
+        }
     }
     pthread_mutex_unlock(&__timerMutex);
     if (timeout < 1)
@@ -332,6 +519,76 @@ Engine::runTimers()
     return timeout;
 }
 
+bool
+Engine::dropFiredTimer(Timer* timer)
+{
+    TimerHeap::iterator it = std::find(_firedTimers.begin(), _firedTimers.end(), timer);
+    if (it == _firedTimers.end())
+        return false;
+    *it = NULL;
+    return true;
+}
+
+void
+Engine::pushTimer(Timer* timer)
+{
+    timer->_heapIndex = _timers.size();
+    _timers.push_back(timer);
+    siftTimerUp(timer->_heapIndex);
+}
+
+void
+Engine::eraseTimer(unsigned int index)
+{
+    _timers[index]->_heapIndex = -1;
+    Timer* last = _timers.back();
+    _timers.pop_back();
+    if (index < _timers.size())
+    {
+        _timers[index] = last;
+        last->_heapIndex = index;
+        siftTimerDown(index);
+        siftTimerUp(last->_heapIndex);
+    }
+}
+
+void
+Engine::siftTimerUp(unsigned int index)
+{
+    Timer* timer = _timers[index];
+    while (index)
+    {
+        unsigned int parent = (index - 1) / 2;
+        if (_timers[parent]->expiry() <= timer->expiry())
+            break;
+        _timers[index] = _timers[parent];
+        _timers[index]->_heapIndex = index;
+        index = parent;
+    }
+    _timers[index] = timer;
+    timer->_heapIndex = index;
+}
+
+void
+Engine::siftTimerDown(unsigned int index)
+{
+    Timer* timer = _timers[index];
+    unsigned int size = _timers.size();
+    while (2 * index + 1 < size)
+    {
+        unsigned int child = 2 * index + 1;
+        if (child + 1 < size && _timers[child + 1]->expiry() < _timers[child]->expiry())
+            ++child;
+        if (timer->expiry() <= _timers[child]->expiry())
+            break;
+        _timers[index] = _timers[child];
+        _timers[index]->_heapIndex = index;
+        index = child;
+    }
+    _timers[index] = timer;
+    timer->_heapIndex = index;
+}
+
 void
 Engine::initEventBuffer()
 {
@@ -344,6 +601,65 @@ Engine::initEventBuffer()
         ILOG_THROW(ILX_ENGINE, "Error while creating event buffer!\n");
 }
 
+void
+Engine::detectFrameInterval()
+{
+    ILOG_TRACE(ILX_ENGINE);
+    _frameInterval = 16;
+    IDirectFBDisplayLayer* layer = PlatformManager::instance().getLayer();
+    IDirectFBScreen* screen = NULL;
+    if (layer && layer->GetScreen(layer, &screen) == DFB_OK)
+    {
+        // only screens with an encoder report their frequency.
+        DFBScreenEncoderConfig config;
+        if (screen->GetEncoderConfiguration(screen, 0, &config) == DFB_OK && (config.flags & DSECONF_FREQUENCY))
+        {
+            switch (config.frequency)
+            {
+            case DSEF_25HZ:
+                _frameInterval = 40;
+                break;
+            case DSEF_29_97HZ:
+            case DSEF_30HZ:
+                _frameInterval = 33;
+                break;
+            case DSEF_50HZ:
+                _frameInterval = 20;
+                break;
+            case DSEF_75HZ:
+                _frameInterval = 13;
+                break;
+            default:
+                break;
+            }
+        }
+        screen->Release(screen);
+    }
+    ILOG_DEBUG(ILX_ENGINE, "Frame interval: %u ms\n", _frameInterval);
+}
+
+void
+Engine::setFrameTime(long long micros)
+{
+    if (micros > 0)
+        _framePhase = micros / 1000;
+}
+
+int64_t
+Engine::nextFrame(int64_t now) const
+{
+    if (_framePhase)
+    {
+        // frame time is monotonic, so only its phase is used.
+        int64_t mono = direct_clock_get_time(DIRECT_CLOCK_MONOTONIC) / 1000;
+        int64_t elapsed = (mono - _framePhase) % _frameInterval;
+        if (elapsed < 0)
+            elapsed += _frameInterval;
+        return now + _frameInterval - elapsed;
+    }
+    return now + _frameInterval;
+}
+
 void
 Engine::releaseEventBuffer()
 {
@@ -397,12 +713,16 @@ Engine::waitForEvents(int32_t timeout)
 	ILOG_TRACE(ILX_ENGINE_LOOP);
     DFBEvent event;
 
-    if (timeout < 1)
+    if (timeout < 0)
         ILOG_ERROR(ILX_ENGINE_LOOP, "Timeout error with value %d\n", timeout);
-    else if (timeout && Engine::instance().numCallbacks())
+    else if (timeout == 0)
+    {
+        // do not wait, callbacks are due.
+        ILOG_DEBUG(ILX_ENGINE_LOOP, " -> callbacks are due!\n");
+    } else if (__postPending)
     {
-        // do not wait
-    	ILOG_DEBUG(ILX_ENGINE_LOOP, " -> we have %d callbacks!\n", Engine::instance().numCallbacks());
+        // do not wait, posted items are pending.
+        ILOG_DEBUG(ILX_ENGINE_LOOP, " -> we have posted items!\n");
     } else
     {
         // discard window update event in buffer.
@@ -428,8 +748,8 @@ Engine::addSurfaceEventListener(SurfaceEventListener* sel)
     {
         pthread_mutex_lock(&__selMutex);
 
-        SurfaceListenerList::iterator it = std::find(__selList.begin(), __selList.end(), sel);
-        if (sel == *it)
+        SurfaceListeners& entry = __selMap[sel->sourceID()];
+        if (std::find(entry.listeners.begin(), entry.listeners.end(), sel) != entry.listeners.end())
         {
             pthread_mutex_unlock(&__selMutex);
             ILOG_ERROR(ILX_ENGINE, "SurfaceEventListener %p already added!\n", sel);
@@ -437,22 +757,17 @@ Engine::addSurfaceEventListener(SurfaceEventListener* sel)
         }
 
         ILOG_DEBUG(ILX_ENGINE, "SurfaceEventListener %p is added.\n", sel);
-        // check whether to attach source surface
-        bool attach = true;
-        for (SurfaceListenerList::iterator it = __selList.begin(); it != __selList.end(); ++it)
-        {
-            if (sel->sourceSurface() == ((SurfaceEventListener*) *it)->sourceSurface())
-                attach = false;
-        }
-
-        if (attach)
+        // source surface is attached once, events are shared by its listeners.
+        if (entry.listeners.empty())
         {
-            sel->sourceSurface()->MakeClient(sel->sourceSurface());
-            sel->sourceSurface()->AttachEventBuffer(sel->sourceSurface(), __buffer);
-            ILOG_DEBUG(ILX_ENGINE, " -> Surface[%p] is attached.\n", sel->sourceSurface());
+            entry.attached = sel->sourceSurface();
+            entry.attached->MakeClient(entry.attached);
+            entry.attached->AttachEventBuffer(entry.attached, __buffer);
+            ILOG_DEBUG(ILX_ENGINE, " -> Surface[%p] is attached.\n", entry.attached);
         }
 
-        __selList.push_back(sel);
+        entry.listeners.push_back(sel);
+        sel->_listenID = sel->sourceID();
         pthread_mutex_unlock(&__selMutex);
         return true;
     }
@@ -467,41 +782,48 @@ Engine::removeSurfaceEventListener(SurfaceEventListener* sel)
     {
         pthread_mutex_lock(&__selMutex);
 
-        bool ret = false;
-        IDirectFBSurface* source = sel->sourceSurface();
-
-        for (SurfaceListenerList::iterator it = __selList.begin(); it != __selList.end(); ++it)
+        // source may be released already, so use id at the time listener was added.
+        SurfaceListenerMap::iterator it = __selMap.find(sel->_listenID);
+        if (it == __selMap.end())
         {
-            if (sel == *it)
-            {
-                __selList.erase(it);
-                ILOG_DEBUG(ILX_ENGINE, "SurfaceEventListener %p is removed.\n", sel);
-                ret = true;
-                break;
-            }
+            pthread_mutex_unlock(&__selMutex);
+            return false;
         }
 
-        if (ret)
+        SurfaceListenerList& listeners = it->second.listeners;
+        SurfaceListenerList::iterator lit = std::find(listeners.begin(), listeners.end(), sel);
+        if (lit == listeners.end())
         {
-            bool detach = true;
-            for (SurfaceListenerList::iterator it = __selList.begin(); it != __selList.end(); ++it)
-            {
-                if (source == ((SurfaceEventListener*) *it)->sourceSurface())
-                    detach = false;
-            }
             pthread_mutex_unlock(&__selMutex);
+            return false;
+        }
 
-            if (detach)
-            {
-                sel->sourceSurface()->DetachEventBuffer(sel->sourceSurface(), __buffer);
-                ILOG_DEBUG(ILX_ENGINE, " -> Surface[%p] is detached.\n", sel->sourceSurface());
-            }
-            return true;
-        } else
+        listeners.erase(lit);
+        sel->_listenID = 0;
+        ILOG_DEBUG(ILX_ENGINE, "SurfaceEventListener %p is removed.\n", sel);
+
+        IDirectFBSurface* detach = NULL;
+        if (listeners.empty())
         {
-            pthread_mutex_unlock(&__selMutex);
-            return false;
+            detach = it->second.attached;
+            __selMap.erase(it);
+        } else if (it->second.attached == sel->sourceSurface())
+        {
+            // attached interface belongs to removed listener, so hand over to another one.
+            detach = it->second.attached;
+            it->second.attached = listeners.front()->sourceSurface();
+            it->second.attached->MakeClient(it->second.attached);
+            it->second.attached->AttachEventBuffer(it->second.attached, __buffer);
+            ILOG_DEBUG(ILX_ENGINE, " -> Surface[%p] is attached.\n", it->second.attached);
         }
+        pthread_mutex_unlock(&__selMutex);
+
+        if (detach)
+        {
+            detach->DetachEventBuffer(detach, __buffer);
+            ILOG_DEBUG(ILX_ENGINE, " -> Surface[%p] is detached.\n", detach);
+        }
+        return true;
     }
     return false;
 }
@@ -512,8 +834,21 @@ Engine::consumeSurfaceEvent(const DFBSurfaceEvent& event)
     pthread_mutex_lock(&__selMutex);
 
     ILOG_DEBUG(ILX_ENGINE_UPDATES, " -> SURFACE EVENT [%3d]  %4d,%4d-%4dx%4d (count %d)\n", event.surface_id, DFB_RECTANGLE_VALS_FROM_REGION(&event.update), event.flip_count);
-    for (SurfaceListenerList::iterator it = __selList.begin(); it != __selList.end(); ++it)
-        ((SurfaceEventListener*) *it)->consumeSurfaceEvent(event);
+    SurfaceListenerMap::iterator it = __selMap.find(event.surface_id);
+    if (it != __selMap.end())
+    {
+        SurfaceListenerList& listeners = it->second.listeners;
+        for (SurfaceListenerList::iterator lit = listeners.begin(); lit != listeners.end(); ++lit)
+            (*lit)->consumeSurfaceEvent(event);
+
+        // surface is gone, so there is nothing left to detach.
+        if (event.type == DSEVT_DESTROYED)
+        {
+            for (SurfaceListenerList::iterator lit = listeners.begin(); lit != listeners.end(); ++lit)
+                (*lit)->_listenID = 0;
+            __selMap.erase(it);
+        }
+    }
 
     pthread_mutex_unlock(&__selMutex);
 }
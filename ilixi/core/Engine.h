@@ -25,12 +25,15 @@
 #define ILIXI_ENGINE_H_
 
 #include <core/Callback.h>
+#include <lib/LockFreeQueue.h>
 #include <lib/Timer.h>
 #include <lib/Util.h>
 #include <types/Event.h>
 
 #include <directfb.h>
 #include <list>
+#include <map>
+#include <vector>
 #include <sigc++/signal.h>
 
 #if ILIXI_HAS_SURFACEEVENTS
@@ -39,6 +42,7 @@
 
 namespace ilixi
 {
+class AnimationClock;
 
 //! This class provides a mechanism to run callbacks, timers and custom work items inside main loop.
 class Engine : public sigc::trackable
@@ -53,7 +57,7 @@ public:
     /*!
      * Runs callbacks, timers and custom work items.
      *
-     * @return next timeout in milliseconds.
+     * @return next timeout in milliseconds, 0 if a callback is due.
      */
     int32_t
     cycle();
@@ -107,7 +111,68 @@ public:
     removeTimer(Timer* timer);
 
     /*!
-     * Post a universal event to main event buffer.
+     * Returns clock which drives running animations.
+     *
+     * Returns NULL if engine is not initialised.
+     */
+    AnimationClock*
+    animationClock() const;
+
+    /*!
+     * Returns frame interval in milliseconds.
+     */
+    unsigned int
+    frameInterval() const;
+
+    /*!
+     * Sets frame interval in milliseconds.
+     *
+     * Callbacks which run once per frame are paced using this interval. Default
+     * is derived from refresh rate of screen, or 16ms if it is not available, and
+     * can be set using ILX_FRAMEINTERVAL environment variable. If DirectFB provides
+     * frame time, callbacks are run in phase with display.
+     */
+    void
+    setFrameInterval(unsigned int msec);
+
+    /*!
+     * Returns timer slack in milliseconds.
+     */
+    unsigned int
+    timerSlack() const;
+
+    /*!
+     * Sets timer slack in milliseconds.
+     *
+     * Timers which expire within slack of each other are fired together
+     * in the same cycle, so main loop wakes up less often. Timers may
+     * fire up to slack milliseconds earlier than their expiry. Default
+     * is 1ms and can be set using ILX_TIMERSLACK environment variable.
+     */
+    void
+    setTimerSlack(unsigned int msec);
+
+    /*!
+     * Posts a function which is called by main loop at next cycle.
+     *
+     * This method can be called from any thread. It does not lock or
+     * allocate memory, and main loop is woken up only once for items
+     * posted before it runs. Items posted before initialise() are queued
+     * and run at first cycle.
+     *
+     * @param func function to call.
+     * @param data passed to func.
+     * @return false if queue is full.
+     */
+    bool
+    post(void (*func)(void*), void* data = NULL);
+
+    /*!
+     * Post a universal event.
+     *
+     * This method can be called from any thread. Event is queued using
+     * post() mechanism and delivered at next cycle. If queue is full,
+     * event is posted to main event buffer.
      *
      * @param target Widget.
      * @param type of event
@@ -140,13 +205,25 @@ public:
 
 protected:
     /*!
-     * Executes callbacks.
+     * Executes callbacks which are due.
      */
     void
     runCallbacks();
 
     /*!
-     * Executes each timer and returns a timeout for next interval in ms.
+     * Returns milliseconds until next callback is due, or -1 if there are no callbacks.
+     */
+    int32_t
+    nextCallback();
+
+    /*!
+     * Executes functions and delivers events posted from other threads.
+     */
+    void
+    runPosted();
+
+    /*!
+     * Executes all expired timers and returns a timeout for next interval in ms.
      */
     int32_t
     runTimers();
@@ -158,21 +235,67 @@ private:
     //! Termination flag.
     bool _terminate;
 
-    typedef std::list<Callback*> CallbackList;
-    //! List of callbacks
-    CallbackList __callbacks;
+    //! Steps all running animations once per frame.
+    AnimationClock* _animationClock;
+
+    typedef std::vector<Callback*> CallbackVector;
+    //! List of callbacks, removed entries are set to NULL while running.
+    CallbackVector __callbacks;
+    //! Depth of nested runCallbacks() calls.
+    unsigned int __cbDepth;
+    //! Set if callbacks are removed while running.
+    bool __cbRemoved;
     //! Serialises access to __callbacks.
     pthread_mutex_t __cbMutex;
-
-    typedef std::list<Timer*> TimerList;
-    TimerList _timers;
+    //! Callbacks which run once per frame are due at this interval in milliseconds.
+    unsigned int _frameInterval;
+    //! Monotonic time of a displayed frame in milliseconds, 0 if frame time is not known.
+    int64_t _framePhase;
+
+    //! Item posted from any thread, see post() and postUniversalEvent().
+    struct PostedItem
+    {
+        //! Function to call, NULL for universal events.
+        void (*func)(void*);
+        //! Function argument or event data.
+        void* data;
+        //! Event target.
+        Widget* target;
+        //! Event type.
+        unsigned int type;
+    };
+    //! Items posted from other threads, drained by cycle().
+    LockFreeQueue<PostedItem> __posted;
+    //! Set once main loop is woken up for posted items.
+    volatile int __postPending;
+
+    typedef std::vector<Timer*> TimerHeap;
+    //! Binary min-heap of timers ordered by expiry, see Timer::_heapIndex.
+    TimerHeap _timers;
+    //! Timers which are being fired by runTimers().
+    TimerHeap _firingTimers;
+    //! Repeating timers which are fired and scheduled again at the end of runTimers().
+    TimerHeap _firedTimers;
+    //! Timers expiring within this many milliseconds are fired together.
+    unsigned int _timerSlack;
+    //! Serialises access to _timers.
     pthread_mutex_t __timerMutex;
 
 #if ILIXI_HAS_SURFACEEVENTS
-    typedef std::list<SurfaceEventListener*> SurfaceListenerList;
-    //! List of surface event listeners.
-    SurfaceListenerList __selList;
-    //! Serialises access to _selList.
+    typedef std::vector<SurfaceEventListener*> SurfaceListenerList;
+
+    //! Listeners of a source surface.
+    struct SurfaceListeners
+    {
+        //! Interface which is attached to event buffer.
+        IDirectFBSurface* attached;
+        SurfaceListenerList listeners;
+    };
+
+    typedef std::map<DFBSurfaceID, SurfaceListeners> SurfaceListenerMap;
+    //! Surface event listeners indexed by id of their source surface.
+    SurfaceListenerMap __selMap;
+    //! Serialises access to __selMap.
     pthread_mutex_t __selMutex;
 #endif // end ILIXI_HAS_SURFACEEVENTS
     Engine();
@@ -189,6 +312,38 @@ private:
     void
     initEventBuffer();
 
+    //! Sets frame interval using refresh rate of screen.
+    void
+    detectFrameInterval();
+
+    //! Stores display time of a frame in microseconds, see Application::setFrameTime().
+    void
+    setFrameTime(long long micros);
+
+    //! Returns start of next frame after now in milliseconds.
+    int64_t
+    nextFrame(int64_t now) const;
+
+    //! Removes timer from timers waiting to be scheduled again, returns false if not found.
+    bool
+    dropFiredTimer(Timer* timer);
+
+    //! Inserts timer into heap.
+    void
+    pushTimer(Timer* timer);
+
+    //! Removes timer at given heap index.
+    void
+    eraseTimer(unsigned int index);
+
+    //! Moves timer at index towards root until heap order is restored.
+    void
+    siftTimerUp(unsigned int index);
+
+    //! Moves timer at index towards leaves until heap order is restored.
+    void
+    siftTimerDown(unsigned int index);
+
     void
     releaseEventBuffer();
 
@@ -26,9 +26,11 @@
 #include <core/Application.h>
 #include <core/Logger.h>
 #include <graphics/ImagePack.h>
+#include <graphics/ThemeBundle.h>
 #include <lib/FileSystem.h>
 #include <lib/XMLReader.h>
 #include <types/FontCache.h>
+#include <types/ImageCache.h>
 #include <algorithm>
 
 extern "C"
@@ -648,6 +650,8 @@ PlatformManager::release()
         _imgPackMap.clear();
 
         FontCache::Instance()->releaseAllEntries();
+        ImageCache::instance().releaseUnused();
+        ThemeBundle::instance().close();
 
         if ((appOptions() & OptExclusive) && _cursorImage)
             _cursorImage->Release(_cursorImage);
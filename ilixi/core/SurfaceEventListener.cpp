@@ -26,6 +26,7 @@
 #include <core/Application.h>
 #include <core/Engine.h>
 #include <core/Logger.h>
+#include <directfb_util.h>
 
 namespace ilixi
 {
@@ -35,6 +36,8 @@ SurfaceEventListener::SurfaceEventListener()
         : _surfaceID(0),
           _sourceSurface(NULL),
           _cb(this),
+          _hasPending(false),
+          _listenID(0),
           _lastTime(0)
 {
 }
@@ -85,8 +88,19 @@ SurfaceEventListener::consumeSurfaceEvent(const DFBSurfaceEvent& event)
             onSourceDestroyed(event);
         else if (event.type == DSEVT_UPDATE)
         {
-            _queue.push(event);
-            ILOG_DEBUG(ILX_SURFACELISTENER_UPDATES, " -> surface id: %d -- flip count: %d -- queue.size: %d\n", event.surface_id, event.flip_count, _queue.size());
+            // only latest flip is handled, so keep its state and merge damage of unhandled ones.
+            if (_hasPending)
+            {
+                DFBSurfaceEvent merged = event;
+                dfb_region_region_union(&merged.update, &_pending.update);
+#ifdef ILIXI_STEREO_OUTPUT
+                dfb_region_region_union(&merged.update_right, &_pending.update_right);
+#endif
+                _pending = merged;
+            } else
+                _pending = event;
+            _hasPending = true;
+            ILOG_DEBUG(ILX_SURFACELISTENER_UPDATES, " -> surface id: %d -- flip count: %d\n", event.surface_id, event.flip_count);
             _cb.start();
 
             _lastTime = event.time_stamp;
@@ -99,17 +113,10 @@ SurfaceEventListener::consumeSurfaceEvent(const DFBSurfaceEvent& event)
 bool
 SurfaceEventListener::funck()
 {
-    if (!_queue.empty())
+    if (_hasPending && onSourceUpdate(_pending))
     {
-        // FIXME: avoid queuing up too much
-        while (_queue.size() > 2)
-            _queue.pop();
-
-        if (onSourceUpdate(_queue.front()))
-        {
-            _queue.pop();
-            return true;
-        }
+        _hasPending = false;
+        return true;
     }
     return false;
 }
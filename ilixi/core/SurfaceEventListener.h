@@ -25,7 +25,6 @@
 #define ILIXI_SURFACELISTENER_H_
 
 #include <directfb.h>
-#include <queue>
 #include <core/Callback.h>
 
 namespace ilixi
@@ -101,8 +100,12 @@ protected:
 private:
     //! Callback for stack.
     Callback _cb;
-    //! Stack of surface events waiting.
-    std::queue<DFBSurfaceEvent> _queue;
+    //! Latest update event which is not handled yet, damage of earlier ones is merged into it.
+    DFBSurfaceEvent _pending;
+    //! True if there is a pending update event.
+    bool _hasPending;
+    //! Id of source surface this listener is registered with in Engine.
+    DFBSurfaceID _listenID;
 
     //! Intercepts surface events of source surface.
     bool
@@ -453,7 +453,7 @@ void
 CairoPainter::drawLayout(const TextLayout& layout, int x, int y)
 {
     ILOG_TRACE(ILX_CPAINTER);
-    if (layout.text().empty())
+    if (layout.isEmpty())
         return;
 
     if (_state & PFActive)
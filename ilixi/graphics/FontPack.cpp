@@ -23,29 +23,61 @@
 
 #include <graphics/FontPack.h>
 #include <lib/FileSystem.h>
+#include <lib/Util.h>
 #include <lib/XMLReader.h>
 #include <core/Logger.h>
+#include <graphics/ThemeBundle.h>
 #include <types/FontCache.h>
 #include <fstream>
+#include <stdlib.h>
+#include <vector>
 
 namespace ilixi
 {
 
 D_DEBUG_DOMAIN(ILX_FONTPACK, "ilixi/graphics/FontPack", "FontPack");
 
+//! Layout of font section in ThemeBundle, followed by FontRecords.
+struct FontSectionHeader
+{
+    uint32_t count;
+};
+
+//! Font descriptor in ThemeBundle.
+struct FontRecord
+{
+    //! Index of font in FontPack::fontSlots(), -1 for custom fonts.
+    int32_t slot;
+    //! Name of custom font.
+    uint32_t name;
+    uint32_t file;
+    int32_t size;
+    int32_t style;
+};
+
+//! Names of fonts in FontPack::fontSlots(), as used in fonts file and prewarm list.
+static const char* __slotNames[5] = { "ButtonFont", "DefaultFont", "InputFont", "TitleFont", "MicroFont" };
+
 FontPack::FontPack()
         : _buttonFont(NULL),
           _defaultFont(NULL),
           _inputFont(NULL),
           _titleFont(NULL),
-          _microFont(NULL)
+          _microFont(NULL),
+          _touched(0),
+          _prewarmRunning(false),
+          _prewarmJoinable(false),
+          _prewarmStop(false)
 {
+    pthread_mutex_init(&_prewarmLock, NULL);
 }
 
 FontPack::~FontPack()
 {
     ILOG_TRACE(ILX_FONTPACK);
+    savePrewarmList();
     release();
+    pthread_mutex_destroy(&_prewarmLock);
 }
 
 Font*
@@ -55,14 +87,19 @@ FontPack::getFont(StyleHint::FontHint font) const
     switch (font)
     {
     case StyleHint::ButtonFont:
+        _touched |= 1 << 0;
         return _buttonFont;
     case StyleHint::TitleFont:
+        _touched |= 1 << 3;
         return _titleFont;
     case StyleHint::InputFont:
+        _touched |= 1 << 2;
         return _inputFont;
     case StyleHint::MicroFont:
+        _touched |= 1 << 4;
         return _microFont;
     default:
+        _touched |= 1 << 1;
         return _defaultFont;
     }
 }
@@ -74,116 +111,130 @@ FontPack::getCustomFont(const std::string& name) const
     ILOG_DEBUG(ILX_FONTPACK, " -> name: %s\n", name.c_str());
     FontMap::const_iterator it = _fontMap.find(name);
     if (it != _fontMap.end())
+    {
+        _touchedCustom.insert(name);
         return it->second;
+    }
     ILOG_WARNING(ILX_FONTPACK, " -> Cannot find font: %s\n", name.c_str());
     return getFont(StyleHint::DefaultFont);
 }
 
+void
+FontPack::prewarm(StyleHint::FontHint font)
+{
+    ILOG_TRACE(ILX_FONTPACK);
+    // marking a font is not a use, keep it out of prewarm list.
+    unsigned int touched = _touched;
+    queuePrewarm(getFont(font));
+    _touched = touched;
+}
+
+void
+FontPack::prewarmCustomFont(const std::string& name)
+{
+    ILOG_TRACE(ILX_FONTPACK);
+    FontMap::const_iterator it = _fontMap.find(name);
+    if (it != _fontMap.end())
+        queuePrewarm(it->second);
+}
+
 bool
 FontPack::parseFonts(const char* fontsFile)
 {
     ILOG_TRACE(ILX_FONTPACK);
     ILOG_DEBUG(ILX_FONTPACK, " -> file: %s\n", fontsFile);
 
-    std::string cacheFile = PrintF("%s%u.sxml", FileSystem::ilxDirectory().c_str(), createHash(fontsFile));
-    if (difftime(FileSystem::getModificationTime(cacheFile), FileSystem::getModificationTime(fontsFile)) > 0)
+    savePrewarmList();
+    release();
+    _fontsFile = fontsFile;
+    _touched = 0;
+    _touchedCustom.clear();
+
+    unsigned int bytes = 0;
+    const void* data = ThemeBundle::instance().find(ThemeBundle::FontSection, fontsFile, &bytes);
+    if (data && loadSection(data, bytes))
     {
-        ILOG_DEBUG(ILX_FONTPACK, " -> Parsing cached fonts file: %s\n", cacheFile.c_str());
-        std::ifstream ifs(cacheFile.c_str(), std::ios::in);
-        ifs >> *this;
-        ifs.close();
-        ILOG_INFO(ILX_FONTPACK, "Parsed cached fonts file: %s\n", cacheFile.c_str());
-    } else
+        ILOG_INFO(ILX_FONTPACK, "Loaded fonts from theme bundle: %s\n", fontsFile);
+        loadPrewarmList();
+        return true;
+    }
+
+    XMLReader xml;
+    if (xml.loadFile(fontsFile) == false)
     {
-        XMLReader xml;
-        if (xml.loadFile(fontsFile) == false)
-        {
-            ILOG_FATAL(ILX_FONTPACK, "Could not parse fonts!\n");
-            return false;
-        }
+        ILOG_FATAL(ILX_FONTPACK, "Could not parse fonts!\n");
+        return false;
+    }
 
-        xmlNodePtr node = xml.currentNode();
+    xmlNodePtr node = xml.currentNode();
 
-        release();
+    while (node != NULL)
+    {
+        ILOG_DEBUG(ILX_FONTPACK, " -> font: %s\n", node->name);
+        xmlChar* fileC = xmlNodeGetContent(node->children);
+        xmlChar* sizeC = xmlNodeGetContent(node->children->next);
+        xmlChar* styleC = xmlNodeGetContent(node->children->next->next);
 
-        while (node != NULL)
+        Font::Style fontStyle = Font::Plain;
+        if (styleC)
         {
-            ILOG_DEBUG(ILX_FONTPACK, " -> font: %s\n", node->name);
-            xmlChar* fileC = xmlNodeGetContent(node->children);
-            xmlChar* sizeC = xmlNodeGetContent(node->children->next);
-            xmlChar* styleC = xmlNodeGetContent(node->children->next->next);
+            if (xmlStrcmp(styleC, (xmlChar *) "italic") == 0)
+                fontStyle = Font::Italic;
+            else if (xmlStrcmp(styleC, (xmlChar *) "bold") == 0)
+                fontStyle = Font::Bold;
+            xmlFree(styleC);
+        }
 
-            Font::Style fontStyle = Font::Plain;
-            if (styleC)
-            {
-                if (xmlStrcmp(styleC, (xmlChar *) "italic") == 0)
-                    fontStyle = Font::Italic;
-                else if (xmlStrcmp(styleC, (xmlChar *) "bold") == 0)
-                    fontStyle = Font::Bold;
-                xmlFree(styleC);
-            }
-
-            if (xmlStrcmp(node->name, (xmlChar*) "DefaultFont") == 0)
-            {
-                _defaultFont = new Font((char*) fileC, atoi((char*) sizeC));
-                _defaultFont->setStyle(fontStyle);
-                _defaultFont->dfbFont();
-            } else if (xmlStrcmp(node->name, (xmlChar*) "ButtonFont") == 0)
-            {
-                _buttonFont = new Font((char*) fileC, atoi((char*) sizeC));
-                _buttonFont->setStyle(fontStyle);
-                _buttonFont->dfbFont();
-            }
+        if (xmlStrcmp(node->name, (xmlChar*) "DefaultFont") == 0)
+        {
+            _defaultFont = new Font((char*) fileC, atoi((char*) sizeC));
+            _defaultFont->setStyle(fontStyle);
+        } else if (xmlStrcmp(node->name, (xmlChar*) "ButtonFont") == 0)
+        {
+            _buttonFont = new Font((char*) fileC, atoi((char*) sizeC));
+            _buttonFont->setStyle(fontStyle);
+        }
 
-            else if (xmlStrcmp(node->name, (xmlChar*) "InputFont") == 0)
-            {
-                _inputFont = new Font((char*) fileC, atoi((char*) sizeC));
-                _inputFont->setStyle(fontStyle);
-                _inputFont->dfbFont();
-            }
+        else if (xmlStrcmp(node->name, (xmlChar*) "InputFont") == 0)
+        {
+            _inputFont = new Font((char*) fileC, atoi((char*) sizeC));
+            _inputFont->setStyle(fontStyle);
+        }
 
-            else if (xmlStrcmp(node->name, (xmlChar*) "TitleFont") == 0)
-            {
-                _titleFont = new Font((char*) fileC, atoi((char*) sizeC));
-                _titleFont->setStyle(fontStyle);
-                _titleFont->dfbFont();
-            }
+        else if (xmlStrcmp(node->name, (xmlChar*) "TitleFont") == 0)
+        {
+            _titleFont = new Font((char*) fileC, atoi((char*) sizeC));
+            _titleFont->setStyle(fontStyle);
+        }
 
-            else if (xmlStrcmp(node->name, (xmlChar*) "MicroFont") == 0)
-            {
-                _microFont = new Font((char*) fileC, atoi((char*) sizeC));
-                _microFont->setStyle(fontStyle);
-                _microFont->dfbFont();
-            }
+        else if (xmlStrcmp(node->name, (xmlChar*) "MicroFont") == 0)
+        {
+            _microFont = new Font((char*) fileC, atoi((char*) sizeC));
+            _microFont->setStyle(fontStyle);
+        }
 
-            else if (xmlStrcmp(node->name, (xmlChar*) "CustomFont") == 0)
+        else if (xmlStrcmp(node->name, (xmlChar*) "CustomFont") == 0)
+        {
+            xmlChar* fontName = xmlGetProp(node, (xmlChar*) "name");
+            FontMap::const_iterator it = _fontMap.find((char*) fontName);
+            if (it == _fontMap.end())
             {
-                xmlChar* fontName = xmlGetProp(node, (xmlChar*) "name");
-                FontMap::const_iterator it = _fontMap.find((char*) fontName);
-                if (it == _fontMap.end())
-                {
-                    Font* cFont = new Font((char*) fileC, atoi((char*) sizeC));
-                    cFont->setStyle(fontStyle);
-                    cFont->dfbFont();
-                    std::pair<FontMap::iterator, bool> res = _fontMap.insert(std::make_pair((char*) fontName, cFont));
-                } else
-                    ILOG_WARNING(ILX_FONTPACK, "CustomFont '%s' already exists!\n", fontName);
-                xmlFree(fontName);
-            }
-
-            xmlFree(fileC);
-            xmlFree(sizeC);
-            node = node->next;
+                Font* cFont = new Font((char*) fileC, atoi((char*) sizeC));
+                cFont->setStyle(fontStyle);
+                std::pair<FontMap::iterator, bool> res = _fontMap.insert(std::make_pair((char*) fontName, cFont));
+            } else
+                ILOG_WARNING(ILX_FONTPACK, "CustomFont '%s' already exists!\n", fontName);
+            xmlFree(fontName);
         }
-        ILOG_INFO(ILX_FONTPACK, "Parsed fonts file: %s\n", fontsFile);
 
-        std::ofstream ofs(cacheFile.c_str(), std::ios::out);
-        ofs.seekp(0, std::ios::beg);
-        ofs << *this;
-        ofs.close();
-        ILOG_INFO(ILX_FONTPACK, "Created cached fonts file: %s\n", cacheFile.c_str());
+        xmlFree(fileC);
+        xmlFree(sizeC);
+        node = node->next;
     }
+    ILOG_INFO(ILX_FONTPACK, "Parsed fonts file: %s\n", fontsFile);
 
+    storeSection(fontsFile);
+    loadPrewarmList();
     return true;
 }
 
@@ -191,6 +242,8 @@ void
 FontPack::release()
 {
     ILOG_TRACE(ILX_FONTPACK);
+    stopPrewarm();
+
     delete _buttonFont;
     delete _defaultFont;
     delete _inputFont;
@@ -210,67 +263,223 @@ FontPack::release()
     FontCache::Instance()->logEntries();
 }
 
-std::istream&
-operator>>(std::istream& is, FontPack& obj)
+void
+FontPack::queuePrewarm(Font* font)
 {
-    ILOG_TRACE_F(ILX_FONTPACK);
-    obj.release();
-
-    obj._buttonFont = new Font();
-    obj._defaultFont = new Font();
-    obj._inputFont = new Font();
-    obj._titleFont = new Font();
-    obj._microFont = new Font();
-
-    is >> *obj._buttonFont;
-    is.ignore(1);
-    is >> *obj._defaultFont;
-    is.ignore(1);
-    is >> *obj._inputFont;
-    is.ignore(1);
-    is >> *obj._titleFont;
-    is.ignore(1);
-    is >> *obj._microFont;
-    is.ignore(1);
-
-    int mapSize = 0;
-    std::string fontName;
-    is >> mapSize;
-    for (int i = 0; i < mapSize; ++i)
+    if (!font)
+        return;
+
+    PrewarmEntry entry;
+    entry.name = font->name();
+    entry.size = font->size();
+    entry.attr = (DFBFontAttributes) font->style();
+    ILOG_DEBUG(ILX_FONTPACK, " -> prewarm: %s size: %d\n", entry.name.c_str(), entry.size);
+
+    pthread_mutex_lock(&_prewarmLock);
+    _prewarmQueue.push_back(entry);
+    if (!_prewarmRunning)
     {
-        is >> fontName;
-        is.ignore(1);
-        Font* font = new Font();
-        is >> *font;
-        font->dfbFont();
-        obj._fontMap.insert(std::make_pair(fontName, font));
+        // previous thread has finished its queue, reap it before starting a new one.
+        if (_prewarmJoinable)
+            pthread_join(_prewarmThread, NULL);
+        _prewarmRunning = !pthread_create(&_prewarmThread, NULL, prewarmThread, this);
+        _prewarmJoinable = _prewarmRunning;
+        if (!_prewarmRunning)
+        {
+            ILOG_ERROR(ILX_FONTPACK, "Cannot create prewarm thread!\n");
+            _prewarmQueue.clear();
+        }
     }
-    is.ignore(1);
+    pthread_mutex_unlock(&_prewarmLock);
+}
+
+void
+FontPack::stopPrewarm()
+{
+    pthread_mutex_lock(&_prewarmLock);
+    _prewarmStop = true;
+    _prewarmQueue.clear();
+    pthread_mutex_unlock(&_prewarmLock);
 
-    *obj._buttonFont->dfbFont();
-    *obj._defaultFont->dfbFont();
-    *obj._inputFont->dfbFont();
-    *obj._titleFont->dfbFont();
-    *obj._microFont->dfbFont();
+    if (_prewarmJoinable)
+        pthread_join(_prewarmThread, NULL);
 
-    return is;
+    _prewarmRunning = false;
+    _prewarmJoinable = false;
+    _prewarmStop = false;
+
+    for (unsigned int i = 0; i < _prewarmKeys.size(); ++i)
+        FontCache::Instance()->releaseEntry(_prewarmKeys[i]);
+    _prewarmKeys.clear();
 }
 
-std::ostream&
-operator<<(std::ostream& os, const FontPack& obj)
+void*
+FontPack::prewarmThread(void* arg)
 {
-    ILOG_TRACE_F(ILX_FONTPACK);
-    os << *obj._buttonFont << std::endl;
-    os << *obj._defaultFont << std::endl;
-    os << *obj._inputFont << std::endl;
-    os << *obj._titleFont << std::endl;
-    os << *obj._microFont << std::endl;
-
-    os << obj._fontMap.size() << std::endl;
-    for (FontPack::FontMap::const_iterator it = obj._fontMap.begin(); it != obj._fontMap.end(); ++it)
-        os << it->first << std::endl << *((Font*) it->second) << std::endl;
-
-    return os;
+    FontPack* pack = (FontPack*) arg;
+    pthread_mutex_lock(&pack->_prewarmLock);
+    while (!pack->_prewarmQueue.empty() && !pack->_prewarmStop)
+    {
+        PrewarmEntry entry = pack->_prewarmQueue.front();
+        pack->_prewarmQueue.pop_front();
+        pthread_mutex_unlock(&pack->_prewarmLock);
+
+        // FontCache keeps a reference, so first use of font is a cache hit.
+        IDirectFBFont* font = NULL;
+        unsigned int key = FontCache::Instance()->getEntry(entry.name, entry.size, entry.attr, &font);
+
+        pthread_mutex_lock(&pack->_prewarmLock);
+        if (font)
+            pack->_prewarmKeys.push_back(key);
+    }
+    pack->_prewarmRunning = false;
+    pthread_mutex_unlock(&pack->_prewarmLock);
+    return NULL;
+}
+
+std::string
+FontPack::prewarmListFile() const
+{
+    return PrintF("%s%u.fonts", FileSystem::ilxDirectory().c_str(), createHash(_fontsFile));
+}
+
+void
+FontPack::loadPrewarmList()
+{
+    ILOG_TRACE(ILX_FONTPACK);
+    char* var = getenv("ILX_FONTPREWARM");
+    if (var && atoi(var) == 0)
+        return;
+
+    std::ifstream ifs(prewarmListFile().c_str(), std::ios::in);
+    Font** slots[5];
+    fontSlots(slots);
+    std::string line;
+    while (std::getline(ifs, line))
+    {
+        if (line.compare(0, 7, "custom:") == 0)
+            prewarmCustomFont(line.substr(7));
+        else
+        {
+            for (int i = 0; i < 5; ++i)
+                if (line == __slotNames[i])
+                    queuePrewarm(*slots[i]);
+        }
+    }
+}
+
+void
+FontPack::savePrewarmList()
+{
+    ILOG_TRACE(ILX_FONTPACK);
+    if (_fontsFile.empty() || (!_touched && _touchedCustom.empty()))
+        return;
+
+    std::ofstream ofs(prewarmListFile().c_str(), std::ios::out | std::ios::trunc);
+    for (int i = 0; i < 5; ++i)
+        if (_touched & (1 << i))
+            ofs << __slotNames[i] << std::endl;
+    for (std::set<std::string>::const_iterator it = _touchedCustom.begin(); it != _touchedCustom.end(); ++it)
+        ofs << "custom:" << *it << std::endl;
+    ILOG_DEBUG(ILX_FONTPACK, " -> Saved prewarm list: %s\n", prewarmListFile().c_str());
+}
+
+void
+FontPack::fontSlots(Font** slots[5])
+{
+    slots[0] = &_buttonFont;
+    slots[1] = &_defaultFont;
+    slots[2] = &_inputFont;
+    slots[3] = &_titleFont;
+    slots[4] = &_microFont;
+}
+
+bool
+FontPack::loadSection(const void* data, unsigned int bytes)
+{
+    ILOG_TRACE(ILX_FONTPACK);
+    const FontSectionHeader* header = (const FontSectionHeader*) data;
+    if (bytes < sizeof(FontSectionHeader) || bytes < sizeof(FontSectionHeader) + header->count * sizeof(FontRecord))
+        return false;
+
+    Font** slots[5];
+    fontSlots(slots);
+    const FontRecord* record = (const FontRecord*) (header + 1);
+    for (unsigned int i = 0; i < header->count; ++i, ++record)
+    {
+        const char* file = ThemeBundle::string(data, bytes, record->file);
+        if (!file || record->slot < -1 || record->slot > 4)
+        {
+            release();
+            return false;
+        }
+
+        Font* font = new Font(file, record->size);
+        font->setStyle((Font::Style) record->style);
+        if (record->slot >= 0)
+        {
+            delete *slots[record->slot];
+            *slots[record->slot] = font;
+        } else
+        {
+            const char* name = ThemeBundle::string(data, bytes, record->name);
+            if (!name || !_fontMap.insert(std::make_pair(name, font)).second)
+                delete font;
+        }
+    }
+    return true;
+}
+
+void
+FontPack::storeSection(const char* fontsFile)
+{
+    ILOG_TRACE(ILX_FONTPACK);
+    std::vector<std::pair<std::string, Font*> > fonts;
+    std::vector<int32_t> fontSlot;
+    Font** slots[5];
+    fontSlots(slots);
+    for (int i = 0; i < 5; ++i)
+    {
+        if (*slots[i])
+        {
+            fonts.push_back(std::make_pair(std::string(), *slots[i]));
+            fontSlot.push_back(i);
+        }
+    }
+    for (FontMap::const_iterator it = _fontMap.begin(); it != _fontMap.end(); ++it)
+    {
+        fonts.push_back(*it);
+        fontSlot.push_back(-1);
+    }
+
+    ThemeBundle::Writer writer;
+    FontSectionHeader header;
+    header.count = fonts.size();
+    writer.append(header);
+
+    std::vector<unsigned int> offsets;
+    for (unsigned int i = 0; i < fonts.size(); ++i)
+    {
+        FontRecord record;
+        record.slot = fontSlot[i];
+        record.name = 0;
+        record.file = 0;
+        record.size = fonts[i].second->size();
+        record.style = fonts[i].second->style();
+        offsets.push_back(writer.append(record));
+    }
+
+    for (unsigned int i = 0; i < fonts.size(); ++i)
+    {
+        uint32_t file = writer.appendString(fonts[i].second->name());
+        writer.at<FontRecord>(offsets[i])->file = file;
+        if (fontSlot[i] == -1)
+        {
+            uint32_t name = writer.appendString(fonts[i].first);
+            writer.at<FontRecord>(offsets[i])->name = name;
+        }
+    }
+    ThemeBundle::instance().store(ThemeBundle::FontSection, fontsFile, writer);
 }
 
 } /* namespace ilixi */
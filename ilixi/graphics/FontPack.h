@@ -26,12 +26,24 @@
 
 #include <types/Font.h>
 #include <types/Enums.h>
+#include <pthread.h>
+#include <list>
 #include <map>
-#include <iostream>
+#include <set>
+#include <vector>
 
 namespace ilixi
 {
 //! Provides a font pack.
+/*!
+ * Fonts are only described when a fonts file is parsed, DirectFB fonts are
+ * created on first use. Fonts marked using prewarm() are loaded by a background
+ * thread instead.
+ *
+ * Fonts used in a session are saved to a prewarm list in ilxDirectory() and
+ * prewarmed next time the same fonts file is parsed. Set ILX_FONTPREWARM=0 to
+ * disable prewarming from this list.
+ */
 class FontPack
 {
 public:
@@ -55,6 +67,18 @@ public:
     Font*
     getCustomFont(const std::string& name) const;
 
+    /*!
+     * Marks font for given type as likely needed and loads it in background.
+     */
+    void
+    prewarm(StyleHint::FontHint font);
+
+    /*!
+     * Marks custom font as likely needed and loads it in background.
+     */
+    void
+    prewarmCustomFont(const std::string& name);
+
     /*!
      * Initialise fonts from an XML file.
      *
@@ -78,15 +102,73 @@ private:
     typedef std::map<std::string, Font*> FontMap;
     FontMap _fontMap;
 
+    //! Fonts file which is parsed last.
+    std::string _fontsFile;
+    //! Bits of fonts in fontSlots() which are used in this session.
+    mutable unsigned int _touched;
+    //! Names of custom fonts which are used in this session.
+    mutable std::set<std::string> _touchedCustom;
+
+    struct PrewarmEntry
+    {
+        std::string name;
+        int size;
+        DFBFontAttributes attr;
+    };
+
+    //! This mutex protects prewarm queue and keys.
+    pthread_mutex_t _prewarmLock;
+    //! Background thread which loads queued fonts.
+    pthread_t _prewarmThread;
+    //! Fonts waiting to be loaded.
+    std::list<PrewarmEntry> _prewarmQueue;
+    //! FontCache keys of loaded fonts, released with pack.
+    std::vector<unsigned int> _prewarmKeys;
+    //! True while thread is processing queue.
+    bool _prewarmRunning;
+    //! True if thread is created and not joined yet.
+    bool _prewarmJoinable;
+    //! Set to stop thread after current font.
+    bool _prewarmStop;
+
     //! Release fonts.
     void
     release();
 
-    friend std::istream&
-    operator>>(std::istream& is, FontPack& obj);
+    //! Adds font to prewarm queue and starts thread if necessary.
+    void
+    queuePrewarm(Font* font);
+
+    //! Stops prewarm thread and releases prewarmed fonts.
+    void
+    stopPrewarm();
+
+    static void*
+    prewarmThread(void* arg);
+
+    //! Returns path of prewarm list for current fonts file.
+    std::string
+    prewarmListFile() const;
+
+    //! Prewarms fonts used in a previous session.
+    void
+    loadPrewarmList();
+
+    //! Saves fonts used in this session.
+    void
+    savePrewarmList();
+
+    //! Sets slots to members which store fonts of style hints.
+    void
+    fontSlots(Font** slots[5]);
 
-    friend std::ostream&
-    operator<<(std::ostream& os, const FontPack& obj);
+    //! Initialises fonts from a ThemeBundle section, returns false if section is invalid.
+    bool
+    loadSection(const void* data, unsigned int bytes);
+
+    //! Stores font descriptors in ThemeBundle.
+    void
+    storeSection(const char* fontsFile);
 };
 
 } /* namespace ilixi */
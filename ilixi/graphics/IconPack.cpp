@@ -26,13 +26,30 @@
 #include <lib/FileSystem.h>
 #include <lib/XMLReader.h>
 #include <core/Logger.h>
-#include <fstream>
+#include <graphics/ThemeBundle.h>
+#include <vector>
 
 namespace ilixi
 {
 
 D_DEBUG_DOMAIN(ILX_ICONPACK, "ilixi/graphics/IconPack", "IconPack");
 
+//! Layout of icon pack section in ThemeBundle, followed by IconRecords.
+struct IconSectionHeader
+{
+    uint32_t pack;
+    int32_t iconSize;
+    uint32_t count;
+};
+
+//! Position of an icon in pack image.
+struct IconRecord
+{
+    uint32_t name;
+    int32_t x;
+    int32_t y;
+};
+
 IconPack::IconPack(const char* iconsFile)
         : _iconPack(NULL),
           _iconSize(48)
@@ -57,93 +74,99 @@ IconPack::getIcon(const std::string& name)
         ILOG_DEBUG(ILX_ICONPACK, " -> %s @ (%d, %d, %d, %d)\n", name.c_str(), it->second.x(), it->second.y(), _iconSize, _iconSize);
         return new Image(_iconPack, Rectangle(it->second.x(), it->second.y(), _iconSize, _iconSize));
     }
+    if (_atlas.contains(name))
+        return _atlas.getImage(name);
     ILOG_WARNING(ILX_ICONPACK, " -> Cannot find icon: %s\n", name.c_str());
     return NULL;
 }
 
+bool
+IconPack::addIcon(const std::string& name, const std::string& path)
+{
+    ILOG_TRACE(ILX_ICONPACK);
+    ILOG_DEBUG(ILX_ICONPACK, " -> name: %s path: %s\n", name.c_str(), path.c_str());
+    if (_iconMap.find(name) != _iconMap.end())
+    {
+        ILOG_WARNING(ILX_ICONPACK, "Icon %s already exists!\n", name.c_str());
+        return false;
+    }
+    return _atlas.addImage(name, path, Size(_iconSize, _iconSize));
+}
+
 bool
 IconPack::parseIcons(const char* iconsFile)
 {
     ILOG_TRACE(ILX_ICONPACK);
     ILOG_DEBUG(ILX_ICONPACK, " -> file: %s\n", iconsFile);
 
-    std::string cacheFile = PrintF("%s%u.sxml", FileSystem::ilxDirectory().c_str(), createHash(iconsFile));
-    ILOG_DEBUG(ILX_ICONPACK, " -> cache file: %s\n", cacheFile.c_str());
-    if (difftime(FileSystem::getModificationTime(cacheFile), FileSystem::getModificationTime(iconsFile)) > 0)
+    unsigned int bytes = 0;
+    const void* data = ThemeBundle::instance().find(ThemeBundle::IconSection, iconsFile, &bytes);
+    if (data && loadSection(data, bytes))
     {
-        ILOG_DEBUG(ILX_ICONPACK, " -> Parsing cached icons file.\n");
-        std::ifstream ifs(cacheFile.c_str(), std::ios::in);
-        ifs >> *this;
-        ifs.close();
-        ILOG_INFO(ILX_ICONPACK, "Parsed cached icons file: %s\n", cacheFile.c_str());
-    } else
+        ILOG_INFO(ILX_ICONPACK, "Loaded icons from theme bundle: %s\n", iconsFile);
+        return true;
+    }
+
+    XMLReader xml;
+    if (xml.loadFile(iconsFile) == false)
     {
-        XMLReader xml;
-        if (xml.loadFile(iconsFile) == false)
-        {
-            ILOG_FATAL(ILX_ICONPACK, "Could not parse icon pack!\n");
-            return false;
-        }
+        ILOG_FATAL(ILX_ICONPACK, "Could not parse icon pack!\n");
+        return false;
+    }
 
-        xmlNodePtr root = xml.root();
-        xmlNodePtr node = xml.currentNode();
+    xmlNodePtr root = xml.root();
+    xmlNodePtr node = xml.currentNode();
 
-        release();
+    release();
 
-        xmlChar* imgFile = xmlGetProp(root, (xmlChar*) "resource");
-        xmlChar* imgDefSize = xmlGetProp(root, (xmlChar*) "defaultSize");
-        std::string path = (char*) imgFile;
-        std::string file;
-        size_t found = path.find("@ILX_IMGDIR:");
+    xmlChar* imgFile = xmlGetProp(root, (xmlChar*) "resource");
+    xmlChar* imgDefSize = xmlGetProp(root, (xmlChar*) "defaultSize");
+    std::string path = (char*) imgFile;
+    std::string file;
+    size_t found = path.find("@ILX_IMGDIR:");
+    if (found != std::string::npos)
+    {
+        file = ILIXI_DATADIR"images/";
+        file.append(path.substr(found + 12, std::string::npos));
+    } else
+    {
+        found = path.find("@ILX_THEMEDIR:");
         if (found != std::string::npos)
         {
-            file = ILIXI_DATADIR"images/";
-            file.append(path.substr(found + 12, std::string::npos));
+            file.append(PlatformManager::instance().getThemeDirectory());
+            file.append(path.substr(found + 14, std::string::npos));
+            ILOG_DEBUG(ILX_ICONPACK, " -> image file: %s\n", file.c_str());
         } else
-        {
-            found = path.find("@ILX_THEMEDIR:");
-            if (found != std::string::npos)
-            {
-                file.append(PlatformManager::instance().getThemeDirectory());
-                file.append(path.substr(found + 14, std::string::npos));
-                ILOG_DEBUG(ILX_ICONPACK, " -> image file: %s\n", file.c_str());
-            } else
-                file = path;
-        }
-
-        _iconPack = new Image(file);
-        _iconSize = atoi((char*) imgDefSize);
-        xmlFree(imgDefSize);
-        xmlFree(imgFile);
-
-        while (node != NULL)
-        {
-            xmlChar* iconName = xmlGetProp(node, (xmlChar*) "name");
-            xmlChar* iconRow = xmlGetProp(node, (xmlChar*) "row");
-            xmlChar* iconCol = xmlGetProp(node, (xmlChar*) "col");
-            int x = (atoi((char*) iconCol) - 1) * _iconSize;
-            int y = (atoi((char*) iconRow) - 1) * _iconSize;
-            std::pair<IconMap::iterator, bool> res = _iconMap.insert(std::make_pair((char*) iconName, Point(x, y)));
-            if (!res.second)
-                ILOG_WARNING(ILX_ICONPACK, "Icon %s already exists!\n", iconName);
-            else
-                ILOG_DEBUG(ILX_ICONPACK, " -> %s - %d, %d\n", iconName, res.first->second.x(), res.first->second.y());
-
-            xmlFree(iconCol);
-            xmlFree(iconRow);
-            xmlFree(iconName);
-            node = node->next;
-        }
-
-        ILOG_INFO(ILX_ICONPACK, "Parsed icons file: %s\n", iconsFile);
-
-        std::ofstream ofs(cacheFile.c_str(), std::ios::out);
-        ofs.seekp(0, std::ios::beg);
-        ofs << *this;
-        ofs.close();
-        ILOG_INFO(ILX_ICONPACK, "Created cached icons file: %s\n", cacheFile.c_str());
+            file = path;
+    }
+
+    _iconPack = new Image(file);
+    _iconSize = atoi((char*) imgDefSize);
+    xmlFree(imgDefSize);
+    xmlFree(imgFile);
+
+    while (node != NULL)
+    {
+        xmlChar* iconName = xmlGetProp(node, (xmlChar*) "name");
+        xmlChar* iconRow = xmlGetProp(node, (xmlChar*) "row");
+        xmlChar* iconCol = xmlGetProp(node, (xmlChar*) "col");
+        int x = (atoi((char*) iconCol) - 1) * _iconSize;
+        int y = (atoi((char*) iconRow) - 1) * _iconSize;
+        std::pair<IconMap::iterator, bool> res = _iconMap.insert(std::make_pair((char*) iconName, Point(x, y)));
+        if (!res.second)
+            ILOG_WARNING(ILX_ICONPACK, "Icon %s already exists!\n", iconName);
+        else
+            ILOG_DEBUG(ILX_ICONPACK, " -> %s - %d, %d\n", iconName, res.first->second.x(), res.first->second.y());
+
+        xmlFree(iconCol);
+        xmlFree(iconRow);
+        xmlFree(iconName);
+        node = node->next;
     }
 
+    ILOG_INFO(ILX_ICONPACK, "Parsed icons file: %s\n", iconsFile);
+
+    storeSection(iconsFile, file);
     return true;
 }
 
@@ -151,46 +174,68 @@ void
 IconPack::release()
 {
     _iconMap.clear();
+    _atlas.clear();
     delete _iconPack;
     _iconPack = NULL;
 }
 
-std::istream&
-operator>>(std::istream& is, IconPack& obj)
+bool
+IconPack::loadSection(const void* data, unsigned int bytes)
 {
-    obj.release();
-
-    int mapSize = 0;
-    std::string iconName;
-    Point p;
-    obj._iconPack = new Image();
-
-    is >> obj._iconSize;
-    is.ignore(1);
-    is >> *obj._iconPack;
-    is >> mapSize;
-    for (int i = 0; i < mapSize; ++i)
+    ILOG_TRACE(ILX_ICONPACK);
+    const IconSectionHeader* header = (const IconSectionHeader*) data;
+    if (bytes < sizeof(IconSectionHeader) || bytes < sizeof(IconSectionHeader) + header->count * sizeof(IconRecord))
+        return false;
+
+    const char* pack = ThemeBundle::string(data, bytes, header->pack);
+    if (!pack)
+        return false;
+
+    release();
+    _iconPack = new Image(pack);
+    _iconSize = header->iconSize;
+
+    const IconRecord* record = (const IconRecord*) (header + 1);
+    for (unsigned int i = 0; i < header->count; ++i, ++record)
     {
-        is >> iconName;
-        is.ignore(1);
-        is >> p;
-        obj._iconMap.insert(std::make_pair(iconName, p));
+        const char* name = ThemeBundle::string(data, bytes, record->name);
+        if (name)
+            _iconMap.insert(std::make_pair(name, Point(record->x, record->y)));
     }
-    is.ignore(1);
-
-    return is;
+    return true;
 }
 
-std::ostream&
-operator<<(std::ostream& os, const IconPack& obj)
+void
+IconPack::storeSection(const char* iconsFile, const std::string& pack)
 {
-    os << obj._iconSize << std::endl;
-    os << *obj._iconPack << std::endl;
-    os << obj._iconMap.size() << std::endl;
-    for (IconPack::IconMap::const_iterator it = obj._iconMap.begin(); it != obj._iconMap.end(); ++it)
-        os << it->first << "\t" << it->second << std::endl;
+    ILOG_TRACE(ILX_ICONPACK);
+    ThemeBundle::Writer writer;
+    IconSectionHeader header;
+    header.pack = 0;
+    header.iconSize = _iconSize;
+    header.count = _iconMap.size();
+    unsigned int offset = writer.append(header);
+
+    std::vector<unsigned int> offsets;
+    for (IconMap::const_iterator it = _iconMap.begin(); it != _iconMap.end(); ++it)
+    {
+        IconRecord record;
+        record.name = 0;
+        record.x = it->second.x();
+        record.y = it->second.y();
+        offsets.push_back(writer.append(record));
+    }
 
-    return os;
+    // strings are appended after records, so records directly follow header.
+    unsigned int i = 0;
+    for (IconMap::const_iterator it = _iconMap.begin(); it != _iconMap.end(); ++it, ++i)
+    {
+        uint32_t name = writer.appendString(it->first);
+        writer.at<IconRecord>(offsets[i])->name = name;
+    }
+    uint32_t packOffset = writer.appendString(pack);
+    writer.at<IconSectionHeader>(offset)->pack = packOffset;
+    ThemeBundle::instance().store(ThemeBundle::IconSection, iconsFile, writer);
 }
 
 } /* namespace ilixi */
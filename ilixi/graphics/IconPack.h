@@ -24,13 +24,16 @@
 #ifndef ILIXI_ICONS_H_
 #define ILIXI_ICONS_H_
 
-#include <types/Image.h>
+#include <graphics/TextureAtlas.h>
 #include <map>
-#include <iostream>
 
 namespace ilixi
 {
 //! Provides an icon pack.
+/*!
+ * Icons of a pack are sub-images of a single image. Icons registered at runtime using
+ * addIcon() are packed into a TextureAtlas, so they share a few surfaces as well.
+ */
 class IconPack
 {
 public:
@@ -51,6 +54,14 @@ public:
     Image*
     getIcon(const std::string& name);
 
+    /*!
+     * Registers an icon file at runtime. Icon is scaled to default icon size.
+     *
+     * Returns false if icon cannot be loaded or name is already used.
+     */
+    bool
+    addIcon(const std::string& name, const std::string& path);
+
     /*!
      * Initialise icons from an XML file.
      *
@@ -68,16 +79,20 @@ private:
     typedef std::map<std::string, Point> IconMap;
     //! This is for mapping icons to sub_images.
     IconMap _iconMap;
+    //! This atlas stores icons registered at runtime.
+    TextureAtlas _atlas;
 
-    //! Release icon pack image.
+    //! Release icon pack image and icons registered at runtime.
     void
     release();
 
-    friend std::istream&
-    operator>>(std::istream& is, IconPack& obj);
+    //! Initialises pack from a ThemeBundle section, returns false if section is invalid.
+    bool
+    loadSection(const void* data, unsigned int bytes);
 
-    friend std::ostream&
-    operator<<(std::ostream& os, const IconPack& obj);
+    //! Stores pack image path and sub-image geometry in ThemeBundle.
+    void
+    storeSection(const char* iconsFile, const std::string& pack);
 };
 
 } /* namespace ilixi */
@@ -26,13 +26,31 @@
 #include <lib/FileSystem.h>
 #include <lib/XMLReader.h>
 #include <core/Logger.h>
-#include <fstream>
+#include <graphics/ThemeBundle.h>
+#include <vector>
 
 namespace ilixi
 {
 
 D_DEBUG_DOMAIN(ILX_IMAGEPACK, "ilixi/graphics/ImagePack", "ImagePack");
 
+//! Layout of image pack section in ThemeBundle, followed by ImageRecords.
+struct ImagePackSectionHeader
+{
+    uint32_t pack;
+    uint32_t count;
+};
+
+//! Geometry of a sub-image in pack image.
+struct ImageRecord
+{
+    uint32_t name;
+    int32_t x;
+    int32_t y;
+    int32_t width;
+    int32_t height;
+};
+
 ImagePack::ImagePack(const char* file)
         : _pack(NULL)
 {
@@ -55,93 +73,99 @@ ImagePack::getImage(const std::string& name) const
         ILOG_DEBUG(ILX_IMAGEPACK, " -> %s @ (%d, %d, %d, %d)\n", name.c_str(), it->second.x(), it->second.y(), it->second.width(), it->second.height());
         return new Image(_pack, it->second);
     }
+    if (_atlas.contains(name))
+        return _atlas.getImage(name);
     ILOG_WARNING(ILX_IMAGEPACK, " -> Cannot find image: %s\n", name.c_str());
     return NULL;
 }
 
+bool
+ImagePack::addImage(const std::string& name, const std::string& path, const Size& size)
+{
+    ILOG_TRACE(ILX_IMAGEPACK);
+    ILOG_DEBUG(ILX_IMAGEPACK, " -> name: %s path: %s\n", name.c_str(), path.c_str());
+    if (_map.find(name) != _map.end())
+    {
+        ILOG_WARNING(ILX_IMAGEPACK, "Image %s already exists!\n", name.c_str());
+        return false;
+    }
+    return _atlas.addImage(name, path, size);
+}
+
 bool
 ImagePack::parsePack(const char* packFile)
 {
     ILOG_TRACE(ILX_IMAGEPACK);
     ILOG_DEBUG(ILX_IMAGEPACK, " -> file: %s\n", packFile);
 
-    std::string cacheFile = PrintF("%s%u.sxml", FileSystem::ilxDirectory().c_str(), createHash(packFile));
-    ILOG_DEBUG(ILX_IMAGEPACK, " -> cache file: %s\n", cacheFile.c_str());
-    if (difftime(FileSystem::getModificationTime(cacheFile), FileSystem::getModificationTime(packFile)) > 0)
+    unsigned int bytes = 0;
+    const void* data = ThemeBundle::instance().find(ThemeBundle::ImagePackSection, packFile, &bytes);
+    if (data && loadSection(data, bytes))
     {
-        ILOG_DEBUG(ILX_IMAGEPACK, " -> Parsing cached image pack file.\n");
-        std::ifstream ifs(cacheFile.c_str(), std::ios::in);
-        ifs >> *this;
-        ifs.close();
-        ILOG_INFO(ILX_IMAGEPACK, "Parsed cached image pack file: %s\n", cacheFile.c_str());
-    } else
+        ILOG_INFO(ILX_IMAGEPACK, "Loaded image pack from theme bundle: %s\n", packFile);
+        return true;
+    }
+
+    XMLReader xml;
+    if (xml.loadFile(packFile) == false)
     {
-        XMLReader xml;
-        if (xml.loadFile(packFile) == false)
-        {
-            ILOG_FATAL(ILX_IMAGEPACK, "Could not parse image pack!\n");
-            return false;
-        }
+        ILOG_FATAL(ILX_IMAGEPACK, "Could not parse image pack!\n");
+        return false;
+    }
 
-        xmlNodePtr root = xml.root();
-        xmlNodePtr node = xml.currentNode();
+    xmlNodePtr root = xml.root();
+    xmlNodePtr node = xml.currentNode();
 
-        release();
+    release();
 
-        xmlChar* imgFile = xmlGetProp(root, (xmlChar*) "resource");
-        std::string path = (char*) imgFile;
-        std::string file;
-        size_t found = path.find("@IMGDIR:");
+    xmlChar* imgFile = xmlGetProp(root, (xmlChar*) "resource");
+    std::string path = (char*) imgFile;
+    std::string file;
+    size_t found = path.find("@IMGDIR:");
+    if (found != std::string::npos)
+    {
+        file = ILIXI_DATADIR"images/";
+        file.append(path.substr(found + 8, std::string::npos));
+        ILOG_DEBUG(ILX_IMAGEPACK, " -> image file: %s\n", file.c_str());
+    } else
+    {
+        found = path.find("@ILX_THEMEDIR:");
         if (found != std::string::npos)
         {
-            file = ILIXI_DATADIR"images/";
-            file.append(path.substr(found + 8, std::string::npos));
+            file.append(PlatformManager::instance().getThemeDirectory());
+            file.append(path.substr(found + 14, std::string::npos));
             ILOG_DEBUG(ILX_IMAGEPACK, " -> image file: %s\n", file.c_str());
         } else
-        {
-            found = path.find("@ILX_THEMEDIR:");
-            if (found != std::string::npos)
-            {
-                file.append(PlatformManager::instance().getThemeDirectory());
-                file.append(path.substr(found + 14, std::string::npos));
-                ILOG_DEBUG(ILX_IMAGEPACK, " -> image file: %s\n", file.c_str());
-            } else
-                file = path;
-        }
-
-        _pack = new Image(file);
-        xmlFree(imgFile);
-
-        while (node != NULL)
-        {
-            xmlChar* imgName = xmlGetProp(node, (xmlChar*) "name");
-            xmlChar* imgX = xmlGetProp(node, (xmlChar*) "x");
-            xmlChar* imgY = xmlGetProp(node, (xmlChar*) "y");
-            xmlChar* imgW = xmlGetProp(node, (xmlChar*) "w");
-            xmlChar* imgH = xmlGetProp(node, (xmlChar*) "h");
-            std::pair<ImageMap::iterator, bool> res = _map.insert(std::make_pair((char*) imgName, Rectangle(atoi((char*) imgX), atoi((char*) imgY), atoi((char*) imgW), atoi((char*) imgH))));
-            if (!res.second)
-                ILOG_WARNING(ILX_IMAGEPACK, "Image %s already exists!\n", imgName);
-            else
-                ILOG_DEBUG(ILX_IMAGEPACK, " -> %s - %d, %d, %d, %d\n", imgName, res.first->second.x(), res.first->second.y(), res.first->second.width(), res.first->second.height());
-
-            xmlFree(imgH);
-            xmlFree(imgW);
-            xmlFree(imgY);
-            xmlFree(imgX);
-            xmlFree(imgName);
-            node = node->next;
-        }
-
-        ILOG_INFO(ILX_IMAGEPACK, "Parsed image pack file: %s\n", packFile);
-
-        std::ofstream ofs(cacheFile.c_str(), std::ios::out);
-        ofs.seekp(0, std::ios::beg);
-        ofs << *this;
-        ofs.close();
-        ILOG_INFO(ILX_IMAGEPACK, "Created cached image pack file: %s\n", cacheFile.c_str());
+            file = path;
+    }
+
+    _pack = new Image(file);
+    xmlFree(imgFile);
+
+    while (node != NULL)
+    {
+        xmlChar* imgName = xmlGetProp(node, (xmlChar*) "name");
+        xmlChar* imgX = xmlGetProp(node, (xmlChar*) "x");
+        xmlChar* imgY = xmlGetProp(node, (xmlChar*) "y");
+        xmlChar* imgW = xmlGetProp(node, (xmlChar*) "w");
+        xmlChar* imgH = xmlGetProp(node, (xmlChar*) "h");
+        std::pair<ImageMap::iterator, bool> res = _map.insert(std::make_pair((char*) imgName, Rectangle(atoi((char*) imgX), atoi((char*) imgY), atoi((char*) imgW), atoi((char*) imgH))));
+        if (!res.second)
+            ILOG_WARNING(ILX_IMAGEPACK, "Image %s already exists!\n", imgName);
+        else
+            ILOG_DEBUG(ILX_IMAGEPACK, " -> %s - %d, %d, %d, %d\n", imgName, res.first->second.x(), res.first->second.y(), res.first->second.width(), res.first->second.height());
+
+        xmlFree(imgH);
+        xmlFree(imgW);
+        xmlFree(imgY);
+        xmlFree(imgX);
+        xmlFree(imgName);
+        node = node->next;
     }
 
+    ILOG_INFO(ILX_IMAGEPACK, "Parsed image pack file: %s\n", packFile);
+
+    storeSection(packFile, file);
     return true;
 }
 
@@ -149,43 +173,68 @@ void
 ImagePack::release()
 {
     _map.clear();
+    _atlas.clear();
     delete _pack;
     _pack = NULL;
 }
 
-std::istream&
-operator>>(std::istream& is, ImagePack& obj)
+bool
+ImagePack::loadSection(const void* data, unsigned int bytes)
 {
-    obj.release();
+    ILOG_TRACE(ILX_IMAGEPACK);
+    const ImagePackSectionHeader* header = (const ImagePackSectionHeader*) data;
+    if (bytes < sizeof(ImagePackSectionHeader) || bytes < sizeof(ImagePackSectionHeader) + header->count * sizeof(ImageRecord))
+        return false;
 
-    int mapSize = 0;
-    std::string imgName;
-    Rectangle r;
-    obj._pack = new Image();
+    const char* pack = ThemeBundle::string(data, bytes, header->pack);
+    if (!pack)
+        return false;
 
-    is >> *obj._pack;
-    is >> mapSize;
-    for (int i = 0; i < mapSize; ++i)
+    release();
+    _pack = new Image(pack);
+
+    const ImageRecord* record = (const ImageRecord*) (header + 1);
+    for (unsigned int i = 0; i < header->count; ++i, ++record)
     {
-        is >> imgName;
-        is.ignore(1);
-        is >> r;
-        obj._map.insert(std::make_pair(imgName, r));
+        const char* name = ThemeBundle::string(data, bytes, record->name);
+        if (name)
+            _map.insert(std::make_pair(name, Rectangle(record->x, record->y, record->width, record->height)));
     }
-    is.ignore(1);
-
-    return is;
+    return true;
 }
 
-std::ostream&
-operator<<(std::ostream& os, const ImagePack& obj)
+void
+ImagePack::storeSection(const char* packFile, const std::string& pack)
 {
-    os << *obj._pack << std::endl;
-    os << obj._map.size() << std::endl;
-    for (ImagePack::ImageMap::const_iterator it = obj._map.begin(); it != obj._map.end(); ++it)
-        os << it->first << "\t" << it->second << std::endl;
+    ILOG_TRACE(ILX_IMAGEPACK);
+    ThemeBundle::Writer writer;
+    ImagePackSectionHeader header;
+    header.pack = 0;
+    header.count = _map.size();
+    unsigned int offset = writer.append(header);
+
+    std::vector<unsigned int> offsets;
+    for (ImageMap::const_iterator it = _map.begin(); it != _map.end(); ++it)
+    {
+        ImageRecord record;
+        record.name = 0;
+        record.x = it->second.x();
+        record.y = it->second.y();
+        record.width = it->second.width();
+        record.height = it->second.height();
+        offsets.push_back(writer.append(record));
+    }
 
-    return os;
+    // strings are appended after records, so records directly follow header.
+    unsigned int i = 0;
+    for (ImageMap::const_iterator it = _map.begin(); it != _map.end(); ++it, ++i)
+    {
+        uint32_t name = writer.appendString(it->first);
+        writer.at<ImageRecord>(offsets[i])->name = name;
+    }
+    uint32_t packOffset = writer.appendString(pack);
+    writer.at<ImagePackSectionHeader>(offset)->pack = packOffset;
+    ThemeBundle::instance().store(ThemeBundle::ImagePackSection, packFile, writer);
 }
 
 } /* namespace ilixi */
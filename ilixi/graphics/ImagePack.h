@@ -24,9 +24,8 @@
 #ifndef ILIXI_IMAGEPACK_H_
 #define ILIXI_IMAGEPACK_H_
 
-#include <types/Image.h>
+#include <graphics/TextureAtlas.h>
 #include <map>
-#include <iostream>
 
 namespace ilixi
 {
@@ -62,6 +61,18 @@ public:
     Image*
     getImage(const std::string& name) const;
 
+    /*!
+     * Registers an image file at runtime. Image is packed into a texture atlas.
+     *
+     * @param name unique name of image.
+     * @param path image file.
+     * @param size if valid, image is scaled to this size.
+     *
+     * Returns false if image cannot be loaded or name is already used.
+     */
+    bool
+    addImage(const std::string& name, const std::string& path, const Size& size = Size());
+
     /*!
      * Initialise image pack from an XML file.
      *
@@ -77,16 +88,20 @@ private:
     typedef std::map<std::string, Rectangle> ImageMap;
     //! This map stores position and dimensions of sub-images in pack.
     ImageMap _map;
+    //! This atlas stores images registered at runtime.
+    TextureAtlas _atlas;
 
-    //! Release pack image.
+    //! Release pack image and images registered at runtime.
     void
     release();
 
-    friend std::istream&
-    operator>>(std::istream& is, ImagePack& obj);
+    //! Initialises pack from a ThemeBundle section, returns false if section is invalid.
+    bool
+    loadSection(const void* data, unsigned int bytes);
 
-    friend std::ostream&
-    operator<<(std::ostream& os, const ImagePack& obj);
+    //! Stores pack image path and sub-image geometry in ThemeBundle.
+    void
+    storeSection(const char* packFile, const std::string& pack);
 };
 
 } /* namespace ilixi */
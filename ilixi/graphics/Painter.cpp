@@ -24,6 +24,7 @@
 #include <graphics/Painter.h>
 #include <types/TextLayout.h>
 #include <core/Logger.h>
+#include <lib/ImageLoader.h>
 
 namespace ilixi
 {
@@ -275,7 +276,7 @@ void
 Painter::drawLayout(const TextLayout& layout, const DFBSurfaceDrawingFlags& flags)
 {
     ILOG_TRACE(ILX_PAINTER);
-    if (layout.text().empty())
+    if (layout.isEmpty())
         return;
 
     if (_state & PFActive)
@@ -302,7 +303,7 @@ Painter::drawLayout(const TextLayout& layout, const DFBSurfaceDrawingFlags& flag
 void
 Painter::drawLayout(const TextLayout& layout, int x, int y, const DFBSurfaceDrawingFlags& flags)
 {
-    if (layout.text().empty())
+    if (layout.isEmpty())
         return;
 
     if (_state & PFActive)
@@ -335,7 +336,7 @@ Painter::stretchImage(Image* image, int x, int y, int w, int h, const DFBSurface
 void
 Painter::stretchImage(Image* image, const Rectangle& destRect, const DFBSurfaceBlittingFlags& flags)
 {
-    if ((_state & PFActive) && image)
+    if ((_state & PFActive) && image && prepareImage(image, destRect))
     {
         applyBrush();
         DFBRectangle dest = destRect.dfbRect();
@@ -362,7 +363,7 @@ Painter::stretchImage(Image* image, const Rectangle& destRect, const DFBSurfaceB
 void
 Painter::stretchImage(Image* image, const Rectangle& destRect, const Rectangle& sourceRect, const DFBSurfaceBlittingFlags& flags)
 {
-    if ((_state & PFActive) && image)
+    if ((_state & PFActive) && image && prepareImage(image, destRect))
     {
         applyBrush();
         DFBRectangle source = sourceRect.dfbRect();
@@ -390,7 +391,7 @@ Painter::stretchImage(Image* image, const Rectangle& destRect, const Rectangle&
 void
 Painter::drawImage(Image* image, int x, int y, const DFBSurfaceBlittingFlags& flags)
 {
-    if ((_state & PFActive) && image)
+    if ((_state & PFActive) && image && prepareImage(image, Rectangle(x, y, image->width(), image->height())))
     {
         applyBrush();
         if (!(image->getCaps() & DICAPS_ALPHACHANNEL))
@@ -422,7 +423,7 @@ Painter::drawImage(Image* image, const Point& point, const DFBSurfaceBlittingFla
 void
 Painter::tileImage(Image* image, int x, int y, const DFBSurfaceBlittingFlags& flags)
 {
-    if ((_state & PFActive) && image)
+    if ((_state & PFActive) && image && prepareImage(image))
     {
         applyBrush();
         if (!(image->getCaps() & DICAPS_ALPHACHANNEL))
@@ -448,7 +449,7 @@ Painter::tileImage(Image* image, int x, int y, const DFBSurfaceBlittingFlags& fl
 void
 Painter::tileImage(Image* image, int x, int y, const Rectangle& source, const DFBSurfaceBlittingFlags& flags)
 {
-    if ((_state & PFActive) && image)
+    if ((_state & PFActive) && image && prepareImage(image))
     {
         applyBrush();
         if (!(image->getCaps() & DICAPS_ALPHACHANNEL))
@@ -476,7 +477,7 @@ void
 Painter::blitImage(Image* image, const Rectangle& source, int x, int y, const DFBSurfaceBlittingFlags& flags)
 {
     ILOG_TRACE(ILX_PAINTER);
-    if ((_state & PFActive) && image)
+    if ((_state & PFActive) && image && prepareImage(image, Rectangle(x, y, source.width(), source.height())))
     {
         applyBrush();
         if (!(image->getCaps() & DICAPS_ALPHACHANNEL))
@@ -503,7 +504,7 @@ Painter::blitImage(Image* image, const Rectangle& source, int x, int y, const DF
 void
 Painter::batchBlitImage(Image* image, const DFBRectangle* sourceRects, const DFBPoint* points, int num, const DFBSurfaceBlittingFlags& flags)
 {
-    if ((_state & PFActive) && image)
+    if ((_state & PFActive) && image && prepareImage(image))
     {
         applyBrush();
         if (!(image->getCaps() & DICAPS_ALPHACHANNEL))
@@ -535,7 +536,7 @@ Painter::batchBlitImage(Image* image, const DFBRectangle* sourceRects, const DFB
 void
 Painter::batchBlitImage(Image* image, const Rectangle* sourceRects, const Point* points, int num, const DFBSurfaceBlittingFlags& flags)
 {
-    if ((_state & PFActive) && image)
+    if ((_state & PFActive) && image && prepareImage(image))
     {
         applyBrush();
         if (!(image->getCaps() & DICAPS_ALPHACHANNEL))
@@ -581,7 +582,7 @@ Painter::batchBlitImage(Image* image, const Rectangle* sourceRects, const Point*
 
 void Painter::batchStretchBlitImage(Image* image, const DFBRectangle* sourceRects, const DFBRectangle* destRects, int num, const DFBSurfaceBlittingFlags& flags)
 {
-    if ((_state & PFActive) && image)
+    if ((_state & PFActive) && image && prepareImage(image))
     {
         applyBrush();
         if (!(image->getCaps() & DICAPS_ALPHACHANNEL))
@@ -615,7 +616,7 @@ void Painter::batchStretchBlitImage(Image* image, const DFBRectangle* sourceRect
 void
 Painter::batchStretchBlitImage(Image* image, const Rectangle* sourceRects, const Rectangle* destRects, int num, const DFBSurfaceBlittingFlags& flags)
 {
-    if ((_state & PFActive) && image)
+    if ((_state & PFActive) && image && prepareImage(image))
     {
         applyBrush();
         if (!(image->getCaps() & DICAPS_ALPHACHANNEL))
@@ -757,6 +758,27 @@ Painter::textExtents(const std::string& text, int bytes)
     return _font.extents(text, bytes);
 }
 
+bool
+Painter::prepareImage(Image* image, const Rectangle& rect)
+{
+    if (image->loadMode() == Image::Synchronous || image->ready())
+        return true;
+
+    ImageLoader::instance().load(image, _myWidget, image->loadPriority());
+    // images which can not be queued, e.g. not available ones, are drawn as before.
+    if (!image->loading())
+        return true;
+
+    if (rect.isValid() && image->placeholder().alpha())
+    {
+        Brush brush = _brush;
+        setBrush(image->placeholder());
+        fillRectangle(rect, image->placeholder().alpha() == 255 ? DSDRAW_NOFX : DSDRAW_BLEND);
+        setBrush(brush);
+    }
+    return false;
+}
+
 void
 Painter::applyBrush()
 {
@@ -387,6 +387,10 @@ private:
     //! Apply pen to content if it is modified.
     void
     applyPen();
+
+    //! Returns true if image can be drawn, otherwise queues image to ImageLoader and fills rect with its placeholder.
+    bool
+    prepareImage(Image* image, const Rectangle& rect = Rectangle());
 };
 }
 
@@ -22,6 +22,7 @@
  */
 
 #include <graphics/Palette.h>
+#include <graphics/ThemeBundle.h>
 #include <core/Logger.h>
 #include <lib/XMLReader.h>
 
@@ -30,6 +31,25 @@ namespace ilixi
 
 D_DEBUG_DOMAIN( ILX_PALETTE, "ilixi/graphics/Palette", "Palette Parser");
 
+//! Layout of palette section in ThemeBundle, followed by colors as red, green, blue, alpha.
+struct PaletteSectionHeader
+{
+    uint32_t count;
+};
+
+static void
+addColors(std::vector<Color*>& list, ColorGroup& group)
+{
+    list.push_back(&group.base);
+    list.push_back(&group.baseText);
+    list.push_back(&group.baseAlt);
+    list.push_back(&group.baseAltText);
+    list.push_back(&group.bg);
+    list.push_back(&group.border);
+    list.push_back(&group.fill);
+    list.push_back(&group.text);
+}
+
 ColorGroup::ColorGroup()
         : base(1, 1, 1),
           baseText(0, 0, 0),
@@ -103,6 +123,14 @@ Palette::getGroup(WidgetState state)
 bool
 Palette::parsePalette(const char* palette)
 {
+    unsigned int bytes = 0;
+    const void* data = ThemeBundle::instance().find(ThemeBundle::PaletteSection, palette, &bytes);
+    if (data && loadSection(data, bytes))
+    {
+        ILOG_INFO(ILX_PALETTE, "Loaded palette from theme bundle: %s\n", palette);
+        return true;
+    }
+
     XMLReader xml;
     if (xml.loadFile(palette) == false)
     {
@@ -240,7 +268,56 @@ Palette::parsePalette(const char* palette)
     }
 
     ILOG_INFO(ILX_PALETTE, "Parsed palette file: %s\n", palette);
+    storeSection(palette);
     return true;
 }
 
+bool
+Palette::loadSection(const void* data, unsigned int bytes)
+{
+    std::vector<Color*> list;
+    colors(list);
+
+    const PaletteSectionHeader* header = (const PaletteSectionHeader*) data;
+    if (bytes < sizeof(PaletteSectionHeader) || header->count != list.size() || bytes < sizeof(PaletteSectionHeader) + header->count * 4)
+        return false;
+
+    const u8* rgba = (const u8*) (header + 1);
+    for (unsigned int i = 0; i < list.size(); ++i, rgba += 4)
+        *list[i] = Color(rgba[0], rgba[1], rgba[2], rgba[3]);
+    return true;
+}
+
+void
+Palette::storeSection(const char* palette)
+{
+    std::vector<Color*> list;
+    colors(list);
+
+    ThemeBundle::Writer writer;
+    PaletteSectionHeader header;
+    header.count = list.size();
+    writer.append(header);
+    for (unsigned int i = 0; i < list.size(); ++i)
+    {
+        u8 rgba[4] = { list[i]->red(), list[i]->green(), list[i]->blue(), list[i]->alpha() };
+        writer.append(rgba);
+    }
+    ThemeBundle::instance().store(ThemeBundle::PaletteSection, palette, writer);
+}
+
+void
+Palette::colors(std::vector<Color*>& list)
+{
+    list.clear();
+    list.push_back(&bg);
+    list.push_back(&focus);
+    list.push_back(&text);
+    list.push_back(&textDisabled);
+    addColors(list, _default);
+    addColors(list, _exposed);
+    addColors(list, _pressed);
+    addColors(list, _disabled);
+}
+
 } /* namespace ilixi */
@@ -26,6 +26,7 @@
 
 #include <types/Enums.h>
 #include <types/Color.h>
+#include <vector>
 
 namespace ilixi
 {
@@ -112,6 +113,18 @@ public:
     //! Disabled state.
     ColorGroup _disabled;
 
+private:
+    //! Initialises palette from a ThemeBundle section, returns false if section is invalid.
+    bool
+    loadSection(const void* data, unsigned int bytes);
+
+    //! Stores palette in ThemeBundle.
+    void
+    storeSection(const char* palette);
+
+    //! Fills list with all colors in a fixed order.
+    void
+    colors(std::vector<Color*>& list);
 };
 }
 
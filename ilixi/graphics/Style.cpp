@@ -22,18 +22,54 @@
  */
 
 #include <graphics/Style.h>
+#include <graphics/ThemeBundle.h>
 #include <lib/FileSystem.h>
 #include <core/PlatformManager.h>
 #include <core/Logger.h>
 #include <lib/XMLReader.h>
 #include <libgen.h>
-#include <fstream>
 
 namespace ilixi
 {
 
 D_DEBUG_DOMAIN( ILX_STYLE, "ilixi/graphics/Style", "Style Parser");
 
+//! Layout of style section in ThemeBundle, followed by rectangles as x, y, width, height.
+struct StyleSectionHeader
+{
+    uint32_t pack;
+    int32_t overlap;
+    uint32_t count;
+};
+
+static void
+addRects(std::vector<Rectangle*>& list, Rectangle& rect)
+{
+    list.push_back(&rect);
+}
+
+static void
+addRects(std::vector<Rectangle*>& list, r3& rect)
+{
+    list.push_back(&rect.l);
+    list.push_back(&rect.m);
+    list.push_back(&rect.r);
+}
+
+static void
+addRects(std::vector<Rectangle*>& list, r9& rect)
+{
+    list.push_back(&rect.tl);
+    list.push_back(&rect.tm);
+    list.push_back(&rect.tr);
+    list.push_back(&rect.l);
+    list.push_back(&rect.m);
+    list.push_back(&rect.r);
+    list.push_back(&rect.bl);
+    list.push_back(&rect.bm);
+    list.push_back(&rect.br);
+}
+
 Style::Style()
         : _pack(NULL)
 {
@@ -48,6 +84,7 @@ void
 Style::release()
 {
     delete _pack;
+    _pack = NULL;
 }
 
 bool
@@ -56,75 +93,63 @@ Style::parseStyle(const char* style)
     ILOG_TRACE(ILX_STYLE);
     ILOG_DEBUG(ILX_STYLE, " -> file: %s\n", style);
 
-    std::string cacheFile = PrintF("%s%u.sxml", FileSystem::ilxDirectory().c_str(), createHash(style));
-    ILOG_DEBUG(ILX_STYLE, " -> cache file: %s\n", cacheFile.c_str());
-    if (difftime(FileSystem::getModificationTime(cacheFile), FileSystem::getModificationTime(style)) > 0)
+    unsigned int bytes = 0;
+    const void* data = ThemeBundle::instance().find(ThemeBundle::StyleSection, style, &bytes);
+    if (data && loadSection(data, bytes))
     {
-        ILOG_DEBUG(ILX_STYLE, " -> Parsing cached style file.\n");
-        std::ifstream ifs(cacheFile.c_str(), std::ios::binary | std::ios::in);
-        ifs >> *this;
-        ifs.close();
-        ILOG_INFO(ILX_STYLE, "Parsed cached style file: %s\n", cacheFile.c_str());
-    } else
-    {
-        XMLReader xml;
-        if (xml.loadFile(style) == false)
-        {
-            ILOG_FATAL(ILX_STYLE, "Could not parse style!\n");
-            return false;
-        }
-
-        xmlNodePtr root = xml.root();
-        xmlNodePtr group = xml.currentNode();
+        ILOG_INFO(ILX_STYLE, "Loaded style from theme bundle: %s\n", style);
+        return true;
+    }
 
-        release();
+    XMLReader xml;
+    if (xml.loadFile(style) == false)
+    {
+        ILOG_FATAL(ILX_STYLE, "Could not parse style!\n");
+        return false;
+    }
 
+    xmlNodePtr root = xml.root();
+    xmlNodePtr group = xml.currentNode();
 
+    release();
 
-        xmlChar* imgFile = xmlGetProp(root, (xmlChar*) "resource");
-        std::string path = (char*) imgFile;
-        std::string file;
-        size_t found = path.find("@IMGDIR:");
+    xmlChar* imgFile = xmlGetProp(root, (xmlChar*) "resource");
+    std::string path = (char*) imgFile;
+    std::string file;
+    size_t found = path.find("@IMGDIR:");
+    if (found != std::string::npos)
+    {
+        file = ILIXI_DATADIR"images/";
+        file.append(path.substr(found + 8, std::string::npos));
+        ILOG_DEBUG(ILX_STYLE, " -> image file: %s\n", file.c_str());
+    } else
+    {
+        found = path.find("@ILX_THEMEDIR:");
         if (found != std::string::npos)
         {
-            file = ILIXI_DATADIR"images/";
-            file.append(path.substr(found + 8, std::string::npos));
+            file.append(PlatformManager::instance().getThemeDirectory());
+            file.append(path.substr(found + 14, std::string::npos));
             ILOG_DEBUG(ILX_STYLE, " -> image file: %s\n", file.c_str());
         } else
         {
-            found = path.find("@ILX_THEMEDIR:");
-            if (found != std::string::npos)
-            {
-                file.append(PlatformManager::instance().getThemeDirectory());
-                file.append(path.substr(found + 14, std::string::npos));
-                ILOG_DEBUG(ILX_STYLE, " -> image file: %s\n", file.c_str());
-            } else
-            {
-                ILOG_DEBUG(ILX_STYLE, " -> parsing theme...\n");
-                char* path = strdup(style);
-                path = dirname(path);
-                std::string imgPack = std::string(std::string(path).append("/ui-pack.dfiff"));
-
-                file = imgPack;
-                ILOG_DEBUG(ILX_STYLE, " -> pack: %s\n", imgPack.c_str());
-                free(path);
-            }
-        }
+            ILOG_DEBUG(ILX_STYLE, " -> parsing theme...\n");
+            char* path = strdup(style);
+            path = dirname(path);
+            std::string imgPack = std::string(std::string(path).append("/ui-pack.dfiff"));
 
-        _pack = new Image(file);
-        xmlFree(imgFile);
-        parseTheme(group);
+            file = imgPack;
+            ILOG_DEBUG(ILX_STYLE, " -> pack: %s\n", imgPack.c_str());
+            free(path);
+        }
+    }
 
+    _pack = new Image(file);
+    xmlFree(imgFile);
+    parseTheme(group);
 
-        ILOG_INFO(ILX_STYLE, "Parsed style file: %s\n", style);
-
-        // create cached file
-        std::ofstream ofs(cacheFile.c_str(), std::ios::binary | std::ios::out);
-        ofs.seekp(0, std::ios::beg);
-        ofs << *this;
-        ofs.close();
-    }
+    ILOG_INFO(ILX_STYLE, "Parsed style file: %s\n", style);
 
+    storeSection(style, file);
     return true;
 }
 
@@ -676,315 +701,210 @@ Style::parseTheme(xmlNodePtr node)
     } // end while(element)
 }
 
-std::istream&
-operator>>(std::istream& is, Style& obj)
+bool
+Style::loadSection(const void* data, unsigned int bytes)
 {
-    obj.release();
-
-    obj._pack = new Image();
-    is >> *obj._pack;
-
-    is >> obj.pb.def;
-    is >> obj.pb.pre;
-    is >> obj.pb.exp;
-    is >> obj.pb.dis;
-    is >> obj.pb.foc;
-
-    is >> obj.pbOK.def;
-    is >> obj.pbOK.pre;
-    is >> obj.pbOK.exp;
-    is >> obj.pbOK.dis;
-    is >> obj.pbOK.foc;
-
-    is >> obj.pbCAN.def;
-    is >> obj.pbCAN.pre;
-    is >> obj.pbCAN.exp;
-    is >> obj.pbCAN.dis;
-    is >> obj.pbCAN.foc;
-
-    is >> obj.tb.def;
-    is >> obj.tb.pre;
-    is >> obj.tb.exp;
-    is >> obj.tb.dis;
-    is >> obj.tb.foc;
-
-    is >> obj.db1.def;
-    is >> obj.db1.pre;
-    is >> obj.db1.exp;
-    is >> obj.db1.dis;
-    is >> obj.db1.foc;
-
-    is >> obj.db2.def;
-    is >> obj.db2.pre;
-    is >> obj.db2.exp;
-    is >> obj.db2.dis;
-    is >> obj.db2.foc;
-
-    is >> obj.li.def;
-    is >> obj.li.dis;
-    is >> obj.li.foc;
-
-    is >> obj.li2.def;
-    is >> obj.li2.dis;
-    is >> obj.li2.foc;
-
-    is >> obj.cb.def;
-    is >> obj.cb.pre;
-    is >> obj.cb.exp;
-    is >> obj.cb.dis;
-    is >> obj.cb.foc;
-
-    is >> obj.cbC.def;
-    is >> obj.cbC.pre;
-    is >> obj.cbC.exp;
-    is >> obj.cbC.dis;
-    is >> obj.cbC.foc;
-
-    is >> obj.cbT.def;
-    is >> obj.cbT.pre;
-    is >> obj.cbT.exp;
-    is >> obj.cbT.dis;
-    is >> obj.cbT.foc;
-
-    is >> obj.rbOn.def;
-    is >> obj.rbOn.pre;
-    is >> obj.rbOn.exp;
-    is >> obj.rbOn.dis;
-    is >> obj.rbOn.foc;
-
-    is >> obj.rbOff.def;
-    is >> obj.rbOff.pre;
-    is >> obj.rbOff.exp;
-    is >> obj.rbOff.dis;
-    is >> obj.rbOff.foc;
-
-    is >> obj.prH.def;
-    is >> obj.prH.dis;
-
-    is >> obj.prHI.def;
-    is >> obj.prHI.dis;
-
-    is >> obj.prV.def;
-    is >> obj.prV.dis;
-
-    is >> obj.prVI.def;
-    is >> obj.prVI.dis;
-
-    is >> obj.hSl.def;
-    is >> obj.hSl.dis;
-    is >> obj.hSl.fill;
-    is >> obj.hSl.fill_dis;
-
-    is >> obj.vSl.def;
-    is >> obj.vSl.dis;
-    is >> obj.vSl.fill;
-    is >> obj.vSl.fill_dis;
-
-    is >> obj.slI.def;
-    is >> obj.slI.pre;
-    is >> obj.slI.exp;
-    is >> obj.slI.dis;
-    is >> obj.slI.foc;
-
-    is >> obj.fr.def;
-    is >> obj.fr.dis;
-
-    is >> obj.panel.def;
-    is >> obj.panel.dis;
-    is >> obj.panel.passive;
-
-    is >> obj.overlap;
-    is >> obj.panelInv.tl;
-    is >> obj.panelInv.tr;
-    is >> obj.panelInv.bl;
-    is >> obj.panelInv.br;
-
-    is >> obj.panelInvDis.tl;
-    is >> obj.panelInvDis.tr;
-    is >> obj.panelInvDis.bl;
-    is >> obj.panelInvDis.br;
-
-    is >> obj.hScr;
-    is >> obj.vScr;
-
-    is >> obj.sb.def;
-    is >> obj.sb.dis;
-
-    is >> obj.sbRH;
-    is >> obj.sbRV;
-
-    is >> obj.tbar;
-    is >> obj.tbarb.def;
-    is >> obj.tbarb.pre;
-    is >> obj.tbarb.exp;
-    is >> obj.tbarb.dis;
-    is >> obj.tbarb.foc;
-
-    is >> obj.hLine;
-    is >> obj.vLine;
-
-    is >> obj.tbIndH.def;
-    is >> obj.tbIndH.dis;
-    is >> obj.tbIndV.def;
-    is >> obj.tbIndV.dis;
-
-    is >> obj.dialog;
-
-    return is;
+    ILOG_TRACE(ILX_STYLE);
+    std::vector<Rectangle*> list;
+    rectangles(list);
+
+    const StyleSectionHeader* header = (const StyleSectionHeader*) data;
+    if (bytes < sizeof(StyleSectionHeader) || header->count != list.size() || bytes < sizeof(StyleSectionHeader) + header->count * 4 * sizeof(int32_t))
+        return false;
+
+    const char* pack = ThemeBundle::string(data, bytes, header->pack);
+    if (!pack)
+        return false;
+
+    release();
+    _pack = new Image(pack);
+    overlap = header->overlap;
+
+    const int32_t* rect = (const int32_t*) (header + 1);
+    for (unsigned int i = 0; i < list.size(); ++i, rect += 4)
+        list[i]->setRectangle(rect[0], rect[1], rect[2], rect[3]);
+    return true;
 }
 
-std::ostream&
-operator<<(std::ostream& os, const Style& obj)
+void
+Style::storeSection(const char* style, const std::string& pack)
 {
-    os << *obj._pack << std::endl;
-
-    os << obj.pb.def;
-    os << obj.pb.pre;
-    os << obj.pb.exp;
-    os << obj.pb.dis;
-    os << obj.pb.foc;
-
-    os << obj.pbOK.def;
-    os << obj.pbOK.pre;
-    os << obj.pbOK.exp;
-    os << obj.pbOK.dis;
-    os << obj.pbOK.foc;
-
-    os << obj.pbCAN.def;
-    os << obj.pbCAN.pre;
-    os << obj.pbCAN.exp;
-    os << obj.pbCAN.dis;
-    os << obj.pbCAN.foc;
-
-    os << obj.tb.def;
-    os << obj.tb.pre;
-    os << obj.tb.exp;
-    os << obj.tb.dis;
-    os << obj.tb.foc;
-
-    os << obj.db1.def;
-    os << obj.db1.pre;
-    os << obj.db1.exp;
-    os << obj.db1.dis;
-    os << obj.db1.foc;
-
-    os << obj.db2.def;
-    os << obj.db2.pre;
-    os << obj.db2.exp;
-    os << obj.db2.dis;
-    os << obj.db2.foc;
-
-    os << obj.li.def;
-    os << obj.li.dis;
-    os << obj.li.foc;
-
-    os << obj.li2.def;
-    os << obj.li2.dis;
-    os << obj.li2.foc;
-
-    os << obj.cb.def << std::endl;
-    os << obj.cb.pre << std::endl;
-    os << obj.cb.exp << std::endl;
-    os << obj.cb.dis << std::endl;
-    os << obj.cb.foc << std::endl;
-
-    os << obj.cbC.def << std::endl;
-    os << obj.cbC.pre << std::endl;
-    os << obj.cbC.exp << std::endl;
-    os << obj.cbC.dis << std::endl;
-    os << obj.cbC.foc << std::endl;
-
-    os << obj.cbT.def << std::endl;
-    os << obj.cbT.pre << std::endl;
-    os << obj.cbT.exp << std::endl;
-    os << obj.cbT.dis << std::endl;
-    os << obj.cbT.foc << std::endl;
-
-    os << obj.rbOn.def << std::endl;
-    os << obj.rbOn.pre << std::endl;
-    os << obj.rbOn.exp << std::endl;
-    os << obj.rbOn.dis << std::endl;
-    os << obj.rbOn.foc << std::endl;
-
-    os << obj.rbOff.def << std::endl;
-    os << obj.rbOff.pre << std::endl;
-    os << obj.rbOff.exp << std::endl;
-    os << obj.rbOff.dis << std::endl;
-    os << obj.rbOff.foc << std::endl;
-
-    os << obj.prH.def;
-    os << obj.prH.dis;
-
-    os << obj.prHI.def;
-    os << obj.prHI.dis;
-
-    os << obj.prV.def;
-    os << obj.prV.dis;
-
-    os << obj.prVI.def;
-    os << obj.prVI.dis;
-
-    os << obj.hSl.def;
-    os << obj.hSl.dis;
-    os << obj.hSl.fill;
-    os << obj.hSl.fill_dis;
-
-    os << obj.vSl.def;
-    os << obj.vSl.dis;
-    os << obj.vSl.fill;
-    os << obj.vSl.fill_dis;
-
-    os << obj.slI.def << std::endl;
-    os << obj.slI.pre << std::endl;
-    os << obj.slI.exp << std::endl;
-    os << obj.slI.dis << std::endl;
-    os << obj.slI.foc << std::endl;
-
-    os << obj.fr.def;
-    os << obj.fr.dis;
-
-    os << obj.panel.def;
-    os << obj.panel.dis;
-    os << obj.panel.passive;
-
-    os << obj.overlap << std::endl;
-    os << obj.panelInv.tl << std::endl;
-    os << obj.panelInv.tr << std::endl;
-    os << obj.panelInv.bl << std::endl;
-    os << obj.panelInv.br << std::endl;
-
-    os << obj.panelInvDis.tl << std::endl;
-    os << obj.panelInvDis.tr << std::endl;
-    os << obj.panelInvDis.bl << std::endl;
-    os << obj.panelInvDis.br << std::endl;
-
-    os << obj.hScr;
-    os << obj.vScr;
-
-    os << obj.sb.def;
-    os << obj.sb.dis;
-
-    os << obj.sbRH << std::endl;
-    os << obj.sbRV << std::endl;
-
-    os << obj.tbar << std::endl;
-    os << obj.tbarb.def << std::endl;
-    os << obj.tbarb.pre << std::endl;
-    os << obj.tbarb.exp << std::endl;
-    os << obj.tbarb.dis << std::endl;
-    os << obj.tbarb.foc << std::endl;
-
-    os << obj.hLine << std::endl;
-    os << obj.vLine << std::endl;
-
-    os << obj.tbIndH.def << std::endl;
-    os << obj.tbIndH.dis << std::endl;
-    os << obj.tbIndV.def << std::endl;
-    os << obj.tbIndV.dis << std::endl;
-
-    os << obj.dialog << std::endl;
-
-    return os;
+    ILOG_TRACE(ILX_STYLE);
+    std::vector<Rectangle*> list;
+    rectangles(list);
+
+    ThemeBundle::Writer writer;
+    StyleSectionHeader header;
+    header.pack = 0;
+    header.overlap = overlap;
+    header.count = list.size();
+    unsigned int offset = writer.append(header);
+    for (unsigned int i = 0; i < list.size(); ++i)
+    {
+        writer.append((int32_t) list[i]->x());
+        writer.append((int32_t) list[i]->y());
+        writer.append((int32_t) list[i]->width());
+        writer.append((int32_t) list[i]->height());
+    }
+    // string is appended after rectangles, so they directly follow header.
+    uint32_t packOffset = writer.appendString(pack);
+    writer.at<StyleSectionHeader>(offset)->pack = packOffset;
+    ThemeBundle::instance().store(ThemeBundle::StyleSection, style, writer);
+}
+
+void
+Style::rectangles(std::vector<Rectangle*>& list)
+{
+    list.clear();
+    addRects(list, pb.def);
+    addRects(list, pb.pre);
+    addRects(list, pb.exp);
+    addRects(list, pb.dis);
+    addRects(list, pb.foc);
+
+    addRects(list, pbOK.def);
+    addRects(list, pbOK.pre);
+    addRects(list, pbOK.exp);
+    addRects(list, pbOK.dis);
+    addRects(list, pbOK.foc);
+
+    addRects(list, pbCAN.def);
+    addRects(list, pbCAN.pre);
+    addRects(list, pbCAN.exp);
+    addRects(list, pbCAN.dis);
+    addRects(list, pbCAN.foc);
+
+    addRects(list, tb.def);
+    addRects(list, tb.pre);
+    addRects(list, tb.exp);
+    addRects(list, tb.dis);
+    addRects(list, tb.foc);
+
+    addRects(list, db1.def);
+    addRects(list, db1.pre);
+    addRects(list, db1.exp);
+    addRects(list, db1.dis);
+    addRects(list, db1.foc);
+
+    addRects(list, db2.def);
+    addRects(list, db2.pre);
+    addRects(list, db2.exp);
+    addRects(list, db2.dis);
+    addRects(list, db2.foc);
+
+    addRects(list, li.def);
+    addRects(list, li.dis);
+    addRects(list, li.foc);
+
+    addRects(list, li2.def);
+    addRects(list, li2.dis);
+    addRects(list, li2.foc);
+
+    addRects(list, cb.def);
+    addRects(list, cb.pre);
+    addRects(list, cb.exp);
+    addRects(list, cb.dis);
+    addRects(list, cb.foc);
+
+    addRects(list, cbC.def);
+    addRects(list, cbC.pre);
+    addRects(list, cbC.exp);
+    addRects(list, cbC.dis);
+    addRects(list, cbC.foc);
+
+    addRects(list, cbT.def);
+    addRects(list, cbT.pre);
+    addRects(list, cbT.exp);
+    addRects(list, cbT.dis);
+    addRects(list, cbT.foc);
+
+    addRects(list, rbOn.def);
+    addRects(list, rbOn.pre);
+    addRects(list, rbOn.exp);
+    addRects(list, rbOn.dis);
+    addRects(list, rbOn.foc);
+
+    addRects(list, rbOff.def);
+    addRects(list, rbOff.pre);
+    addRects(list, rbOff.exp);
+    addRects(list, rbOff.dis);
+    addRects(list, rbOff.foc);
+
+    addRects(list, prH.def);
+    addRects(list, prH.dis);
+
+    addRects(list, prHI.def);
+    addRects(list, prHI.dis);
+
+    addRects(list, prV.def);
+    addRects(list, prV.dis);
+
+    addRects(list, prVI.def);
+    addRects(list, prVI.dis);
+
+    addRects(list, hSl.def);
+    addRects(list, hSl.dis);
+    addRects(list, hSl.fill);
+    addRects(list, hSl.fill_dis);
+
+    addRects(list, vSl.def);
+    addRects(list, vSl.dis);
+    addRects(list, vSl.fill);
+    addRects(list, vSl.fill_dis);
+
+    addRects(list, slI.def);
+    addRects(list, slI.pre);
+    addRects(list, slI.exp);
+    addRects(list, slI.dis);
+    addRects(list, slI.foc);
+
+    addRects(list, fr.def);
+    addRects(list, fr.dis);
+
+    addRects(list, panel.def);
+    addRects(list, panel.dis);
+    addRects(list, panel.passive);
+
+    addRects(list, panelInv.tl);
+    addRects(list, panelInv.tr);
+    addRects(list, panelInv.bl);
+    addRects(list, panelInv.br);
+
+    addRects(list, panelInvDis.tl);
+    addRects(list, panelInvDis.tr);
+    addRects(list, panelInvDis.bl);
+    addRects(list, panelInvDis.br);
+
+    addRects(list, hScr);
+
+    addRects(list, vScr);
+
+    addRects(list, sb.def);
+    addRects(list, sb.dis);
+
+    addRects(list, sbRH);
+
+    addRects(list, sbRV);
+
+    addRects(list, tbar);
+
+    addRects(list, tbarb.def);
+    addRects(list, tbarb.pre);
+    addRects(list, tbarb.exp);
+    addRects(list, tbarb.dis);
+    addRects(list, tbarb.foc);
+
+    addRects(list, hLine);
+
+    addRects(list, vLine);
+
+    addRects(list, tbIndH.def);
+    addRects(list, tbIndH.dis);
+
+    addRects(list, tbIndV.def);
+    addRects(list, tbIndV.dis);
+
+    addRects(list, dialog);
 }
 
 } /* namespace ilixi */
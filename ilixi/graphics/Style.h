@@ -27,6 +27,7 @@
 #include <types/Image.h>
 #include <graphics/StyleUtil.h>
 #include <map>
+#include <vector>
 
 namespace ilixi
 {
@@ -220,12 +221,17 @@ private:
     void
     release();
 
-    friend std::istream&
-    operator>>(std::istream& is, Style& obj);
+    //! Initialises style from a ThemeBundle section, returns false if section is invalid.
+    bool
+    loadSection(const void* data, unsigned int bytes);
 
-    friend std::ostream&
-    operator<<(std::ostream& os, const Style& obj);
+    //! Stores style in ThemeBundle.
+    void
+    storeSection(const char* style, const std::string& pack);
 
+    //! Fills list with all rectangles in a fixed order.
+    void
+    rectangles(std::vector<Rectangle*>& list);
 };
 
 }
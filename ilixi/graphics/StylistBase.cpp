@@ -22,9 +22,10 @@
  */
 
 #include <graphics/StylistBase.h>
+#include <graphics/SurfaceCache.h>
 #include <lib/TweenAnimation.h>
 #include <sigc++/bind.h>
-#include <ui/Widget.h>
+#include <ui/Frame.h>
 #include <core/Logger.h>
 
 namespace ilixi
@@ -63,6 +64,7 @@ StylistBase::~StylistBase()
 bool
 StylistBase::setFontPack(const char* fontPack)
 {
+    SurfaceCache::instance().invalidateAll();
     if (_fonts)
         return _fonts->parseFonts(fontPack);
     return false;
@@ -71,6 +73,7 @@ StylistBase::setFontPack(const char* fontPack)
 bool
 StylistBase::setIconPack(const char* iconPack)
 {
+    SurfaceCache::instance().invalidateAll();
     if (_icons)
         return _icons->parseIcons(iconPack);
     return false;
@@ -79,6 +82,7 @@ StylistBase::setIconPack(const char* iconPack)
 bool
 StylistBase::setPaletteFromFile(const char* palette)
 {
+    SurfaceCache::instance().invalidateAll();
     if (_palette)
         return _palette->parsePalette(palette);
     return false;
@@ -87,6 +91,8 @@ StylistBase::setPaletteFromFile(const char* palette)
 bool
 StylistBase::setStyleFromFile(const char* style)
 {
+    SurfaceCache::instance().invalidateAll();
+    _opaqueMap.clear();
     if (_style)
         return _style->parseStyle(style);
     return false;
@@ -239,6 +245,18 @@ StylistBase::customFont(const std::string& name) const
     return _fonts->getCustomFont(name);
 }
 
+void
+StylistBase::prewarmFont(StyleHint::FontHint font)
+{
+    _fonts->prewarm(font);
+}
+
+void
+StylistBase::prewarmCustomFont(const std::string& name)
+{
+    _fonts->prewarmCustomFont(name);
+}
+
 Image*
 StylistBase::defaultIcon(StyleHint::PackedIcon icon) const
 {
@@ -439,10 +457,68 @@ StylistBase::customIcon(const std::string& name) const
     return _icons->getIcon(name);
 }
 
+IconPack*
+StylistBase::iconPack() const
+{
+    return _icons;
+}
+
 Palette*
 StylistBase::palette() const
 {
     return _palette;
 }
 
+Rectangle
+StylistBase::opaqueArea(const Frame* frame)
+{
+    const r9& fr = frame->enabled() ? _style->fr.def : _style->fr.dis;
+    if (!opaquePixels(fr.m))
+        return Rectangle();
+    return Rectangle(fr.l.width(), fr.tm.height(), frame->width() - fr.l.width() - fr.r.width(), frame->height() - fr.tm.height() - fr.bm.height());
+}
+
+bool
+StylistBase::opaquePixels(const Rectangle& source)
+{
+    OpaqueMap::const_iterator it = _opaqueMap.find(&source);
+    if (it != _opaqueMap.end())
+        return it->second;
+
+    bool opaque = false;
+    IDirectFBSurface* surface = _style->_pack ? _style->_pack->getDFBSurface() : NULL;
+    if (surface && source.isValid())
+    {
+        DFBSurfacePixelFormat format;
+        surface->GetPixelFormat(surface, &format);
+        if (!DFB_PIXELFORMAT_HAS_ALPHA(format))
+            opaque = true;
+        else if (format == DSPF_ARGB)
+        {
+            void* data;
+            int pitch;
+            if (surface->Lock(surface, DSLF_READ, &data, &pitch) == DFB_OK)
+            {
+                opaque = true;
+                for (int y = source.y(); y < source.bottom() && opaque; ++y)
+                {
+                    const u32* row = (const u32*) ((const u8*) data + y * pitch);
+                    for (int x = source.x(); x < source.right(); ++x)
+                    {
+                        if ((row[x] >> 24) != 0xFF)
+                        {
+                            opaque = false;
+                            break;
+                        }
+                    }
+                }
+                surface->Unlock(surface);
+            }
+        }
+    }
+    ILOG_DEBUG(ILX_STYLISTBASE, "%s(%d, %d, %d, %d) -> %s\n", __FUNCTION__, source.x(), source.y(), source.width(), source.height(), opaque ? "opaque" : "translucent");
+    _opaqueMap.insert(std::make_pair(&source, opaque));
+    return opaque;
+}
+
 } /* namespace ilixi */
@@ -98,6 +98,18 @@ public:
     Font*
     customFont(const std::string& name) const;
 
+    /*!
+     * Loads font for given type in background, see FontPack::prewarm().
+     */
+    void
+    prewarmFont(StyleHint::FontHint font);
+
+    /*!
+     * Loads custom font in background, see FontPack::prewarmCustomFont().
+     */
+    void
+    prewarmCustomFont(const std::string& name);
+
     /*!
      * Returns the default icon for given type.
      */
@@ -110,9 +122,23 @@ public:
     Image*
     customIcon(const std::string& name) const;
 
+    /*!
+     * Returns icon pack, e.g. for registering application icons using IconPack::addIcon().
+     */
+    IconPack*
+    iconPack() const;
+
     Palette*
     palette() const;
 
+    /*!
+     * Returns the area of frame which is filled with opaque pixels by drawFrame(), in frame coordinates.
+     *
+     * Returns an empty rectangle if frame is translucent.
+     */
+    virtual Rectangle
+    opaqueArea(const Frame* frame);
+
     /*!
      * Draws application frame.
      */
@@ -318,9 +344,21 @@ protected:
     virtual bool
     setStyleFromFile(const char* style);
 
+    /*!
+     * Returns true if given area of style image contains only opaque pixels.
+     *
+     * Results are cached until style is changed.
+     */
+    bool
+    opaquePixels(const Rectangle& source);
+
 private:
     //! "Image not found" image.
     static Image* _noImage;
+
+    typedef std::map<const Rectangle*, bool> OpaqueMap;
+    //! This property caches results of opaquePixels().
+    OpaqueMap _opaqueMap;
 };
 
 } /* namespace ilixi */
@@ -22,6 +22,8 @@
  */
 
 #include <graphics/Surface.h>
+#include <graphics/SurfaceCache.h>
+#include <lib/FrameStats.h>
 #include <ui/Widget.h>
 #include <core/PlatformManager.h>
 #include <core/Logger.h>
@@ -50,7 +52,10 @@ Surface::Surface(Widget* owner)
           _xOffset(0),
           _yOffset(0)
           _rightSurface(NULL),
-          _eye(PaintEvent::LeftEye)
+          _eye(PaintEvent::LeftEye),
+          _cacheSurface(NULL),
+          _cacheSerial(0),
+          _cacheState(0)
 #ifdef ILIXI_HAVE_CAIRO
           ,_cairoSurface(NULL),
           _cairoContext(NULL)
@@ -67,7 +72,10 @@ Surface::Surface(Widget* owner)
           _parentSurface(NULL),
           _flags((SurfaceFlags) DefaultDescription),
           _xOffset(0),
-          _yOffset(0)
+          _yOffset(0),
+          _cacheSurface(NULL),
+          _cacheSerial(0),
+          _cacheState(0)
 #ifdef ILIXI_HAVE_CAIRO
           ,_cairoSurface(NULL),
           _cairoContext(NULL)
@@ -85,6 +93,7 @@ Surface::Surface(Widget* owner)
 Surface::~Surface()
 {
     ILOG_TRACE(ILX_SURFACE);
+    releaseCache();
     release();
     pthread_mutex_destroy(&_surfaceLock);
 }
@@ -335,6 +344,38 @@ Surface::flip(const Rectangle& rect)
         ILOG_DEBUG(ILX_SURFACE, " -> Rect(%d, %d, %d, %d)\n", rect.x(), rect.y(), rect.width(), rect.height());
 }
 
+void
+Surface::flip(const Region& region)
+{
+    ILOG_TRACE(ILX_SURFACE);
+    if (region.isEmpty())
+        return;
+
+    LayerFlipMode mode = PlatformManager::instance().getLayerFlipMode(_owner->_rootWindow->layerName());
+    if (region.count() == 1 || mode == FlipNew)
+    {
+        flip(region.bounds());
+        return;
+    }
+
+    DFBSurfaceFlipFlags syncFlags = DSFLIP_NONE;
+    if (mode == FlipOnSync)
+        syncFlags = DSFLIP_ONSYNC;
+    else if (mode == FlipWaitForSync)
+        syncFlags = DSFLIP_WAITFORSYNC;
+
+    const Region::RectangleList& rects = region.rects();
+    for (unsigned int i = 0; i < rects.size(); ++i)
+    {
+        DFBRegion r = rects[i].dfbRegion();
+        DFBResult ret = _dfbSurface->Flip(_dfbSurface, &r, (i + 1 == rects.size()) ? syncFlags : DSFLIP_NONE);
+        if (ret)
+            ILOG_ERROR(ILX_SURFACE, " -> Flip error: %s - Rect(%d, %d, %d, %d)\n", DirectFBErrorString(ret), rects[i].x(), rects[i].y(), rects[i].width(), rects[i].height());
+        else
+            ILOG_DEBUG(ILX_SURFACE, " -> Rect(%d, %d, %d, %d)\n", rects[i].x(), rects[i].y(), rects[i].width(), rects[i].height());
+    }
+}
+
 void
 Surface::lock()
 {
@@ -482,6 +523,38 @@ Surface::blit(Surface* source, int x, int y)
         blit(source->dfbSurface(), x, y);
 }
 
+void
+Surface::scroll(const Rectangle& rect, int dx, int dy)
+{
+    if (!_dfbSurface)
+        return;
+
+    Rectangle target = rect;
+    target.translate(dx, dy);
+    target = target.intersected(rect);
+    if (!target.isValid())
+        return;
+
+    int x = target.x();
+    int y = target.y();
+    if (_flags & SharedSurface)
+    {
+        x += _xOffset;
+        y += _yOffset;
+    }
+
+    DFBRectangle r = target.dfbRect();
+    r.x = x - dx;
+    r.y = y - dy;
+    _dfbSurface->SetClip(_dfbSurface, NULL);
+    _dfbSurface->SetBlittingFlags(_dfbSurface, DSBLIT_NOFX);
+    DFBResult ret = _dfbSurface->Blit(_dfbSurface, _dfbSurface, &r, x, y);
+    if (ret)
+        ILOG_ERROR(ILX_SURFACE, " -> Scroll error: %s - Rect(%d, %d, %d, %d)\n", DirectFBErrorString(ret), rect.x(), rect.y(), rect.width(), rect.height());
+    else
+        ILOG_DEBUG(ILX_SURFACE, "[%p] %s Rect(%d, %d, %d, %d) by (%d, %d)\n", this, __FUNCTION__, rect.x(), rect.y(), rect.width(), rect.height(), dx, dy);
+}
+
 void
 Surface::setOpacity(u8 opacity)
 {
@@ -662,6 +735,12 @@ Surface::setCairoSurfaceGL(cairo_surface_t* surface)
 #endif
 #endif
 
+void
+Surface::invalidateCache()
+{
+    _cacheSerial = 0;
+}
+
 std::string
 Surface::layerName() const
 {
@@ -695,6 +774,7 @@ Surface::updateSurface(const PaintEvent& event)
     if (_flags & DoZSort)
     {
         _owner->_children.sort(compareZ);
+        _owner->invalidateHitTestGrid();
         unsetSurfaceFlag(Surface::DoZSort);
     }
 
@@ -843,4 +923,145 @@ Surface::release()
     unlock();
 }
 
+bool
+Surface::cacheValid(int width, int height, int state) const
+{
+    if (!_cacheSurface || !_cacheSerial || _cacheSerial != SurfaceCache::instance().serial() || _cacheState != state)
+        return false;
+
+    int w, h;
+    _cacheSurface->GetSize(_cacheSurface, &w, &h);
+    return w == width && h == height;
+}
+
+bool
+Surface::renderCache(int state)
+{
+#ifdef ILIXI_STEREO_OUTPUT
+    return false;
+#else
+    ILOG_TRACE(ILX_SURFACE);
+    int width = _owner->width();
+    int height = _owner->height();
+    if (width <= 0 || height <= 0 || !_dfbSurface)
+        return false;
+
+    if (_cacheSurface)
+    {
+        int w, h;
+        _cacheSurface->GetSize(_cacheSurface, &w, &h);
+        if (w != width || h != height)
+            releaseCache();
+    }
+
+    if (!_cacheSurface)
+    {
+        DFBSurfaceDescription desc;
+        desc.flags = (DFBSurfaceDescriptionFlags) (DSDESC_WIDTH | DSDESC_HEIGHT | DSDESC_PIXELFORMAT | DSDESC_CAPS);
+        desc.width = width;
+        desc.height = height;
+        desc.pixelformat = PlatformManager::instance().forcedPixelFormat();
+        desc.caps = (DFBSurfaceCapabilities) (PlatformManager::instance().getWindowSurfaceCaps() & DSCAPS_PREMULTIPLIED);
+        DFBResult ret = PlatformManager::instance().getDFB()->CreateSurface(PlatformManager::instance().getDFB(), &desc, &_cacheSurface);
+        if (ret)
+        {
+            ILOG_ERROR(ILX_SURFACE, "Cannot create cache surface: %s\n", DirectFBErrorString(ret));
+            _cacheSurface = NULL;
+            return false;
+        }
+
+        DFBSurfacePixelFormat format;
+        _cacheSurface->GetPixelFormat(_cacheSurface, &format);
+        SurfaceCache::instance().insert(this, width * height * DFB_BYTES_PER_PIXEL(format));
+        ILOG_DEBUG(ILX_SURFACE, "  -> Created cache surface %p (width %d, height %d)\n", _cacheSurface, width, height);
+    }
+
+    // redirect owner's painter to cache, it draws in local coordinates if surface is not shared.
+    IDirectFBSurface* surface = _dfbSurface;
+    SurfaceFlags flags = _flags;
+#ifdef ILIXI_HAVE_CAIRO
+    cairo_surface_t* cairoSurface = _cairoSurface;
+    cairo_t* cairoContext = _cairoContext;
+    _cairoSurface = NULL;
+    _cairoContext = NULL;
+#endif
+    _dfbSurface = _cacheSurface;
+    _flags = (SurfaceFlags) (_flags & ~SharedSurface);
+
+    _cacheSurface->SetClip(_cacheSurface, NULL);
+    _cacheSurface->Clear(_cacheSurface, 0, 0, 0, 0);
+    _owner->compose(PaintEvent(_owner->frameGeometry()));
+
+#ifdef ILIXI_HAVE_CAIRO
+    if (_cairoContext)
+        cairo_destroy(_cairoContext);
+    if (_cairoSurface)
+        cairo_surface_destroy(_cairoSurface);
+    _cairoSurface = cairoSurface;
+    _cairoContext = cairoContext;
+#endif
+    _dfbSurface = surface;
+    _flags = flags;
+
+    _cacheSerial = SurfaceCache::instance().serial();
+    _cacheState = state;
+    ILOG_DEBUG(ILX_SURFACE, "[%p] %s serial %u\n", this, __FUNCTION__, _cacheSerial);
+    return true;
+#endif
+}
+
+void
+Surface::blitCache(const Rectangle& crop)
+{
+    if (!_cacheSurface || !_dfbSurface)
+        return;
+
+    Rectangle r = crop.intersected(Rectangle(0, 0, _owner->width(), _owner->height()));
+    if (!r.isValid())
+        return;
+
+    SurfaceCache::instance().touch(this);
+
+    int x = r.x();
+    int y = r.y();
+    if (_flags & SharedSurface)
+    {
+        x += _xOffset;
+        y += _yOffset;
+    }
+
+    // an own surface is not cleared before painting, so cached pixels replace old ones.
+    _dfbSurface->SetBlittingFlags(_dfbSurface, (_flags & HasOwnSurface) ? DSBLIT_NOFX : DSBLIT_BLEND_ALPHACHANNEL);
+    DFBRectangle rect = r.dfbRect();
+    FrameStats::instance().begin(FrameStats::Blit);
+    DFBResult ret = _dfbSurface->Blit(_dfbSurface, _cacheSurface, &rect, x, y);
+    FrameStats::instance().end(FrameStats::Blit);
+    if (ret)
+        ILOG_ERROR(ILX_SURFACE, " -> Cache blit error: %s - Rect(%d, %d, %d, %d)\n", DirectFBErrorString(ret), r.x(), r.y(), r.width(), r.height());
+    else
+        ILOG_DEBUG(ILX_SURFACE, "[%p] %s Rect(%d, %d, %d, %d) P(%d, %d)\n", this, __FUNCTION__, r.x(), r.y(), r.width(), r.height(), x, y);
+}
+
+void
+Surface::releaseCache()
+{
+    if (_cacheSurface)
+    {
+        SurfaceCache::instance().remove(this);
+        releaseCacheSurface();
+    }
+}
+
+void
+Surface::releaseCacheSurface()
+{
+    ILOG_TRACE(ILX_SURFACE);
+    if (_cacheSurface)
+    {
+        _cacheSurface->Release(_cacheSurface);
+        _cacheSurface = NULL;
+    }
+    _cacheSerial = 0;
+}
+
 } /* namespace ilixi */
@@ -25,6 +25,7 @@
 #define ILIXI_SURFACE_H_
 
 #include <types/Event.h>
+#include <types/Region.h>
 #include <ilixiConfig.h>
 
 #ifdef ILIXI_HAVE_CAIRO
@@ -39,6 +40,7 @@ class Surface
 {
     friend class Widget;    // so it can release if necessary.
     friend class Painter;   // access to dfbSurface
+    friend class SurfaceCache; // releases cached surface.
 
 public:
     /*!
@@ -57,6 +59,7 @@ public:
         SharedSurface = 0x0080,                                 //!< Widget uses window surface directly.
         ForceSingleSurface = 0x1000,                            //!< Affects offscreen surfaces only. Overrides default platform option.
         DisableAutoFlip = 0x2000,                               //!< Disables flipping in Widget.
+        CachedCompose = 0x4000,                                 //!< Widget's compose() output is kept in a private surface and blitted.
         DefaultDescription = (InitialiseSurface | ModifiedGeometry | SharedSurface),    //!< Default flags for widgets.
         BlitDescription = (InitialiseSurface | ModifiedGeometry | HasOwnSurface),       //!< Use if widget surface should be blitted onto another widget/surface, e.g. a widget inside a ScrollArea.
         WindowDescription = (InitialiseSurface | ModifiedGeometry | RootSurface)        //!< Use if widget is a WindowWidget, e.g. Application or Dialog.
@@ -144,6 +147,14 @@ public:
     void
     flip(const Rectangle& rect);
 
+    /*!
+     * Flips each rectangle of given region, only the last flip waits for sync.
+     *
+     * @param region area to flip in surface coordinates.
+     */
+    void
+    flip(const Region& region);
+
     /*!
      * Lock surface mutex. This is mainly used by Painter to serialise updates.
      */
@@ -226,6 +237,19 @@ public:
     void
     blit(Surface* source, int x = 0, int y = 0);
 
+    /*!
+     * Moves pixels inside a rectangle of this surface.
+     *
+     * Pixels moved outside rectangle are discarded and uncovered area is left as is.
+     * Clip is reset.
+     *
+     * @param rect area in surface coordinates.
+     * @param dx horizontal offset.
+     * @param dy vertical offset.
+     */
+    void
+    scroll(const Rectangle& rect, int dx, int dy);
+
     /*!
      * Sets surface opacity using drawing and blitting flags.
      */
@@ -294,6 +318,12 @@ public:
 
 #endif // ILIXI_HAVE_CAIRO
 
+    /*!
+     * Marks cached compose() output as outdated so it is rendered again on next paint.
+     */
+    void
+    invalidateCache();
+
     /*!
      * Returns logical layer name where surface resides.
      */
@@ -366,6 +396,13 @@ private:
     //! This mutex is used for serialising writes to surface by Painter.
     pthread_mutex_t _surfaceLock;
 
+    //! Surface which holds owner's compose() output if CachedCompose is set.
+    IDirectFBSurface* _cacheSurface;
+    //! SurfaceCache serial used while rendering cache, 0 if cache is outdated.
+    unsigned int _cacheSerial;
+    //! Widget state used while rendering cache.
+    int _cacheState;
+
 #ifdef ILIXI_HAVE_CAIRO
     //! Interface to cairo surface.
     cairo_surface_t* _cairoSurface;
@@ -383,6 +420,41 @@ private:
      */
     void
     release();
+
+    /*!
+     * Returns true if cached surface has given size and it is rendered using current
+     * style and given widget state.
+     */
+    bool
+    cacheValid(int width, int height, int state) const;
+
+    /*!
+     * Renders owner's compose() output into cached surface, which is (re)created if necessary.
+     *
+     * @return false if cached surface could not be created.
+     */
+    bool
+    renderCache(int state);
+
+    /*!
+     * Blits cached surface onto DFB surface.
+     *
+     * @param crop area in owner's coordinates.
+     */
+    void
+    blitCache(const Rectangle& crop);
+
+    /*!
+     * Releases cached surface and removes it from SurfaceCache.
+     */
+    void
+    releaseCache();
+
+    /*!
+     * Releases cached surface only, used by SurfaceCache for eviction.
+     */
+    void
+    releaseCacheSurface();
 };
 }
 #endif /* ILIXI_SURFACE_H_ */
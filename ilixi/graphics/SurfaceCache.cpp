@@ -0,0 +1,156 @@
+/*
+ Copyright 2010-2015 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <graphics/SurfaceCache.h>
+#include <graphics/Surface.h>
+#include <core/Logger.h>
+#include <stdlib.h>
+
+namespace ilixi
+{
+
+D_DEBUG_DOMAIN(ILX_SURFACECACHE, "ilixi/graphics/SurfaceCache", "SurfaceCache");
+
+SurfaceCache&
+SurfaceCache::instance()
+{
+    static SurfaceCache instance;
+    return instance;
+}
+
+SurfaceCache::SurfaceCache()
+        : _budget(8 * 1024 * 1024),
+          _usage(0),
+          _serial(1)
+{
+    pthread_mutex_init(&_lock, NULL);
+    char* var = getenv("ILX_SURFACECACHE");
+    if (var)
+        _budget = atoi(var) * 1024;
+    ILOG_DEBUG(ILX_SURFACECACHE, "Budget: %u bytes\n", _budget);
+}
+
+SurfaceCache::~SurfaceCache()
+{
+    pthread_mutex_destroy(&_lock);
+}
+
+unsigned int
+SurfaceCache::budget() const
+{
+    return _budget;
+}
+
+unsigned int
+SurfaceCache::usage() const
+{
+    return _usage;
+}
+
+unsigned int
+SurfaceCache::serial() const
+{
+    return _serial;
+}
+
+void
+SurfaceCache::setBudget(unsigned int bytes)
+{
+    pthread_mutex_lock(&_lock);
+    _budget = bytes;
+    evict(NULL);
+    pthread_mutex_unlock(&_lock);
+}
+
+void
+SurfaceCache::invalidateAll()
+{
+    pthread_mutex_lock(&_lock);
+    // zero is reserved for invalid caches.
+    if (++_serial == 0)
+        _serial = 1;
+    pthread_mutex_unlock(&_lock);
+}
+
+void
+SurfaceCache::insert(Surface* surface, unsigned int bytes)
+{
+    pthread_mutex_lock(&_lock);
+    SurfaceMap::iterator it = _map.find(surface);
+    if (it != _map.end())
+    {
+        _usage -= it->second.second;
+        _lru.erase(it->second.first);
+        _map.erase(it);
+    }
+    _lru.push_front(surface);
+    _map.insert(std::make_pair(surface, std::make_pair(_lru.begin(), bytes)));
+    _usage += bytes;
+    ILOG_DEBUG(ILX_SURFACECACHE, "[%p] %s(%u) usage: %u\n", surface, __FUNCTION__, bytes, _usage);
+    evict(surface);
+    pthread_mutex_unlock(&_lock);
+}
+
+void
+SurfaceCache::touch(Surface* surface)
+{
+    pthread_mutex_lock(&_lock);
+    SurfaceMap::iterator it = _map.find(surface);
+    if (it != _map.end() && it->second.first != _lru.begin())
+        _lru.splice(_lru.begin(), _lru, it->second.first);
+    pthread_mutex_unlock(&_lock);
+}
+
+void
+SurfaceCache::remove(Surface* surface)
+{
+    pthread_mutex_lock(&_lock);
+    SurfaceMap::iterator it = _map.find(surface);
+    if (it != _map.end())
+    {
+        _usage -= it->second.second;
+        _lru.erase(it->second.first);
+        _map.erase(it);
+    }
+    pthread_mutex_unlock(&_lock);
+}
+
+void
+SurfaceCache::evict(Surface* keep)
+{
+    while (_usage > _budget && !_lru.empty())
+    {
+        Surface* victim = _lru.back();
+        if (victim == keep)
+            break;
+
+        SurfaceMap::iterator it = _map.find(victim);
+        _usage -= it->second.second;
+        _map.erase(it);
+        _lru.pop_back();
+        ILOG_DEBUG(ILX_SURFACECACHE, "[%p] evicted, usage: %u\n", victim, _usage);
+        victim->releaseCacheSurface();
+    }
+}
+
+} /* namespace ilixi */
@@ -0,0 +1,125 @@
+/*
+ Copyright 2010-2015 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ILIXI_SURFACECACHE_H_
+#define ILIXI_SURFACECACHE_H_
+
+#include <pthread.h>
+#include <list>
+#include <map>
+
+namespace ilixi
+{
+class Surface;
+
+//! Keeps track of memory used by cached widget surfaces.
+/*!
+ * Widgets which are set as cached (see Widget::setCached()) render their compose()
+ * output once into a private surface. SurfaceCache accounts memory used by these
+ * surfaces and releases least recently used ones once total size exceeds budget().
+ *
+ * Budget can be set using ILX_SURFACECACHE environment variable in kilobytes.
+ */
+class SurfaceCache
+{
+    friend class Surface;
+
+public:
+    /*!
+     * Returns the instance.
+     */
+    static SurfaceCache&
+    instance();
+
+    /*!
+     * Returns memory budget in bytes.
+     */
+    unsigned int
+    budget() const;
+
+    /*!
+     * Returns memory used by cached surfaces in bytes.
+     */
+    unsigned int
+    usage() const;
+
+    /*!
+     * Returns current cache serial.
+     *
+     * A cached surface rendered with an older serial is outdated.
+     */
+    unsigned int
+    serial() const;
+
+    /*!
+     * Sets memory budget in bytes and releases surfaces if necessary.
+     */
+    void
+    setBudget(unsigned int bytes);
+
+    /*!
+     * Marks all cached surfaces outdated, e.g. after style or palette changes.
+     */
+    void
+    invalidateAll();
+
+private:
+    typedef std::list<Surface*> SurfaceList;
+    typedef std::map<Surface*, std::pair<SurfaceList::iterator, unsigned int> > SurfaceMap;
+
+    //! Most recently used surface is at front.
+    SurfaceList _lru;
+    //! Maps surfaces to their position in _lru and size in bytes.
+    SurfaceMap _map;
+    //! This property stores memory budget in bytes.
+    unsigned int _budget;
+    //! This property stores memory used in bytes.
+    unsigned int _usage;
+    //! This property is incremented each time cache is invalidated.
+    unsigned int _serial;
+    //! This mutex serialises access to lists.
+    pthread_mutex_t _lock;
+
+    SurfaceCache();
+
+    ~SurfaceCache();
+
+    //! Adds or resizes an entry and releases least recently used surfaces if over budget.
+    void
+    insert(Surface* surface, unsigned int bytes);
+
+    //! Moves surface to front of LRU list.
+    void
+    touch(Surface* surface);
+
+    //! Removes surface from cache without releasing it.
+    void
+    remove(Surface* surface);
+
+    //! Releases least recently used surfaces except given one until usage is within budget.
+    void
+    evict(Surface* keep);
+};
+
+} /* namespace ilixi */
+#endif /* ILIXI_SURFACECACHE_H_ */
@@ -0,0 +1,261 @@
+/*
+ Copyright 2010-2015 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <graphics/TextureAtlas.h>
+#include <core/PlatformManager.h>
+#include <core/Logger.h>
+#include <limits.h>
+
+namespace ilixi
+{
+
+D_DEBUG_DOMAIN(ILX_TEXTUREATLAS, "ilixi/graphics/TextureAtlas", "TextureAtlas");
+
+// transparent gap between images so that scaled blits do not bleed.
+static const int ILX_ATLAS_PADDING = 1;
+
+TextureAtlas::TextureAtlas(int pageWidth, int pageHeight)
+        : _pageWidth(pageWidth),
+          _pageHeight(pageHeight)
+{
+    ILOG_TRACE(ILX_TEXTUREATLAS);
+}
+
+TextureAtlas::~TextureAtlas()
+{
+    ILOG_TRACE(ILX_TEXTUREATLAS);
+    clear();
+}
+
+bool
+TextureAtlas::addImage(const std::string& name, const std::string& path, const Size& size)
+{
+    Image image(path, size);
+    return addImage(name, &image);
+}
+
+bool
+TextureAtlas::addImage(const std::string& name, Image* image)
+{
+    ILOG_TRACE(ILX_TEXTUREATLAS);
+    if (!image || contains(name))
+    {
+        ILOG_WARNING(ILX_TEXTUREATLAS, "Image %s already exists!\n", name.c_str());
+        return false;
+    }
+
+    // getDFBSurface() falls back to noImage if image cannot be loaded.
+    IDirectFBSurface* source = image->getDFBSurface();
+    if (!image->ready())
+    {
+        ILOG_ERROR(ILX_TEXTUREATLAS, "Cannot load image %s\n", name.c_str());
+        return false;
+    }
+
+    int w, h;
+    source->GetSize(source, &w, &h);
+
+    Entry entry;
+    Point position;
+    if (!allocate(w, h, &entry.page, &position))
+        return false;
+    entry.rect = Rectangle(position.x(), position.y(), w, h);
+
+    IDirectFBSurface* dest = _pages[entry.page].image->getDFBSurface();
+    dest->SetBlittingFlags(dest, DSBLIT_NOFX);
+    dest->Blit(dest, source, NULL, position.x(), position.y());
+
+    _entries.insert(std::make_pair(name, entry));
+    ILOG_DEBUG(ILX_TEXTUREATLAS, " -> %s @ page: %u (%d, %d, %d, %d)\n", name.c_str(), entry.page, position.x(), position.y(), w, h);
+    return true;
+}
+
+bool
+TextureAtlas::contains(const std::string& name) const
+{
+    return _entries.find(name) != _entries.end();
+}
+
+Image*
+TextureAtlas::getImage(const std::string& name) const
+{
+    EntryMap::const_iterator it = _entries.find(name);
+    if (it == _entries.end())
+        return NULL;
+    return new Image(_pages[it->second.page].image, it->second.rect);
+}
+
+unsigned int
+TextureAtlas::pageCount() const
+{
+    return _pages.size();
+}
+
+void
+TextureAtlas::clear()
+{
+    _entries.clear();
+    for (PageList::iterator it = _pages.begin(); it != _pages.end(); ++it)
+        delete it->image;
+    _pages.clear();
+}
+
+bool
+TextureAtlas::allocate(int width, int height, unsigned int* page, Point* position)
+{
+    int w = width + ILX_ATLAS_PADDING;
+    int h = height + ILX_ATLAS_PADDING;
+
+    if (w > _pageWidth || h > _pageHeight)
+    {
+        ILOG_DEBUG(ILX_TEXTUREATLAS, " -> Image (%d, %d) does not fit a page.\n", width, height);
+        if (!createPage(width, height))
+            return false;
+        _pages.back().skyline.clear();
+        *page = _pages.size() - 1;
+        *position = Point(0, 0);
+        return true;
+    }
+
+    for (unsigned int i = 0; i < _pages.size(); ++i)
+    {
+        int index = findPosition(_pages[i].skyline, w, h, _pageWidth, _pageHeight, position);
+        if (index >= 0)
+        {
+            insert(_pages[i].skyline, index, *position, w, h);
+            *page = i;
+            return true;
+        }
+    }
+
+    if (!createPage(_pageWidth, _pageHeight))
+        return false;
+
+    int index = findPosition(_pages.back().skyline, w, h, _pageWidth, _pageHeight, position);
+    insert(_pages.back().skyline, index, *position, w, h);
+    *page = _pages.size() - 1;
+    return true;
+}
+
+bool
+TextureAtlas::createPage(int width, int height)
+{
+    ILOG_TRACE(ILX_TEXTUREATLAS);
+    DFBSurfaceDescription desc;
+    desc.flags = (DFBSurfaceDescriptionFlags) (DSDESC_CAPS | DSDESC_WIDTH | DSDESC_HEIGHT | DSDESC_PIXELFORMAT);
+    desc.caps = DSCAPS_PREMULTIPLIED;
+    desc.width = width;
+    desc.height = height;
+    if (PlatformManager::instance().forcedPixelFormat() != DSPF_UNKNOWN)
+        desc.pixelformat = PlatformManager::instance().forcedPixelFormat();
+    else
+        desc.pixelformat = DSPF_ARGB;
+
+    IDirectFBSurface* surface;
+    DFBResult ret = PlatformManager::instance().getDFB()->CreateSurface(PlatformManager::instance().getDFB(), &desc, &surface);
+    if (ret != DFB_OK)
+    {
+        ILOG_ERROR(ILX_TEXTUREATLAS, "Cannot create atlas page - %s\n", DirectFBErrorString(ret));
+        return false;
+    }
+    surface->Clear(surface, 0, 0, 0, 0);
+
+    Page page;
+    page.image = new Image(surface);
+    page.skyline.push_back(Segment(0, 0, width));
+    _pages.push_back(page);
+    ILOG_DEBUG(ILX_TEXTUREATLAS, " -> Page %d (%d, %d)\n", (int) _pages.size() - 1, width, height);
+    return true;
+}
+
+int
+TextureAtlas::findPosition(const Skyline& skyline, int width, int height, int pageWidth, int pageHeight, Point* position)
+{
+    int bestIndex = -1;
+    int bestY = INT_MAX;
+    int bestWidth = INT_MAX;
+
+    for (unsigned int i = 0; i < skyline.size(); ++i)
+    {
+        int x = skyline[i].x;
+        if (x + width > pageWidth)
+            break;
+
+        // rectangle rests on the highest segment below it.
+        int y = 0;
+        int remaining = width;
+        for (unsigned int j = i; remaining > 0 && j < skyline.size(); ++j)
+        {
+            if (skyline[j].y > y)
+                y = skyline[j].y;
+            remaining -= skyline[j].width;
+        }
+
+        if (y + height > pageHeight)
+            continue;
+
+        if (y < bestY || (y == bestY && skyline[i].width < bestWidth))
+        {
+            bestIndex = i;
+            bestY = y;
+            bestWidth = skyline[i].width;
+            *position = Point(x, y);
+        }
+    }
+    return bestIndex;
+}
+
+void
+TextureAtlas::insert(Skyline& skyline, int index, const Point& position, int width, int height)
+{
+    skyline.insert(skyline.begin() + index, Segment(position.x(), position.y() + height, width));
+
+    // shrink or remove segments covered by new one.
+    for (unsigned int i = index + 1; i < skyline.size();)
+    {
+        int right = skyline[i - 1].x + skyline[i - 1].width;
+        if (skyline[i].x >= right)
+            break;
+
+        int shrink = right - skyline[i].x;
+        skyline[i].x += shrink;
+        skyline[i].width -= shrink;
+        if (skyline[i].width > 0)
+            break;
+        skyline.erase(skyline.begin() + i);
+    }
+
+    // merge neighbours at same height.
+    for (unsigned int i = 0; i + 1 < skyline.size();)
+    {
+        if (skyline[i].y == skyline[i + 1].y)
+        {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        } else
+            ++i;
+    }
+}
+
+} /* namespace ilixi */
@@ -0,0 +1,164 @@
+/*
+ Copyright 2010-2015 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef ILIXI_TEXTUREATLAS_H_
+#define ILIXI_TEXTUREATLAS_H_
+
+#include <types/Image.h>
+#include <map>
+#include <vector>
+
+namespace ilixi
+{
+//! Packs images into a few large surfaces.
+/*!
+ * Images added at runtime are copied into atlas pages using a skyline packer. Sub-images
+ * of an atlas share their page surface instead of allocating a surface per image. Each
+ * sub-image is still drawn using its own blit, blits are not batched across widgets.
+ *
+ * An image larger than a page is stored in its own page.
+ */
+class TextureAtlas
+{
+public:
+    /*!
+     * Constructor.
+     *
+     * @param pageWidth width of an atlas page.
+     * @param pageHeight height of an atlas page.
+     */
+    TextureAtlas(int pageWidth = 1024, int pageHeight = 1024);
+
+    /*!
+     * Destructor.
+     */
+    virtual
+    ~TextureAtlas();
+
+    /*!
+     * Decodes image at path and packs it using name.
+     *
+     * @param name unique name of image.
+     * @param path image file.
+     * @param size if valid, image is scaled to this size.
+     *
+     * Returns false if image cannot be loaded or name is already used.
+     */
+    bool
+    addImage(const std::string& name, const std::string& path, const Size& size = Size());
+
+    /*!
+     * Copies given image into atlas using name.
+     *
+     * Returns false if image cannot be loaded or name is already used.
+     */
+    bool
+    addImage(const std::string& name, Image* image);
+
+    /*!
+     * Returns true if an image with given name is packed.
+     */
+    bool
+    contains(const std::string& name) const;
+
+    /*!
+     * If name is found returns a new sub-image of its page, else returns NULL.
+     */
+    Image*
+    getImage(const std::string& name) const;
+
+    /*!
+     * Returns number of pages.
+     */
+    unsigned int
+    pageCount() const;
+
+    /*!
+     * Removes all images and releases pages.
+     */
+    void
+    clear();
+
+private:
+    //! A horizontal segment of skyline.
+    struct Segment
+    {
+        Segment(int sx, int sy, int w)
+                : x(sx),
+                  y(sy),
+                  width(w)
+        {
+        }
+
+        int x;
+        int y;
+        int width;
+    };
+
+    typedef std::vector<Segment> Skyline;
+
+    struct Page
+    {
+        Image* image;
+        Skyline skyline;
+    };
+
+    typedef std::vector<Page> PageList;
+
+    struct Entry
+    {
+        unsigned int page;
+        Rectangle rect;
+    };
+
+    typedef std::map<std::string, Entry> EntryMap;
+
+    //! This property stores width of a page.
+    int _pageWidth;
+    //! This property stores height of a page.
+    int _pageHeight;
+    //! Atlas pages.
+    PageList _pages;
+    //! Maps names to their page and position.
+    EntryMap _entries;
+
+    //! Finds space for a rectangle of given size and reserves it, creating a new page if necessary.
+    bool
+    allocate(int width, int height, unsigned int* page, Point* position);
+
+    //! Creates a new page with given size.
+    bool
+    createPage(int width, int height);
+
+    //! Returns the skyline index with lowest position where rectangle fits, or -1.
+    static int
+    findPosition(const Skyline& skyline, int width, int height, int pageWidth, int pageHeight, Point* position);
+
+    //! Raises skyline after a rectangle is placed at index.
+    static void
+    insert(Skyline& skyline, int index, const Point& position, int width, int height);
+};
+
+} /* namespace ilixi */
+#endif /* ILIXI_TEXTUREATLAS_H_ */
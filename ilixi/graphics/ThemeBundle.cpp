@@ -0,0 +1,345 @@
+/*
+ Copyright 2010-2015 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <graphics/ThemeBundle.h>
+#include <core/PlatformManager.h>
+#include <core/Logger.h>
+#include <lib/FileSystem.h>
+#include <lib/Util.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ilixi
+{
+
+D_DEBUG_DOMAIN(ILX_THEMEBUNDLE, "ilixi/graphics/ThemeBundle", "ThemeBundle");
+
+static const char __bundleMagic[4] = { 'I', 'L', 'X', 'T' };
+
+//*********************************************************************
+
+ThemeBundle::Writer::Writer()
+{
+}
+
+unsigned int
+ThemeBundle::Writer::appendString(const std::string& str)
+{
+    unsigned int offset = reserve(str.length() + 1);
+    memcpy(&_data[offset], str.c_str(), str.length() + 1);
+    return offset;
+}
+
+const void*
+ThemeBundle::Writer::data() const
+{
+    return &_data[0];
+}
+
+unsigned int
+ThemeBundle::Writer::size() const
+{
+    return _data.size();
+}
+
+unsigned int
+ThemeBundle::Writer::reserve(unsigned int bytes)
+{
+    unsigned int offset = (_data.size() + 3) & ~3;
+    _data.resize(offset + bytes, 0);
+    return offset;
+}
+
+//*********************************************************************
+
+ThemeBundle&
+ThemeBundle::instance()
+{
+    static ThemeBundle instance;
+    return instance;
+}
+
+ThemeBundle::ThemeBundle()
+        : _map(NULL),
+          _mapSize(0),
+          _opened(false)
+{
+}
+
+ThemeBundle::~ThemeBundle()
+{
+    close();
+}
+
+const void*
+ThemeBundle::find(SectionType type, const std::string& source, unsigned int* bytes)
+{
+    ILOG_TRACE(ILX_THEMEBUNDLE);
+    if (!_opened)
+        open();
+    if (!_map)
+        return NULL;
+
+    const Header* header = (const Header*) _map;
+    const Section* table = sections();
+    uint32_t key = createHash(source);
+    for (uint32_t i = 0; i < header->count; ++i)
+    {
+        const Section& section = table[i];
+        if (section.type != (uint32_t) type || section.key != key)
+            continue;
+
+        const char* name = (const char*) _map + section.source;
+        if (source != name)
+            continue;
+
+        if (section.mtime != (int64_t) FileSystem::getModificationTime(source))
+        {
+            ILOG_DEBUG(ILX_THEMEBUNDLE, " -> %s is modified.\n", source.c_str());
+            return NULL;
+        }
+
+        ILOG_DEBUG(ILX_THEMEBUNDLE, " -> Found section %u for %s (%u bytes)\n", type, source.c_str(), section.bytes);
+        if (bytes)
+            *bytes = section.bytes;
+        return (const char*) _map + section.offset;
+    }
+    return NULL;
+}
+
+bool
+ThemeBundle::store(SectionType type, const std::string& source, const Writer& data)
+{
+    ILOG_TRACE(ILX_THEMEBUNDLE);
+    // processes starting with same theme serialise updates, so none of their sections are lost.
+    std::string lockPath = path() + ".lock";
+    int lock = ::open(lockPath.c_str(), O_RDWR | O_CREAT, 0644);
+    if (lock == -1 || flock(lock, LOCK_EX) != 0)
+    {
+        ILOG_WARNING(ILX_THEMEBUNDLE, "Cannot lock %s (%s)!\n", lockPath.c_str(), strerror(errno));
+        if (lock != -1)
+            ::close(lock);
+        return false;
+    }
+
+    // merge with bundle on disk, which may be updated by another process since it was mapped.
+    if (_map)
+        _oldMaps.push_back(std::make_pair(_map, _mapSize));
+    _map = NULL;
+    _mapSize = 0;
+    open();
+
+    bool stored = write(type, source, data);
+    flock(lock, LOCK_UN);
+    ::close(lock);
+    return stored;
+}
+
+const char*
+ThemeBundle::string(const void* data, unsigned int bytes, uint32_t offset)
+{
+    if (!offset || offset >= bytes)
+        return NULL;
+    const char* str = (const char*) data + offset;
+    if (!memchr(str, 0, bytes - offset))
+        return NULL;
+    return str;
+}
+
+void
+ThemeBundle::close()
+{
+    ILOG_TRACE(ILX_THEMEBUNDLE);
+    if (_map)
+        munmap(_map, _mapSize);
+    for (unsigned int i = 0; i < _oldMaps.size(); ++i)
+        munmap(_oldMaps[i].first, _oldMaps[i].second);
+    _oldMaps.clear();
+    _map = NULL;
+    _mapSize = 0;
+    _opened = false;
+}
+
+const std::string&
+ThemeBundle::path()
+{
+    if (_path.empty())
+    {
+        char* var = getenv("ILX_THEMEBUNDLE");
+        if (var)
+            _path = var;
+        else
+            _path = PrintF("%s%u.ilxtheme", FileSystem::ilxDirectory().c_str(), createHash(PlatformManager::instance().getThemeDirectory()));
+        ILOG_DEBUG(ILX_THEMEBUNDLE, " -> path: %s\n", _path.c_str());
+    }
+    return _path;
+}
+
+bool
+ThemeBundle::write(SectionType type, const std::string& source, const Writer& data)
+{
+    // keep sections of other sources.
+    std::vector<Section> table;
+    std::vector<std::string> sources;
+    std::vector<const void*> blocks;
+    uint32_t key = createHash(source);
+    if (_map)
+    {
+        const Header* header = (const Header*) _map;
+        const Section* old = sections();
+        for (uint32_t i = 0; i < header->count; ++i)
+        {
+            const char* name = (const char*) _map + old[i].source;
+            if (old[i].type == (uint32_t) type && old[i].key == key && source == name)
+                continue;
+            table.push_back(old[i]);
+            sources.push_back(name);
+            blocks.push_back((const char*) _map + old[i].offset);
+        }
+    }
+
+    Section section;
+    memset(&section, 0, sizeof(Section));
+    section.type = type;
+    section.key = key;
+    section.mtime = FileSystem::getModificationTime(source);
+    section.bytes = data.size();
+    table.push_back(section);
+    sources.push_back(source);
+    blocks.push_back(data.data());
+
+    // header, section table, source paths and 8 byte aligned section data.
+    uint32_t offset = sizeof(Header) + table.size() * sizeof(Section);
+    for (unsigned int i = 0; i < table.size(); ++i)
+    {
+        table[i].source = offset;
+        offset += sources[i].length() + 1;
+    }
+    for (unsigned int i = 0; i < table.size(); ++i)
+    {
+        offset = (offset + 7) & ~7;
+        table[i].offset = offset;
+        offset += table[i].bytes;
+    }
+
+    std::vector<char> buffer(offset, 0);
+    Header* header = (Header*) &buffer[0];
+    memcpy(header->magic, __bundleMagic, 4);
+    header->version = Version;
+    header->count = table.size();
+    header->size = offset;
+    memcpy(&buffer[sizeof(Header)], &table[0], table.size() * sizeof(Section));
+    for (unsigned int i = 0; i < table.size(); ++i)
+    {
+        memcpy(&buffer[table[i].source], sources[i].c_str(), sources[i].length() + 1);
+        memcpy(&buffer[table[i].offset], blocks[i], table[i].bytes);
+    }
+
+    // write a temporary file and rename, so other processes never map a partial bundle.
+    std::string tmp = PrintF("%s.%d", path().c_str(), getpid());
+    FILE* file = fopen(tmp.c_str(), "wb");
+    if (!file)
+    {
+        ILOG_WARNING(ILX_THEMEBUNDLE, "Cannot write %s (%s)!\n", tmp.c_str(), strerror(errno));
+        return false;
+    }
+    bool written = fwrite(&buffer[0], 1, buffer.size(), file) == buffer.size();
+    if (fclose(file) != 0 || !written || rename(tmp.c_str(), path().c_str()) != 0)
+    {
+        ILOG_WARNING(ILX_THEMEBUNDLE, "Cannot write %s (%s)!\n", path().c_str(), strerror(errno));
+        unlink(tmp.c_str());
+        return false;
+    }
+    ILOG_INFO(ILX_THEMEBUNDLE, "Stored %s in theme bundle %s\n", source.c_str(), path().c_str());
+
+    if (_map)
+        _oldMaps.push_back(std::make_pair(_map, _mapSize));
+    _map = NULL;
+    _mapSize = 0;
+    open();
+    return true;
+}
+
+void
+ThemeBundle::open()
+{
+    ILOG_TRACE(ILX_THEMEBUNDLE);
+    _opened = true;
+
+    int fd = ::open(path().c_str(), O_RDONLY);
+    if (fd == -1)
+    {
+        ILOG_DEBUG(ILX_THEMEBUNDLE, " -> %s does not exist.\n", path().c_str());
+        return;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t) sizeof(Header))
+    {
+        ::close(fd);
+        return;
+    }
+
+    void* map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED)
+    {
+        ILOG_ERROR(ILX_THEMEBUNDLE, "Cannot map %s (%s)!\n", path().c_str(), strerror(errno));
+        return;
+    }
+
+    const Header* header = (const Header*) map;
+    bool valid = memcmp(header->magic, __bundleMagic, 4) == 0 && header->version == Version && header->size == (uint32_t) st.st_size && sizeof(Header) + (uint64_t) header->count * sizeof(Section) <= header->size;
+    if (valid)
+    {
+        const Section* table = (const Section*) ((const char*) map + sizeof(Header));
+        for (uint32_t i = 0; i < header->count && valid; ++i)
+            valid = table[i].source < header->size && (uint64_t) table[i].offset + table[i].bytes <= header->size && memchr((const char*) map + table[i].source, 0, header->size - table[i].source);
+    }
+
+    if (!valid)
+    {
+        ILOG_WARNING(ILX_THEMEBUNDLE, "Ignoring outdated or invalid theme bundle %s\n", path().c_str());
+        munmap(map, st.st_size);
+        return;
+    }
+
+    _map = map;
+    _mapSize = st.st_size;
+    ILOG_DEBUG(ILX_THEMEBUNDLE, " -> Mapped %s, %u sections, %u bytes\n", path().c_str(), header->count, _mapSize);
+}
+
+const ThemeBundle::Section*
+ThemeBundle::sections() const
+{
+    return (const Section*) ((const char*) _map + sizeof(Header));
+}
+
+} /* namespace ilixi */
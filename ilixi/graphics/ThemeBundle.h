@@ -0,0 +1,206 @@
+/*
+ Copyright 2010-2015 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ILIXI_THEMEBUNDLE_H_
+#define ILIXI_THEMEBUNDLE_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace ilixi
+{
+
+//! Binary cache of parsed theme files.
+/*!
+ * Style, palette, font, icon and image pack files of a theme are parsed once and
+ * stored as sections of a single versioned bundle file in ilxDirectory(). Bundle
+ * is memory-mapped on first use and sections are read in place, so an application
+ * does not parse XML files at start-up.
+ *
+ * Each section records modification time of its source file. A section is
+ * regenerated if its source file is modified or bundle version changes.
+ *
+ * Path of bundle can be set using ILX_THEMEBUNDLE environment variable, e.g. to
+ * use a bundle generated at build time.
+ */
+class ThemeBundle
+{
+public:
+    //! Bundle file version, incremented if layout of a section changes.
+    static const uint32_t Version = 1;
+
+    //! Type of section.
+    enum SectionType
+    {
+        StyleSection = 1,   //!< Rectangles of a Style.
+        PaletteSection,     //!< Colors of a Palette.
+        FontSection,        //!< Font descriptors of a FontPack.
+        IconSection,        //!< Icon positions of an IconPack.
+        ImagePackSection    //!< Image rectangles of an ImagePack.
+    };
+
+    //! Builds data of a section.
+    /*!
+     * Values are appended at 4 byte aligned offsets. A section starts with a
+     * header, so strings appended after it are referenced using their offset
+     * and 0 is used for no string.
+     */
+    class Writer
+    {
+    public:
+        Writer();
+
+        //! Appends value and returns its offset.
+        template<typename T>
+        unsigned int
+        append(const T& value)
+        {
+            unsigned int offset = reserve(sizeof(T));
+            memcpy(&_data[offset], &value, sizeof(T));
+            return offset;
+        }
+
+        //! Appends a NUL terminated string and returns its offset.
+        unsigned int
+        appendString(const std::string& str);
+
+        //! Returns value at offset.
+        template<typename T>
+        T*
+        at(unsigned int offset)
+        {
+            return (T*) &_data[offset];
+        }
+
+        //! Returns data.
+        const void*
+        data() const;
+
+        //! Returns size of data in bytes.
+        unsigned int
+        size() const;
+
+    private:
+        std::vector<char> _data;
+
+        unsigned int
+        reserve(unsigned int bytes);
+    };
+
+    /*!
+     * Returns the instance.
+     */
+    static ThemeBundle&
+    instance();
+
+    /*!
+     * Returns data of section which is created from given source file.
+     *
+     * @param type of section.
+     * @param source file path.
+     * @param bytes is set to size of data.
+     * @return NULL if bundle has no such section or source file is modified.
+     */
+    const void*
+    find(SectionType type, const std::string& source, unsigned int* bytes);
+
+    /*!
+     * Adds or replaces section of given source file and writes bundle.
+     *
+     * Bundle file is locked, then sections stored by other processes are read
+     * again and kept. Data returned by find() earlier stays valid until bundle
+     * is closed.
+     */
+    bool
+    store(SectionType type, const std::string& source, const Writer& section);
+
+    /*!
+     * Returns string at offset in data of a section, or NULL if offset is invalid.
+     */
+    static const char*
+    string(const void* data, unsigned int bytes, uint32_t offset);
+
+    /*!
+     * Unmaps bundle.
+     */
+    void
+    close();
+
+    /*!
+     * Returns path of bundle file.
+     */
+    const std::string&
+    path();
+
+private:
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t count;
+        uint32_t size;
+    };
+
+    struct Section
+    {
+        uint32_t type;
+        uint32_t key;
+        int64_t mtime;
+        uint32_t source;
+        uint32_t offset;
+        uint32_t bytes;
+        uint32_t reserved;
+    };
+
+    //! Bundle file.
+    std::string _path;
+    //! Mapped bundle file, NULL if bundle is not mapped.
+    void* _map;
+    //! Size of mapped file in bytes.
+    unsigned int _mapSize;
+    //! Mappings replaced by store(), released by close().
+    std::vector<std::pair<void*, unsigned int> > _oldMaps;
+    //! Set once bundle is opened.
+    bool _opened;
+
+    ThemeBundle();
+
+    ~ThemeBundle();
+
+    //! Maps bundle file and validates its header.
+    void
+    open();
+
+    //! Writes mapped sections and given section to bundle file, called while bundle is locked.
+    bool
+    write(SectionType type, const std::string& source, const Writer& data);
+
+    //! Returns section table of mapped bundle.
+    const Section*
+    sections() const;
+};
+
+} /* namespace ilixi */
+#endif /* ILIXI_THEMEBUNDLE_H_ */
@@ -35,6 +35,8 @@
 #include <ui/GroupBox.h>
 #include <ui/HBoxLayout.h>
 #include <ui/Icon.h>
+#include <ui/ItemModel.h>
+#include <ui/ItemView.h>
 #include <ui/Label.h>
 #include <ui/LineInput.h>
 #include <ui/LineSeperator.h>
@@ -22,22 +22,24 @@
  */
 
 #include <lib/Animation.h>
-#include <core/Application.h>
-#include <core/Window.h>
-#include <lib/Util.h>
-
-extern "C"
-{
-#include <direct/clock.h>
-}
-
-#define ILIXI_HAS_GETFRAMETIME 0
+#include <lib/AnimationClock.h>
+#include <core/Engine.h>
+#include <core/Logger.h>
 
 namespace ilixi
 {
 
 D_DEBUG_DOMAIN( ILX_ANIMATION, "ilixi/lib/Animation", "Animation");
 
+//! Returns timestamp of current AnimationClock tick.
+static long
+clockTime()
+{
+    if (Engine::instance().animationClock())
+        return Engine::instance().animationClock()->time();
+    return 0;
+}
+
 Animation::Animation()
         : _state(Stopped),
           _delayDuration(0),
@@ -47,14 +49,15 @@ Animation::Animation()
           _currentTime(0),
           _lastTime(0),
           _loops(1),
-          _currentLoop(1),
-          _cb(this)
+          _currentLoop(1)
 {
 }
 
 Animation::~Animation()
 {
-    stop();
+    _state = Stopped;
+    if (Engine::instance().animationClock())
+        Engine::instance().animationClock()->removeAnimation(this);
 }
 
 Animation::AnimationState
@@ -99,7 +102,10 @@ Animation::start()
     _currentLoop = 1;
     setCurrentTime();
     _state = Running;
-    _cb.start();
+    if (Engine::instance().animationClock())
+        Engine::instance().animationClock()->addAnimation(this);
+    else
+        ILOG_ERROR(ILX_ANIMATION, "Cannot start animation %p, Engine is not initialised!\n", this);
 }
 
 void
@@ -108,7 +114,8 @@ Animation::stop()
     if (_state == Running)
     {
         _state = Stopped;
-        _cb.stop();
+        if (Engine::instance().animationClock())
+            Engine::instance().animationClock()->removeAnimation(this);
     }
 }
 
@@ -119,6 +126,9 @@ Animation::resume()
     {
         setCurrentTime();
         _state = Running;
+        // clock drops paused animations.
+        if (Engine::instance().animationClock())
+            Engine::instance().animationClock()->addAnimation(this);
     } else if (_state == Stopped)
         start();
 }
@@ -155,14 +165,7 @@ Animation::setCurrentTime(int ms)
     else
         _currentTime = 0;
 
-#if ILIXI_HAS_GETFRAMETIME
-    long long frameTime = Application::getFrameTime();
-    long long actualTime = direct_clock_get_time(DIRECT_CLOCK_MONOTONIC);
-    //D_INFO( "frameTime %lld, actualTime %lld (diff %lld)\n", frameTime, actualTime, actualTime - frameTime );
-    _delayLast = frameTime / 1000LL;
-#else
-    _delayLast = direct_clock_get_abs_millis();
-#endif
+    _delayLast = clockTime();
     _lastTime = _delayLast + _delayDuration;
 }
 
@@ -183,14 +186,7 @@ Animation::funck()
     {
         if (_delayTime < _delayDuration)
         {
-#if ILIXI_HAS_GETFRAMETIME
-            long long frameTime = Application::getFrameTime();
-            long long actualTime = direct_clock_get_time(DIRECT_CLOCK_MONOTONIC);
-            //D_INFO( "frameTime %lld, actualTime %lld (diff %lld)\n", frameTime, actualTime, actualTime - frameTime );
-            _delayTime = frameTime / 1000LL - _delayLast;
-#else
-            _delayTime = direct_clock_get_abs_millis() - _delayLast;
-#endif
+            _delayTime = clockTime() - _delayLast;
             return 1;
         }
 
@@ -198,14 +194,7 @@ Animation::funck()
         {
             if (_currentTime == 0)
                 sigStarted();
-#if ILIXI_HAS_GETFRAMETIME
-            long long frameTime = Application::getFrameTime();
-            long long actualTime = direct_clock_get_time(DIRECT_CLOCK_MONOTONIC);
-            //D_INFO( "frameTime %lld, actualTime %lld (diff %lld)\n", frameTime, actualTime, actualTime - frameTime );
-            long stepTime = frameTime / 1000LL - _lastTime;
-#else
-            long stepTime = direct_clock_get_abs_millis() - _lastTime;
-#endif
+            long stepTime = clockTime() - _lastTime;
             step(stepTime);
             _currentTime += stepTime;
             _lastTime += stepTime;
@@ -37,6 +37,8 @@ namespace ilixi
  */
 class Animation : public sigc::trackable, public Functionoid
 {
+    friend class AnimationClock; // funck()
+
 public:
 
     //! This enum specifies animation's state.
@@ -174,7 +176,7 @@ protected:
     virtual void
     setState(AnimationState state);
 
-    //! Callback which iterates animation.
+    //! Called by AnimationClock at each tick to iterate animation.
     bool
     funck();
 
@@ -204,12 +206,6 @@ private:
     int _loops;
     //! Current loop in animation.
     int _currentLoop;
-    //! Callback for animation.
-    Callback _cb;
-
-    // Callback uses animate()
-    friend bool
-    animationCallback(void*);
 };
 
 }
@@ -0,0 +1,150 @@
+/*
+ Copyright 2010-2015 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <lib/AnimationClock.h>
+#include <lib/Animation.h>
+#include <core/Application.h>
+#include <core/Logger.h>
+#include <algorithm>
+
+extern "C"
+{
+#include <direct/clock.h>
+}
+
+namespace ilixi
+{
+
+D_DEBUG_DOMAIN( ILX_ANIMATIONCLOCK, "ilixi/lib/AnimationClock", "AnimationClock");
+
+AnimationClock::AnimationClock()
+        : _time(0),
+          _ticking(false)
+{
+    ILOG_TRACE(ILX_ANIMATIONCLOCK);
+    _timer.setInterval(16);
+    _timer.sigExec.connect(sigc::mem_fun(this, &AnimationClock::tick));
+}
+
+AnimationClock::~AnimationClock()
+{
+    ILOG_TRACE(ILX_ANIMATIONCLOCK);
+    _timer.stop();
+}
+
+int64_t
+AnimationClock::time() const
+{
+    if (_ticking)
+        return _time;
+    return now();
+}
+
+unsigned int
+AnimationClock::interval() const
+{
+    return _timer.interval();
+}
+
+unsigned int
+AnimationClock::count() const
+{
+    return _animations.size();
+}
+
+void
+AnimationClock::setInterval(unsigned int msec)
+{
+    _timer.setInterval(msec);
+    if (_timer.running())
+        _timer.restart();
+}
+
+void
+AnimationClock::addAnimation(Animation* animation)
+{
+    if (std::find(_animations.begin(), _animations.end(), animation) != _animations.end())
+        return;
+
+    _animations.push_back(animation);
+    ILOG_DEBUG(ILX_ANIMATIONCLOCK, "Animation %p is added, count: %d\n", animation, (int) _animations.size());
+    if (!_timer.running())
+        _timer.start(_timer.interval());
+}
+
+void
+AnimationClock::removeAnimation(Animation* animation)
+{
+    AnimationVector::iterator it = std::find(_animations.begin(), _animations.end(), animation);
+    if (it == _animations.end())
+        return;
+
+    _animations.erase(it);
+    ILOG_DEBUG(ILX_ANIMATIONCLOCK, "Animation %p is removed, count: %d\n", animation, (int) _animations.size());
+    if (_animations.empty() && !_ticking)
+        _timer.stop();
+}
+
+void
+AnimationClock::tick()
+{
+    ILOG_TRACE(ILX_ANIMATIONCLOCK);
+    // timestamps never go backwards, even if frame time lags behind.
+    _time = std::max(_time, now());
+    _ticking = true;
+
+    // animations may start, stop or delete other animations while stepping.
+    AnimationVector animations(_animations);
+    for (AnimationVector::iterator it = animations.begin(); it != animations.end(); ++it)
+    {
+        if (std::find(_animations.begin(), _animations.end(), *it) == _animations.end())
+            continue;
+        if (!(*it)->funck())
+            removeAnimation(*it);
+    }
+
+    _ticking = false;
+    ILOG_DEBUG(ILX_ANIMATIONCLOCK, " -> Stepped %d animations at %lld\n", (int) animations.size(), (long long) _time);
+    sigTick();
+
+    if (_animations.empty())
+        _timer.stop();
+}
+
+int64_t
+AnimationClock::now() const
+{
+#if ILIXI_HAS_GETFRAMETIME
+    long long actualTime = direct_clock_get_time(DIRECT_CLOCK_MONOTONIC);
+    long long frameTime = Application::getFrameTime();
+    // frame time is only updated while windows flip, do not use it if it is stale.
+    if (frameTime > actualTime - 2000LL * _timer.interval())
+        return frameTime / 1000LL;
+    return actualTime / 1000LL;
+#else
+    return direct_clock_get_abs_millis();
+#endif
+}
+
+} /* namespace ilixi */
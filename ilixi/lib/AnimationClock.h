@@ -0,0 +1,117 @@
+/*
+ Copyright 2010-2015 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef ILIXI_ANIMATIONCLOCK_H_
+#define ILIXI_ANIMATIONCLOCK_H_
+
+#include <lib/Timer.h>
+#include <vector>
+
+namespace ilixi
+{
+class Animation;
+
+//! Drives all running animations from a single tick.
+/*!
+ * Engine owns one AnimationClock. Running animations are registered with the
+ * clock, which ticks once per frame interval and steps every animation using
+ * the same timestamp. Since all animations step in the same cycle, updates
+ * they request are merged and painted in a single pass.
+ *
+ * If DirectFB provides frame time, timestamps are taken from
+ * Application::getFrameTime() so animations are in phase with display.
+ *
+ * \sa Engine::animationClock()
+ */
+class AnimationClock : public sigc::trackable
+{
+    friend class Engine;
+    friend class Animation;
+
+public:
+    /*!
+     * Returns timestamp of current tick in milliseconds.
+     *
+     * If clock is not ticking, returns current time.
+     */
+    int64_t
+    time() const;
+
+    /*!
+     * Returns tick interval in milliseconds.
+     */
+    unsigned int
+    interval() const;
+
+    /*!
+     * Returns number of running animations.
+     */
+    unsigned int
+    count() const;
+
+    /*!
+     * Sets tick interval in milliseconds, default is Engine::frameInterval().
+     */
+    void
+    setInterval(unsigned int msec);
+
+    /*!
+     * This signal is emitted after all animations are stepped.
+     */
+    sigc::signal<void> sigTick;
+
+private:
+    typedef std::vector<Animation*> AnimationVector;
+    //! Running animations.
+    AnimationVector _animations;
+    //! Fires ticks while there are running animations.
+    Timer _timer;
+    //! Timestamp of last tick in milliseconds.
+    int64_t _time;
+    //! This flag is set during a tick.
+    bool _ticking;
+
+    AnimationClock();
+
+    ~AnimationClock();
+
+    //! Adds animation and starts ticking if necessary.
+    void
+    addAnimation(Animation* animation);
+
+    //! Removes animation and stops ticking if there are no animations left.
+    void
+    removeAnimation(Animation* animation);
+
+    //! Steps all animations.
+    void
+    tick();
+
+    //! Returns current time in milliseconds.
+    int64_t
+    now() const;
+};
+
+} /* namespace ilixi */
+#endif /* ILIXI_ANIMATIONCLOCK_H_ */
@@ -0,0 +1,315 @@
+/*
+ Copyright 2010-2015 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <lib/FrameStats.h>
+#include <core/Logger.h>
+#include <directfb.h>
+#include <stdlib.h>
+#include <string.h>
+extern "C"
+{
+#include <direct/clock.h>
+}
+
+namespace ilixi
+{
+
+D_DEBUG_DOMAIN(ILX_FRAMESTATS, "ilixi/lib/FrameStats", "FrameStats");
+
+static const char* __stageNames[FrameStats::StageCount] = { "posted", "callbacks", "timers", "wait", "events", "layout", "compose", "blit", "flip" };
+
+FrameStats&
+FrameStats::instance()
+{
+    static FrameStats instance;
+    return instance;
+}
+
+FrameStats::FrameStats()
+        : _slots(NULL),
+          _capacity(512),
+          _count(0),
+          _enabled(false),
+          _inFrame(false),
+          _pointerEvents(0),
+          _pointerOldest(0),
+          _pointerNewest(0),
+          _pointerBase(0),
+          _pointerSum(0),
+          _flipTime(0),
+          _printSummary(false)
+{
+    _slots = new Slot[_capacity];
+    memset(_slots, 0, _capacity * sizeof(Slot));
+    memset(&_current, 0, sizeof(Frame));
+    memset(_depth, 0, sizeof(_depth));
+    memset(_stageStart, 0, sizeof(_stageStart));
+
+    char* var = getenv("ILX_FRAMESTATS");
+    if (var)
+    {
+        _enabled = true;
+        if (strcmp(var, "stderr") == 0)
+            _printSummary = true;
+        else if (strcmp(var, "1") != 0 && *var)
+            _file = var;
+        ILOG_DEBUG(ILX_FRAMESTATS, "Enabled with %u frames\n", _capacity);
+    }
+}
+
+FrameStats::~FrameStats()
+{
+    delete[] _slots;
+}
+
+bool
+FrameStats::enabled() const
+{
+    return _enabled;
+}
+
+void
+FrameStats::setEnabled(bool enabled)
+{
+    _enabled = enabled;
+    _inFrame = false;
+    memset(_depth, 0, sizeof(_depth));
+}
+
+unsigned int
+FrameStats::capacity() const
+{
+    return _capacity;
+}
+
+unsigned int
+FrameStats::count() const
+{
+    return _count;
+}
+
+unsigned int
+FrameStats::frames(FrameVector& frames, unsigned int last) const
+{
+    frames.clear();
+    unsigned int count = _count;
+    __sync_synchronize();
+    unsigned int n = count < _capacity ? count : _capacity;
+    if (last && last < n)
+        n = last;
+    frames.reserve(n);
+
+    Frame frame;
+    for (unsigned int i = count - n; i != count; ++i)
+    {
+        const Slot& slot = _slots[i % _capacity];
+        unsigned int seq = slot.seq;
+        __sync_synchronize();
+        frame = slot.frame;
+        __sync_synchronize();
+        // skip slots overwritten while copying.
+        if ((seq & 1) || seq != slot.seq || frame.number != i + 1)
+            continue;
+        frames.push_back(frame);
+    }
+    return frames.size();
+}
+
+void
+FrameStats::printSummary(FILE* stream) const
+{
+    FrameVector list;
+    if (!frames(list))
+        return;
+
+    long long stages[StageCount];
+    memset(stages, 0, sizeof(stages));
+    long long busy = 0;
+    long long busyMax = 0;
+    long long damage = 0;
+    unsigned int events = 0;
+    long long latencySum = 0;
+    long long latencyMax = 0;
+
+    for (FrameVector::const_iterator it = list.begin(); it != list.end(); ++it)
+    {
+        long long b = it->duration - it->stages[Wait];
+        busy += b;
+        if (b > busyMax)
+            busyMax = b;
+        for (int i = 0; i < StageCount; ++i)
+            stages[i] += it->stages[i];
+        damage += it->damagedArea;
+        events += it->pointerEvents;
+        latencySum += it->latencyAvg * it->pointerEvents;
+        if (it->latencyMax > latencyMax)
+            latencyMax = it->latencyMax;
+    }
+
+    unsigned int n = list.size();
+    fprintf(stream, "ilixi frames %u-%u: busy avg %lld us max %lld us, damage avg %lld px\n", list.front().number, list.back().number, busy / n, busyMax, damage / n);
+    fprintf(stream, "  stages avg (us):");
+    for (int i = 0; i < StageCount; ++i)
+        fprintf(stream, " %s %lld", __stageNames[i], stages[i] / n);
+    fprintf(stream, "\n");
+    if (events)
+        fprintf(stream, "  pointer latency: %u events avg %lld us max %lld us\n", events, latencySum / events, latencyMax);
+}
+
+bool
+FrameStats::dump(const std::string& file) const
+{
+    FILE* stream = fopen(file.c_str(), "w");
+    if (!stream)
+    {
+        ILOG_ERROR(ILX_FRAMESTATS, "Cannot open %s for writing!\n", file.c_str());
+        return false;
+    }
+
+    fprintf(stream, "frame,start,duration");
+    for (int i = 0; i < StageCount; ++i)
+        fprintf(stream, ",%s", __stageNames[i]);
+    fprintf(stream, ",damaged_area,damaged_rects,pointer_events,latency_min,latency_max,latency_avg\n");
+
+    FrameVector list;
+    frames(list);
+    for (FrameVector::const_iterator it = list.begin(); it != list.end(); ++it)
+    {
+        fprintf(stream, "%u,%lld,%lld", it->number, it->start, it->duration);
+        for (int i = 0; i < StageCount; ++i)
+            fprintf(stream, ",%lld", it->stages[i]);
+        fprintf(stream, ",%lld,%u,%u,%lld,%lld,%lld\n", it->damagedArea, it->damagedRects, it->pointerEvents, it->latencyMin, it->latencyMax, it->latencyAvg);
+    }
+    fclose(stream);
+    ILOG_DEBUG(ILX_FRAMESTATS, "Wrote %u frames to %s\n", (unsigned int) list.size(), file.c_str());
+    return true;
+}
+
+void
+FrameStats::beginFrame()
+{
+    if (!_enabled)
+        return;
+
+    memset(&_current, 0, sizeof(Frame));
+    _current.start = direct_clock_get_time(DIRECT_CLOCK_MONOTONIC);
+    _flipTime = 0;
+    _inFrame = true;
+}
+
+void
+FrameStats::endFrame()
+{
+    if (!_enabled || !_inFrame)
+        return;
+
+    _inFrame = false;
+    _current.duration = direct_clock_get_time(DIRECT_CLOCK_MONOTONIC) - _current.start;
+    _current.number = _count + 1;
+
+    if (_flipTime && _pointerEvents)
+    {
+        _current.pointerEvents = _pointerEvents;
+        _current.latencyMin = _flipTime - _pointerNewest;
+        _current.latencyMax = _flipTime - _pointerOldest;
+        _current.latencyAvg = _flipTime - _pointerBase - _pointerSum / _pointerEvents;
+        _pointerEvents = 0;
+    }
+
+    Slot& slot = _slots[_count % _capacity];
+    __sync_add_and_fetch(&slot.seq, 1);
+    slot.frame = _current;
+    __sync_add_and_fetch(&slot.seq, 1);
+    __sync_add_and_fetch(&_count, 1);
+
+    if (_printSummary && _count % _capacity == 0)
+        printSummary(stderr);
+}
+
+void
+FrameStats::begin(Stage stage)
+{
+    if (!_inFrame)
+        return;
+
+    if (_depth[stage]++ == 0)
+        _stageStart[stage] = direct_clock_get_time(DIRECT_CLOCK_MONOTONIC);
+}
+
+void
+FrameStats::end(Stage stage)
+{
+    if (!_inFrame || !_depth[stage])
+        return;
+
+    if (--_depth[stage] == 0)
+    {
+        _current.stages[stage] += direct_clock_get_time(DIRECT_CLOCK_MONOTONIC) - _stageStart[stage];
+        if (stage == Flip)
+            _flipTime = direct_clock_get_time(DIRECT_CLOCK_REALTIME);
+    }
+}
+
+void
+FrameStats::addDamage(long long area, unsigned int rects)
+{
+    if (!_inFrame)
+        return;
+
+    _current.damagedArea += area;
+    _current.damagedRects += rects;
+}
+
+void
+FrameStats::addPointerEvent(const struct timeval& timestamp)
+{
+    if (!_inFrame)
+        return;
+
+    long long micros = timestamp.tv_sec * 1000000LL + timestamp.tv_usec;
+    if (!_pointerEvents)
+    {
+        _pointerBase = _pointerOldest = _pointerNewest = micros;
+        _pointerSum = 0;
+    } else if (micros < _pointerOldest)
+        _pointerOldest = micros;
+    else if (micros > _pointerNewest)
+        _pointerNewest = micros;
+    _pointerSum += micros - _pointerBase;
+    ++_pointerEvents;
+}
+
+void
+FrameStats::report()
+{
+    if (!_enabled)
+        return;
+
+    if (_printSummary)
+        printSummary(stderr);
+    else if (!_file.empty())
+        dump(_file);
+}
+
+} /* namespace ilixi */
@@ -0,0 +1,262 @@
+/*
+ Copyright 2010-2015 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef ILIXI_FRAMESTATS_H_
+#define ILIXI_FRAMESTATS_H_
+
+#include <sys/time.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+namespace ilixi
+{
+//! Collects per-frame timing statistics of main loop.
+/*!
+ * Each iteration of Application::exec() is recorded as a frame. Time spent in
+ * posted items, callbacks, timers, waiting, event dispatch, layout, compose,
+ * cache blits and flips is measured along with damaged pixel area and
+ * input-to-photon latency of pointer events, i.e. time between event timestamp
+ * and the end of first flip after it is dispatched.
+ *
+ * Frames are stored in a ring buffer which is written by main thread only and
+ * can be read from any thread without locking.
+ *
+ * Statistics are disabled by default. ILX_FRAMESTATS environment variable
+ * enables them:
+ *  - "stderr" prints a summary to stderr each time ring buffer is filled.
+ *  - Any other value except "1" is used as a file name and frames are
+ *    written to it in CSV format when application exits.
+ */
+class FrameStats
+{
+public:
+    //! Measured parts of a frame.
+    enum Stage
+    {
+        Posted,     //!< Items posted using Engine::post() or UniversalEvents.
+        Callbacks,  //!< Callbacks and Engine::sigPerformWork.
+        Timers,     //!< Timers.
+        Wait,       //!< Waiting for events.
+        Events,     //!< Event dispatch.
+        Layout,     //!< Tiling layouts, included in Compose.
+        Compose,    //!< Painting windows.
+        Blit,       //!< Blitting cached widget surfaces, included in Compose.
+        Flip,       //!< Flipping window surfaces.
+        StageCount
+    };
+
+    //! Statistics of a single frame, times are in microseconds.
+    struct Frame
+    {
+        //! Frame number starting from 1.
+        unsigned int number;
+        //! Monotonic time at start of frame.
+        long long start;
+        //! Duration of frame including Wait.
+        long long duration;
+        //! Duration of each stage.
+        long long stages[StageCount];
+        //! Area of damaged regions in pixels.
+        long long damagedArea;
+        //! Number of damaged rectangles.
+        unsigned int damagedRects;
+        //! Number of pointer events which reached screen in this frame.
+        unsigned int pointerEvents;
+        //! Minimum input-to-photon latency.
+        long long latencyMin;
+        //! Maximum input-to-photon latency.
+        long long latencyMax;
+        //! Average input-to-photon latency.
+        long long latencyAvg;
+    };
+
+    typedef std::vector<Frame> FrameVector;
+
+    /*!
+     * Returns the instance.
+     */
+    static FrameStats&
+    instance();
+
+    /*!
+     * Returns true if statistics are collected.
+     */
+    bool
+    enabled() const;
+
+    /*!
+     * Starts or stops collecting statistics.
+     */
+    void
+    setEnabled(bool enabled);
+
+    /*!
+     * Returns maximum number of frames kept.
+     */
+    unsigned int
+    capacity() const;
+
+    /*!
+     * Returns number of frames recorded so far.
+     */
+    unsigned int
+    count() const;
+
+    /*!
+     * Fills frames with last recorded frames, oldest first.
+     *
+     * This method can be called from any thread.
+     *
+     * @param frames is set to recorded frames.
+     * @param last maximum number of frames, 0 for all frames in buffer.
+     * @return number of frames copied.
+     */
+    unsigned int
+    frames(FrameVector& frames, unsigned int last = 0) const;
+
+    /*!
+     * Prints a summary of frames in buffer.
+     */
+    void
+    printSummary(FILE* stream) const;
+
+    /*!
+     * Writes frames in buffer to a file in CSV format.
+     *
+     * @return false if file can not be written.
+     */
+    bool
+    dump(const std::string& file) const;
+
+    /*!
+     * Starts a new frame.
+     */
+    void
+    beginFrame();
+
+    /*!
+     * Records current frame.
+     */
+    void
+    endFrame();
+
+    /*!
+     * Starts measuring a stage, nested calls are measured once.
+     *
+     * Stages are measured on main thread only.
+     */
+    void
+    begin(Stage stage);
+
+    /*!
+     * Stops measuring a stage.
+     */
+    void
+    end(Stage stage);
+
+    /*!
+     * Adds damaged area.
+     */
+    void
+    addDamage(long long area, unsigned int rects);
+
+    /*!
+     * Records timestamp of a dispatched pointer event.
+     */
+    void
+    addPointerEvent(const struct timeval& timestamp);
+
+    /*!
+     * Prints a summary or writes frames to file as set using ILX_FRAMESTATS.
+     */
+    void
+    report();
+
+    //! Measures a stage in a scope.
+    class Scope
+    {
+    public:
+        Scope(Stage stage)
+                : _stage(stage)
+        {
+            FrameStats::instance().begin(_stage);
+        }
+
+        ~Scope()
+        {
+            FrameStats::instance().end(_stage);
+        }
+
+    private:
+        Stage _stage;
+    };
+
+private:
+    struct Slot
+    {
+        //! Odd while slot is being written.
+        volatile unsigned int seq;
+        Frame frame;
+    };
+
+    //! Ring buffer.
+    Slot* _slots;
+    //! This property stores number of slots.
+    unsigned int _capacity;
+    //! Number of frames written.
+    volatile unsigned int _count;
+    //! This flag is set if statistics are collected.
+    bool _enabled;
+    //! This flag is set between beginFrame() and endFrame().
+    bool _inFrame;
+    //! Frame being measured.
+    Frame _current;
+    //! Nesting depth of each stage.
+    unsigned int _depth[StageCount];
+    //! Start time of each stage.
+    long long _stageStart[StageCount];
+    //! Number of pointer events waiting for a flip.
+    unsigned int _pointerEvents;
+    //! Oldest and newest pending pointer event timestamps.
+    long long _pointerOldest;
+    long long _pointerNewest;
+    //! Timestamp of first pending pointer event.
+    long long _pointerBase;
+    //! Sum of pending pointer event timestamps relative to _pointerBase.
+    long long _pointerSum;
+    //! Realtime clock at end of last flip.
+    long long _flipTime;
+    //! Print summary to stderr each time buffer is filled.
+    bool _printSummary;
+    //! File to write frames to, if any.
+    std::string _file;
+
+    FrameStats();
+
+    ~FrameStats();
+};
+
+} /* namespace ilixi */
+#endif /* ILIXI_FRAMESTATS_H_ */
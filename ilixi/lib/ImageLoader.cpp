@@ -0,0 +1,327 @@
+/*
+ Copyright 2010-2015 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <lib/ImageLoader.h>
+#include <core/Engine.h>
+#include <core/Logger.h>
+#include <types/Image.h>
+#include <types/ImageCache.h>
+#include <ui/Widget.h>
+#include <algorithm>
+#include <stdlib.h>
+#include <unistd.h>
+
+namespace ilixi
+{
+
+D_DEBUG_DOMAIN(ILX_IMAGELOADER, "ilixi/lib/ImageLoader", "ImageLoader");
+
+ImageLoader&
+ImageLoader::instance()
+{
+    static ImageLoader instance;
+    return instance;
+}
+
+ImageLoader::ImageLoader()
+        : _nextId(0),
+          _threadCount(2),
+          _quit(false)
+{
+    pthread_mutex_init(&_lock, NULL);
+    pthread_cond_init(&_cond, NULL);
+    char* var = getenv("ILX_IMAGELOADER");
+    if (var && atoi(var) > 0)
+        _threadCount = atoi(var);
+    ILOG_DEBUG(ILX_IMAGELOADER, "Threads: %u\n", _threadCount);
+    // cache must outlive workers.
+    ImageCache::instance();
+}
+
+ImageLoader::~ImageLoader()
+{
+    pthread_mutex_lock(&_lock);
+    _quit = true;
+    pthread_cond_broadcast(&_cond);
+    pthread_mutex_unlock(&_lock);
+
+    for (unsigned int i = 0; i < _threads.size(); ++i)
+        pthread_join(_threads[i], NULL);
+
+    pthread_cond_destroy(&_cond);
+    pthread_mutex_destroy(&_lock);
+}
+
+void
+ImageLoader::load(Image* image, Widget* owner, int priority)
+{
+    if (!image || image->ready() || (image->_state & (Image::NotAvailable | Image::SubImage)))
+        return;
+
+    if (!(image->_state & Image::Loading))
+    {
+        DFBImageCapabilities caps;
+        IDirectFBSurface* surface = ImageCache::instance().find(image->_imagePath, image->_size, &caps);
+        if (surface)
+        {
+            ILOG_DEBUG(ILX_IMAGELOADER, "[%p] Cached %s\n", image, image->_imagePath.c_str());
+            image->setLoadedSurface(surface, caps);
+            return;
+        }
+    }
+
+    pthread_mutex_lock(&_lock);
+    if (image->_state & Image::Loading)
+    {
+        for (JobList::iterator it = _queue.begin(); it != _queue.end(); ++it)
+        {
+            if (it->image == image)
+            {
+                if (priority > it->priority)
+                    it->priority = priority;
+                addOwner(*it, owner);
+                break;
+            }
+        }
+
+        for (JobMap::iterator it = _running.begin(); it != _running.end(); ++it)
+            if (it->second.image == image)
+                addOwner(it->second, owner);
+        pthread_mutex_unlock(&_lock);
+        return;
+    }
+
+    Job job;
+    job.id = _nextId++;
+    job.image = image;
+    addOwner(job, owner);
+    job.priority = priority;
+    job.path = image->_imagePath;
+    job.size = image->_size;
+    _queue.push_back(job);
+    image->_state = (Image::ImageFlags) (image->_state | Image::Loading);
+    ILOG_DEBUG(ILX_IMAGELOADER, "[%p] Queued %s priority: %d\n", image, job.path.c_str(), priority);
+
+    startThreads();
+    pthread_cond_signal(&_cond);
+    pthread_mutex_unlock(&_lock);
+}
+
+void
+ImageLoader::setPriority(Image* image, int priority)
+{
+    pthread_mutex_lock(&_lock);
+    for (JobList::iterator it = _queue.begin(); it != _queue.end(); ++it)
+    {
+        if (it->image == image)
+        {
+            it->priority = priority;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&_lock);
+}
+
+void
+ImageLoader::cancel(Image* image)
+{
+    pthread_mutex_lock(&_lock);
+    for (JobList::iterator it = _queue.begin(); it != _queue.end(); ++it)
+    {
+        if (it->image == image)
+        {
+            _queue.erase(it);
+            break;
+        }
+    }
+
+    // decoded surface is released once it is delivered.
+    for (JobMap::iterator it = _running.begin(); it != _running.end(); ++it)
+    {
+        if (it->second.image == image)
+        {
+            it->second.image = NULL;
+            it->second.owners.clear();
+        }
+    }
+    image->_state = (Image::ImageFlags) (image->_state & ~Image::Loading);
+    ILOG_DEBUG(ILX_IMAGELOADER, "[%p] Cancelled\n", image);
+    pthread_mutex_unlock(&_lock);
+}
+
+void
+ImageLoader::cancel(Widget* owner)
+{
+    pthread_mutex_lock(&_lock);
+    for (JobList::iterator it = _queue.begin(); it != _queue.end();)
+    {
+        // requests of other widgets sharing same image are kept.
+        if (removeOwners(*it, owner) && it->owners.empty())
+        {
+            ILOG_DEBUG(ILX_IMAGELOADER, "[%p] Cancelled by owner %p\n", it->image, owner);
+            it->image->_state = (Image::ImageFlags) (it->image->_state & ~Image::Loading);
+            it = _queue.erase(it);
+        } else
+            ++it;
+    }
+
+    // image still receives its surface, but removed owners are not updated.
+    for (JobMap::iterator it = _running.begin(); it != _running.end(); ++it)
+        removeOwners(it->second, owner);
+    pthread_mutex_unlock(&_lock);
+}
+
+unsigned int
+ImageLoader::pending() const
+{
+    pthread_mutex_lock(&_lock);
+    unsigned int count = _queue.size() + _running.size();
+    pthread_mutex_unlock(&_lock);
+    return count;
+}
+
+void
+ImageLoader::startThreads()
+{
+    if (_threads.size())
+        return;
+
+    for (unsigned int i = 0; i < _threadCount; ++i)
+    {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, workerLoop, this) == 0)
+            _threads.push_back(thread);
+        else
+            ILOG_ERROR(ILX_IMAGELOADER, "Cannot create worker thread!\n");
+    }
+}
+
+bool
+ImageLoader::isOwnedBy(Widget* owner, Widget* widget)
+{
+    for (Widget* w = owner; w; w = w->parent())
+        if (w == widget)
+            return true;
+    return false;
+}
+
+void
+ImageLoader::addOwner(Job& job, Widget* owner)
+{
+    if (owner && std::find(job.owners.begin(), job.owners.end(), owner) == job.owners.end())
+        job.owners.push_back(owner);
+}
+
+bool
+ImageLoader::removeOwners(Job& job, Widget* widget)
+{
+    unsigned int count = job.owners.size();
+    for (OwnerVector::iterator it = job.owners.begin(); it != job.owners.end();)
+    {
+        if (isOwnedBy(*it, widget))
+            it = job.owners.erase(it);
+        else
+            ++it;
+    }
+    return job.owners.size() != count;
+}
+
+void*
+ImageLoader::workerLoop(void* arg)
+{
+    ImageLoader* loader = (ImageLoader*) arg;
+    while (true)
+    {
+        pthread_mutex_lock(&loader->_lock);
+        while (loader->_queue.empty() && !loader->_quit)
+            pthread_cond_wait(&loader->_cond, &loader->_lock);
+
+        if (loader->_quit)
+        {
+            pthread_mutex_unlock(&loader->_lock);
+            break;
+        }
+
+        // first job with highest priority, queue order is kept among equal priorities.
+        JobList::iterator best = loader->_queue.begin();
+        for (JobList::iterator it = best; it != loader->_queue.end(); ++it)
+            if (it->priority > best->priority)
+                best = it;
+
+        Job job = *best;
+        loader->_queue.erase(best);
+        loader->_running.insert(std::make_pair(job.id, job));
+        pthread_mutex_unlock(&loader->_lock);
+
+        ILOG_DEBUG(ILX_IMAGELOADER, "Decoding %s\n", job.path.c_str());
+        Result* result = new Result;
+        result->id = job.id;
+        result->caps = DICAPS_NONE;
+        result->surface = ImageCache::instance().acquire(job.path, job.size, &result->caps);
+
+        while (!Engine::instance().post(deliver, result))
+        {
+            if (loader->_quit)
+            {
+                if (result->surface)
+                    ImageCache::instance().release(result->surface);
+                delete result;
+                break;
+            }
+            usleep(1000);
+        }
+    }
+    return NULL;
+}
+
+void
+ImageLoader::deliver(void* arg)
+{
+    Result* result = (Result*) arg;
+    ImageLoader& loader = instance();
+    Image* image = NULL;
+    OwnerVector owners;
+
+    pthread_mutex_lock(&loader._lock);
+    JobMap::iterator it = loader._running.find(result->id);
+    if (it != loader._running.end())
+    {
+        image = it->second.image;
+        owners.swap(it->second.owners);
+        loader._running.erase(it);
+    }
+    pthread_mutex_unlock(&loader._lock);
+
+    if (image)
+    {
+        ILOG_DEBUG(ILX_IMAGELOADER, "[%p] Ready, owners: %u\n", image, (unsigned int) owners.size());
+        image->setLoadedSurface(result->surface, result->caps);
+        for (OwnerVector::iterator it = owners.begin(); it != owners.end(); ++it)
+            (*it)->update();
+    } else if (result->surface)
+        ImageCache::instance().release(result->surface);
+    delete result;
+}
+
+} /* namespace ilixi */
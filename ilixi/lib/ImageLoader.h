@@ -0,0 +1,189 @@
+/*
+ Copyright 2010-2015 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef ILIXI_IMAGELOADER_H_
+#define ILIXI_IMAGELOADER_H_
+
+#include <directfb.h>
+#include <types/Size.h>
+#include <pthread.h>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ilixi
+{
+class Image;
+class Widget;
+
+//! Decodes images on worker threads.
+/*!
+ * Images with Image::Asynchronous load mode are queued by Painter when they are
+ * painted for the first time. Worker threads decode queued images in order of
+ * priority and decoded surfaces are handed over to images by main loop, see
+ * Engine::post(). Owner widgets of each image are updated once its image is ready.
+ *
+ * Requests are cancelled when image is destroyed or modified, and when all of its
+ * owner widgets, or their ancestors, are hidden or destroyed.
+ *
+ * Number of worker threads can be set using ILX_IMAGELOADER environment
+ * variable, default is 2.
+ */
+class ImageLoader
+{
+public:
+    /*!
+     * This enum specifies common priorities, any integer can be used.
+     */
+    enum Priority
+    {
+        LowPriority = -10,      //!< Used for prefetching images which are not visible.
+        NormalPriority = 0,     //!< Default priority of images.
+        HighPriority = 10       //!< Used for images which should appear first.
+    };
+
+    /*!
+     * Returns the instance.
+     */
+    static ImageLoader&
+    instance();
+
+    /*!
+     * Queues image for decoding.
+     *
+     * If image is already queued its priority is raised if necessary and owner is
+     * added to its owners. This method should be called from main thread.
+     *
+     * @param image to decode.
+     * @param owner is updated once image is ready, can be NULL.
+     * @param priority images with higher priority are decoded first.
+     */
+    void
+    load(Image* image, Widget* owner, int priority = NormalPriority);
+
+    /*!
+     * Changes priority of a queued image.
+     */
+    void
+    setPriority(Image* image, int priority);
+
+    /*!
+     * Cancels request for given image.
+     */
+    void
+    cancel(Image* image);
+
+    /*!
+     * Removes given widget and its children from owners of requests.
+     *
+     * Queued requests are cancelled if they have no owners left.
+     */
+    void
+    cancel(Widget* owner);
+
+    /*!
+     * Returns number of queued images, including images being decoded.
+     */
+    unsigned int
+    pending() const;
+
+private:
+    typedef std::vector<Widget*> OwnerVector;
+
+    struct Job
+    {
+        //! Unique id used for matching decoded surfaces.
+        unsigned int id;
+        //! Image is NULL once request is cancelled.
+        Image* image;
+        //! Widgets which are updated once image is ready.
+        OwnerVector owners;
+        //! Jobs with higher priority are decoded first.
+        int priority;
+        //! Copied from image so that workers do not access images.
+        std::string path;
+        //! Copied from image so that workers do not access images.
+        Size size;
+    };
+
+    struct Result
+    {
+        unsigned int id;
+        IDirectFBSurface* surface;
+        DFBImageCapabilities caps;
+    };
+
+    typedef std::list<Job> JobList;
+    typedef std::map<unsigned int, Job> JobMap;
+    typedef std::vector<pthread_t> ThreadVector;
+
+    //! Jobs which are waiting for a worker.
+    JobList _queue;
+    //! Jobs which are being decoded by workers.
+    JobMap _running;
+    //! Id of next job.
+    unsigned int _nextId;
+    //! Number of worker threads started on first request.
+    unsigned int _threadCount;
+    //! Worker threads.
+    ThreadVector _threads;
+    //! This flag is set when workers should exit.
+    bool _quit;
+    //! This mutex serialises access to jobs.
+    mutable pthread_mutex_t _lock;
+    //! Workers wait on this condition for new jobs.
+    pthread_cond_t _cond;
+
+    ImageLoader();
+
+    ~ImageLoader();
+
+    //! Starts worker threads if they are not running.
+    void
+    startThreads();
+
+    //! Returns true if widget is owner or one of its ancestors.
+    static bool
+    isOwnedBy(Widget* owner, Widget* widget);
+
+    //! Adds owner to job unless it is NULL or already added.
+    static void
+    addOwner(Job& job, Widget* owner);
+
+    //! Removes owners which belong to widget, returns true if any owner is removed.
+    static bool
+    removeOwners(Job& job, Widget* widget);
+
+    //! Decodes jobs until loader is destroyed.
+    static void*
+    workerLoop(void* arg);
+
+    //! Hands over decoded surface to image, called by main loop.
+    static void
+    deliver(void* arg);
+};
+
+} /* namespace ilixi */
+#endif /* ILIXI_IMAGELOADER_H_ */
@@ -0,0 +1,155 @@
+/*
+ Copyright 2010-2015 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef ILIXI_LOCKFREEQUEUE_H_
+#define ILIXI_LOCKFREEQUEUE_H_
+
+namespace ilixi
+{
+
+//! Bounded multi-producer single-consumer queue which does not use locks.
+/*!
+ * Any thread can push() items, while only one thread, e.g. main loop, can
+ * pop() them. Each cell stores a sequence number which tells producers and
+ * the consumer whether it is free or contains an item, so pushing an item
+ * costs a single compare-and-swap and neither operation allocates memory.
+ *
+ * T should be a small copyable type.
+ */
+template<typename T>
+class LockFreeQueue
+{
+public:
+    /*!
+     * Constructor.
+     *
+     * @param capacity maximum number of items, rounded up to a power of two.
+     */
+    LockFreeQueue(unsigned int capacity = 1024)
+            : _enqueuePos(0),
+              _dequeuePos(0)
+    {
+        unsigned int size = 2;
+        while (size < capacity)
+            size <<= 1;
+        _mask = size - 1;
+        _cells = new Cell[size];
+        for (unsigned int i = 0; i < size; ++i)
+            _cells[i].sequence = i;
+    }
+
+    /*!
+     * Destructor.
+     */
+    ~LockFreeQueue()
+    {
+        delete[] _cells;
+    }
+
+    /*!
+     * Returns maximum number of items.
+     */
+    unsigned int
+    capacity() const
+    {
+        return _mask + 1;
+    }
+
+    /*!
+     * Appends item to queue, can be called from any thread.
+     *
+     * Returns false if queue is full.
+     */
+    bool
+    push(const T& item)
+    {
+        Cell* cell;
+        unsigned int pos = _enqueuePos;
+        while (true)
+        {
+            cell = &_cells[pos & _mask];
+            unsigned int sequence = cell->sequence;
+            __sync_synchronize();
+            int diff = (int) (sequence - pos);
+            if (diff == 0)
+            {
+                if (__sync_bool_compare_and_swap(&_enqueuePos, pos, pos + 1))
+                    break;
+            } else if (diff < 0)
+                return false;
+            pos = _enqueuePos;
+        }
+        cell->data = item;
+        __sync_synchronize();
+        cell->sequence = pos + 1;
+        return true;
+    }
+
+    /*!
+     * Removes first item from queue, should be called only by consumer thread.
+     *
+     * Returns false if queue is empty.
+     */
+    bool
+    pop(T& item)
+    {
+        Cell* cell = &_cells[_dequeuePos & _mask];
+        unsigned int sequence = cell->sequence;
+        __sync_synchronize();
+        if ((int) (sequence - (_dequeuePos + 1)) < 0)
+            return false;
+        item = cell->data;
+        __sync_synchronize();
+        cell->sequence = _dequeuePos + _mask + 1;
+        ++_dequeuePos;
+        return true;
+    }
+
+private:
+    struct Cell
+    {
+        //! Equals position for free cells and position + 1 for filled cells.
+        volatile unsigned int sequence;
+        T data;
+    };
+
+    //! Ring buffer of cells.
+    Cell* _cells;
+    //! Size of ring buffer minus one.
+    unsigned int _mask;
+    //! Next position to write, shared by producers.
+    volatile unsigned int _enqueuePos;
+    //! Keeps producer and consumer positions on separate cache lines.
+    char _padding[64];
+    //! Next position to read, used only by consumer.
+    unsigned int _dequeuePos;
+
+    LockFreeQueue(const LockFreeQueue&);
+
+    LockFreeQueue&
+    operator=(const LockFreeQueue&);
+};
+
+} /* namespace ilixi */
+#endif /* ILIXI_LOCKFREEQUEUE_H_ */
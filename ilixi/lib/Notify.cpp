@@ -110,20 +110,19 @@ Notify::show()
 {
     ILOG_TRACE_F(ILX_NOTIFY);
 
-    void *ptr;
-    DaleDFB::comaGetLocal(sizeof(Compositor::NotificationData), &ptr);
-    Compositor::NotificationData* data = (Compositor::NotificationData*) ptr;
+    // copied into shared memory by dispatcher.
+    Compositor::NotificationData data;
 
-    snprintf(data->body, 256, "%s", _body.c_str());
-    snprintf(data->icon, 256, "%s", _icon.c_str());
-    snprintf(data->origin, 256, "");
-    snprintf(data->tag, 128, "%s", _tag.c_str());
-    snprintf(data->title, 128, "%s", _title.c_str());
-    snprintf(data->uuid, 37, "%s", _uuid);
+    snprintf(data.body, 256, "%s", _body.c_str());
+    snprintf(data.icon, 256, "%s", _icon.c_str());
+    snprintf(data.origin, 256, "");
+    snprintf(data.tag, 128, "%s", _tag.c_str());
+    snprintf(data.title, 128, "%s", _title.c_str());
+    snprintf(data.uuid, 37, "%s", _uuid);
 
-    data->client = getpid();
+    data.client = getpid();
 
-    DaleDFB::addNotification(this, (void*) data);
+    DaleDFB::addNotification(this, &data);
 }
 
 } /* namespace ilixi */
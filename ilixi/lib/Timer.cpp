@@ -41,7 +41,8 @@ Timer::Timer()
           _repeats(0),
           _count(0),
           _running(false),
-          _expiry(0)
+          _expiry(0),
+          _heapIndex(-1)
 {
     ILOG_TRACE(ILX_TIMER);
 }
@@ -96,6 +97,9 @@ Timer::restart()
         _count = 0;
         _expiry = direct_clock_get_millis() + _interval;
         ILOG_DEBUG( ILX_TIMER, " -> Interval %d msec (trigger time %d.%d)\n", _interval, (int) (_expiry/1000), (int)(_expiry%1000));
+        // reschedule using new expiry.
+        Engine::instance().removeTimer(this);
+        Engine::instance().addTimer(this);
     }
 }
 
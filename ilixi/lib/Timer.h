@@ -130,6 +130,8 @@ private:
     bool _running;
     //! This property stores when timer will fire next.
     int64_t _expiry;
+    //! Position of timer inside Engine's timer heap, -1 if not scheduled.
+    int _heapIndex;
 
     // Callback uses step()
     friend bool
@@ -24,6 +24,7 @@
 #include <types/Font.h>
 #include <core/Logger.h>
 #include <types/FontCache.h>
+#include <types/FontMetrics.h>
 #include <sstream>
 
 namespace ilixi
@@ -38,7 +39,8 @@ Font::Font()
           _attr(DFFA_NONE),
           _name("sans"),
           _ref(1),
-          _key(0)
+          _key(0),
+          _metrics(NULL)
 {
     ILOG_TRACE(ILX_FONT);
     ILOG_DEBUG(ILX_FONT, " -> name: %s, size: %d (default)\n", _name.c_str(), _size);
@@ -51,7 +53,8 @@ Font::Font(const std::string& name, int size)
           _attr(DFFA_NONE),
           _name(name),
           _ref(1),
-          _key(0)
+          _key(0),
+          _metrics(NULL)
 {
     ILOG_TRACE(ILX_FONT);
     ILOG_DEBUG(ILX_FONT, " -> name: %s, size: %d\n", _name.c_str(), _size);
@@ -59,16 +62,21 @@ Font::Font(const std::string& name, int size)
 
 Font::Font(const Font& font)
         : _modified(true),
-          _font(font._font),
+          _font(NULL),
           _size(font._size),
           _attr(font._attr),
           _name(font._name),
           _ref(1),
-          _key(font._key)
+          _key(0),
+          _metrics(NULL)
 {
-    if (_font)
-        _font->AddRef(_font);
     ILOG_TRACE(ILX_FONT);
+    // copy holds its own reference to cache entry, so it shares font and metrics.
+    if (font._font)
+    {
+        _key = FontCache::Instance()->getEntry(_name, _size, _attr, &_font, &_metrics);
+        _modified = false;
+    }
     ILOG_DEBUG(ILX_FONT, " -> copied, name: %s, size: %d\n", _name.c_str(), _size);
 }
 
@@ -92,12 +100,22 @@ Font::name() const
     return _name;
 }
 
+unsigned int
+Font::key()
+{
+    if (!loadFont())
+        return 0;
+    return _key;
+}
+
 int
 Font::ascender()
 {
     ILOG_TRACE(ILX_FONT);
     if (!loadFont())
         return 0;
+    if (_metrics)
+        return _metrics->ascender();
 
     int ascender;
     _font->GetAscender(_font, &ascender);
@@ -110,6 +128,8 @@ Font::descender()
     ILOG_TRACE(ILX_FONT);
     if (!loadFont())
         return 0;
+    if (_metrics)
+        return _metrics->descender();
 
     int descender;
     _font->GetDescender(_font, &descender);
@@ -122,6 +142,8 @@ Font::leading()
     ILOG_TRACE(ILX_FONT);
     if (!loadFont())
         return 0;
+    if (_metrics)
+        return _metrics->height();
 
     int height;
     _font->GetHeight(_font, &height);
@@ -134,6 +156,9 @@ Font::extents(const std::string& text, int bytes)
     ILOG_TRACE(ILX_FONT);
     if (!loadFont())
         return Size();
+    // logical extents of text are its width and font height.
+    if (_metrics)
+        return Size(_metrics->textWidth(text.c_str(), bytes) + 1, _metrics->height());
     DFBRectangle rect;
     _font->GetStringExtents(_font, text.c_str(), bytes, &rect, NULL);
     ILOG_DEBUG(ILX_FONT, " -> \"%s\" (%d, %d, %d, %d)\n", text.c_str(), rect.x, rect.y, rect.w, rect.h);
@@ -158,6 +183,8 @@ Font::glyphAdvance(unsigned int c)
     ILOG_TRACE(ILX_FONT);
     if (!loadFont())
         return 0;
+    if (_metrics)
+        return _metrics->advance(c);
 
     int r;
     _font->GetGlyphExtents(_font, c, NULL, &r);
@@ -170,6 +197,11 @@ Font::stringBreak(const char* text, int offset, int maxWidth, int* lineWidth, in
     ILOG_TRACE(ILX_FONT);
     if (!loadFont())
         return;
+    if (_metrics)
+    {
+        _metrics->stringBreak(text, offset, maxWidth, lineWidth, length, nextLine);
+        return;
+    }
 
     DFBResult ret = _font->GetStringBreak(_font, text, offset, maxWidth, lineWidth, length, nextLine);
     ILOG_DEBUG(ILX_FONT, " -> text: %s - offset: %d - maxWidth: %d - lineWidth: %d - length: %d - nextLine: %s\n", text, offset, maxWidth, *lineWidth, *length, *nextLine);
@@ -188,6 +220,8 @@ Font::textWidth(const std::string& text, int offset)
     ILOG_TRACE(ILX_FONT);
     if (!loadFont())
         return 0;
+    if (_metrics)
+        return _metrics->textWidth(text.c_str(), offset);
 
     int width;
     _font->GetStringWidth(_font, text.c_str(), offset, &width);
@@ -213,6 +247,7 @@ Font::setEncoding(DFBTextEncodingID encoding)
         return;
 
     _font->SetEncoding(_font, encoding);
+    _metrics = NULL;
 }
 
 void
@@ -242,7 +277,7 @@ Font::operator=(const Font& font)
         {
             ILOG_DEBUG(ILX_FONT, " -> %s\n", toString().c_str());
             release();
-            _key = FontCache::Instance()->getEntry(_name, _size, _attr, &_font);
+            _key = FontCache::Instance()->getEntry(_name, _size, _attr, &_font, &_metrics);
             _modified = false;
         } else
             _modified = true;
@@ -305,7 +340,7 @@ Font::loadFont()
     if (_modified)
     {
         release();
-        _key = FontCache::Instance()->getEntry(_name, _size, _attr, &_font);
+        _key = FontCache::Instance()->getEntry(_name, _size, _attr, &_font, &_metrics);
         ILOG_DEBUG(ILX_FONT, " -> Font: %p key: %u\n", _font, _key);
         _modified = false;
         if (!_font)
@@ -324,6 +359,7 @@ Font::release()
         FontCache::Instance()->releaseEntry(_key);
         _font = NULL;
         _key = 0;
+        _metrics = NULL;
     }
 }
 
@@ -35,10 +35,15 @@
 
 namespace ilixi
 {
+class FontMetrics;
+
 //! Specifies a font for drawing text.
 /*!
  * This class enables to set and query attributes of a font. It also
  * provides measurement information for laying out text.
+ *
+ * Measurements except glyphExtents() use client side FontMetrics of the
+ * FontCache entry if available.
  */
 class Font
 {
@@ -87,6 +92,14 @@ public:
     const std::string&
     name() const;
 
+    /*!
+     * Returns the FontCache key of font, loads font if necessary.
+     *
+     * Fonts with the same name, size and style share the same key.
+     */
+    unsigned int
+    key();
+
     /*!
      * Returns distance from the baseline to the ascender line.
      *
@@ -179,6 +192,8 @@ public:
 
     /*!
      * Sets the default encoding for font.
+     *
+     * Client side metrics assume UTF-8, so they are not used afterwards.
      */
     void
     setEncoding(DFBTextEncodingID encoding);
@@ -234,6 +249,8 @@ private:
     unsigned int _ref;
     //! Key returned from FontCache.
     unsigned int _key;
+    //! Metrics of FontCache entry, NULL if disabled or encoding is changed.
+    FontMetrics* _metrics;
 
     //! Applies font to surface.
     bool
@@ -27,8 +27,8 @@
 #include <core/PlatformManager.h>
 #include <core/Logger.h>
 #include <ilixiConfig.h>
-#include <sstream>
 #include <fontconfig/fontconfig.h>
+#include <stdlib.h>
 
 namespace ilixi
 {
@@ -50,8 +50,14 @@ FontCache::Instance()
 }
 
 FontCache::FontCache()
+        : _useMetrics(true)
 {
-    pthread_mutex_init(&_lock, NULL);
+    char* var = getenv("ILX_FONTMETRICS");
+    if (var && atoi(var) == 0)
+        _useMetrics = false;
+    pthread_rwlock_init(&_lock, NULL);
+    pthread_mutex_init(&_loadLock, NULL);
+    pthread_cond_init(&_loadCond, NULL);
 }
 
 FontCache::FontCache(FontCache const&)
@@ -67,38 +73,53 @@ FontCache::operator=(FontCache const&)
 FontCache::~FontCache()
 {
     releaseAllEntries();
-    pthread_mutex_destroy(&_lock);
+    pthread_cond_destroy(&_loadCond);
+    pthread_mutex_destroy(&_loadLock);
+    pthread_rwlock_destroy(&_lock);
 }
 
 unsigned int
 FontCache::getKey(const std::string& name, int size, DFBFontAttributes attr)
 {
     ILOG_TRACE_F(ILX_FONTCACHE);
-    std::stringstream ss;
-    ss << name << size << attr;
-    return createHash(ss.str());
+    FontKey fontKey(0, size, attr);
+
+    pthread_rwlock_rdlock(&_lock);
+    FamilyMap::iterator family = _families.find(name);
+    if (family != _families.end())
+    {
+        fontKey.family = family->second;
+        KeyMap::iterator it = _keys.find(fontKey);
+        if (it != _keys.end())
+        {
+            unsigned int key = it->second;
+            pthread_rwlock_unlock(&_lock);
+            return key;
+        }
+    }
+    pthread_rwlock_unlock(&_lock);
+
+    // keys start from 1, since 0 is used for fonts which are not loaded.
+    pthread_rwlock_wrlock(&_lock);
+    fontKey.family = _families.insert(std::make_pair(name, (unsigned int) _families.size() + 1)).first->second;
+    unsigned int key = _keys.insert(std::make_pair(fontKey, (unsigned int) _keys.size() + 1)).first->second;
+    pthread_rwlock_unlock(&_lock);
+    ILOG_DEBUG(ILX_FONTCACHE, " -> New key (%u) for family (%u), size (%d), attr (0x%x)\n", key, fontKey.family, size, attr);
+    return key;
 }
 
 unsigned int
-FontCache::getEntry(const std::string& name, int size, DFBFontAttributes attr, IDirectFBFont** font)
+FontCache::getEntry(const std::string& name, int size, DFBFontAttributes attr, IDirectFBFont** font, FontMetrics** metrics)
 {
     ILOG_TRACE_F(ILX_FONTCACHE);
     ILOG_DEBUG(ILX_FONTCACHE, " -> name: %s\n", name.c_str());
     ILOG_DEBUG(ILX_FONTCACHE, " -> size: %d\n", size);
-    std::string style = "regular";
-    int slant = 0;
-
-#if ILIXI_DFB_VERSION >= VERSION_CODE(1,6,0)
-    if (attr & DFFA_STYLE_BOLD)
-        style = "bold";
-
-    if (attr & DFFA_STYLE_ITALIC)
-        slant = FC_SLANT_ITALIC;
-#endif
-    ILOG_DEBUG(ILX_FONTCACHE, " -> style: %s\n", style.c_str());
     unsigned int key = getKey(name, size, attr);
     ILOG_DEBUG(ILX_FONTCACHE, " -> key: %u\n", key);
-    *font = getEntryFromFile(key, name, style, slant, size, attr);
+    FontMetrics* fontMetrics = NULL;
+    *font = getEntryFromFile(key, name, size, attr, &fontMetrics);
+    if (metrics)
+        *metrics = fontMetrics;
     return key;
 }
 
@@ -106,23 +127,24 @@ void
 FontCache::releaseEntry(unsigned int key)
 {
     ILOG_TRACE_F(ILX_FONTCACHE);
-    pthread_mutex_lock(&_lock);
+    pthread_rwlock_wrlock(&_lock);
     CacheMap::iterator it = _cache.find(key);
     if (it != _cache.end())
     {
         if (--(it->second.ref))
         {
             ILOG_DEBUG(ILX_FONTCACHE, " -> Decrement ref counter for entry (%u)\n", key);
-            pthread_mutex_unlock(&_lock);
+            pthread_rwlock_unlock(&_lock);
             return;
         }
         // remove entry...
         ILOG_DEBUG(ILX_FONTCACHE, " -> Release font for entry (%u)\n", key);
+        delete it->second.metrics;
         it->second.font->Release(it->second.font);
         _cache.erase(it);
     } else
         ILOG_DEBUG(ILX_FONTCACHE, " -> Key (%u) not found.\n", key);
-    pthread_mutex_unlock(&_lock);
+    pthread_rwlock_unlock(&_lock);
 }
 
 void
@@ -135,54 +157,119 @@ void
 FontCache::logEntries()
 {
     ILOG_TRACE_F(ILX_FONTCACHE);
-    pthread_mutex_lock(&_lock);
+    pthread_rwlock_rdlock(&_lock);
     ILOG_DEBUG(ILX_FONTCACHE, " -> Map size: %d\n", _cache.size());
     for (CacheMap::iterator it = _cache.begin(); it != _cache.end(); ++it)
         ILOG_DEBUG(ILX_FONTCACHE, "   -> %u: %p\n", it->first, it->second.font);
-    pthread_mutex_unlock(&_lock);
+    ILOG_DEBUG(ILX_FONTCACHE, " -> Matched files: %d\n", _files.size());
+    for (FileMap::iterator it = _files.begin(); it != _files.end(); ++it)
+        ILOG_DEBUG(ILX_FONTCACHE, "   -> %u (%d): %s\n", it->first.first, it->first.second, it->second.c_str());
+    pthread_rwlock_unlock(&_lock);
 }
 
 IDirectFBFont*
-FontCache::getEntryFromFile(unsigned int key, const std::string& name, const std::string& style, int slant, int size, DFBFontAttributes attr)
+FontCache::getEntryFromFile(unsigned int key, const std::string& name, int size, DFBFontAttributes attr, FontMetrics** metrics)
 {
     ILOG_TRACE_F(ILX_FONTCACHE);
+    IDirectFBFont* font = getCachedEntry(key, metrics);
+    if (font)
+        return font;
 
-    pthread_mutex_lock(&_lock);
-    CacheMap::iterator it = _cache.find(key);
-    if (it == _cache.end())
-    {
-        // load and insert
-        IDirectFBFont* font;
-        DFBFontDescription desc;
-
-        desc.flags = (DFBFontDescriptionFlags) (DFDESC_HEIGHT | DFDESC_ATTRIBUTES);
-        desc.height = size;
-        desc.attributes = attr;
-        std::string file = getFCFileName(name.c_str(), style.c_str(), size, slant);
-        DFBResult ret = PlatformManager::instance().getDFB()->CreateFont(PlatformManager::instance().getDFB(), file.c_str(), &desc, &font);
-        if (ret)
-        {
-            ILOG_WARNING(ILX_FONTCACHE, " -> Loading failed for (%s, %d)!\n", file.c_str(), size);
-            ILOG_WARNING(ILX_FONTCACHE, " -> Error: %s\n", DirectFBErrorString(ret));
-            pthread_mutex_unlock(&_lock);
-            return NULL;
-        }
+    // wait if another thread is loading same font.
+    pthread_mutex_lock(&_loadLock);
+    while (_loading.find(key) != _loading.end())
+        pthread_cond_wait(&_loadCond, &_loadLock);
 
-        CacheMap::iterator it2 = _cache.begin();
-        FontData data(font);
-        _cache.insert(it2, std::pair<unsigned int, FontData>(key, data));
+    font = getCachedEntry(key, metrics);
+    if (font)
+    {
+        pthread_mutex_unlock(&_loadLock);
+        return font;
+    }
+    _loading.insert(key);
+    pthread_mutex_unlock(&_loadLock);
+
+    // load without holding locks.
+    DFBFontDescription desc;
+    desc.flags = (DFBFontDescriptionFlags) (DFDESC_HEIGHT | DFDESC_ATTRIBUTES);
+    desc.height = size;
+    desc.attributes = attr;
+    std::string file = getFileName(name, size, attr);
+    DFBResult ret = PlatformManager::instance().getDFB()->CreateFont(PlatformManager::instance().getDFB(), file.c_str(), &desc, &font);
+    if (ret)
+    {
+        ILOG_WARNING(ILX_FONTCACHE, " -> Loading failed for (%s, %d)!\n", file.c_str(), size);
+        ILOG_WARNING(ILX_FONTCACHE, " -> Error: %s\n", DirectFBErrorString(ret));
+        font = NULL;
+    } else
+    {
+        // metrics are queried before entry is visible to other threads.
+        *metrics = _useMetrics ? new FontMetrics(font) : NULL;
+        pthread_rwlock_wrlock(&_lock);
+        _cache.insert(std::make_pair(key, FontData(font, *metrics)));
+        pthread_rwlock_unlock(&_lock);
         ILOG_DEBUG(ILX_FONTCACHE, " -> Cached key (%u) for (%s, %d)\n", key, file.c_str(), size);
-        pthread_mutex_unlock(&_lock);
+    }
 
-        return font;
+    pthread_mutex_lock(&_loadLock);
+    _loading.erase(key);
+    pthread_cond_broadcast(&_loadCond);
+    pthread_mutex_unlock(&_loadLock);
+    return font;
+}
 
-    } else
+IDirectFBFont*
+FontCache::getCachedEntry(unsigned int key, FontMetrics** metrics)
+{
+    IDirectFBFont* font = NULL;
+    pthread_rwlock_rdlock(&_lock);
+    CacheMap::iterator it = _cache.find(key);
+    if (it != _cache.end())
     {
         ILOG_DEBUG(ILX_FONTCACHE, " -> Got from cache using key: %u\n", key);
-        it->second.ref++;
-        pthread_mutex_unlock(&_lock);
-        return it->second.font;
+        __sync_add_and_fetch(&it->second.ref, 1);
+        font = it->second.font;
+        *metrics = it->second.metrics;
     }
+    pthread_rwlock_unlock(&_lock);
+    return font;
+}
+
+std::string
+FontCache::getFileName(const std::string& name, int size, DFBFontAttributes attr)
+{
+    ILOG_TRACE_F(ILX_FONTCACHE);
+    std::string style = "regular";
+    int slant = 0;
+
+#if ILIXI_DFB_VERSION >= VERSION_CODE(1,6,0)
+    if (attr & DFFA_STYLE_BOLD)
+        style = "bold";
+
+    if (attr & DFFA_STYLE_ITALIC)
+        slant = FC_SLANT_ITALIC;
+#endif
+    ILOG_DEBUG(ILX_FONTCACHE, " -> style: %s\n", style.c_str());
+
+    pthread_rwlock_rdlock(&_lock);
+    // family is always registered by getKey() before loading.
+    FamilyMap::iterator family = _families.find(name);
+    std::pair<unsigned int, int> fileKey(family != _families.end() ? family->second : 0, (slant << 1) | (style == "bold"));
+    FileMap::iterator it = _files.find(fileKey);
+    if (it != _files.end())
+    {
+        std::string file = it->second;
+        pthread_rwlock_unlock(&_lock);
+        return file;
+    }
+    pthread_rwlock_unlock(&_lock);
+
+    std::string file = getFCFileName(name.c_str(), style.c_str(), size, slant);
+
+    pthread_rwlock_wrlock(&_lock);
+    _files.insert(std::make_pair(fileKey, file));
+    pthread_rwlock_unlock(&_lock);
+    return file;
 }
 
 std::string
@@ -219,11 +306,15 @@ void
 FontCache::releaseAllEntries()
 {
     ILOG_TRACE_F(ILX_FONTCACHE);
-    pthread_mutex_lock(&_lock);
+    pthread_rwlock_wrlock(&_lock);
     for (CacheMap::iterator it = _cache.begin(); it != _cache.end(); ++it)
+    {
+        delete it->second.metrics;
         it->second.font->Release(it->second.font);
+    }
     _cache.clear();
-    pthread_mutex_unlock(&_lock);
+    _files.clear();
+    pthread_rwlock_unlock(&_lock);
 }
 
 } /* namespace ilixi */
@@ -27,8 +27,10 @@
 
 #include <pthread.h>
 #include <map>
+#include <set>
 #include <directfb.h>
 #include <string>
+#include <types/FontMetrics.h>
 
 namespace ilixi
 {
@@ -37,6 +39,16 @@ namespace ilixi
  * FontCache stores a map of loaded fonts for ease of .
  *
  * Fontconfig is used for finding fonts with given parameters.
+ *
+ * Fonts are identified by a structured key made of family id, size and
+ * attributes, which maps to a numeric key that stays the same for the
+ * lifetime of cache. Cache hits only take a reader lock. Fonts are loaded
+ * outside of locks and concurrent requests for the same font wait for a
+ * single load. Files matched by fontconfig are stored per family and
+ * style, so loading a new size of a known family skips matching.
+ *
+ * Each entry also stores FontMetrics, so text can be measured without calling
+ * IDirectFBFont. Set ILX_FONTMETRICS=0 to disable client side metrics.
  */
 class FontCache
 {
@@ -49,7 +61,7 @@ public:
     Instance();
 
     /*!
-     * Returns a hash value for given font parameters.
+     * Returns a key for given font parameters.
      *
      * @param name Font name, e.g. Sans.
      * @param size Font size, e.g. 12.
@@ -59,18 +71,19 @@ public:
     getKey(const std::string& name, int size, DFBFontAttributes attr);
 
     /*!
-     * Returns a font and a hash value for given font parameters.
+     * Returns a font and a key for given font parameters.
      *
      * @param name Font name, e.g. Sans.
      * @param size Font size, e.g. 12.
      * @param attr DirectFB font attributes.
      * @param font This parameter is set with requested font.
+     * @param metrics If not NULL, set to metrics of font, or NULL if metrics are disabled.
      */
     unsigned int
-    getEntry(const std::string& name, int size, DFBFontAttributes attr, IDirectFBFont** font);
+    getEntry(const std::string& name, int size, DFBFontAttributes attr, IDirectFBFont** font, FontMetrics** metrics = NULL);
 
     /*!
-     * Releases reference to font with given hash value.
+     * Releases reference to font with given key.
      */
     void
     releaseEntry(unsigned int key);
@@ -92,24 +105,75 @@ public:
     logEntries();
 
 private:
-    //! This mutex locks cache map for access.
-    pthread_mutex_t _lock;
+    //! This lock protects maps, cache hits only take a reader lock.
+    pthread_rwlock_t _lock;
+    //! This mutex protects _loading.
+    pthread_mutex_t _loadLock;
+    //! Signalled when a font load is finished.
+    pthread_cond_t _loadCond;
+
+    struct FontKey
+    {
+        FontKey(unsigned int f, int s, DFBFontAttributes a)
+                : family(f),
+                  size(s),
+                  attr(a)
+        {
+        }
+
+        bool
+        operator<(const FontKey& other) const
+        {
+            if (family != other.family)
+                return family < other.family;
+            if (size != other.size)
+                return size < other.size;
+            return attr < other.attr;
+        }
+
+        unsigned int family;
+        int size;
+        DFBFontAttributes attr;
+    };
 
     struct FontData
     {
-        FontData(IDirectFBFont* f)
+        FontData(IDirectFBFont* f, FontMetrics* m)
                 : font(f),
+                  metrics(m),
                   ref(1)
         {
         }
 
         IDirectFBFont* font;
+        //! Owned by entry, NULL if metrics are disabled.
+        FontMetrics* metrics;
+        //! Incremented atomically while holding reader lock.
         unsigned int ref;
     };
 
+    //! Maps family names to ids.
+    typedef std::map<std::string, unsigned int> FamilyMap;
+    FamilyMap _families;
+
+    //! Maps font parameters to keys.
+    typedef std::map<FontKey, unsigned int> KeyMap;
+    KeyMap _keys;
+
+    //! Maps family id and style to file matched by fontconfig.
+    typedef std::map<std::pair<unsigned int, int>, std::string> FileMap;
+    FileMap _files;
+
+    //! Maps keys to loaded fonts.
     typedef std::map<unsigned int, FontData> CacheMap;
     CacheMap _cache;
 
+    //! Keys of fonts which are being loaded.
+    std::set<unsigned int> _loading;
+
+    //! True if FontMetrics are created for entries.
+    bool _useMetrics;
+
     FontCache();
 
     FontCache(FontCache const&);
@@ -121,7 +185,15 @@ private:
     ~FontCache();
 
     IDirectFBFont*
-    getEntryFromFile(unsigned int key, const std::string& name, const std::string& style, int slant, int size, DFBFontAttributes attr);
+    getEntryFromFile(unsigned int key, const std::string& name, int size, DFBFontAttributes attr, FontMetrics** metrics);
+
+    //! Returns cached font and its metrics and increments its reference count, or NULL.
+    IDirectFBFont*
+    getCachedEntry(unsigned int key, FontMetrics** metrics);
+
+    //! Returns file for family and style, uses fontconfig only once per family and style.
+    std::string
+    getFileName(const std::string& name, int size, DFBFontAttributes attr);
 
     std::string
     getFCFileName(const char* name, const char* style, double size, int slant);
@@ -0,0 +1,359 @@
+/*
+ Copyright 2010-2015 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <types/FontMetrics.h>
+#include <core/Logger.h>
+#include <limits.h>
+#include <string.h>
+
+namespace ilixi
+{
+
+D_DEBUG_DOMAIN(ILX_FONTMETRICS, "ilixi/types/FontMetrics", "FontMetrics");
+
+//! Marks advances and kerning values which are not queried yet.
+#define ADVANCE_UNKNOWN SHRT_MIN
+#define KERNING_UNKNOWN SCHAR_MIN
+
+//! Decodes UTF-8 character at text and advances text, invalid bytes are returned as is.
+static unsigned int
+decodeChar(const unsigned char*& text, const unsigned char* end)
+{
+    unsigned int c = *text++;
+    if (c < 0x80)
+        return c;
+
+    int extra;
+    if ((c & 0xE0) == 0xC0)
+    {
+        extra = 1;
+        c &= 0x1F;
+    } else if ((c & 0xF0) == 0xE0)
+    {
+        extra = 2;
+        c &= 0x0F;
+    } else if ((c & 0xF8) == 0xF0)
+    {
+        extra = 3;
+        c &= 0x07;
+    } else
+        return c;
+
+    if (end - text < extra)
+        return c;
+
+    for (int i = 0; i < extra; ++i)
+    {
+        if ((text[i] & 0xC0) != 0x80)
+            return c;
+        c = (c << 6) | (text[i] & 0x3F);
+    }
+    text += extra;
+    return c;
+}
+
+FontMetrics::FontMetrics(IDirectFBFont* font)
+        : _font(font),
+          _ascender(0),
+          _descender(0),
+          _height(0),
+          _kerning(false),
+          _asciiKerning(NULL)
+{
+    ILOG_TRACE(ILX_FONTMETRICS);
+    pthread_mutex_init(&_kerningLock, NULL);
+    _font->GetAscender(_font, &_ascender);
+    _font->GetDescender(_font, &_descender);
+    _font->GetHeight(_font, &_height);
+
+    _kerning = hasKerning();
+    if (_kerning)
+    {
+        _asciiKerning = new signed char[128 * 128];
+        memset(_asciiKerning, KERNING_UNKNOWN, 128 * 128);
+    }
+
+    for (unsigned int c = 0; c < 128; ++c)
+        _ascii[c] = ADVANCE_UNKNOWN;
+    memset(_pages, 0, sizeof(_pages));
+    ILOG_DEBUG(ILX_FONTMETRICS, " -> ascender: %d descender: %d height: %d kerning: %d\n", _ascender, _descender, _height, _kerning);
+}
+
+FontMetrics::~FontMetrics()
+{
+    ILOG_TRACE(ILX_FONTMETRICS);
+    for (int i = 0; i < 256; ++i)
+        delete[] _pages[i];
+    delete[] _asciiKerning;
+    pthread_mutex_destroy(&_kerningLock);
+}
+
+int
+FontMetrics::ascender() const
+{
+    return _ascender;
+}
+
+int
+FontMetrics::descender() const
+{
+    return _descender;
+}
+
+int
+FontMetrics::height() const
+{
+    return _height;
+}
+
+bool
+FontMetrics::kerning() const
+{
+    return _kerning;
+}
+
+inline int
+FontMetrics::asciiAdvance(unsigned int c)
+{
+    if (_ascii[c] == ADVANCE_UNKNOWN)
+        _ascii[c] = queryAdvance(c);
+    return _ascii[c];
+}
+
+int
+FontMetrics::advance(unsigned int c)
+{
+    if (c < 128)
+        return asciiAdvance(c);
+    if (c > 0xFFFF)
+        return queryAdvance(c);
+
+    short* page = _pages[c >> 8];
+    if (!page)
+    {
+        page = new short[256];
+        for (int i = 0; i < 256; ++i)
+            page[i] = ADVANCE_UNKNOWN;
+        // another thread may have allocated same page.
+        if (!__sync_bool_compare_and_swap(&_pages[c >> 8], (short*) NULL, page))
+        {
+            delete[] page;
+            page = _pages[c >> 8];
+        }
+    }
+
+    short advance = page[c & 0xFF];
+    if (advance == ADVANCE_UNKNOWN)
+    {
+        advance = queryAdvance(c);
+        page[c & 0xFF] = advance;
+    }
+    return advance;
+}
+
+int
+FontMetrics::kerning(unsigned int prev, unsigned int current)
+{
+    if (!_kerning)
+        return 0;
+
+    if (prev < 128 && current < 128)
+    {
+        signed char& kx = _asciiKerning[(prev << 7) | current];
+        if (kx == KERNING_UNKNOWN)
+        {
+            int value = queryKerning(prev, current);
+            kx = value < -127 ? -127 : (value > 127 ? 127 : value);
+        }
+        return kx;
+    }
+
+    std::pair<unsigned int, unsigned int> pair(prev, current);
+    pthread_mutex_lock(&_kerningLock);
+    KerningMap::const_iterator it = _kerningPairs.find(pair);
+    if (it != _kerningPairs.end())
+    {
+        int kx = it->second;
+        pthread_mutex_unlock(&_kerningLock);
+        return kx;
+    }
+    pthread_mutex_unlock(&_kerningLock);
+
+    int kx = queryKerning(prev, current);
+    pthread_mutex_lock(&_kerningLock);
+    _kerningPairs.insert(std::make_pair(pair, kx));
+    pthread_mutex_unlock(&_kerningLock);
+    return kx;
+}
+
+int
+FontMetrics::textWidth(const char* text, int bytes)
+{
+    if (!text)
+        return 0;
+
+    const unsigned char* p = (const unsigned char*) text;
+    const unsigned char* end = p + (bytes < 0 ? strlen(text) : bytes);
+    unsigned int prev = 0;
+    int width = 0;
+    while (p < end && *p)
+    {
+        if (*p < 0x80 && !_kerning)
+        {
+            const unsigned char* run = p;
+            while (p < end && *p && *p < 0x80)
+                ++p;
+            width += asciiWidth(run, p - run);
+            prev = p[-1];
+            continue;
+        }
+
+        unsigned int c = decodeChar(p, end);
+        width += advance(c);
+        if (prev)
+            width += kerning(prev, c);
+        prev = c;
+    }
+    return width;
+}
+
+void
+FontMetrics::stringBreak(const char* text, int bytes, int maxWidth, int* lineWidth, int* length, const char** nextLine)
+{
+    *lineWidth = 0;
+    *length = 0;
+    *nextLine = NULL;
+    if (!text)
+        return;
+
+    const unsigned char* p = (const unsigned char*) text;
+    const unsigned char* end = p + (bytes < 0 ? strlen(text) : bytes);
+    unsigned int prev = 0;
+    int width = 0;
+    int chars = 0;
+    bool hasBreak = false;
+    while (p < end && *p)
+    {
+        const unsigned char* current = p;
+        unsigned int c = decodeChar(p, end);
+        if (c == '\n')
+        {
+            *lineWidth = width;
+            *length = chars;
+            *nextLine = (const char*) p;
+            return;
+        }
+
+        if (c == ' ')
+        {
+            hasBreak = true;
+            *lineWidth = width;
+            *length = chars;
+            *nextLine = (const char*) p;
+        }
+
+        int next = width + advance(c);
+        if (prev)
+            next += kerning(prev, c);
+
+        if (next > maxWidth)
+        {
+            if (hasBreak)
+                return;
+
+            // a line has at least one character.
+            if (!chars)
+            {
+                width = next;
+                chars = 1;
+                current = p;
+            }
+            *lineWidth = width;
+            *length = chars;
+            *nextLine = (current < end && *current) ? (const char*) current : NULL;
+            return;
+        }
+
+        width = next;
+        ++chars;
+        prev = c;
+    }
+
+    *lineWidth = width;
+    *length = chars;
+    *nextLine = NULL;
+}
+
+int
+FontMetrics::asciiWidth(const unsigned char* text, int length)
+{
+    // independent sums let compiler pipeline table lookups.
+    int w0 = 0, w1 = 0, w2 = 0, w3 = 0;
+    int i = 0;
+    for (; i + 4 <= length; i += 4)
+    {
+        w0 += asciiAdvance(text[i]);
+        w1 += asciiAdvance(text[i + 1]);
+        w2 += asciiAdvance(text[i + 2]);
+        w3 += asciiAdvance(text[i + 3]);
+    }
+    for (; i < length; ++i)
+        w0 += asciiAdvance(text[i]);
+    return w0 + w1 + w2 + w3;
+}
+
+bool
+FontMetrics::hasKerning()
+{
+    // FT2 fonts report success for any pair, so a non-zero value is required.
+    static const char* pairs[] = { "AV", "AW", "AY", "AT", "LT", "LV", "TA", "Te", "To", "VA", "Va", "WA", "Yo", "P.", "F," };
+    for (unsigned int i = 0; i < sizeof(pairs) / sizeof(pairs[0]); ++i)
+    {
+        int kx = 0;
+        if (_font->GetKerning(_font, pairs[i][0], pairs[i][1], &kx, NULL) != DFB_OK)
+            return false;
+        if (kx)
+            return true;
+    }
+    return false;
+}
+
+int
+FontMetrics::queryAdvance(unsigned int c)
+{
+    int advance = 0;
+    if (_font->GetGlyphExtents(_font, c, NULL, &advance) != DFB_OK)
+        return 0;
+    return advance;
+}
+
+int
+FontMetrics::queryKerning(unsigned int prev, unsigned int current)
+{
+    int kx = 0;
+    if (_font->GetKerning(_font, prev, current, &kx, NULL) != DFB_OK)
+        return 0;
+    return kx;
+}
+
+} /* namespace ilixi */
@@ -0,0 +1,166 @@
+/*
+ Copyright 2010-2015 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ILIXI_FONTMETRICS_H_
+#define ILIXI_FONTMETRICS_H_
+
+#include <directfb.h>
+#include <pthread.h>
+#include <map>
+
+namespace ilixi
+{
+//! Client side metrics of a loaded font.
+/*!
+ * IDirectFBFont methods may require a round trip to DirectFB master in multi
+ * application mode. FontMetrics stores ascender, descender, height and glyph
+ * advances of a font, so text width and line breaks are calculated locally.
+ *
+ * Advances are stored in tables of 256 characters which are allocated for
+ * pages of the Basic Multilingual Plane as they are used. Advances of ASCII
+ * characters are stored in a fixed table and queried on first use. Kerning
+ * pairs are cached if font has kerning values.
+ *
+ * Metrics are owned by FontCache entries and can be used by multiple threads.
+ */
+class FontMetrics
+{
+public:
+    /*!
+     * Queries metrics of font.
+     */
+    FontMetrics(IDirectFBFont* font);
+
+    /*!
+     * Destructor.
+     */
+    ~FontMetrics();
+
+    /*!
+     * Returns the distance from baseline to top.
+     */
+    int
+    ascender() const;
+
+    /*!
+     * Returns the distance from baseline to bottom, a negative value.
+     */
+    int
+    descender() const;
+
+    /*!
+     * Returns the distance between two lines of text.
+     */
+    int
+    height() const;
+
+    /*!
+     * Returns true if font has kerning values for common pairs.
+     */
+    bool
+    kerning() const;
+
+    /*!
+     * Returns advance of character c.
+     */
+    int
+    advance(unsigned int c);
+
+    /*!
+     * Returns horizontal kerning between characters prev and current.
+     */
+    int
+    kerning(unsigned int prev, unsigned int current);
+
+    /*!
+     * Returns logical width of UTF-8 text, same as IDirectFBFont::GetStringWidth().
+     *
+     * @param text UTF-8 encoded text.
+     * @param bytes length of text in bytes, -1 for NUL terminated text.
+     */
+    int
+    textWidth(const char* text, int bytes);
+
+    /*!
+     * Finds next line break, same as IDirectFBFont::GetStringBreak().
+     *
+     * Text is broken after a space or newline character, or before the first
+     * character which exceeds maxWidth if line has no spaces.
+     *
+     * @param text UTF-8 encoded text.
+     * @param bytes length of text in bytes, -1 for NUL terminated text.
+     * @param maxWidth maximum width of line.
+     * @param lineWidth is set to width of line.
+     * @param length is set to number of characters in line.
+     * @param nextLine is set to start of next line or NULL if text ends.
+     */
+    void
+    stringBreak(const char* text, int bytes, int maxWidth, int* lineWidth, int* length, const char** nextLine);
+
+private:
+    //! Font is referenced by FontCache entry which owns metrics.
+    IDirectFBFont* _font;
+    //! This property stores ascender.
+    int _ascender;
+    //! This property stores descender.
+    int _descender;
+    //! This property stores height.
+    int _height;
+    //! True if font has kerning values, otherwise ASCII text is measured without kerning.
+    bool _kerning;
+    //! Advances of ASCII characters, queried on first use.
+    int _ascii[128];
+    //! Advances of BMP characters, pages are allocated on demand.
+    short* _pages[256];
+    //! Kerning of ASCII pairs, allocated if font has kerning values.
+    signed char* _asciiKerning;
+
+    typedef std::map<std::pair<unsigned int, unsigned int>, int> KerningMap;
+    //! Kerning of other pairs.
+    KerningMap _kerningPairs;
+    //! This mutex protects _kerningPairs.
+    pthread_mutex_t _kerningLock;
+
+    //! Returns advance of ASCII character c, querying it on first use.
+    int
+    asciiAdvance(unsigned int c);
+
+    //! Sums advances of ASCII characters without kerning.
+    int
+    asciiWidth(const unsigned char* text, int length);
+
+    //! Returns true if any of a few commonly kerned pairs has a kerning value.
+    bool
+    hasKerning();
+
+    //! Queries DirectFB for advance of c.
+    int
+    queryAdvance(unsigned int c);
+
+    //! Queries DirectFB for kerning between prev and current.
+    int
+    queryKerning(unsigned int prev, unsigned int current);
+};
+
+} /* namespace ilixi */
+#endif /* ILIXI_FONTMETRICS_H_ */
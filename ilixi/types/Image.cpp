@@ -22,7 +22,9 @@
  */
 
 #include <types/Image.h>
+#include <types/ImageCache.h>
 #include <core/PlatformManager.h>
+#include <lib/ImageLoader.h>
 #include <core/Logger.h>
 #include <graphics/Stylist.h>
 
@@ -36,7 +38,10 @@ Image::Image()
           _imagePath(""),
           _size(),
           _state(Initialised),
-          _caps(DICAPS_NONE)
+          _caps(DICAPS_NONE),
+          _loadMode(Synchronous),
+          _loadPriority(ImageLoader::NormalPriority),
+          _placeholder(0, 0, 0, 0)
 {
     ILOG_TRACE(ILX_IMAGE);
 }
@@ -46,7 +51,10 @@ Image::Image(const std::string& path)
           _imagePath(path),
           _size(),
           _state(Initialised),
-          _caps(DICAPS_NONE)
+          _caps(DICAPS_NONE),
+          _loadMode(Synchronous),
+          _loadPriority(ImageLoader::NormalPriority),
+          _placeholder(0, 0, 0, 0)
 {
     ILOG_TRACE(ILX_IMAGE);
     ILOG_DEBUG(ILX_IMAGE, " -> path: %s\n", _imagePath.c_str());
@@ -57,7 +65,10 @@ Image::Image(const std::string& path, int width, int height)
           _imagePath(path),
           _size(width, height),
           _state(Initialised),
-          _caps(DICAPS_NONE)
+          _caps(DICAPS_NONE),
+          _loadMode(Synchronous),
+          _loadPriority(ImageLoader::NormalPriority),
+          _placeholder(0, 0, 0, 0)
 {
     ILOG_TRACE(ILX_IMAGE);
     ILOG_DEBUG(ILX_IMAGE, " -> path: %s - width: %d height: %d\n", _imagePath.c_str(), _size.width(), _size.height());
@@ -68,7 +79,10 @@ Image::Image(const std::string& path, const Size& size)
           _imagePath(path),
           _size(size),
           _state(Initialised),
-          _caps(DICAPS_NONE)
+          _caps(DICAPS_NONE),
+          _loadMode(Synchronous),
+          _loadPriority(ImageLoader::NormalPriority),
+          _placeholder(0, 0, 0, 0)
 {
     ILOG_TRACE(ILX_IMAGE);
     ILOG_DEBUG(ILX_IMAGE, " -> path: %s - size: %d, %d\n", _imagePath.c_str(), _size.width(), _size.height());
@@ -79,7 +93,10 @@ Image::Image(Image* source, const Rectangle& sourceRect)
           _imagePath(""),
           _size(sourceRect.size()),
           _state((ImageFlags) (Initialised | SubImage)),
-          _caps(source->_caps)
+          _caps(source->_caps),
+          _loadMode(Synchronous),
+          _loadPriority(ImageLoader::NormalPriority),
+          _placeholder(0, 0, 0, 0)
 {
     ILOG_TRACE(ILX_IMAGE);
     ILOG_DEBUG(ILX_IMAGE, " -> SubImage of %p - size: %d, %d\n", source, _size.width(), _size.height());
@@ -87,12 +104,32 @@ Image::Image(Image* source, const Rectangle& sourceRect)
     loadSubImage(source, sourceRect);
 }
 
+Image::Image(IDirectFBSurface* surface)
+        : _dfbSurface(surface),
+          _imagePath(""),
+          _size(),
+          _state((ImageFlags) (Initialised | SubImage | Ready)),
+          _caps(DICAPS_ALPHACHANNEL),
+          _loadMode(Synchronous),
+          _loadPriority(ImageLoader::NormalPriority),
+          _placeholder(0, 0, 0, 0)
+{
+    ILOG_TRACE(ILX_IMAGE);
+    int w, h;
+    _dfbSurface->GetSize(_dfbSurface, &w, &h);
+    _size = Size(w, h);
+    ILOG_DEBUG(ILX_IMAGE, " -> Surface %p - size: %d, %d\n", surface, w, h);
+}
+
 Image::Image(const Image& img)
         : _dfbSurface(NULL),
           _imagePath(img._imagePath),
           _size(img._size),
-          _state(img._state),
-          _caps(img._caps)
+          _state((ImageFlags) (img._state & ~Loading)),
+          _caps(img._caps),
+          _loadMode(img._loadMode),
+          _loadPriority(img._loadPriority),
+          _placeholder(img._placeholder)
 {
     ILOG_TRACE(ILX_IMAGE);
     if (_state & SubImage)
@@ -105,6 +142,7 @@ Image::Image(const Image& img)
 Image::~Image()
 {
     ILOG_TRACE(ILX_IMAGE);
+    cancelLoad();
     invalidateSurface();
 }
 
@@ -188,6 +226,36 @@ Image::getDFBSurface()
         return Stylist::_noImage->getDFBSurface();
 }
 
+bool
+Image::ready() const
+{
+    return _dfbSurface != NULL;
+}
+
+bool
+Image::loading() const
+{
+    return _state & Loading;
+}
+
+Image::LoadMode
+Image::loadMode() const
+{
+    return _loadMode;
+}
+
+int
+Image::loadPriority() const
+{
+    return _loadPriority;
+}
+
+const Color&
+Image::placeholder() const
+{
+    return _placeholder;
+}
+
 std::string
 Image::getImagePath() const
 {
@@ -201,6 +269,7 @@ Image::setImagePath(const std::string& path)
     if (path != _imagePath)
     {
         ILOG_DEBUG(ILX_IMAGE, " -> Path: %s\n", path.c_str());
+        cancelLoad();
         _imagePath = path;
         _state = Initialised;
         invalidateSurface();
@@ -221,18 +290,45 @@ Image::setSize(const Size& s)
 
     if (s.isValid() && s != _size)
     {
+        cancelLoad();
         invalidateSurface();
         _size = s;
     }
 }
 
+void
+Image::setLoadMode(LoadMode mode)
+{
+    _loadMode = mode;
+}
+
+void
+Image::setLoadPriority(int priority)
+{
+    if (priority != _loadPriority)
+    {
+        _loadPriority = priority;
+        if (_state & Loading)
+            ImageLoader::instance().setPriority(this, priority);
+    }
+}
+
+void
+Image::setPlaceholder(const Color& color)
+{
+    _placeholder = color;
+}
+
 void
 Image::invalidateSurface()
 {
     if (_dfbSurface)
     {
         ILOG_TRACE(ILX_IMAGE);
-        _dfbSurface->Release(_dfbSurface);
+        if (_state & SubImage)
+            _dfbSurface->Release(_dfbSurface);
+        else
+            ImageCache::instance().release(_dfbSurface);
         _dfbSurface = NULL;
         if (_state & SubImage)
             _state = (ImageFlags) (Initialised | SubImage);
@@ -262,26 +358,64 @@ Image::loadImage()
         return false;
     }
 
+    // image is needed now, so do not wait for ImageLoader.
+    cancelLoad();
+
     ILOG_DEBUG(ILX_IMAGE, " -> Loading image: %s\n", _imagePath.c_str());
+    _dfbSurface = ImageCache::instance().acquire(_imagePath, _size, &_caps);
+    if (!_dfbSurface)
+    {
+        _state = (ImageFlags) (_state | NotAvailable);
+        return false;
+    }
+
+    ILOG_DEBUG(ILX_IMAGE, " -> Image is loaded.\n");
+    _state = (ImageFlags) (_state | Ready);
+    return true;
+}
+
+void
+Image::cancelLoad()
+{
+    if (_state & Loading)
+        ImageLoader::instance().cancel(this);
+}
+
+void
+Image::setLoadedSurface(IDirectFBSurface* surface, DFBImageCapabilities caps)
+{
+    ILOG_TRACE(ILX_IMAGE);
+    invalidateSurface();
+    _state = (ImageFlags) (_state & ~Loading);
+    if (surface)
+    {
+        _dfbSurface = surface;
+        _caps = caps;
+        _state = (ImageFlags) (_state | Ready);
+    } else
+        _state = (ImageFlags) (_state | NotAvailable);
+}
+
+IDirectFBSurface*
+Image::decode(const std::string& path, const Size& size, DFBImageCapabilities* caps)
+{
     DFBSurfaceDescription desc;
+    IDirectFBSurface* surface = NULL;
 
     IDirectFBImageProvider* provider;
-    DFBResult ret = PlatformManager::instance().getDFB()->CreateImageProvider(PlatformManager::instance().getDFB(), _imagePath.c_str(), &provider);
+    DFBResult ret = PlatformManager::instance().getDFB()->CreateImageProvider(PlatformManager::instance().getDFB(), path.c_str(), &provider);
     if (ret)
     {
         ILOG_ERROR(ILX_IMAGE, "Cannot create image provider! %s\n", DirectFBErrorString(ret));
-        _state = (ImageFlags) (_state | NotAvailable);
-        return false;
+        return NULL;
     }
 
-    invalidateSurface();
-
     if (provider->GetSurfaceDescription(provider, &desc) != DFB_OK)
         ILOG_ERROR(ILX_IMAGE, "Cannot get surface description!\n");
 
     DFBImageDescription iDesc;
-    if (provider->GetImageDescription(provider, &iDesc) == DFB_OK)
-        _caps = iDesc.caps;
+    if (caps && provider->GetImageDescription(provider, &iDesc) == DFB_OK)
+        *caps = iDesc.caps;
 
     if (PlatformManager::instance().forcedPixelFormat() != DSPF_UNKNOWN)
     {
@@ -291,37 +425,29 @@ Image::loadImage()
         desc.flags = (DFBSurfaceDescriptionFlags) (desc.flags | DSDESC_CAPS | DSDESC_WIDTH | DSDESC_HEIGHT);
     desc.caps = DSCAPS_PREMULTIPLIED;
 
-    if (width() > 0)
-        desc.width = width();
-
-    if (height() > 0)
-        desc.height = height();
+    if (size.width() > 0)
+        desc.width = size.width();
 
-    ret = PlatformManager::instance().getDFB()->CreateSurface(PlatformManager::instance().getDFB(), &desc, &_dfbSurface);
+    if (size.height() > 0)
+        desc.height = size.height();
 
+    ret = PlatformManager::instance().getDFB()->CreateSurface(PlatformManager::instance().getDFB(), &desc, &surface);
     if (ret != DFB_OK)
     {
-        invalidateSurface();
         provider->Release(provider);
-        ILOG_ERROR(ILX_IMAGE, "Cannot create surface for %s - %s\n", _imagePath.c_str(), DirectFBErrorString(ret));
-        _state = (ImageFlags) (_state | NotAvailable);
-        return false;
-    } else
+        ILOG_ERROR(ILX_IMAGE, "Cannot create surface for %s - %s\n", path.c_str(), DirectFBErrorString(ret));
+        return NULL;
+    }
+
+    ret = provider->RenderTo(provider, surface, NULL);
+    provider->Release(provider);
+    if (ret != DFB_OK)
     {
-        ret = provider->RenderTo(provider, _dfbSurface, NULL);
-        if (ret != DFB_OK)
-        {
-            invalidateSurface();
-            provider->Release(provider);
-            ILOG_ERROR(ILX_IMAGE, "Cannot render image to surface! %s\n", DirectFBErrorString(ret));
-            _state = (ImageFlags) (_state | NotAvailable);
-            return false;
-        }
-        provider->Release(provider);
-        ILOG_DEBUG(ILX_IMAGE, " -> Image is loaded.\n");
-        _state = (ImageFlags) (_state | Ready);
-        return true;
+        surface->Release(surface);
+        ILOG_ERROR(ILX_IMAGE, "Cannot render image to surface! %s\n", DirectFBErrorString(ret));
+        return NULL;
     }
+    return surface;
 }
 
 DFBImageCapabilities
@@ -354,6 +480,7 @@ Image::loadSubImage(Image* source, const Rectangle& sourceRect)
 std::istream&
 operator>>(std::istream& is, Image& obj)
 {
+    obj.cancelLoad();
     obj.invalidateSurface();
     std::string name;
     int w, h;
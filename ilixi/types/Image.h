@@ -26,6 +26,7 @@
 
 #include <directfb.h>
 #include <string>
+#include <types/Color.h>
 #include <types/Rectangle.h>
 
 namespace ilixi
@@ -36,10 +37,25 @@ namespace ilixi
  * permanently stored in system memory and it has premultiplied alpha flag set in its surface description.
  *
  * Note that images are loaded before accessing their surface using getDFBSurface() method for the first time.
+ * Images with the same path and size share their surface using ImageCache.
+ *
+ * If load mode is set to Asynchronous, Painter does not block while image is decoded. Instead
+ * it queues image to ImageLoader and draws placeholder color until image is ready.
  */
 class Image
 {
+    friend class ImageCache;
+    friend class ImageLoader;
 public:
+    /*!
+     * This enum specifies how image is loaded when it is painted for the first time.
+     */
+    enum LoadMode
+    {
+        Synchronous,    //!< Image is decoded by painting thread.
+        Asynchronous    //!< Image is decoded by ImageLoader and owner widget is updated once it is ready.
+    };
+
     /*!
      * Creates an empty image so you can later set an image path.
      *
@@ -72,6 +88,13 @@ public:
      */
     Image(Image* source, const Rectangle& sourceRect);
 
+    /*!
+     * Creates an image using given surface, e.g. a texture atlas page.
+     *
+     * Image takes ownership of surface and it is treated like a sub-image.
+     */
+    Image(IDirectFBSurface* surface);
+
     /*!
      * Copy constructor.
      */
@@ -118,6 +141,36 @@ public:
     IDirectFBSurface*
     getDFBSurface();
 
+    /*!
+     * Returns true if image surface is loaded.
+     */
+    bool
+    ready() const;
+
+    /*!
+     * Returns true if image is queued for asynchronous loading.
+     */
+    bool
+    loading() const;
+
+    /*!
+     * Returns load mode, default is Synchronous.
+     */
+    LoadMode
+    loadMode() const;
+
+    /*!
+     * Returns load priority used in asynchronous mode.
+     */
+    int
+    loadPriority() const;
+
+    /*!
+     * Returns color which is drawn while image is loading.
+     */
+    const Color&
+    placeholder() const;
+
     /*!
      * Returns image path.
      */
@@ -153,6 +206,28 @@ public:
     void
     setSize(const Size& size);
 
+    /*!
+     * Sets load mode.
+     */
+    void
+    setLoadMode(LoadMode mode);
+
+    /*!
+     * Sets load priority, images with higher priority are decoded first.
+     *
+     * \sa ImageLoader::Priority
+     */
+    void
+    setLoadPriority(int priority);
+
+    /*!
+     * Sets color which is drawn while image is loading.
+     *
+     * Default is transparent, i.e. nothing is drawn.
+     */
+    void
+    setPlaceholder(const Color& color);
+
 private:
     enum ImageFlags
     {
@@ -160,7 +235,8 @@ private:
         Modified = 0x0002,
         NotAvailable = 0x0004,
         Ready = 0x0008,
-        SubImage = 0x0010
+        SubImage = 0x0010,
+        Loading = 0x0020
     };
 
     //! This property stores the pointer to DirectFB surface.
@@ -173,6 +249,12 @@ private:
     ImageFlags _state;
     //! This property stores the image capabilities acquired from image provider.
     DFBImageCapabilities _caps;
+    //! This property stores how image is loaded.
+    LoadMode _loadMode;
+    //! This property stores priority for asynchronous loading.
+    int _loadPriority;
+    //! This property stores color drawn while image is loading.
+    Color _placeholder;
 
     /*!
      * Release surface and set it to NULL.
@@ -188,6 +270,28 @@ private:
     bool
     loadImage();
 
+    /*!
+     * Removes image from ImageLoader queue.
+     */
+    void
+    cancelLoad();
+
+    /*!
+     * Sets surface decoded by ImageLoader.
+     */
+    void
+    setLoadedSurface(IDirectFBSurface* surface, DFBImageCapabilities caps);
+
+    /*!
+     * Decodes image at path into a new surface. Surface is scaled to size if it is valid.
+     *
+     * This method does not access any image, so it can be used by any thread.
+     *
+     * @return NULL if image cannot be decoded.
+     */
+    static IDirectFBSurface*
+    decode(const std::string& path, const Size& size, DFBImageCapabilities* caps);
+
     bool
     loadSubImage(Image* source, const Rectangle& sourceRect);
 
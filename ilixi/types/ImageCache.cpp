@@ -0,0 +1,218 @@
+/*
+ Copyright 2010-2015 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <types/ImageCache.h>
+#include <types/Image.h>
+#include <core/PlatformManager.h>
+#include <core/Logger.h>
+#include <stdlib.h>
+
+namespace ilixi
+{
+
+D_DEBUG_DOMAIN(ILX_IMAGECACHE, "ilixi/types/ImageCache", "ImageCache");
+
+ImageCache&
+ImageCache::instance()
+{
+    static ImageCache instance;
+    return instance;
+}
+
+ImageCache::ImageCache()
+        : _budget(16 * 1024 * 1024),
+          _usage(0)
+{
+    pthread_mutex_init(&_lock, NULL);
+    char* var = getenv("ILX_IMAGECACHE");
+    if (var)
+        _budget = atoi(var) * 1024;
+    ILOG_DEBUG(ILX_IMAGECACHE, "Budget: %u bytes\n", _budget);
+}
+
+ImageCache::~ImageCache()
+{
+    // unused surfaces are released by PlatformManager::release() while DirectFB is alive.
+    pthread_mutex_destroy(&_lock);
+}
+
+unsigned int
+ImageCache::budget() const
+{
+    return _budget;
+}
+
+unsigned int
+ImageCache::usage() const
+{
+    return _usage;
+}
+
+unsigned int
+ImageCache::entries() const
+{
+    pthread_mutex_lock(&_lock);
+    unsigned int count = _entries.size();
+    pthread_mutex_unlock(&_lock);
+    return count;
+}
+
+void
+ImageCache::setBudget(unsigned int bytes)
+{
+    pthread_mutex_lock(&_lock);
+    _budget = bytes;
+    evict(_budget);
+    pthread_mutex_unlock(&_lock);
+}
+
+void
+ImageCache::releaseUnused()
+{
+    ILOG_TRACE_F(ILX_IMAGECACHE);
+    pthread_mutex_lock(&_lock);
+    evict(0);
+    ILOG_DEBUG(ILX_IMAGECACHE, " -> entries: %d usage: %u\n", (int) _entries.size(), _usage);
+    pthread_mutex_unlock(&_lock);
+}
+
+IDirectFBSurface*
+ImageCache::acquire(const std::string& path, const Size& size, DFBImageCapabilities* caps)
+{
+    Key key(path, size, PlatformManager::instance().forcedPixelFormat());
+
+    pthread_mutex_lock(&_lock);
+    IDirectFBSurface* surface = lookup(key, caps);
+    pthread_mutex_unlock(&_lock);
+    if (surface)
+        return surface;
+
+    // decode without holding lock.
+    DFBImageCapabilities decodedCaps = DICAPS_NONE;
+    IDirectFBSurface* decoded = Image::decode(path, size, &decodedCaps);
+    if (!decoded)
+        return NULL;
+
+    pthread_mutex_lock(&_lock);
+    surface = lookup(key, caps);
+    if (surface)
+    {
+        // decoded by another thread meanwhile.
+        pthread_mutex_unlock(&_lock);
+        decoded->Release(decoded);
+        return surface;
+    }
+
+    int w, h;
+    DFBSurfacePixelFormat format;
+    decoded->GetSize(decoded, &w, &h);
+    decoded->GetPixelFormat(decoded, &format);
+
+    _lru.push_front(key);
+    EntryMap::iterator it = _entries.insert(std::make_pair(key, Entry())).first;
+    it->second.surface = decoded;
+    it->second.caps = decodedCaps;
+    it->second.bytes = w * h * DFB_BYTES_PER_PIXEL(format);
+    it->second.refs = 1;
+    it->second.lru = _lru.begin();
+    _surfaces.insert(std::make_pair(decoded, it));
+    _usage += it->second.bytes;
+    ILOG_DEBUG(ILX_IMAGECACHE, "[%p] Cached %s (%d, %d) bytes: %u usage: %u\n", decoded, path.c_str(), w, h, it->second.bytes, _usage);
+    evict(_budget);
+    pthread_mutex_unlock(&_lock);
+
+    if (caps)
+        *caps = decodedCaps;
+    return decoded;
+}
+
+IDirectFBSurface*
+ImageCache::find(const std::string& path, const Size& size, DFBImageCapabilities* caps)
+{
+    Key key(path, size, PlatformManager::instance().forcedPixelFormat());
+    pthread_mutex_lock(&_lock);
+    IDirectFBSurface* surface = lookup(key, caps);
+    pthread_mutex_unlock(&_lock);
+    return surface;
+}
+
+void
+ImageCache::release(IDirectFBSurface* surface)
+{
+    pthread_mutex_lock(&_lock);
+    SurfaceMap::iterator it = _surfaces.find(surface);
+    if (it == _surfaces.end())
+    {
+        pthread_mutex_unlock(&_lock);
+        ILOG_WARNING(ILX_IMAGECACHE, "[%p] Surface is not cached!\n", surface);
+        surface->Release(surface);
+        return;
+    }
+
+    Entry& entry = it->second->second;
+    if (entry.refs)
+        --entry.refs;
+    ILOG_DEBUG(ILX_IMAGECACHE, "[%p] Released, refs: %u\n", surface, entry.refs);
+    evict(_budget);
+    pthread_mutex_unlock(&_lock);
+}
+
+IDirectFBSurface*
+ImageCache::lookup(const Key& key, DFBImageCapabilities* caps)
+{
+    EntryMap::iterator it = _entries.find(key);
+    if (it == _entries.end())
+        return NULL;
+
+    ++it->second.refs;
+    if (it->second.lru != _lru.begin())
+        _lru.splice(_lru.begin(), _lru, it->second.lru);
+    if (caps)
+        *caps = it->second.caps;
+    ILOG_DEBUG(ILX_IMAGECACHE, "[%p] Hit %s refs: %u\n", it->second.surface, key.path.c_str(), it->second.refs);
+    return it->second.surface;
+}
+
+void
+ImageCache::evict(unsigned int limit)
+{
+    KeyList::iterator it = _lru.end();
+    while (_usage > limit && it != _lru.begin())
+    {
+        --it;
+        EntryMap::iterator entry = _entries.find(*it);
+        if (entry->second.refs)
+            continue;
+
+        IDirectFBSurface* surface = entry->second.surface;
+        _usage -= entry->second.bytes;
+        _surfaces.erase(surface);
+        _entries.erase(entry);
+        it = _lru.erase(it);
+        ILOG_DEBUG(ILX_IMAGECACHE, "[%p] Evicted, usage: %u\n", surface, _usage);
+        surface->Release(surface);
+    }
+}
+
+} /* namespace ilixi */
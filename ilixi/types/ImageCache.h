@@ -0,0 +1,180 @@
+/*
+ Copyright 2010-2015 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef ILIXI_IMAGECACHE_H_
+#define ILIXI_IMAGECACHE_H_
+
+#include <directfb.h>
+#include <types/Size.h>
+#include <pthread.h>
+#include <list>
+#include <map>
+#include <string>
+
+namespace ilixi
+{
+//! Application wide cache of decoded image surfaces.
+/*!
+ * Images with the same path, size and pixel format share a single surface. Each
+ * acquire() adds a reference to an entry and release() removes it. Entries
+ * without references are kept for later use until total size exceeds budget(),
+ * then the least recently used ones are released.
+ *
+ * Budget can be set using ILX_IMAGECACHE environment variable in kilobytes.
+ */
+class ImageCache
+{
+    friend class Image;
+    friend class ImageLoader;
+
+public:
+    /*!
+     * Returns the instance.
+     */
+    static ImageCache&
+    instance();
+
+    /*!
+     * Returns memory budget in bytes.
+     */
+    unsigned int
+    budget() const;
+
+    /*!
+     * Returns memory used by all cached surfaces in bytes.
+     */
+    unsigned int
+    usage() const;
+
+    /*!
+     * Returns number of entries.
+     */
+    unsigned int
+    entries() const;
+
+    /*!
+     * Sets memory budget in bytes and releases unused surfaces if necessary.
+     */
+    void
+    setBudget(unsigned int bytes);
+
+    /*!
+     * Releases all surfaces which are not used by an image, e.g. when memory is low.
+     */
+    void
+    releaseUnused();
+
+private:
+    struct Key
+    {
+        Key(const std::string& p, const Size& s, DFBSurfacePixelFormat f)
+                : path(p),
+                  width(s.width()),
+                  height(s.height()),
+                  format(f)
+        {
+        }
+
+        bool
+        operator<(const Key& other) const
+        {
+            if (width != other.width)
+                return width < other.width;
+            if (height != other.height)
+                return height < other.height;
+            if (format != other.format)
+                return format < other.format;
+            return path < other.path;
+        }
+
+        std::string path;
+        int width;
+        int height;
+        DFBSurfacePixelFormat format;
+    };
+
+    typedef std::list<Key> KeyList;
+
+    struct Entry
+    {
+        IDirectFBSurface* surface;
+        DFBImageCapabilities caps;
+        unsigned int bytes;
+        unsigned int refs;
+        KeyList::iterator lru;
+    };
+
+    typedef std::map<Key, Entry> EntryMap;
+    typedef std::map<IDirectFBSurface*, EntryMap::iterator> SurfaceMap;
+
+    //! This mutex serialises access to cache.
+    mutable pthread_mutex_t _lock;
+    //! Stores entries.
+    EntryMap _entries;
+    //! Maps shared surfaces to their entries.
+    SurfaceMap _surfaces;
+    //! Most recently used key is at front.
+    KeyList _lru;
+    //! This property stores memory budget in bytes.
+    unsigned int _budget;
+    //! This property stores memory used in bytes.
+    unsigned int _usage;
+
+    ImageCache();
+
+    ~ImageCache();
+
+    /*!
+     * Returns a shared surface for image at path with given size, decoding it if it is not cached.
+     *
+     * Surface must be returned using release(). This method can be used by any thread.
+     *
+     * @return NULL if image cannot be decoded.
+     */
+    IDirectFBSurface*
+    acquire(const std::string& path, const Size& size, DFBImageCapabilities* caps);
+
+    /*!
+     * Returns a shared surface only if it is already cached.
+     */
+    IDirectFBSurface*
+    find(const std::string& path, const Size& size, DFBImageCapabilities* caps);
+
+    /*!
+     * Removes a reference from surface acquired from cache.
+     */
+    void
+    release(IDirectFBSurface* surface);
+
+    //! Returns entry and adds a reference if key is cached, caller must hold lock.
+    IDirectFBSurface*
+    lookup(const Key& key, DFBImageCapabilities* caps);
+
+    //! Releases least recently used unreferenced entries until usage is within limit.
+    void
+    evict(unsigned int limit);
+};
+
+} /* namespace ilixi */
+#endif /* ILIXI_IMAGECACHE_H_ */
@@ -0,0 +1,330 @@
+/*
+ Copyright 2010-2015 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <types/Region.h>
+#include <algorithm>
+
+namespace ilixi
+{
+
+static inline bool
+overlaps(const Rectangle& r1, const Rectangle& r2)
+{
+    return r1.left() < r2.right() && r2.left() < r1.right() && r1.top() < r2.bottom() && r2.top() < r1.bottom();
+}
+
+static inline long long
+areaOf(const Rectangle& r)
+{
+    return (long long) r.width() * r.height();
+}
+
+static inline long long
+overlapArea(const Rectangle& r1, const Rectangle& r2)
+{
+    if (!overlaps(r1, r2))
+        return 0;
+    return (long long) (std::min(r1.right(), r2.right()) - std::max(r1.left(), r2.left())) * (std::min(r1.bottom(), r2.bottom()) - std::max(r1.top(), r2.top()));
+}
+
+//! Appends parts of r1 which are not covered by r2, r1 and r2 must overlap.
+static void
+cutAway(const Rectangle& r1, const Rectangle& r2, Region::RectangleList& out)
+{
+    int top = r1.top();
+    int bottom = r1.bottom();
+
+    if (r2.top() > r1.top())
+    {
+        out.push_back(Rectangle(r1.left(), r1.top(), r1.width(), r2.top() - r1.top()));
+        top = r2.top();
+    }
+
+    if (r2.bottom() < r1.bottom())
+    {
+        out.push_back(Rectangle(r1.left(), r2.bottom(), r1.width(), r1.bottom() - r2.bottom()));
+        bottom = r2.bottom();
+    }
+
+    if (r2.left() > r1.left())
+        out.push_back(Rectangle(r1.left(), top, r2.left() - r1.left(), bottom - top));
+
+    if (r2.right() < r1.right())
+        out.push_back(Rectangle(r2.right(), top, r1.right() - r2.right(), bottom - top));
+}
+
+Region::Region(unsigned int maxRects, unsigned int mergeWaste)
+        : _maxRects(maxRects),
+          _mergeWaste(mergeWaste)
+{
+    _rects.reserve(_maxRects ? _maxRects + 4 : 8);
+}
+
+Region::~Region()
+{
+}
+
+bool
+Region::isEmpty() const
+{
+    return _rects.empty();
+}
+
+unsigned int
+Region::count() const
+{
+    return _rects.size();
+}
+
+const Region::RectangleList&
+Region::rects() const
+{
+    return _rects;
+}
+
+Rectangle
+Region::bounds() const
+{
+    if (_rects.empty())
+        return Rectangle(0, 0, 0, 0);
+
+    Rectangle r = _rects[0];
+    for (unsigned int i = 1; i < _rects.size(); ++i)
+        r = r.united(_rects[i]);
+    return r;
+}
+
+long long
+Region::area() const
+{
+    long long a = 0;
+    for (unsigned int i = 0; i < _rects.size(); ++i)
+        a += areaOf(_rects[i]);
+    return a;
+}
+
+unsigned int
+Region::maxRects() const
+{
+    return _maxRects;
+}
+
+unsigned int
+Region::mergeWaste() const
+{
+    return _mergeWaste;
+}
+
+void
+Region::add(const Rectangle& rect)
+{
+    if (!rect.isValid())
+        return;
+
+    Rectangle r = rect;
+    bool merged = true;
+    while (merged)
+    {
+        merged = false;
+        for (RectangleList::iterator it = _rects.begin(); it != _rects.end(); ++it)
+        {
+            if (it->contains(r, true))
+                return;
+
+            if (r.contains(*it, true) || cheapMerge(r, *it))
+            {
+                r = r.united(*it);
+                _rects.erase(it);
+                merged = true;
+                break;
+            }
+        }
+    }
+
+    // keep rectangles disjoint by removing parts which are already in region.
+    RectangleList pieces(1, r);
+    RectangleList temp;
+    for (RectangleList::const_iterator it = _rects.begin(); it != _rects.end() && !pieces.empty(); ++it)
+    {
+        temp.clear();
+        for (RectangleList::const_iterator p = pieces.begin(); p != pieces.end(); ++p)
+        {
+            if (overlaps(*p, *it))
+                cutAway(*p, *it, temp);
+            else
+                temp.push_back(*p);
+        }
+        pieces.swap(temp);
+    }
+
+    _rects.insert(_rects.end(), pieces.begin(), pieces.end());
+    reduce();
+}
+
+void
+Region::add(const Region& region)
+{
+    for (RectangleList::const_iterator it = region._rects.begin(); it != region._rects.end(); ++it)
+        add(*it);
+}
+
+void
+Region::subtract(const Rectangle& rect)
+{
+    if (!rect.isValid())
+        return;
+
+    RectangleList temp;
+    temp.reserve(_rects.size() + 4);
+    for (RectangleList::const_iterator it = _rects.begin(); it != _rects.end(); ++it)
+    {
+        if (overlaps(*it, rect))
+            cutAway(*it, rect, temp);
+        else
+            temp.push_back(*it);
+    }
+    _rects.swap(temp);
+    reduce();
+}
+
+bool
+Region::contains(const Rectangle& rect) const
+{
+    if (!rect.isValid() || _rects.empty())
+        return false;
+
+    RectangleList pieces(1, rect);
+    RectangleList temp;
+    for (RectangleList::const_iterator it = _rects.begin(); it != _rects.end() && !pieces.empty(); ++it)
+    {
+        temp.clear();
+        for (RectangleList::const_iterator p = pieces.begin(); p != pieces.end(); ++p)
+        {
+            if (overlaps(*p, *it))
+                cutAway(*p, *it, temp);
+            else
+                temp.push_back(*p);
+        }
+        pieces.swap(temp);
+    }
+    return pieces.empty();
+}
+
+bool
+Region::intersects(const Rectangle& rect) const
+{
+    for (RectangleList::const_iterator it = _rects.begin(); it != _rects.end(); ++it)
+        if (overlaps(*it, rect))
+            return true;
+    return false;
+}
+
+void
+Region::intersect(const Rectangle& rect)
+{
+    RectangleList::iterator it = _rects.begin();
+    while (it != _rects.end())
+    {
+        if (overlaps(*it, rect))
+        {
+            *it = it->intersected(rect);
+            ++it;
+        } else
+            it = _rects.erase(it);
+    }
+}
+
+void
+Region::clear()
+{
+    _rects.clear();
+}
+
+void
+Region::setMaxRects(unsigned int maxRects)
+{
+    _maxRects = maxRects;
+    reduce();
+}
+
+void
+Region::setMergeWaste(unsigned int mergeWaste)
+{
+    _mergeWaste = mergeWaste;
+}
+
+bool
+Region::cheapMerge(const Rectangle& r1, const Rectangle& r2) const
+{
+    long long total = areaOf(r1.united(r2));
+    long long waste = total - (areaOf(r1) + areaOf(r2) - overlapArea(r1, r2));
+    return waste * 100 <= total * _mergeWaste;
+}
+
+void
+Region::reduce()
+{
+    while (_maxRects && _rects.size() > _maxRects)
+    {
+        unsigned int first = 0;
+        unsigned int second = 1;
+        long long best = -1;
+        for (unsigned int i = 0; i < _rects.size(); ++i)
+        {
+            for (unsigned int j = i + 1; j < _rects.size(); ++j)
+            {
+                long long waste = areaOf(_rects[i].united(_rects[j])) - areaOf(_rects[i]) - areaOf(_rects[j]);
+                if (best < 0 || waste < best)
+                {
+                    best = waste;
+                    first = i;
+                    second = j;
+                }
+            }
+        }
+
+        Rectangle r = _rects[first].united(_rects[second]);
+        _rects.erase(_rects.begin() + second);
+        _rects.erase(_rects.begin() + first);
+
+        // absorb rectangles overlapping the merged one so region stays disjoint.
+        bool merged = true;
+        while (merged)
+        {
+            merged = false;
+            for (RectangleList::iterator it = _rects.begin(); it != _rects.end(); ++it)
+            {
+                if (overlaps(r, *it))
+                {
+                    r = r.united(*it);
+                    _rects.erase(it);
+                    merged = true;
+                    break;
+                }
+            }
+        }
+        _rects.push_back(r);
+    }
+}
+
+} /* namespace ilixi */
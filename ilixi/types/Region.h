@@ -0,0 +1,174 @@
+/*
+ Copyright 2010-2015 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ILIXI_REGION_H_
+#define ILIXI_REGION_H_
+
+#include <types/Rectangle.h>
+#include <vector>
+
+namespace ilixi
+{
+//! Stores a damaged area as a bounded list of disjoint rectangles.
+/*!
+ * Rectangles which are added to a region are merged with existing ones if their
+ * union does not waste more than mergeWaste() percent of its area. Otherwise the
+ * overlapping parts are cut away so that rectangles in region never intersect.
+ * If number of rectangles exceeds maxRects(), the cheapest pairs are merged.
+ *
+ * A region with maxRects() 0 is never reduced, so it covers exactly the added area.
+ */
+class Region
+{
+public:
+    typedef std::vector<Rectangle> RectangleList;
+
+    /*!
+     * Creates an empty region.
+     *
+     * @param maxRects maximum number of rectangles stored in region, 0 for no limit.
+     * @param mergeWaste percentage of wasted area allowed when merging two rectangles.
+     */
+    Region(unsigned int maxRects = 8, unsigned int mergeWaste = 25);
+
+    /*!
+     * Destructor.
+     */
+    ~Region();
+
+    /*!
+     * Returns true if region does not contain any rectangles.
+     */
+    bool
+    isEmpty() const;
+
+    /*!
+     * Returns the number of rectangles in region.
+     */
+    unsigned int
+    count() const;
+
+    /*!
+     * Returns disjoint rectangles of region.
+     */
+    const RectangleList&
+    rects() const;
+
+    /*!
+     * Returns the bounding rectangle of region.
+     */
+    Rectangle
+    bounds() const;
+
+    /*!
+     * Returns total area of rectangles in region.
+     */
+    long long
+    area() const;
+
+    /*!
+     * Returns maximum number of rectangles.
+     */
+    unsigned int
+    maxRects() const;
+
+    /*!
+     * Returns the percentage of wasted area allowed when merging.
+     */
+    unsigned int
+    mergeWaste() const;
+
+    /*!
+     * Adds given rectangle to region.
+     */
+    void
+    add(const Rectangle& rect);
+
+    /*!
+     * Adds all rectangles of given region.
+     */
+    void
+    add(const Region& region);
+
+    /*!
+     * Removes given rectangle from region.
+     */
+    void
+    subtract(const Rectangle& rect);
+
+    /*!
+     * Returns true if given rectangle is fully covered by region.
+     */
+    bool
+    contains(const Rectangle& rect) const;
+
+    /*!
+     * Returns true if any rectangle in region intersects with given rectangle.
+     */
+    bool
+    intersects(const Rectangle& rect) const;
+
+    /*!
+     * Limits region to given rectangle.
+     */
+    void
+    intersect(const Rectangle& rect);
+
+    /*!
+     * Removes all rectangles.
+     */
+    void
+    clear();
+
+    /*!
+     * Sets maximum number of rectangles, 0 for no limit.
+     */
+    void
+    setMaxRects(unsigned int maxRects);
+
+    /*!
+     * Sets the percentage of wasted area allowed when merging.
+     */
+    void
+    setMergeWaste(unsigned int mergeWaste);
+
+private:
+    //! This property stores disjoint rectangles.
+    RectangleList _rects;
+    //! This property stores maximum number of rectangles.
+    unsigned int _maxRects;
+    //! This property stores allowed wasted area in percent.
+    unsigned int _mergeWaste;
+
+    //! Returns true if union of given rectangles wastes less than allowed area.
+    bool
+    cheapMerge(const Rectangle& r1, const Rectangle& r2) const;
+
+    //! Merges pairs with least wasted area until count is within limit.
+    void
+    reduce();
+};
+
+}
+
+#endif /* ILIXI_REGION_H_ */
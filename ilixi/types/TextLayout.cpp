@@ -22,9 +22,12 @@
  */
 
 #include <TextLayout.h>
+#include <types/TextLayoutCache.h>
 #include <core/Logger.h>
+#include <lib/Util.h>
 #include <lib/utf8.h>
 #include <string.h>
+#include <climits>
 
 namespace ilixi
 {
@@ -36,10 +39,15 @@ TextLayout::TextLayout()
           _singleLine(false),
 #ifdef ILIXI_USE_WSTRING
           _text(L""),
+          _utf8Valid(true),
 #else
           _text(""),
 #endif
-          _alignment(Left)
+          _hash(0),
+          _hashValid(false),
+          _alignment(Left),
+          _layoutFont(0),
+          _textModified(true)
 {
     ILOG_TRACE_F(ILX_TEXTLAYOUT);
 }
@@ -49,10 +57,15 @@ TextLayout::TextLayout(const std::string& text)
           _singleLine(false),
 #ifdef ILIXI_USE_WSTRING
           _text(L""),
+          _utf8Valid(true),
 #else
           _text(""),
 #endif
-          _alignment(Left)
+          _hash(0),
+          _hashValid(false),
+          _alignment(Left),
+          _layoutFont(0),
+          _textModified(true)
 {
     ILOG_TRACE_F(ILX_TEXTLAYOUT);
     setText(text);
@@ -62,9 +75,21 @@ TextLayout::TextLayout(const TextLayout& layout)
         : _modified(true),
           _singleLine(layout._singleLine),
           _text(layout._text),
+#ifdef ILIXI_USE_WSTRING
+          _utf8(layout._utf8),
+          _utf8Valid(layout._utf8Valid),
+#endif
+          _hash(layout._hash),
+          _hashValid(layout._hashValid),
           _alignment(layout._alignment),
           _bounds(layout._bounds),
-          _lines(layout._lines)
+          _lines(layout._lines),
+          _breaks(layout._breaks),
+          _layoutText(layout._layoutText),
+          _layoutFont(layout._layoutFont),
+          _layoutBounds(layout._layoutBounds),
+          _textModified(layout._textModified),
+          _dirty(layout._dirty)
 {
     ILOG_TRACE_F(ILX_TEXTLAYOUT);
 }
@@ -131,16 +156,18 @@ TextLayout::isEmpty() const
     return _text.empty();
 }
 
-std::string
+const std::string&
 TextLayout::text() const
 {
-    ILOG_TRACE_F(ILX_TEXTLAYOUT);
 #ifdef ILIXI_USE_WSTRING
-    char* out = (char*) calloc(_text.size() * 4 + 1, 1);
-    size_t bytes = wchar_to_utf8(_text.c_str(), _text.size(), out, _text.size() * 4 + 1, UTF8_SKIP_BOM);
-    std::string s = out;
-    free(out);
-    return s;
+    if (!_utf8Valid)
+    {
+        _utf8.resize(_text.size() * 4 + 1);
+        size_t bytes = wchar_to_utf8(_text.c_str(), _text.size(), &_utf8[0], _utf8.size(), UTF8_SKIP_BOM);
+        _utf8.resize(bytes);
+        _utf8Valid = true;
+    }
+    return _utf8;
 #else
     return _text;
 #endif
@@ -259,7 +286,7 @@ TextLayout::insert(int pos, char c)
 #endif
 {
     _text.insert(pos, 1, c);
-    _modified = true;
+    textChanged();
 }
 
 void
@@ -273,7 +300,7 @@ TextLayout::insert(int pos, const std::string& str)
         _text = str;
     else
         _text.insert(pos, str);
-    _modified = true;
+    textChanged();
 }
 
 void
@@ -284,7 +311,7 @@ TextLayout::replace(int pos, int number, const char c)
 #endif
 {
     _text.replace(pos, number, 1, c);
-    _modified = true;
+    textChanged();
 }
 
 void
@@ -295,14 +322,14 @@ TextLayout::replace(int pos, int number, const std::string& str)
 #endif
 {
     _text.replace(pos, number, str);
-    _modified = true;
+    textChanged();
 }
 
 void
 TextLayout::erase(int pos, int amount)
 {
     _text.erase(pos, amount);
-    _modified = true;
+    textChanged();
 }
 
 void
@@ -374,7 +401,7 @@ TextLayout::setText(const std::string& text)
 #else
     _text = text;
 #endif
-    _modified = true;
+    textChanged();
 }
 
 #ifdef ILIXI_USE_WSTRING
@@ -383,7 +410,7 @@ TextLayout::setText(const std::wstring& text)
 {
     ILOG_TRACE_F(ILX_TEXTLAYOUT);
     _text = text;
-    _modified = true;
+    textChanged();
 }
 #endif
 
@@ -400,6 +427,7 @@ TextLayout::doLayout(Font* font)
     if (!_modified || font == NULL)
         return;
 
+    unsigned int fontKey = font->key();
     _lines.clear();
     LayoutLine l;
 
@@ -410,36 +438,50 @@ TextLayout::doLayout(Font* font)
         l.length = _text.length();
         l.y = _bounds.y();
         _lines.push_back(l);
+
+        if (_textModified && fontKey == _layoutFont && _bounds == _layoutBounds && _alignment == Left)
+        {
+            // only characters after first modified byte move.
+            const std::string& str = text();
+            unsigned int prefix = 0;
+            while (prefix < str.size() && prefix < _layoutText.size() && str[prefix] == _layoutText[prefix])
+                ++prefix;
+            int x = _bounds.x() + font->extents(str, prefix).width() - 1;
+            addDirtyRect(Rectangle(x, _bounds.y(), _bounds.right() - x, _bounds.height()));
+        } else if (_textModified || fontKey != _layoutFont || _bounds != _layoutBounds)
+            addDirtyRect(_bounds);
+        _layoutText = text();
     } else
     {
-        l.y = _bounds.y();
-        int leading = font->leading();
-
-#ifdef ILIXI_USE_WSTRING
-        char* out = (char*) calloc(_text.size() * 4 + 1, 1);
-        size_t bytes = wchar_to_utf8(_text.c_str(), _text.size(), out, _text.size() * 4 + 1, UTF8_SKIP_BOM);
-        const char* start = out;
-#else
-        const char* start = _text.c_str();
-#endif
+        if (fontKey == _layoutFont && _bounds.width() == _layoutBounds.width() && !_breaks.empty())
+        {
+            if (_textModified)
+                relayoutLines(font);
+        } else
+        {
+            TextLayoutCache::instance().getLines(font, text(), hash(), _bounds.width(), _breaks);
+            _layoutText = text();
+            addDirtyRect(_bounds);
+        }
 
-        const char* text = start;
-        const char* next = text;
+        if (_bounds != _layoutBounds)
+            addDirtyRect(_bounds);
 
-        while (text && l.y <= _bounds.bottom())
+        for (LineVector::const_iterator it = _breaks.begin(); it != _breaks.end(); ++it)
         {
-            l.offset = text - start;
-
-            font->stringBreak(text, -1, _bounds.width(), &l.lineWidth, &l.length, &next);
-            l.bytes = l.length;
+            l = *it;
+            l.y += _bounds.y();
+            if (l.y > _bounds.bottom())
+                break;
             _lines.push_back(l);
-            text = next;
-            l.y += leading;
         }
-#ifdef ILIXI_USE_WSTRING
-        free(out);
-#endif
     }
+
+    if (_bounds != _layoutBounds && !_layoutBounds.isNull())
+        addDirtyRect(_layoutBounds);
+    _layoutFont = fontKey;
+    _layoutBounds = _bounds;
+    _textModified = false;
     _modified = false;
 }
 
@@ -450,35 +492,15 @@ TextLayout::heightForWidth(int width, Font* font) const
     if (font == NULL)
         return -1;
 
-    int leading = font->leading();
-
     if (_singleLine)
-        return leading;
-    else
-    {
-#ifdef ILIXI_USE_WSTRING
-        char* out = (char*) calloc(_text.size() * 4 + 1, 1);
-        size_t bytes = wchar_to_utf8(_text.c_str(), _text.size(), out, _text.size() * 4 + 1, UTF8_SKIP_BOM);
-        const char* text = out;
-#else
-        const char* text = _text.c_str();
-#endif
-        const char* next = text;
-        int lw = 0;
-        int len = 0;
-        int h = 0;
+        return font->leading();
 
-        while (text)
-        {
-            font->stringBreak(text, -1, width, &lw, &len, &next);
-            text = next;
-            h += leading;
-        }
-#ifdef ILIXI_USE_WSTRING
-        free(out);
-#endif
-        return h;
-    }
+    if (!_textModified && width == _layoutBounds.width() && font->key() == _layoutFont && !_breaks.empty())
+        return _breaks.size() * font->leading();
+
+    TextLayoutCache::LineVector lines;
+    TextLayoutCache::instance().getLines(font, text(), hash(), width, lines);
+    return lines.size() * font->leading();
 }
 
 Size
@@ -486,46 +508,144 @@ TextLayout::multiExtents(Font* font) const
 {
     ILOG_TRACE_F(ILX_TEXTLAYOUT);
     int w = 0;
-    int h = 0;
-    int lw, len;
 
+    TextLayoutCache::LineVector lines;
+    TextLayoutCache::instance().getLines(font, text(), hash(), INT_MAX, lines);
+    for (TextLayoutCache::LineVector::const_iterator it = lines.begin(); it != lines.end(); ++it)
+        if (w < it->lineWidth)
+            w = it->lineWidth + 1;
+
+    return Size(w, lines.size() * font->leading());
+}
+
+Rectangle
+TextLayout::dirtyRect() const
+{
+    return _dirty;
+}
+
+void
+TextLayout::clearDirtyRect()
+{
+    _dirty.setRectangle(0, 0, 0, 0);
+}
+
+void
+TextLayout::textChanged()
+{
+    // edits are encoded and hashed once, when text is laid out or drawn.
 #ifdef ILIXI_USE_WSTRING
-    char* out = (char*) calloc(_text.size() * 4 + 1, 1);
-    size_t bytes = wchar_to_utf8(_text.c_str(), _text.size(), out, _text.size() * 4 + 1, UTF8_SKIP_BOM);
-    const char* start = out;
-#else
-    const char* start = _text.c_str();
+    _utf8Valid = false;
 #endif
+    _hashValid = false;
+    _textModified = true;
+    _modified = true;
+}
+
+unsigned int
+TextLayout::hash() const
+{
+    if (!_hashValid)
+    {
+        _hash = createHash(text());
+        _hashValid = true;
+    }
+    return _hash;
+}
 
-    const char* text = start;
-    const char* next = text;
+void
+TextLayout::relayoutLines(Font* font)
+{
+    ILOG_TRACE_F(ILX_TEXTLAYOUT);
+    const std::string& str = text();
+    int oldSize = _layoutText.size();
+    int newSize = str.size();
+    int limit = std::min(oldSize, newSize);
+
+    // find modified bytes.
+    int prefix = 0;
+    while (prefix < limit && str[prefix] == _layoutText[prefix])
+        ++prefix;
+    int suffix = 0;
+    while (suffix < limit - prefix && str[newSize - 1 - suffix] == _layoutText[oldSize - 1 - suffix])
+        ++suffix;
+    int delta = newSize - oldSize;
+    int editEnd = newSize - suffix;
+
+    // start from line before edit since its last word may fit now.
+    unsigned int first = 0;
+    while (first + 1 < _breaks.size() && _breaks[first + 1].offset <= prefix)
+        ++first;
+    if (first)
+        --first;
+
+    LineVector lines(_breaks.begin(), _breaks.begin() + first);
+    unsigned int old = first;
+    bool synced = false;
     int leading = font->leading();
+    const char* start = str.c_str();
+    const char* line = start + _breaks[first].offset;
+    const char* next = line;
+    LayoutLine l;
+    l.y = first * leading;
+    while (line)
+    {
+        l.offset = line - start;
+        if (l.offset >= editEnd)
+        {
+            // breaks are same as before if an old line starts at this offset.
+            while (old < _breaks.size() && _breaks[old].offset < l.offset - delta)
+                ++old;
+            if (old < _breaks.size() && _breaks[old].offset == l.offset - delta)
+            {
+                synced = true;
+                break;
+            }
+        }
+        font->stringBreak(line, -1, _bounds.width(), &l.lineWidth, &l.length, &next);
+        l.bytes = l.length;
+        lines.push_back(l);
+        line = next;
+        l.y += leading;
+    }
+    unsigned int last = lines.size();
 
-    while (text)
+    if (synced)
     {
-        font->stringBreak(text, -1, INT_MAX, &lw, &len, &next);
-        if (w < lw)
-            w = lw + 1;
-        text = next;
-        h += leading;
+        for (; old < _breaks.size(); ++old)
+        {
+            l = _breaks[old];
+            l.offset += delta;
+            l.y = lines.size() * leading;
+            lines.push_back(l);
+        }
     }
-#ifdef ILIXI_USE_WSTRING
-    free(out);
-#endif
-    return Size(w, h);
+    ILOG_DEBUG(ILX_TEXTLAYOUT, " -> Relayout lines [%u, %u) of %d\n", first, last, (int) lines.size());
+
+    // following lines move if number of lines is changed.
+    Rectangle dirty(_bounds.x(), _bounds.y() + first * leading, _bounds.width(), (last - first) * leading);
+    if (lines.size() != _breaks.size())
+        dirty.setBottom(std::max(_bounds.bottom(), _bounds.y() + (int) std::max(lines.size(), _breaks.size()) * leading));
+    addDirtyRect(dirty);
+
+    _breaks.swap(lines);
+    _layoutText = str;
+}
+
+void
+TextLayout::addDirtyRect(const Rectangle& rect)
+{
+    if (_dirty.isNull())
+        _dirty = rect;
+    else
+        _dirty = _dirty.united(rect);
 }
 
 void
 TextLayout::drawTextLayout(IDirectFBSurface* surface, int x, int y) const
 {
     ILOG_TRACE_F(ILX_TEXTLAYOUT);
-#ifdef ILIXI_USE_WSTRING
-    char* out = (char*) calloc(_text.size() * 4 + 1, 1);
-    size_t bytes = wchar_to_utf8(_text.c_str(), _text.size(), out, _text.size() * 4 + 1, UTF8_SKIP_BOM);
-    const char* text = out;
-#else
-    const char* text = _text.c_str();
-#endif
+    const char* text = this->text().c_str();
     DFBRegion clip;
     surface->GetClip(surface, &clip);
     Rectangle intersect = Rectangle(clip.x1, clip.y1, clip.x2 - clip.x1 + 1, clip.y2 - clip.y1 + 1);
@@ -543,9 +663,6 @@ TextLayout::drawTextLayout(IDirectFBSurface* surface, int x, int y) const
 
     for (TextLayout::LineList::const_iterator it = _lines.begin(); it != _lines.end(); ++it)
         surface->DrawString(surface, text + ((TextLayout::LayoutLine) *it).offset, ((TextLayout::LayoutLine) *it).bytes, x, y + ((TextLayout::LayoutLine) *it).y, (DFBSurfaceTextFlags) _alignment);
-#ifdef ILIXI_USE_WSTRING
-    free(out);
-#endif
     surface->SetClip(surface, &clip);
 }
 
@@ -554,13 +671,7 @@ void
 TextLayout::drawTextLayout(cairo_t* context, int x, int y) const
 {
     ILOG_TRACE_F(ILX_TEXTLAYOUT);
-#ifdef ILIXI_USE_WSTRING
-    char* out = (char*) calloc(_text.size() * 4 + 1, 1);
-    size_t bytes = wchar_to_utf8(_text.c_str(), _text.size(), out, _text.size() * 4 + 1, UTF8_SKIP_BOM);
-    const char* text = out;
-#else
-    const char* text = _text.c_str();
-#endif
+    const char* text = this->text().c_str();
 
     cairo_save(context);
     cairo_rectangle(context, _bounds.x(), _bounds.y(), _bounds.width(), _bounds.height());
@@ -580,9 +691,6 @@ TextLayout::drawTextLayout(cairo_t* context, int x, int y) const
         cairo_move_to(context, x, y + ((TextLayout::LayoutLine) *it).y);
         cairo_show_text(context, subtxt);
     }
-#ifdef ILIXI_USE_WSTRING
-    free(out);
-#endif
     cairo_restore(context);
 }
 #endif
@@ -25,6 +25,7 @@
 #define TEXTLAYOUT_H_
 
 #include <list>
+#include <vector>
 #include <types/Font.h>
 #include <types/Rectangle.h>
 
@@ -145,9 +146,9 @@ public:
     isEmpty() const;
 
     /*!
-     * Returns text inside layout.
+     * Returns UTF-8 encoded text inside layout.
      */
-    std::string
+    const std::string&
     text() const;
 
 #ifdef ILIXI_USE_WSTRING
@@ -340,6 +341,23 @@ public:
     int
     heightForWidth(int width, Font* font) const;
 
+    /*!
+     * Returns the area of layout which is changed by doLayout() since last
+     * call to clearDirtyRect().
+     *
+     * After an edit only lines from the edited one until line breaks
+     * resynchronise are broken again, and only those lines are included.
+     * A null rectangle is returned if nothing has changed.
+     */
+    Rectangle
+    dirtyRect() const;
+
+    /*!
+     * Resets dirty rectangle.
+     */
+    void
+    clearDirtyRect();
+
 private:
     //! Flag is set to true if layout is modified.
     bool _modified;
@@ -348,9 +366,17 @@ private:
     //! Text inside layout
 #ifdef ILIXI_USE_WSTRING
     std::wstring _text;
+    //! UTF-8 encoded copy of _text, used for drawing and breaking lines.
+    mutable std::string _utf8;
+    //! True if _utf8 is encoded from current text.
+    mutable bool _utf8Valid;
 #else
     std::string _text;
 #endif
+    //! Hash of UTF-8 encoded text, used as TextLayoutCache key.
+    mutable unsigned int _hash;
+    //! True if _hash is calculated from current text.
+    mutable bool _hashValid;
     //! Horizontal alignment of text inside layout.
     Alignment _alignment;
     //! Bounding rectangle of layout.
@@ -360,9 +386,39 @@ private:
     //! List of lines inside layout.
     LineList _lines;
 
+    typedef std::vector<LayoutLine> LineVector;
+    //! Breaks of whole text used for last layout, y-coordinates are relative to first line.
+    LineVector _breaks;
+    //! UTF-8 encoded text used for last layout.
+    std::string _layoutText;
+    //! Key of font used for last layout.
+    unsigned int _layoutFont;
+    //! Bounding rectangle used for last layout.
+    Rectangle _layoutBounds;
+    //! Flag is set to true if text is changed since last layout.
+    bool _textModified;
+    //! Area changed since clearDirtyRect().
+    Rectangle _dirty;
+
     Size
     multiExtents(Font* font) const;
 
+    //! Invalidates UTF-8 copy and hash of text and sets modified flag.
+    void
+    textChanged();
+
+    //! Returns hash of UTF-8 encoded text, calculated on first use after text changes.
+    unsigned int
+    hash() const;
+
+    //! Breaks only lines affected by changes since last layout and marks them dirty.
+    void
+    relayoutLines(Font* font);
+
+    //! Adds rect to dirty area.
+    void
+    addDirtyRect(const Rectangle& rect);
+
     void
     drawTextLayout(IDirectFBSurface* surface, int x = 0, int y = 0) const;
 
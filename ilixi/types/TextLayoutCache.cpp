@@ -0,0 +1,143 @@
+/*
+ Copyright 2010-2015 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <types/TextLayoutCache.h>
+#include <core/Logger.h>
+
+namespace ilixi
+{
+
+D_DEBUG_DOMAIN(ILX_TEXTLAYOUTCACHE, "ilixi/types/TextLayoutCache", "TextLayoutCache");
+
+TextLayoutCache&
+TextLayoutCache::instance()
+{
+    static TextLayoutCache instance;
+    return instance;
+}
+
+TextLayoutCache::TextLayoutCache()
+        : _maxEntries(512)
+{
+    pthread_mutex_init(&_lock, NULL);
+}
+
+TextLayoutCache::~TextLayoutCache()
+{
+    pthread_mutex_destroy(&_lock);
+}
+
+void
+TextLayoutCache::getLines(Font* font, const std::string& text, unsigned int hash, int width, LineVector& lines)
+{
+    ILOG_TRACE_F(ILX_TEXTLAYOUTCACHE);
+    lines.clear();
+    if (!font)
+        return;
+
+    Key key(hash, font->key(), width);
+
+    pthread_mutex_lock(&_lock);
+    EntryMap::iterator it = _entries.find(key);
+    if (it != _entries.end() && it->second.text == text)
+    {
+        ILOG_DEBUG(ILX_TEXTLAYOUTCACHE, " -> Hit hash: %u font: %u width: %d\n", hash, key.font, width);
+        _lru.splice(_lru.begin(), _lru, it->second.lru);
+        lines = it->second.lines;
+        pthread_mutex_unlock(&_lock);
+        return;
+    }
+    pthread_mutex_unlock(&_lock);
+
+    // break text without holding lock.
+    TextLayout::LayoutLine l;
+    int leading = font->leading();
+    const char* start = text.c_str();
+    const char* line = start;
+    const char* next = line;
+    while (line)
+    {
+        l.offset = line - start;
+        font->stringBreak(line, -1, width, &l.lineWidth, &l.length, &next);
+        l.bytes = l.length;
+        lines.push_back(l);
+        line = next;
+        l.y += leading;
+    }
+
+    pthread_mutex_lock(&_lock);
+    it = _entries.find(key);
+    if (it == _entries.end())
+    {
+        _lru.push_front(key);
+        Entry& entry = _entries[key];
+        entry.lru = _lru.begin();
+        entry.text = text;
+        entry.lines = lines;
+        evict();
+    } else
+    {
+        // hash collision or entry added by another thread, keep latest text.
+        _lru.splice(_lru.begin(), _lru, it->second.lru);
+        it->second.text = text;
+        it->second.lines = lines;
+    }
+    ILOG_DEBUG(ILX_TEXTLAYOUTCACHE, " -> Cached hash: %u font: %u width: %d lines: %d\n", hash, key.font, width, (int) lines.size());
+    pthread_mutex_unlock(&_lock);
+}
+
+unsigned int
+TextLayoutCache::maxEntries() const
+{
+    return _maxEntries;
+}
+
+void
+TextLayoutCache::setMaxEntries(unsigned int entries)
+{
+    pthread_mutex_lock(&_lock);
+    _maxEntries = entries;
+    evict();
+    pthread_mutex_unlock(&_lock);
+}
+
+void
+TextLayoutCache::clear()
+{
+    pthread_mutex_lock(&_lock);
+    _entries.clear();
+    _lru.clear();
+    pthread_mutex_unlock(&_lock);
+}
+
+void
+TextLayoutCache::evict()
+{
+    while (_entries.size() > _maxEntries && !_lru.empty())
+    {
+        _entries.erase(_lru.back());
+        _lru.pop_back();
+    }
+}
+
+} /* namespace ilixi */
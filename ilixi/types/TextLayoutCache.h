@@ -0,0 +1,141 @@
+/*
+ Copyright 2010-2015 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ILIXI_TEXTLAYOUTCACHE_H_
+#define ILIXI_TEXTLAYOUTCACHE_H_
+
+#include <types/TextLayout.h>
+#include <pthread.h>
+#include <list>
+#include <map>
+#include <vector>
+
+namespace ilixi
+{
+//! Application wide cache of line breaks.
+/*!
+ * Line breaks of a text are stored using text hash, font key and width. Layouts
+ * with identical text and font, e.g. same labels in different widgets, share entries.
+ * Least recently used entries are removed once maxEntries() is exceeded.
+ */
+class TextLayoutCache
+{
+public:
+    //! Lines of a text, y-coordinates are relative to first line.
+    typedef std::vector<TextLayout::LayoutLine> LineVector;
+
+    /*!
+     * Returns the instance.
+     */
+    static TextLayoutCache&
+    instance();
+
+    /*!
+     * Fills lines with breaks of text for given font and width.
+     *
+     * Breaks are calculated using Font::stringBreak() only if they are not cached.
+     *
+     * @param font used for breaking text.
+     * @param text UTF-8 encoded text.
+     * @param hash of text, see createHash().
+     * @param width maximum width of a line.
+     * @param lines is set to breaks of text.
+     */
+    void
+    getLines(Font* font, const std::string& text, unsigned int hash, int width, LineVector& lines);
+
+    /*!
+     * Returns the maximum number of entries.
+     */
+    unsigned int
+    maxEntries() const;
+
+    /*!
+     * Sets the maximum number of entries.
+     */
+    void
+    setMaxEntries(unsigned int entries);
+
+    /*!
+     * Removes all entries.
+     */
+    void
+    clear();
+
+private:
+    struct Key
+    {
+        Key(unsigned int h, unsigned int f, int w)
+                : hash(h),
+                  font(f),
+                  width(w)
+        {
+        }
+
+        bool
+        operator<(const Key& other) const
+        {
+            if (hash != other.hash)
+                return hash < other.hash;
+            if (font != other.font)
+                return font < other.font;
+            return width < other.width;
+        }
+
+        unsigned int hash;
+        unsigned int font;
+        int width;
+    };
+
+    typedef std::list<Key> KeyList;
+
+    struct Entry
+    {
+        //! Text is kept for resolving hash collisions.
+        std::string text;
+        LineVector lines;
+        KeyList::iterator lru;
+    };
+
+    typedef std::map<Key, Entry> EntryMap;
+
+    //! This mutex serialises access to cache.
+    pthread_mutex_t _lock;
+    //! Stores entries.
+    EntryMap _entries;
+    //! Most recently used key is at front.
+    KeyList _lru;
+    //! This property stores the maximum number of entries.
+    unsigned int _maxEntries;
+
+    TextLayoutCache();
+
+    ~TextLayoutCache();
+
+    //! Removes least recently used entries until size is within limit.
+    void
+    evict();
+};
+
+} /* namespace ilixi */
+#endif /* ILIXI_TEXTLAYOUTCACHE_H_ */
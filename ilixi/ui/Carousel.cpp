@@ -219,6 +219,7 @@ Carousel::removeWidget(Widget* widget)
         if (item->source() == widget)
         {
             _children.erase(it);
+            invalidateHitTestGrid();
             delete item;
             updateCarouselGeometry();
             break;
@@ -137,9 +137,7 @@ ContainerBase::consumePointerEvent(const PointerEvent& pointerEvent)
     {
         // priority is given to child on top.
         if (_frameGeometry.contains(pointerEvent.x, pointerEvent.y, true))
-            for (WidgetListReverseIterator it = _children.rbegin(); it != _children.rend(); ++it)
-                if (((Widget*) *it)->consumePointerEvent(pointerEvent))
-                    return true;
+            return consumeChildPointerEvent(pointerEvent);
     }
     return false;
 }
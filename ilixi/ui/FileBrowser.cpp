@@ -45,19 +45,20 @@ D_DEBUG_DOMAIN(ILX_FILEBROWSERITEM, "ilixi/ui/FileBrowserItem", "FileBrowserItem
 D_DEBUG_DOMAIN(ILX_FILEBROWSER, "ilixi/ui/FileBrowser", "FileBrowser");
 
 bool
-itemsSort(FileBrowserItem* a, FileBrowserItem* b)
+filesSort(FileInfo* a, FileInfo* b)
 {
-    if (a->_info->isDir() && !b->_info->isDir())
+    if (a->isDir() && !b->isDir())
         return true;
-    else if (!a->_info->isDir() && b->_info->isDir())
+    else if (!a->isDir() && b->isDir())
         return false;
-    return (a->_info->fileName() < b->_info->fileName());
+    return (a->fileName() < b->fileName());
 }
 
-FileBrowserItem::FileBrowserItem(FileInfo* info, FileBrowser* parent)
+FileBrowserItem::FileBrowserItem(FileBrowser* parent)
         : Widget(parent),
           _owner(parent),
-          _info(info),
+          _isDir(false),
+          _iconType(-1),
           _icon(NULL),
           _alternateRow(false),
           _date(NULL),
@@ -71,36 +72,33 @@ FileBrowserItem::FileBrowserItem(FileInfo* info, FileBrowser* parent)
     _box->setSpacing(10);
     addChild(_box);
 
-    _icon = new Icon(_info->packedIcon());
+    _icon = new Icon();
     _icon->setSize(32, 32);
     _box->addWidget(_icon);
 
     VBoxLayout* labelBox = new VBoxLayout();
     _box->addWidget(labelBox);
 
-    _label = new Label(_info->baseName());
+    _label = new Label("");
     _label->setConstraints(ExpandingConstraint, MinimumConstraint);
     _label->setSingleLine(true);
     _label->setFont(stylist()->defaultFont(StyleHint::ButtonFont));
     labelBox->addWidget(_label);
 
-    if (_info->isFile())
-    {
-        HBoxLayout* infoBox = new HBoxLayout();
-        labelBox->addWidget(infoBox);
+    _infoBox = new HBoxLayout();
+    labelBox->addWidget(_infoBox);
 
-        _size = new Label(formatSize(_info->size()));
-        _size->setFont(stylist()->defaultFont(StyleHint::MicroFont));
-        _size->setSingleLine(true);
-        infoBox->addWidget(_size);
+    _size = new Label("");
+    _size->setFont(stylist()->defaultFont(StyleHint::MicroFont));
+    _size->setSingleLine(true);
+    _infoBox->addWidget(_size);
 
-        infoBox->addWidget(new Spacer(Horizontal));
+    _infoBox->addWidget(new Spacer(Horizontal));
 
-        _date = new Label(formatDate(_info->lastModified()));
-        _date->setFont(stylist()->defaultFont(StyleHint::MicroFont));
-        _date->setSingleLine(true);
-        infoBox->addWidget(_date);
-    }
+    _date = new Label("");
+    _date->setFont(stylist()->defaultFont(StyleHint::MicroFont));
+    _date->setSingleLine(true);
+    _infoBox->addWidget(_date);
 
     sigGeometryUpdated.connect(sigc::mem_fun(this, &FileBrowserItem::updateFileBrowserItemGeometry));
 }
@@ -108,7 +106,6 @@ FileBrowserItem::FileBrowserItem(FileInfo* info, FileBrowser* parent)
 FileBrowserItem::~FileBrowserItem()
 {
     ILOG_TRACE_W(ILX_FILEBROWSERITEM);
-    delete _info;
 }
 
 Size
@@ -138,34 +135,14 @@ FileBrowserItem::compose(const PaintEvent& event)
 void
 FileBrowserItem::pointerButtonDownEvent(const PointerEvent& pointerEvent)
 {
-    std::string s;
-    if (_info->isDir())
-    {
-        s = _info->file();
-        char* buffer = realpath(s.c_str(), NULL);
-        std::string s(buffer);
-        free(buffer);
-        _owner->setPath(s + "/");
-    } else
-        _owner->sigFileSelected(_info->file());
+    select();
 }
 
 void
 FileBrowserItem::keyUpEvent(const KeyEvent& keyEvent)
 {
     if (keyEvent.keySymbol == DIKS_SPACE)
-    {
-        std::string s;
-        if (_info->isDir())
-        {
-            s = _info->file();
-            char* buffer = realpath(s.c_str(), NULL);
-            std::string s(buffer);
-            free(buffer);
-            _owner->setPath(s + "/");
-        } else
-            _owner->sigFileSelected(_info->file());
-    }
+        select();
 }
 
 void
@@ -180,6 +157,45 @@ FileBrowserItem::focusOutEvent()
     update();
 }
 
+void
+FileBrowserItem::setInfo(const FileInfo* info, bool alternateRow)
+{
+    ILOG_TRACE_W(ILX_FILEBROWSERITEM);
+    _file = info->file();
+    _isDir = info->isDir();
+    _alternateRow = alternateRow;
+
+    StyleHint::PackedIcon iconType = info->packedIcon();
+    if (iconType != _iconType)
+    {
+        _iconType = iconType;
+        _icon->setImage(stylist()->defaultIcon(iconType));
+    }
+
+    _label->setText(info->baseName());
+    if (info->isFile())
+    {
+        _size->setText(formatSize(info->size()));
+        _date->setText(formatDate(info->lastModified()));
+        _infoBox->setVisible(true);
+    } else
+        _infoBox->setVisible(false);
+    update();
+}
+
+void
+FileBrowserItem::select()
+{
+    if (_isDir)
+    {
+        char* buffer = realpath(_file.c_str(), NULL);
+        std::string s(buffer);
+        free(buffer);
+        _owner->setPath(s + "/");
+    } else
+        _owner->sigFileSelected(_file);
+}
+
 void
 FileBrowserItem::updateFileBrowserItemGeometry()
 {
@@ -189,6 +205,55 @@ FileBrowserItem::updateFileBrowserItemGeometry()
 
 //************************************************************************
 
+FileBrowserModel::FileBrowserModel(FileBrowser* owner)
+        : ItemModel(),
+          ItemFactory(),
+          _owner(owner)
+{
+}
+
+FileBrowserModel::~FileBrowserModel()
+{
+    for (unsigned int i = 0; i < _files.size(); ++i)
+        delete _files[i];
+}
+
+unsigned int
+FileBrowserModel::count() const
+{
+    return _files.size();
+}
+
+Widget*
+FileBrowserModel::createItem()
+{
+    return new FileBrowserItem(_owner);
+}
+
+void
+FileBrowserModel::setItem(Widget* item, unsigned int index)
+{
+    ((FileBrowserItem*) item)->setInfo(_files[index], index % 2 == 0);
+}
+
+Size
+FileBrowserModel::itemSize() const
+{
+    int h = Widget::stylist()->defaultFont(StyleHint::ButtonFont)->extents("X").height() + Widget::stylist()->defaultFont(StyleHint::MicroFont)->extents("X").height() + 5;
+    return Size(200, std::max(h, 32));
+}
+
+void
+FileBrowserModel::setFiles(const std::vector<FileInfo*>& files)
+{
+    for (unsigned int i = 0; i < _files.size(); ++i)
+        delete _files[i];
+    _files = files;
+    sigReset();
+}
+
+//************************************************************************
+
 FileBrowser::FileBrowser(const std::string& path, Widget* parent)
         : Widget(parent),
           _showHidden(false),
@@ -215,6 +280,9 @@ FileBrowser::FileBrowser(const std::string& path, Widget* parent)
     _list->setSpacing(1);
     _box->addWidget(_list);
 
+    _model = new FileBrowserModel(this);
+    _list->setModel(_model, _model);
+
     setPath(path);
     sigGeometryUpdated.connect(sigc::mem_fun(this, &FileBrowser::updateFileBrowserGeometry));
 }
@@ -222,6 +290,7 @@ FileBrowser::FileBrowser(const std::string& path, Widget* parent)
 FileBrowser::~FileBrowser()
 {
     ILOG_TRACE_W(ILX_FILEBROWSER);
+    delete _model;
 }
 
 Size
@@ -251,7 +320,7 @@ FileBrowser::setPath(const std::string& path)
     {
         _path->setText(path);
         std::vector<std::string> files = FileSystem::listDirectory(path);
-        std::vector<FileBrowserItem*> items;
+        std::vector<FileInfo*> items;
         for (int i = 0; i < files.size(); ++i)
         {
             if (files[i] == ".")
@@ -261,26 +330,20 @@ FileBrowser::setPath(const std::string& path)
 
             FileInfo* info = new FileInfo(path + files[i]);
             if (info->isDir())
-                items.push_back(new FileBrowserItem(info, this));
-            else if (info->isFile())
-            {
-                if (_filter.empty())
-                    items.push_back(new FileBrowserItem(info, this));
-                else if (!info->suffix().empty() && (_filter.find(info->suffix()) != std::string::npos))
-                    items.push_back(new FileBrowserItem(info, this));
-            }
+                items.push_back(info);
+            else if (info->isFile() && (_filter.empty() || (!info->suffix().empty() && (_filter.find(info->suffix()) != std::string::npos))))
+                items.push_back(info);
+            else
+                delete info;
         }
 
-        std::sort(items.begin(), items.end(), itemsSort);
+        std::sort(items.begin(), items.end(), filesSort);
 
-        _list->clear();
-        for (int i = 0; i < items.size(); ++i)
-        {
-            if (i % 2 == 0)
-                items[i]->_alternateRow = true;
-            _list->addItem(items[i]);
-        }
-        items[0]->setFocus();
+        // widgets of visible items are filled with new files before next paint.
+        _model->setFiles(items);
+        Widget* first = _list->itemAtIndex(0);
+        if (first)
+            first->setFocus();
         _modified = false;
         update();
     }
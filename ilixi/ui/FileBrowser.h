@@ -24,7 +24,9 @@
 #ifndef ILIXI_FILEBROWSER_H_
 #define ILIXI_FILEBROWSER_H_
 
+#include <ui/ItemModel.h>
 #include <ui/Widget.h>
+#include <vector>
 
 namespace ilixi
 {
@@ -44,11 +46,12 @@ class FileBrowser;
 class FileBrowserItem : public Widget
 {
     friend class FileBrowser;
+    friend class FileBrowserModel;
 public:
     /*!
      * Constructor
      */
-    FileBrowserItem(FileInfo* info, FileBrowser* parent = 0);
+    FileBrowserItem(FileBrowser* parent = 0);
 
     /*!
      * Destructor
@@ -78,8 +81,12 @@ protected:
 private:
     //! This is a pointer to parent file browser.
     FileBrowser* _owner;
-    //! This stores information about file
-    FileInfo* _info;
+    //! This stores path of file
+    std::string _file;
+    //! This flag is set if file is a directory
+    bool _isDir;
+    //! This stores icon type of file
+    int _iconType;
     //! This label shows name of file
     Label* _label;
     //! This label shows modified date of file
@@ -92,12 +99,59 @@ private:
     bool _alternateRow;
     //! This stores all child widgets
     HBoxLayout* _box;
+    //! This stores size and date labels
+    HBoxLayout* _infoBox;
+
+    //! Shows given file.
+    void
+    setInfo(const FileInfo* info, bool alternateRow);
+
+    //! Opens directory or emits sigFileSelected.
+    void
+    select();
 
     void
     updateFileBrowserItemGeometry();
+};
+
+//! Provides files of current path to list of a file browser.
+class FileBrowserModel : public ItemModel, public ItemFactory
+{
+public:
+    /*!
+     * Constructor
+     */
+    FileBrowserModel(FileBrowser* owner);
+
+    /*!
+     * Destructor
+     */
+    virtual
+    ~FileBrowserModel();
+
+    unsigned int
+    count() const;
+
+    Widget*
+    createItem();
+
+    void
+    setItem(Widget* item, unsigned int index);
+
+    Size
+    itemSize() const;
 
-    friend bool
-    itemsSort(FileBrowserItem* a, FileBrowserItem* b);
+    /*!
+     * Replaces files and emits sigReset, files are owned by model.
+     */
+    void
+    setFiles(const std::vector<FileInfo*>& files);
+
+private:
+    //! This is a pointer to file browser which owns items.
+    FileBrowser* _owner;
+    //! This stores sorted files.
+    std::vector<FileInfo*> _files;
 };
 
 //! Provides a simple widget to list/select files and directories
@@ -174,6 +228,8 @@ private:
     Label* _path;
     //! This list contains file browser items.
     ListBox* _list;
+    //! This model provides files to list.
+    FileBrowserModel* _model;
     //! This layout is used to position path label and list.
     VBoxLayout* _box;
 
@@ -61,6 +61,19 @@ Frame::preferredSize() const
     return Size(s.width() + _margin.hSum(), s.height() + _margin.vSum());
 }
 
+Rectangle
+Frame::opaqueGeometry() const
+{
+    if (opaque() || !_drawFrame || opacity() != 255 || !visible())
+        return Widget::opaqueGeometry();
+
+    Rectangle r = stylist()->opaqueArea(this);
+    if (!r.isValid())
+        return Rectangle();
+    r.translate(absX(), absY());
+    return r;
+}
+
 int
 Frame::canvasX() const
 {
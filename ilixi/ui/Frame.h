@@ -61,6 +61,14 @@ public:
     virtual Size
     preferredSize() const;
 
+    /*!
+     * Returns the area inside frame borders if stylist draws an opaque frame.
+     *
+     * Reimplement if compose() does not use stylist's drawFrame().
+     */
+    virtual Rectangle
+    opaqueGeometry() const;
+
     /*!
      * Returns frame's canvas x-coordinate including the left margin.
      */
@@ -64,6 +64,18 @@ GridLayout::~GridLayout()
 
 int
 GridLayout::heightForWidth(int width) const
+{
+    return cachedHeightForWidth(width);
+}
+
+Size
+GridLayout::preferredSize() const
+{
+    return cachedPreferredSize();
+}
+
+int
+GridLayout::calculateHeightForWidth(int width) const
 {
     // FIXME implement h4w
     ILOG_TRACE_W(ILX_GRIDLAYOUT);
@@ -71,7 +83,7 @@ GridLayout::heightForWidth(int width) const
 }
 
 Size
-GridLayout::preferredSize() const
+GridLayout::calculatePreferredSize() const
 {
     ILOG_TRACE_W(ILX_GRIDLAYOUT);
 
@@ -253,15 +265,21 @@ GridLayout::clear()
 void
 GridLayout::setColumnWidth(unsigned int column, unsigned int colWidth)
 {
-    if (column < _cols)
+    if (column < _cols && _colWidths[column] != colWidth)
+    {
         _colWidths[column] = colWidth;
+        doLayout();
+    }
 }
 
 void
 GridLayout::setRowHeight(unsigned int row, unsigned int rowHeight)
 {
-    if (row < _rows)
+    if (row < _rows && _rowHeights[row] != rowHeight)
+    {
         _rowHeights[row] = rowHeight;
+        doLayout();
+    }
 }
 
 bool
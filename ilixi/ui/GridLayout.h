@@ -201,6 +201,13 @@ public:
     void
     tile();
 
+protected:
+    virtual Size
+    calculatePreferredSize() const;
+
+    virtual int
+    calculateHeightForWidth(int width) const;
+
 private:
     //! This property stores the number of rows.
     int _rows;
@@ -23,6 +23,7 @@
 
 #include <ui/GridView.h>
 #include <ui/GridLayout.h>
+#include <ui/ItemView.h>
 #include <ui/ScrollArea.h>
 #include <graphics/Painter.h>
 #include <core/Logger.h>
@@ -36,12 +37,15 @@ GridView::GridView(Widget* parent)
         : Widget(parent),
           _scrollArea(NULL),
           _layout(NULL),
+          _view(NULL),
           _currentIndex(0),
           _currentItem(NULL)
 {
     ILOG_TRACE_W(ILX_GRIDVIEW);
     setInputMethod(PointerPassthrough);
     _scrollArea = new ScrollArea();
+    // long lists are scrolled often, so only exposed items are repainted.
+    _scrollArea->setBlitScrolling(true);
     addChild(_scrollArea);
 
     _layout = new GridLayout(2, 2);
@@ -67,6 +71,12 @@ void
 GridView::addItem(Widget* item)
 {
     ILOG_TRACE_W(ILX_GRIDVIEW);
+    if (_view)
+    {
+        ILOG_WARNING(ILX_GRIDVIEW, "Cannot add item while a model is set.\n");
+        return;
+    }
+
     if (_layout->addWidget(item))
     {
         _items.push_back(item);
@@ -78,6 +88,8 @@ void
 GridView::clear()
 {
     ILOG_TRACE_W(ILX_GRIDVIEW);
+    if (_view)
+        setModel(NULL, NULL);
     _items.clear();
     _layout->clear();
 }
@@ -86,6 +98,8 @@ unsigned int
 GridView::count() const
 {
     ILOG_TRACE_W(ILX_GRIDVIEW);
+    if (_view)
+        return _view->count();
     return _layout->count();
 }
 
@@ -93,6 +107,8 @@ Widget*
 GridView::currentItem() const
 {
     ILOG_TRACE_W(ILX_GRIDVIEW);
+    if (_view)
+        return _view->itemWidget(_currentIndex);
     return _currentItem;
 }
 
@@ -113,6 +129,8 @@ int
 GridView::itemIndex(Widget* item)
 {
     ILOG_TRACE_W(ILX_GRIDVIEW);
+    if (_view)
+        return _view->itemIndex(item);
     int i = 0;
     for (WidgetList::iterator it = _items.begin(); it != _items.end(); ++it, ++i)
         if (*it == item)
@@ -124,6 +142,8 @@ Widget*
 GridView::itemAtIndex(unsigned int index)
 {
     ILOG_TRACE_W(ILX_GRIDVIEW);
+    if (_view)
+        return _view->itemWidget(index);
     if (index > _items.size())
         return NULL;
     int i = 0;
@@ -137,6 +157,11 @@ void
 GridView::insertItem(unsigned int index, Widget* item)
 {
     ILOG_TRACE_W(ILX_GRIDVIEW);
+    if (_view)
+    {
+        ILOG_WARNING(ILX_GRIDVIEW, "Cannot insert item while a model is set.\n");
+        return;
+    }
     _layout->addWidget(item, index / _layout->columns(), index % _layout->columns());
 }
 
@@ -144,6 +169,8 @@ bool
 GridView::removeItem(Widget* item)
 {
     ILOG_TRACE_W(ILX_GRIDVIEW);
+    if (_view)
+        return false;
     if (item == _currentItem)
         setCurrentItem(_currentIndex + 1 > _items.size() ? 0 : _currentIndex + 1);
     return _layout->removeWidget(item);
@@ -153,6 +180,8 @@ bool
 GridView::removeItem(unsigned int index)
 {
     ILOG_TRACE_W(ILX_GRIDVIEW);
+    if (_view)
+        return false;
     Widget* widget = itemAtIndex(index);
     if (widget)
     {
@@ -162,15 +191,25 @@ GridView::removeItem(unsigned int index)
     return false;
 }
 
+ItemModel*
+GridView::model() const
+{
+    return _view ? _view->model() : NULL;
+}
+
 unsigned int
 GridView::columns() const
 {
+    if (_view)
+        return _view->columns();
     return _layout->columns();
 }
 
 unsigned int
 GridView::rows() const
 {
+    if (_view)
+        return _view->rows();
     return _layout->rows();
 }
 
@@ -178,6 +217,23 @@ void
 GridView::setCurrentItem(unsigned int index)
 {
     ILOG_TRACE_W(ILX_GRIDVIEW);
+    if (_view)
+    {
+        if (_currentIndex != index && index < _view->count())
+        {
+            _currentIndex = index;
+            _currentItem = _view->itemWidget(_currentIndex);
+            if (_currentItem)
+                _scrollArea->scrollTo(_currentItem);
+            else
+            {
+                Point p = _view->scrollPosition(_currentIndex, _scrollArea->size());
+                _scrollArea->scrollTo(p.x(), p.y());
+            }
+        }
+        return;
+    }
+
     if (_currentIndex != index && index < _items.size())
     {
         _currentIndex = index;
@@ -190,6 +246,14 @@ void
 GridView::setCurrentItem(Widget* item)
 {
     ILOG_TRACE_W(ILX_GRIDVIEW);
+    if (_view)
+    {
+        int index = _view->itemIndex(item);
+        if (index >= 0)
+            setCurrentItem((unsigned int) index);
+        return;
+    }
+
     if (_currentItem != item && _layout->isChild(item))
     {
         _currentItem = item;
@@ -212,7 +276,9 @@ GridView::setUseThumbs(bool useThumbs)
 void
 GridView::setGridSize(unsigned int rows, unsigned int cols)
 {
-    if (rows != _layout->rows() || cols != _layout->columns())
+    if (_view)
+        _view->setColumns(cols);
+    else if (rows != _layout->rows() || cols != _layout->columns())
     {
         _layout = new GridLayout(rows, cols);
         _scrollArea->setContent(_layout);
@@ -223,7 +289,40 @@ GridView::setGridSize(unsigned int rows, unsigned int cols)
 void
 GridView::setLayoutSpacing(int spacing)
 {
-    _layout->setSpacing(spacing);
+    if (_view)
+        _view->setSpacing(spacing);
+    else
+        _layout->setSpacing(spacing);
+}
+
+void
+GridView::setModel(ItemModel* model, ItemFactory* factory)
+{
+    ILOG_TRACE_W(ILX_GRIDVIEW);
+    _currentIndex = 0;
+    _currentItem = NULL;
+
+    if (model && factory)
+    {
+        if (!_view)
+        {
+            _view = new ItemView();
+            _view->setColumns(_layout->columns());
+            _view->setSpacing(_layout->spacing());
+            _view->sigItemStateChanged.connect(sigc::mem_fun(this, &GridView::trackItem));
+            _items.clear();
+            _layout = NULL;
+            _scrollArea->setContent(_view);
+        }
+        _view->setModel(model, factory);
+    } else if (_view)
+    {
+        _layout = new GridLayout(2, _view->columns());
+        _layout->setSpacing(_view->spacing());
+        _layout->setKeyNavChildrenFirst(true);
+        _view = NULL;
+        _scrollArea->setContent(_layout);
+    }
 }
 
 void
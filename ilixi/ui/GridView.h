@@ -30,9 +30,17 @@ namespace ilixi
 {
 
 class GridLayout;
+class ItemFactory;
+class ItemModel;
+class ItemView;
 class ScrollArea;
 
 //! A container widget with a ScrollArea and a GridLayout.
+/*!
+ * Items are either added as widgets using addItem() or they are provided by a
+ * model, see setModel(). In latter case only visible items have widgets and
+ * these widgets are reused while grid is scrolled.
+ */
 class GridView : public Widget
 {
 public:
@@ -52,12 +60,16 @@ public:
 
     /*!
      * Adds widget to internal layout.
+     *
+     * Items can not be added while a model is set.
      */
     void
     addItem(Widget* item);
 
     /*!
      * Removes all widgets from layout.
+     *
+     * If a model is set, it is removed and grid uses a layout again.
      */
     void
     clear();
@@ -95,7 +107,8 @@ public:
     /*!
      * Returns the widget at given index.
      *
-     * Returns NULL if there is no item at index.
+     * Returns NULL if there is no item at index, or if a model is set
+     * and item at index is not visible.
      */
     Widget*
     itemAtIndex(unsigned int index);
@@ -118,6 +131,12 @@ public:
     bool
     removeItem(unsigned int index);
 
+    /*!
+     * Returns model or NULL if items are added as widgets.
+     */
+    ItemModel*
+    model() const;
+
     /*!
      * Returns number of columns.
      */
@@ -159,8 +178,22 @@ public:
     void
     setUseThumbs(bool useThumbs);
 
+    /*!
+     * Sets model and factory used for creating item widgets.
+     *
+     * Existing items are removed. Only visible items, plus a row outside
+     * visible area, have widgets which are created by factory and recycled
+     * while grid is scrolled. Model and factory are not owned by grid view.
+     *
+     * Setting a NULL model removes it and grid uses a layout again.
+     */
+    void
+    setModel(ItemModel* model, ItemFactory* factory);
+
     /*!
      * Sets number of rows and columns.
+     *
+     * If a model is set, number of rows depends on model and only columns are used.
      */
     void
     setGridSize(unsigned int rows, unsigned int cols);
@@ -196,8 +229,10 @@ protected:
 private:
     //! This holds internal layout.
     ScrollArea* _scrollArea;
-    //! This is the internal grid layout.
+    //! This is the internal grid layout, NULL if a model is set.
     GridLayout* _layout;
+    //! This is used instead of layout if a model is set.
+    ItemView* _view;
     //! Index of current item.
     unsigned int _currentIndex;
     //! Points to current/last focused item.
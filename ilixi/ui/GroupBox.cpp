@@ -69,6 +69,12 @@ GroupBox::preferredSize() const
     return Size(std::max(s.width(), _titleSize.width()) + _margin.hSum() + stylist()->defaultParameter(StyleHint::PanelLR), s.height() + _margin.vSum() + stylist()->defaultParameter(StyleHint::PanelTB) + _titleSize.height());
 }
 
+Rectangle
+GroupBox::opaqueGeometry() const
+{
+    return Widget::opaqueGeometry();
+}
+
 std::string
 GroupBox::title() const
 {
@@ -67,6 +67,12 @@ public:
     virtual Size
     preferredSize() const;
 
+    /*!
+     * Returns opaque area only if widget is marked as opaque.
+     */
+    virtual Rectangle
+    opaqueGeometry() const;
+
     /*!
      * Returns title.
      *
@@ -67,6 +67,18 @@ HBoxLayout::insertWidget(unsigned int column, Widget* widget)
 
 int
 HBoxLayout::heightForWidth(int width) const
+{
+    return cachedHeightForWidth(width);
+}
+
+Size
+HBoxLayout::preferredSize() const
+{
+    return cachedPreferredSize();
+}
+
+int
+HBoxLayout::calculateHeightForWidth(int width) const
 {
     ILOG_TRACE_W(ILX_HBOX);
     if (!_children.size())
@@ -304,7 +316,7 @@ HBoxLayout::heightForWidth(int width) const
 }
 
 Size
-HBoxLayout::preferredSize() const
+HBoxLayout::calculatePreferredSize() const
 {
     ILOG_TRACE_W(ILX_HBOX);
     if (!_children.size())
@@ -83,6 +83,13 @@ public:
     void
     tile();
 
+protected:
+    virtual Size
+    calculatePreferredSize() const;
+
+    virtual int
+    calculateHeightForWidth(int width) const;
+
 private:
     //! This property defines how widgets are placed on y axis.
     Alignment::Vertical _alignment;
@@ -0,0 +1,247 @@
+/*
+ Copyright 2010-2015 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <ui/HitTestGrid.h>
+#include <ui/Widget.h>
+#include <core/Logger.h>
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
+
+namespace ilixi
+{
+
+D_DEBUG_DOMAIN(ILX_HITTESTGRID, "ilixi/ui/HitTestGrid", "HitTestGrid");
+
+//! Number of cells in a row or column is limited to this value.
+#define HITTESTGRID_MAX_CELLS 64
+
+unsigned int HitTestGrid::__threshold = 0xFFFFFFFF;
+
+//! Sorts candidates so that top most child is first.
+static bool
+compareCandidates(const std::pair<int, Widget*>& a, const std::pair<int, Widget*>& b)
+{
+    return a.first > b.first;
+}
+
+HitTestGrid::HitTestGrid(Widget* owner)
+        : _owner(owner),
+          _valid(false),
+          _cellWidth(1),
+          _cellHeight(1),
+          _columns(1),
+          _rows(1)
+{
+}
+
+HitTestGrid::~HitTestGrid()
+{
+}
+
+void
+HitTestGrid::invalidate()
+{
+    _valid = false;
+}
+
+void
+HitTestGrid::update(Widget* child)
+{
+    if (!_valid)
+        return;
+
+    EntryMap::iterator it = _entries.find(child);
+    if (it == _entries.end())
+        return;
+
+    Entry entry = it->second;
+    setCells(entry, child->_frameGeometry);
+    if (entry.column0 == it->second.column0 && entry.row0 == it->second.row0 && entry.column1 == it->second.column1 && entry.row1 == it->second.row1)
+        return;
+
+    remove(child, it->second);
+    insert(child, entry);
+    it->second = entry;
+}
+
+void
+HitTestGrid::query(int x, int y, Widget* grabbed, WidgetVector& candidates)
+{
+    candidates.clear();
+    if (!_valid)
+        rebuild();
+
+    std::vector<std::pair<int, Widget*> > hits;
+    bool hasGrabbed = false;
+    const Cell& cell = _cells[row(y) * _columns + column(x)];
+    for (Cell::const_iterator it = cell.begin(); it != cell.end(); ++it)
+    {
+        if (it->second == grabbed)
+        {
+            hits.push_back(*it);
+            hasGrabbed = true;
+        } else if (it->second->_frameGeometry.contains(x, y, true))
+            hits.push_back(*it);
+    }
+
+    if (grabbed && !hasGrabbed)
+    {
+        EntryMap::const_iterator it = _entries.find(grabbed);
+        if (it != _entries.end())
+            hits.push_back(std::make_pair(it->second.position, grabbed));
+    }
+
+    std::sort(hits.begin(), hits.end(), compareCandidates);
+    for (unsigned int i = 0; i < hits.size(); ++i)
+        candidates.push_back(hits[i].second);
+}
+
+unsigned int
+HitTestGrid::threshold()
+{
+    if (__threshold == 0xFFFFFFFF)
+    {
+        char* var = getenv("ILX_HITTESTGRID");
+        __threshold = var ? atoi(var) : 16;
+    }
+    return __threshold;
+}
+
+void
+HitTestGrid::setThreshold(unsigned int children)
+{
+    __threshold = children;
+}
+
+void
+HitTestGrid::rebuild()
+{
+    ILOG_TRACE_F(ILX_HITTESTGRID);
+    _entries.clear();
+    _cells.clear();
+
+    // cover frames of all children, points outside are clamped to border cells.
+    bool hasBounds = false;
+    int left = 0, top = 0, right = 0, bottom = 0;
+    for (Widget::WidgetListConstIterator it = _owner->_children.begin(); it != _owner->_children.end(); ++it)
+    {
+        const Rectangle& frame = ((Widget*) *it)->_frameGeometry;
+        if (frame.width() < 0 || frame.height() < 0)
+            continue;
+        if (!hasBounds)
+        {
+            left = frame.left();
+            top = frame.top();
+            right = frame.right();
+            bottom = frame.bottom();
+            hasBounds = true;
+        } else
+        {
+            left = std::min(left, frame.left());
+            top = std::min(top, frame.top());
+            right = std::max(right, frame.right());
+            bottom = std::max(bottom, frame.bottom());
+        }
+    }
+    _bounds.setRectangle(left, top, right - left + 1, bottom - top + 1);
+
+    // aim for about one child per cell.
+    int side = ceil(sqrt((double) _owner->_children.size()));
+    _columns = std::max(1, std::min(side, HITTESTGRID_MAX_CELLS));
+    _rows = _columns;
+    _cellWidth = std::max(1, (_bounds.width() + _columns - 1) / _columns);
+    _cellHeight = std::max(1, (_bounds.height() + _rows - 1) / _rows);
+    _cells.resize(_columns * _rows);
+
+    int position = 0;
+    for (Widget::WidgetListConstIterator it = _owner->_children.begin(); it != _owner->_children.end(); ++it, ++position)
+    {
+        Widget* child = (Widget*) *it;
+        Entry entry;
+        entry.position = position;
+        setCells(entry, child->_frameGeometry);
+        insert(child, entry);
+        _entries.insert(std::make_pair(child, entry));
+    }
+    _valid = true;
+    ILOG_DEBUG(ILX_HITTESTGRID, "[%p] children: %d cells: %dx%d (%d, %d)\n", _owner, position, _columns, _rows, _cellWidth, _cellHeight);
+}
+
+void
+HitTestGrid::setCells(Entry& entry, const Rectangle& frame)
+{
+    // frames with negative size never contain a point.
+    if (frame.width() < 0 || frame.height() < 0)
+    {
+        entry.column0 = entry.row0 = 0;
+        entry.column1 = entry.row1 = -1;
+        return;
+    }
+    entry.column0 = column(frame.left());
+    entry.row0 = row(frame.top());
+    entry.column1 = column(frame.right());
+    entry.row1 = row(frame.bottom());
+}
+
+void
+HitTestGrid::insert(Widget* child, const Entry& entry)
+{
+    for (int r = entry.row0; r <= entry.row1; ++r)
+        for (int c = entry.column0; c <= entry.column1; ++c)
+            _cells[r * _columns + c].push_back(std::make_pair(entry.position, child));
+}
+
+void
+HitTestGrid::remove(Widget* child, const Entry& entry)
+{
+    for (int r = entry.row0; r <= entry.row1; ++r)
+        for (int c = entry.column0; c <= entry.column1; ++c)
+        {
+            Cell& cell = _cells[r * _columns + c];
+            for (Cell::iterator it = cell.begin(); it != cell.end(); ++it)
+                if (it->second == child)
+                {
+                    cell.erase(it);
+                    break;
+                }
+        }
+}
+
+int
+HitTestGrid::column(int x) const
+{
+    if (x <= _bounds.x())
+        return 0;
+    return std::min((x - _bounds.x()) / _cellWidth, _columns - 1);
+}
+
+int
+HitTestGrid::row(int y) const
+{
+    if (y <= _bounds.y())
+        return 0;
+    return std::min((y - _bounds.y()) / _cellHeight, _rows - 1);
+}
+
+} /* namespace ilixi */
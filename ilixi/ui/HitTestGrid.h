@@ -0,0 +1,160 @@
+/*
+ Copyright 2010-2015 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ILIXI_HITTESTGRID_H_
+#define ILIXI_HITTESTGRID_H_
+
+#include <types/Rectangle.h>
+#include <map>
+#include <vector>
+
+namespace ilixi
+{
+class Widget;
+
+//! Uniform grid of children frames for pointer hit-testing.
+/*!
+ * Widgets with many children, e.g. grids, keyboards or carousels, create a
+ * HitTestGrid on first pointer event. Children are bucketed into cells using
+ * their frame geometry, so only children in the cell under pointer are tested
+ * instead of all children.
+ *
+ * Cells of a child are updated when its frame geometry changes. Grid is
+ * rebuilt lazily if children are added, removed or reordered. Visibility is
+ * not indexed, children decide whether they consume an event as before.
+ *
+ * Grid is used if number of children reaches threshold(), which can be set
+ * using ILX_HITTESTGRID environment variable, 0 disables grids.
+ */
+class HitTestGrid
+{
+public:
+    typedef std::vector<Widget*> WidgetVector;
+
+    /*!
+     * Creates a grid for children of owner.
+     */
+    HitTestGrid(Widget* owner);
+
+    /*!
+     * Destructor.
+     */
+    ~HitTestGrid();
+
+    /*!
+     * Marks grid invalid after children are added, removed or reordered.
+     */
+    void
+    invalidate();
+
+    /*!
+     * Moves child to cells under its current frame geometry.
+     */
+    void
+    update(Widget* child);
+
+    /*!
+     * Sets candidates to children whose frame contains given point, top most child first.
+     *
+     * @param x in frame (absolute) coordinates.
+     * @param y in frame (absolute) coordinates.
+     * @param grabbed if grabbed is a child, it is a candidate regardless of its frame.
+     * @param candidates list of children.
+     */
+    void
+    query(int x, int y, Widget* grabbed, WidgetVector& candidates);
+
+    /*!
+     * Returns minimum number of children for using a grid, 0 if grids are disabled.
+     */
+    static unsigned int
+    threshold();
+
+    /*!
+     * Sets minimum number of children for using a grid, 0 disables grids.
+     */
+    static void
+    setThreshold(unsigned int children);
+
+private:
+    //! Owner of children.
+    Widget* _owner;
+    //! Grid is rebuilt on next query if false.
+    bool _valid;
+    //! Area covered by cells, points outside are mapped to border cells.
+    Rectangle _bounds;
+    //! Width of a cell.
+    int _cellWidth;
+    //! Height of a cell.
+    int _cellHeight;
+    //! Number of columns.
+    int _columns;
+    //! Number of rows.
+    int _rows;
+
+    //! Position of child in children list and its cells.
+    struct Entry
+    {
+        int position;
+        int column0;
+        int row0;
+        int column1;
+        int row1;
+    };
+
+    typedef std::map<Widget*, Entry> EntryMap;
+    EntryMap _entries;
+
+    typedef std::vector<std::pair<int, Widget*> > Cell;
+    //! Children in each cell with their positions.
+    std::vector<Cell> _cells;
+
+    static unsigned int __threshold;
+
+    //! Rebuilds grid using current frames and order of children.
+    void
+    rebuild();
+
+    //! Sets cell range of entry using frame geometry.
+    void
+    setCells(Entry& entry, const Rectangle& frame);
+
+    //! Adds child to cells of entry.
+    void
+    insert(Widget* child, const Entry& entry);
+
+    //! Removes child from cells of entry.
+    void
+    remove(Widget* child, const Entry& entry);
+
+    //! Returns column of x, clamped to grid.
+    int
+    column(int x) const;
+
+    //! Returns row of y, clamped to grid.
+    int
+    row(int y) const;
+};
+
+} /* namespace ilixi */
+#endif /* ILIXI_HITTESTGRID_H_ */
@@ -0,0 +1,111 @@
+/*
+ Copyright 2010-2015 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef ILIXI_ITEMMODEL_H_
+#define ILIXI_ITEMMODEL_H_
+
+#include <types/Size.h>
+#include <sigc++/signal.h>
+#include <sigc++/trackable.h>
+
+namespace ilixi
+{
+class Widget;
+
+//! Provides number of items for an ItemView.
+/*!
+ * Model does not create any widgets itself, data of an item is applied to a
+ * widget by an ItemFactory when item becomes visible.
+ */
+class ItemModel : virtual public sigc::trackable
+{
+public:
+    /*!
+     * Constructor.
+     */
+    ItemModel();
+
+    /*!
+     * Destructor.
+     */
+    virtual
+    ~ItemModel();
+
+    /*!
+     * Returns number of items.
+     */
+    virtual unsigned int
+    count() const = 0;
+
+    /*!
+     * This signal should be emitted after items are added, removed or reordered.
+     */
+    sigc::signal<void> sigReset;
+
+    /*!
+     * This signal should be emitted after data of an item at given index is changed.
+     */
+    sigc::signal<void, unsigned int> sigItemChanged;
+};
+
+//! Creates and fills widgets for items of an ItemModel.
+/*!
+ * Widgets created by factory are owned by ItemView and they are reused for
+ * different indexes while view is scrolled.
+ */
+class ItemFactory
+{
+public:
+    /*!
+     * Constructor.
+     */
+    ItemFactory();
+
+    /*!
+     * Destructor.
+     */
+    virtual
+    ~ItemFactory();
+
+    /*!
+     * Returns a new widget which can display any item.
+     */
+    virtual Widget*
+    createItem() = 0;
+
+    /*!
+     * Sets contents of widget using item at given index.
+     */
+    virtual void
+    setItem(Widget* item, unsigned int index) = 0;
+
+    /*!
+     * Returns size of an item, all items have the same size.
+     */
+    virtual Size
+    itemSize() const = 0;
+};
+
+} /* namespace ilixi */
+#endif /* ILIXI_ITEMMODEL_H_ */
@@ -0,0 +1,425 @@
+/*
+ Copyright 2010-2015 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <ui/ItemView.h>
+#include <ui/ItemModel.h>
+#include <core/Logger.h>
+#include <algorithm>
+
+namespace ilixi
+{
+
+D_DEBUG_DOMAIN(ILX_ITEMVIEW, "ilixi/ui/ItemView", "ItemView");
+
+ItemView::ItemView(Widget* parent)
+        : Widget(parent),
+          _model(NULL),
+          _factory(NULL),
+          _orientation(Vertical),
+          _columns(1),
+          _spacing(5),
+          _overscan(1),
+          _first(0),
+          _last(0),
+          _dirty(true),
+          _updating(false)
+{
+    ILOG_TRACE_W(ILX_ITEMVIEW);
+    setInputMethod(PointerInput);
+    setConstraints(MinimumConstraint, MinimumConstraint);
+}
+
+ItemView::~ItemView()
+{
+    ILOG_TRACE_W(ILX_ITEMVIEW);
+}
+
+Size
+ItemView::preferredSize() const
+{
+    ILOG_TRACE_W(ILX_ITEMVIEW);
+    if (!_model || !_factory)
+        return Size(0, 0);
+
+    Size item = _factory->itemSize();
+    int lanes = _columns;
+    int rowCount = rows();
+    int along = rowCount ? rowCount * (_orientation == Vertical ? item.height() : item.width()) + (rowCount - 1) * _spacing : 0;
+    int across = lanes * (_orientation == Vertical ? item.width() : item.height()) + (lanes - 1) * _spacing;
+    if (_orientation == Vertical)
+        return Size(across, along);
+    return Size(along, across);
+}
+
+void
+ItemView::paint(const PaintEvent& event)
+{
+    if (visible())
+        updateItems();
+    Widget::paint(event);
+}
+
+void
+ItemView::doLayout()
+{
+    // showing or hiding recycled widgets does not change size of view.
+    if (!_updating)
+        Widget::doLayout();
+}
+
+ItemModel*
+ItemView::model() const
+{
+    return _model;
+}
+
+unsigned int
+ItemView::count() const
+{
+    return _model ? _model->count() : 0;
+}
+
+unsigned int
+ItemView::columns() const
+{
+    return _columns;
+}
+
+unsigned int
+ItemView::rows() const
+{
+    return (count() + _columns - 1) / _columns;
+}
+
+Orientation
+ItemView::orientation() const
+{
+    return _orientation;
+}
+
+int
+ItemView::spacing() const
+{
+    return _spacing;
+}
+
+unsigned int
+ItemView::overscan() const
+{
+    return _overscan;
+}
+
+Widget*
+ItemView::itemWidget(unsigned int index) const
+{
+    ItemMap::const_iterator it = _items.find(index);
+    if (it != _items.end())
+        return it->second;
+    return NULL;
+}
+
+int
+ItemView::itemIndex(Widget* item) const
+{
+    for (ItemMap::const_iterator it = _items.begin(); it != _items.end(); ++it)
+        if (it->second == item)
+            return it->first;
+    return -1;
+}
+
+Rectangle
+ItemView::itemGeometry(unsigned int index) const
+{
+    return cellGeometry(index, cellSize());
+}
+
+Point
+ItemView::scrollPosition(unsigned int index, const Size& viewport) const
+{
+    Rectangle r = itemGeometry(index);
+    int px = x();
+    int py = y();
+
+    if (r.x() + px < 0)
+        px = -r.x();
+    else if (r.x() + r.width() + px > viewport.width())
+        px = viewport.width() - r.x() - r.width();
+
+    if (r.y() + py < 0)
+        py = -r.y();
+    else if (r.y() + r.height() + py > viewport.height())
+        py = viewport.height() - r.y() - r.height();
+
+    return Point(px, py);
+}
+
+void
+ItemView::setModel(ItemModel* model, ItemFactory* factory)
+{
+    ILOG_TRACE_W(ILX_ITEMVIEW);
+    _resetConnection.disconnect();
+    _changedConnection.disconnect();
+    clearItems();
+
+    _model = model;
+    _factory = factory;
+    if (_model)
+    {
+        _resetConnection = _model->sigReset.connect(sigc::mem_fun(this, &ItemView::resetItems));
+        _changedConnection = _model->sigItemChanged.connect(sigc::mem_fun(this, &ItemView::updateItem));
+    }
+    resetItems();
+}
+
+void
+ItemView::setColumns(unsigned int columns)
+{
+    if (columns == 0)
+        columns = 1;
+
+    if (columns != _columns)
+    {
+        _columns = columns;
+        resetItems();
+    }
+}
+
+void
+ItemView::setOrientation(Orientation orientation)
+{
+    if (orientation != _orientation)
+    {
+        _orientation = orientation;
+        resetItems();
+    }
+}
+
+void
+ItemView::setSpacing(int spacing)
+{
+    if (spacing != _spacing)
+    {
+        _spacing = spacing;
+        resetItems();
+    }
+}
+
+void
+ItemView::setOverscan(unsigned int rows)
+{
+    _overscan = rows;
+    update();
+}
+
+void
+ItemView::compose(const PaintEvent& event)
+{
+}
+
+Size
+ItemView::cellSize() const
+{
+    Size cell = _factory->itemSize();
+    int lanes = _columns;
+    if (_orientation == Vertical)
+    {
+        int w = (width() - (lanes - 1) * _spacing) / lanes;
+        if (w > cell.width())
+            cell.setWidth(w);
+    } else
+    {
+        int h = (height() - (lanes - 1) * _spacing) / lanes;
+        if (h > cell.height())
+            cell.setHeight(h);
+    }
+    return cell;
+}
+
+Rectangle
+ItemView::cellGeometry(unsigned int index, const Size& cell) const
+{
+    int row = index / _columns;
+    int lane = index % _columns;
+    if (_orientation == Vertical)
+        return Rectangle(lane * (cell.width() + _spacing), row * (cell.height() + _spacing), cell.width(), cell.height());
+    return Rectangle(row * (cell.width() + _spacing), lane * (cell.height() + _spacing), cell.width(), cell.height());
+}
+
+void
+ItemView::updateItems()
+{
+    if (!_model || !_factory)
+        return;
+
+    unsigned int total = _model->count();
+    Size cell = cellSize();
+
+    // visible area of parent, e.g. ScrollArea, in local coordinates.
+    int stride;
+    int offset;
+    int extent;
+    if (_orientation == Vertical)
+    {
+        stride = cell.height() + _spacing;
+        offset = -y();
+        extent = parent() ? parent()->height() : height();
+    } else
+    {
+        stride = cell.width() + _spacing;
+        offset = -x();
+        extent = parent() ? parent()->width() : width();
+    }
+
+    if (stride <= 0)
+        return;
+    if (offset < 0)
+        offset = 0;
+
+    unsigned int firstRow = offset / stride;
+    unsigned int lastRow = (offset + extent) / stride + 1 + _overscan;
+    firstRow = firstRow > _overscan ? firstRow - _overscan : 0;
+
+    unsigned int first = std::min(firstRow * _columns, total);
+    unsigned int last = std::min(lastRow * _columns, total);
+
+    if (!_dirty && first == _first && last == _last && cell == _cellSize)
+        return;
+
+    ILOG_TRACE_W(ILX_ITEMVIEW);
+    ILOG_DEBUG(ILX_ITEMVIEW, " -> items [%u, %u) of %u\n", first, last, total);
+    _updating = true;
+
+    // focused widget is kept so that focus does not jump to another item.
+    for (ItemMap::iterator it = _items.begin(); it != _items.end();)
+    {
+        Widget* item = it->second;
+        if (it->first >= total || ((it->first < first || it->first >= last) && !item->hasFocus()))
+        {
+            item->setVisible(false);
+            _pool.push_back(item);
+            _items.erase(it++);
+        } else
+        {
+            if (_dirty)
+                _factory->setItem(item, it->first);
+            item->setGeometry(cellGeometry(it->first, cell));
+            ++it;
+        }
+    }
+
+    for (unsigned int i = first; i < last; ++i)
+    {
+        if (_items.find(i) != _items.end())
+            continue;
+
+        Widget* item;
+        if (_pool.empty())
+        {
+            item = _factory->createItem();
+            item->sigStateChanged.connect(sigc::mem_fun(this, &ItemView::forwardItemState));
+            addChild(item);
+            ILOG_DEBUG(ILX_ITEMVIEW, " -> created %p for item %u\n", item, i);
+        } else
+        {
+            item = _pool.back();
+            _pool.pop_back();
+        }
+        _factory->setItem(item, i);
+        item->setGeometry(cellGeometry(i, cell));
+        item->setVisible(true);
+        _items.insert(std::make_pair(i, item));
+    }
+
+    updateNeighbours();
+
+    _first = first;
+    _last = last;
+    _cellSize = cell;
+    _dirty = false;
+    _updating = false;
+}
+
+void
+ItemView::updateNeighbours()
+{
+    Widget* before;
+    Widget* after;
+    Widget* prev;
+    Widget* next;
+    for (ItemMap::iterator it = _items.begin(); it != _items.end(); ++it)
+    {
+        unsigned int i = it->first;
+        before = i >= _columns ? itemWidget(i - _columns) : NULL;
+        after = itemWidget(i + _columns);
+        prev = i % _columns ? itemWidget(i - 1) : NULL;
+        next = (i + 1) % _columns ? itemWidget(i + 1) : NULL;
+
+        if (_orientation == Vertical)
+            it->second->setNeighbours(before ? before : getNeighbour(Up), after ? after : getNeighbour(Down), prev ? prev : getNeighbour(Left), next ? next : getNeighbour(Right));
+        else
+            it->second->setNeighbours(prev ? prev : getNeighbour(Up), next ? next : getNeighbour(Down), before ? before : getNeighbour(Left), after ? after : getNeighbour(Right));
+    }
+}
+
+void
+ItemView::clearItems()
+{
+    for (ItemMap::iterator it = _items.begin(); it != _items.end(); ++it)
+        removeChild(it->second);
+    _items.clear();
+
+    for (WidgetListIterator it = _pool.begin(); it != _pool.end(); ++it)
+        removeChild(*it);
+    _pool.clear();
+}
+
+void
+ItemView::resetItems()
+{
+    ILOG_TRACE_W(ILX_ITEMVIEW);
+    _dirty = true;
+    doLayout();
+    update();
+}
+
+void
+ItemView::updateItem(unsigned int index)
+{
+    ILOG_TRACE_W(ILX_ITEMVIEW);
+    Widget* item = itemWidget(index);
+    if (item)
+    {
+        _factory->setItem(item, index);
+        item->update();
+    }
+}
+
+void
+ItemView::forwardItemState(Widget* item, WidgetState state)
+{
+    if (!_updating)
+        sigItemStateChanged(item, state);
+}
+
+} /* namespace ilixi */
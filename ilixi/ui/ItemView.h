@@ -0,0 +1,258 @@
+/*
+ Copyright 2010-2015 Tarik Sekmen.
+
+ All Rights Reserved.
+
+ Written by Tarik Sekmen <tarik@ilixi.org>.
+
+ This file is part of ilixi.
+
+ ilixi is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ilixi is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with ilixi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef ILIXI_ITEMVIEW_H_
+#define ILIXI_ITEMVIEW_H_
+
+#include <ui/Widget.h>
+#include <map>
+
+namespace ilixi
+{
+class ItemFactory;
+class ItemModel;
+
+//! Shows items of an ItemModel using a fixed number of recycled widgets.
+/*!
+ * ItemView is used as the content of a ScrollArea. Items are placed on a grid
+ * of equally sized cells, yet only items inside visible area of parent, plus a
+ * few rows of overscan, have a widget. While view is scrolled, widgets which
+ * leave visible area are moved to a pool and they are filled with data of
+ * newly exposed items using ItemFactory::setItem().
+ *
+ * Therefore memory and layout time depend on size of view instead of number of items.
+ */
+class ItemView : public Widget
+{
+public:
+    /*!
+     * Constructor.
+     */
+    ItemView(Widget* parent = 0);
+
+    /*!
+     * Destructor.
+     */
+    virtual
+    ~ItemView();
+
+    /*!
+     * Returns size required to place all items.
+     */
+    virtual Size
+    preferredSize() const;
+
+    /*!
+     * Creates or recycles widgets for visible items and paints them.
+     */
+    virtual void
+    paint(const PaintEvent& event);
+
+    /*!
+     * Propagates layout changes unless they are caused by recycling.
+     */
+    virtual void
+    doLayout();
+
+    /*!
+     * Returns model or NULL if model is not set.
+     */
+    ItemModel*
+    model() const;
+
+    /*!
+     * Returns number of items in model.
+     */
+    unsigned int
+    count() const;
+
+    /*!
+     * Returns number of items in a row, or in a column if orientation is horizontal.
+     */
+    unsigned int
+    columns() const;
+
+    /*!
+     * Returns number of rows, or columns if orientation is horizontal.
+     */
+    unsigned int
+    rows() const;
+
+    /*!
+     * Returns orientation.
+     */
+    Orientation
+    orientation() const;
+
+    /*!
+     * Returns space between items.
+     */
+    int
+    spacing() const;
+
+    /*!
+     * Returns number of rows which have widgets outside visible area.
+     */
+    unsigned int
+    overscan() const;
+
+    /*!
+     * Returns widget showing item at index.
+     *
+     * Returns NULL if item does not have a widget, e.g. it is not visible.
+     */
+    Widget*
+    itemWidget(unsigned int index) const;
+
+    /*!
+     * Returns the index of item shown by given widget, -1 otherwise.
+     */
+    int
+    itemIndex(Widget* item) const;
+
+    /*!
+     * Returns geometry of item at index relative to view.
+     */
+    Rectangle
+    itemGeometry(unsigned int index) const;
+
+    /*!
+     * Returns position of view inside a ScrollArea of given size, so that item at index is visible.
+     */
+    Point
+    scrollPosition(unsigned int index, const Size& viewport) const;
+
+    /*!
+     * Sets model and factory which are used to create item widgets.
+     *
+     * Existing item widgets are destroyed. Model and factory are not owned by
+     * view and they must be valid until view is destroyed or another model is set.
+     */
+    void
+    setModel(ItemModel* model, ItemFactory* factory);
+
+    /*!
+     * Sets number of items in a row, or in a column if orientation is horizontal.
+     */
+    void
+    setColumns(unsigned int columns);
+
+    /*!
+     * Sets orientation, i.e. direction in which view is scrolled.
+     */
+    void
+    setOrientation(Orientation orientation);
+
+    /*!
+     * Sets space between items.
+     */
+    void
+    setSpacing(int spacing);
+
+    /*!
+     * Sets number of rows which have widgets outside visible area.
+     *
+     * Default is 1.
+     */
+    void
+    setOverscan(unsigned int rows);
+
+    /*!
+     * This signal is emitted when state of an item widget changes.
+     */
+    sigc::signal<void, Widget*, WidgetState> sigItemStateChanged;
+
+protected:
+    void
+    compose(const PaintEvent& event);
+
+private:
+    typedef std::map<unsigned int, Widget*> ItemMap;
+
+    //! Provides number of items.
+    ItemModel* _model;
+    //! Creates and fills item widgets.
+    ItemFactory* _factory;
+    //! This property stores orientation.
+    Orientation _orientation;
+    //! This property stores number of items in a row.
+    unsigned int _columns;
+    //! This property stores space between items.
+    int _spacing;
+    //! This property stores number of extra rows.
+    unsigned int _overscan;
+    //! First item with a widget.
+    unsigned int _first;
+    //! Item after last item with a widget.
+    unsigned int _last;
+    //! Cell size used while placing current widgets.
+    Size _cellSize;
+    //! This flag is set if data of items should be set again.
+    bool _dirty;
+    //! This flag is set while widgets are recycled.
+    bool _updating;
+    //! Widgets of visible items stored by index.
+    ItemMap _items;
+    //! Hidden widgets which can be reused.
+    WidgetList _pool;
+    //! Connection to ItemModel::sigReset.
+    sigc::connection _resetConnection;
+    //! Connection to ItemModel::sigItemChanged.
+    sigc::connection _changedConnection;
+
+    //! Returns size of a cell, items are stretched to fill rows.
+    Size
+    cellSize() const;
+
+    //! Returns geometry of item at index using given cell size.
+    Rectangle
+    cellGeometry(unsigned int index, const Size& cell) const;
+
+    //! Assigns widgets to visible items.
+    void
+    updateItems();
+
+    //! Sets neighbours of item widgets for key navigation.
+    void
+    updateNeighbours();
+
+    //! Destroys all item widgets.
+    void
+    clearItems();
+
+    //! This method is called when model is reset.
+    void
+    resetItems();
+
+    //! This method is called when data of item at index is changed.
+    void
+    updateItem(unsigned int index);
+
+    //! Forwards state changes of item widgets.
+    void
+    forwardItemState(Widget* item, WidgetState state);
+};
+
+} /* namespace ilixi */
+#endif /* ILIXI_ITEMVIEW_H_ */
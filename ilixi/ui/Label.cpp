@@ -98,6 +98,7 @@ void
 Label::setMargin(const Margin& margin)
 {
     _margin = margin;
+    doLayout();
 }
 
 void
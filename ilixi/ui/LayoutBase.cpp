@@ -24,6 +24,7 @@
 #include <ui/LayoutBase.h>
 #include <ui/RadioButton.h>
 #include <core/Logger.h>
+#include <lib/FrameStats.h>
 
 namespace ilixi
 {
@@ -50,11 +51,18 @@ LayoutBase::~LayoutBase()
 int
 LayoutBase::heightForWidth(int width) const
 {
-    return -1;
+    return calculateHeightForWidth(width);
 }
 
 Size
 LayoutBase::preferredSize() const
+{
+    // children are positioned by user, their geometry is not tracked.
+    return calculatePreferredSize();
+}
+
+Size
+LayoutBase::calculatePreferredSize() const
 {
     ILOG_TRACE_W(ILX_LAYOUT);
     if (_children.size())
@@ -77,6 +85,37 @@ LayoutBase::preferredSize() const
     return Size(0, 0); // FIXME default size for layout.
 }
 
+int
+LayoutBase::calculateHeightForWidth(int width) const
+{
+    return -1;
+}
+
+Size
+LayoutBase::cachedPreferredSize() const
+{
+    if (!_sizeCache.hasSize)
+    {
+        _sizeCache.size = calculatePreferredSize();
+        _sizeCache.hasSize = true;
+    }
+    return _sizeCache.size;
+}
+
+int
+LayoutBase::cachedHeightForWidth(int width) const
+{
+    for (unsigned int i = 0; i < SizeCache::Widths; ++i)
+        if (_sizeCache.widths[i] == width)
+            return _sizeCache.heights[i];
+
+    int height = calculateHeightForWidth(width);
+    _sizeCache.widths[_sizeCache.next] = width;
+    _sizeCache.heights[_sizeCache.next] = height;
+    _sizeCache.next = (_sizeCache.next + 1) % SizeCache::Widths;
+    return height;
+}
+
 void
 LayoutBase::clear()
 {
@@ -183,6 +222,7 @@ LayoutBase::doLayout()
 {
     ILOG_TRACE_W(ILX_LAYOUT);
     _modified = true;
+    _sizeCache.clear();
     if (parent())
         parent()->doLayout();
 }
@@ -192,7 +232,25 @@ LayoutBase::compose(const PaintEvent& event)
 {
     ILOG_TRACE_W(ILX_LAYOUT);
     if (_modified)
+    {
+        FrameStats::instance().begin(FrameStats::Layout);
         tile();
+        FrameStats::instance().end(FrameStats::Layout);
+    }
+}
+
+LayoutBase::SizeCache::SizeCache()
+{
+    clear();
+}
+
+void
+LayoutBase::SizeCache::clear()
+{
+    hasSize = false;
+    next = 0;
+    for (unsigned int i = 0; i < Widths; ++i)
+        widths[i] = -1;
 }
 
 bool
@@ -202,9 +260,7 @@ LayoutBase::consumePointerEvent(const PointerEvent& pointerEvent)
     {
         // priority is given to child on top.
         if (_frameGeometry.contains(pointerEvent.x, pointerEvent.y, true))
-            for (WidgetListReverseIterator it = _children.rbegin(); it != _children.rend(); ++it)
-                if (((Widget*) *it)->consumePointerEvent(pointerEvent))
-                    return true;
+            return consumeChildPointerEvent(pointerEvent);
     }
     return false;
 }
@@ -119,7 +119,7 @@ public:
     tile();
 
     /*!
-     * Invalidates layout and notifies parent.
+     * Invalidates layout and cached sizes, then notifies parent.
      */
     virtual void
     doLayout();
@@ -148,7 +148,67 @@ protected:
     void
     compose(const PaintEvent& event);
 
+    /*!
+     * Returns result of calculatePreferredSize() which is stored until layout is invalidated.
+     *
+     * Layouts with sizes depending only on preferred sizes and constraints of
+     * children should use this method in their preferredSize(), so that nested
+     * layouts measure their children once after each doLayout().
+     */
+    Size
+    cachedPreferredSize() const;
+
+    /*!
+     * Returns result of calculateHeightForWidth() for given width.
+     *
+     * Results for last few widths are stored until layout is invalidated.
+     */
+    int
+    cachedHeightForWidth(int width) const;
+
+    /*!
+     * Calculates a size which holds all widgets.
+     */
+    virtual Size
+    calculatePreferredSize() const;
+
+    /*!
+     * Calculates a height which satisfies all widgets.
+     */
+    virtual int
+    calculateHeightForWidth(int width) const;
+
 private:
+    //! Stores sizes calculated since layout was last invalidated.
+    struct SizeCache
+    {
+        SizeCache();
+
+        //! Removes all stored sizes.
+        void
+        clear();
+
+        //! Number of stored heightForWidth results.
+        enum
+        {
+            Widths = 4
+        };
+
+        //! This flag is set if size is valid.
+        bool hasSize;
+        //! Preferred size of layout.
+        Size size;
+        //! Widths used for heightForWidth(), -1 if slot is empty.
+        int widths[Widths];
+        //! Heights for stored widths.
+        int heights[Widths];
+        //! Slot which is replaced next.
+        unsigned int next;
+    };
+
+    //! This property stores calculated sizes.
+    mutable SizeCache _sizeCache;
+
     /*!
      * If pointer event occurs over widget handle it and return true.
      *
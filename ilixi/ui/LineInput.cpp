@@ -93,6 +93,8 @@ LineInput::clear(int from, int chars)
         update();
     } else if (from == -1 && chars > 0)
     {
+        Rectangle cursor = _cursor;
+        Rectangle selection = _selection;
         if (chars > _cursorIndex)
             chars = _cursorIndex;
 
@@ -118,11 +120,10 @@ LineInput::clear(int from, int chars)
             sigCursorMoved(_cursorIndex, pos1);
             _cursorIndex = pos1;
         }
+        updateCursorPosition();
+        updateSelectionRect();
+        updateEdited(cursor, selection);
     }     // TODO implement from > 0
-    updateCursorPosition();
-    updateSelectionRect();
-    update();
-
 }
 
 bool
@@ -153,6 +154,7 @@ void
 LineInput::setMargin(const Margin& margin)
 {
     _margin = margin;
+    doLayout();
 }
 
 void
@@ -367,6 +369,8 @@ LineInput::pointerMotionEvent(const PointerEvent& mouseEvent)
 void
 LineInput::keyDownEvent(const KeyEvent& keyEvent)
 {
+    Rectangle cursor = _cursor;
+    Rectangle selection = _selection;
     switch (keyEvent.keySymbol)
     {
     case DIKS_CURSOR_LEFT:
@@ -483,14 +487,14 @@ LineInput::keyDownEvent(const KeyEvent& keyEvent)
     }
     updateCursorPosition();
     updateSelectionRect();
-    update();
+    updateEdited(cursor, selection);
 }
 
 void
 LineInput::keyUpEvent(const KeyEvent& keyEvent)
 {
     _cursorOn = true;
-    update();
+    update(PaintEvent(mapFromSurface(_cursor), z()));
 }
 
 void
@@ -528,6 +532,26 @@ LineInput::drawCursor()
     update(PaintEvent(mapFromSurface(_cursor), z()));
 }
 
+void
+LineInput::updateEdited(const Rectangle& cursor, const Rectangle& selection)
+{
+    // cursor updates skip layout at index 0 or for empty text, so dirty rect may not be set yet.
+    _layout.doLayout(font());
+    Rectangle rects[] = { _layout.dirtyRect(), cursor, _cursor, selection, _selection };
+    _layout.clearDirtyRect();
+
+    Rectangle dirty;
+    for (int i = 0; i < 5; ++i)
+        if (!rects[i].isNull())
+            dirty = dirty.isNull() ? rects[i] : dirty.united(rects[i]);
+
+    if (dirty.isNull())
+        return;
+
+    ILOG_DEBUG(ILX_LINEINPUT, " -> Dirty (%d, %d, %d, %d)\n", dirty.x(), dirty.y(), dirty.width(), dirty.height());
+    update(PaintEvent(mapFromSurface(dirty), z()));
+}
+
 void
 LineInput::clearCursorIndex(const std::string& text)
 {
@@ -199,6 +199,10 @@ private:
     void
     updateCursorPosition();
 
+    //! Repaints only text changed by layout and old and new cursor and selection rectangles.
+    void
+    updateEdited(const Rectangle& cursor, const Rectangle& selection);
+
     //! Update selection rectangle using selection and cursor index.
     void
     updateSelectionRect();
@@ -23,6 +23,7 @@
 
 #include <ui/ListBox.h>
 #include <ui/HBoxLayout.h>
+#include <ui/ItemView.h>
 #include <ui/VBoxLayout.h>
 #include <ui/ScrollArea.h>
 #include <core/Logger.h>
@@ -38,12 +39,15 @@ ListBox::ListBox(Widget* parent)
           _orientation(Vertical),
           _scrollArea(NULL),
           _layout(NULL),
+          _view(NULL),
           _currentIndex(-1),
           _currentItem(NULL)
 {
     ILOG_TRACE_W(ILX_LISTBOX);
     setInputMethod(PointerPassthrough);
     _scrollArea = new ScrollArea();
+    // long lists are scrolled often, so only exposed items are repainted.
+    _scrollArea->setBlitScrolling(true);
     addChild(_scrollArea);
 
     _layout = new VBoxLayout();
@@ -68,6 +72,12 @@ void
 ListBox::addItem(Widget* item)
 {
     ILOG_TRACE_W(ILX_LISTBOX);
+    if (_view)
+    {
+        ILOG_WARNING(ILX_LISTBOX, "Cannot add item while a model is set.\n");
+        return;
+    }
+
     if (_layout->addWidget(item))
     {
         _items.push_back(item);
@@ -79,6 +89,8 @@ void
 ListBox::clear()
 {
     ILOG_TRACE_W(ILX_LISTBOX);
+    if (_view)
+        setModel(NULL, NULL);
     _layout->clear();
     _items.clear();
 }
@@ -87,6 +99,8 @@ unsigned int
 ListBox::count() const
 {
     ILOG_TRACE_W(ILX_LISTBOX);
+    if (_view)
+        return _view->count();
     return _layout->count();
 }
 
@@ -94,6 +108,8 @@ Widget*
 ListBox::currentItem() const
 {
     ILOG_TRACE_W(ILX_LISTBOX);
+    if (_view)
+        return _view->itemWidget(_currentIndex);
     return _currentItem;
 }
 
@@ -108,6 +124,8 @@ int
 ListBox::itemIndex(Widget* item)
 {
     ILOG_TRACE_W(ILX_LISTBOX);
+    if (_view)
+        return _view->itemIndex(item);
     int i = 0;
     for (WidgetList::iterator it = _items.begin(); it != _items.end(); ++it, ++i)
         if (*it == item)
@@ -119,6 +137,8 @@ Widget*
 ListBox::itemAtIndex(unsigned int index)
 {
     ILOG_TRACE_W(ILX_LISTBOX);
+    if (_view)
+        return _view->itemWidget(index);
     if (index > _items.size())
         return NULL;
     int i = 0;
@@ -132,6 +152,12 @@ void
 ListBox::insertItem(unsigned int index, Widget* item)
 {
     ILOG_TRACE_W(ILX_LISTBOX);
+    if (_view)
+    {
+        ILOG_WARNING(ILX_LISTBOX, "Cannot insert item while a model is set.\n");
+        return;
+    }
+
     if (_orientation == Horizontal)
         ((HBoxLayout*) _layout)->insertWidget(index, item);
     else
@@ -142,6 +168,9 @@ bool
 ListBox::removeItem(Widget* item)
 {
     ILOG_TRACE_W(ILX_LISTBOX);
+    if (_view)
+        return false;
+
     if (_layout->removeWidget(item))
     {
         for (WidgetListIterator it = _items.begin(); it != _items.end(); ++it)
@@ -164,6 +193,9 @@ bool
 ListBox::removeItem(unsigned int index)
 {
     ILOG_TRACE_W(ILX_LISTBOX);
+    if (_view)
+        return false;
+
     Widget* widget = itemAtIndex(index);
     if (widget)
     {
@@ -173,6 +205,12 @@ ListBox::removeItem(unsigned int index)
     return false;
 }
 
+ItemModel*
+ListBox::model() const
+{
+    return _view ? _view->model() : NULL;
+}
+
 Orientation
 ListBox::orientation() const
 {
@@ -183,6 +221,26 @@ void
 ListBox::setCurrentItem(unsigned int index)
 {
     ILOG_TRACE_W(ILX_LISTBOX);
+    if (_view)
+    {
+        if (_currentIndex != index && index < _view->count())
+        {
+            _currentItem = _view->itemWidget(index);
+            if (_currentItem)
+                _scrollArea->scrollTo(_currentItem);
+            else
+            {
+                Point p = _view->scrollPosition(index, _scrollArea->size());
+                _scrollArea->scrollTo(p.x(), p.y());
+            }
+
+            int oldIndex = _currentIndex;
+            _currentIndex = index;
+            sigIndexChanged(oldIndex, _currentIndex);
+        }
+        return;
+    }
+
     if (_currentIndex != index && index < _items.size())
     {
         _currentItem = itemAtIndex(index);
@@ -199,6 +257,14 @@ void
 ListBox::setCurrentItem(Widget* item)
 {
     ILOG_TRACE_W(ILX_LISTBOX);
+    if (_view)
+    {
+        int index = _view->itemIndex(item);
+        if (index >= 0)
+            setCurrentItem((unsigned int) index);
+        return;
+    }
+
     if (_currentItem != item && _layout->isChild(item))
     {
         _currentItem = item;
@@ -218,6 +284,11 @@ ListBox::setOrientation(Orientation orientation)
     if (_orientation != orientation)
     {
         _orientation = orientation;
+        if (_view)
+        {
+            _view->setOrientation(_orientation);
+            return;
+        }
 
         for (WidgetListIterator it = _items.begin(); it != _items.end(); ++it)
             _layout->removeWidget(*it, false);
@@ -256,7 +327,43 @@ ListBox::setUseThumbs(bool useThumbs)
 void
 ListBox::setSpacing(int spacing)
 {
-    _layout->setSpacing(spacing);
+    if (_view)
+        _view->setSpacing(spacing);
+    else
+        _layout->setSpacing(spacing);
+}
+
+void
+ListBox::setModel(ItemModel* model, ItemFactory* factory)
+{
+    ILOG_TRACE_W(ILX_LISTBOX);
+    _currentIndex = -1;
+    _currentItem = NULL;
+
+    if (model && factory)
+    {
+        if (!_view)
+        {
+            _view = new ItemView();
+            _view->setOrientation(_orientation);
+            _view->setSpacing(_layout->spacing());
+            _view->sigItemStateChanged.connect(sigc::mem_fun(this, &ListBox::trackItem));
+            _items.clear();
+            _layout = NULL;
+            _scrollArea->setContent(_view);
+        }
+        _view->setModel(model, factory);
+    } else if (_view)
+    {
+        if (_orientation == Vertical)
+            _layout = new VBoxLayout();
+        else
+            _layout = new HBoxLayout();
+        _layout->setSpacing(_view->spacing());
+        _layout->setKeyNavChildrenFirst(true);
+        _view = NULL;
+        _scrollArea->setContent(_layout);
+    }
 }
 
 void
@@ -28,10 +28,18 @@
 
 namespace ilixi
 {
+class ItemFactory;
+class ItemModel;
+class ItemView;
 class LayoutBase;
 class ScrollArea;
 
 //! A container widget with a ScrollArea and a horizontal or vertical layout.
+/*!
+ * Items are either added as widgets using addItem() or they are provided by a
+ * model, see setModel(). In latter case only visible items have widgets and
+ * these widgets are reused while list is scrolled.
+ */
 class ListBox : public Widget
 {
 public:
@@ -53,12 +61,16 @@ public:
 
     /*!
      * Adds widget to internal layout.
+     *
+     * Items can not be added while a model is set.
      */
     void
     addItem(Widget* item);
 
     /*!
      * Removes all widgets from layout.
+     *
+     * If a model is set, it is removed and list uses a layout again.
      */
     void
     clear();
@@ -96,7 +108,8 @@ public:
     /*!
      * Returns the widget at given index.
      *
-     * Returns NULL if there is no item at index.
+     * Returns NULL if there is no item at index, or if a model is set
+     * and item at index is not visible.
      */
     Widget*
     itemAtIndex(unsigned int index);
@@ -119,6 +132,12 @@ public:
     bool
     removeItem(unsigned int index);
 
+    /*!
+     * Returns model or NULL if items are added as widgets.
+     */
+    ItemModel*
+    model() const;
+
     /*!
      * Returns current orientation, i.e. horizontal or vertical.
      */
@@ -141,6 +160,18 @@ public:
     void
     setCurrentItem(Widget* item);
 
+    /*!
+     * Sets model and factory used for creating item widgets.
+     *
+     * Existing items are removed. Only visible items, plus a few rows outside
+     * visible area, have widgets which are created by factory and recycled
+     * while list is scrolled. Model and factory are not owned by listbox.
+     *
+     * Setting a NULL model removes it and list uses a layout again.
+     */
+    void
+    setModel(ItemModel* model, ItemFactory* factory);
+
     /*!
      * Sets orientation.
      *
@@ -194,8 +225,10 @@ private:
     Orientation _orientation;
     //! This holds internal layout.
     ScrollArea* _scrollArea;
-    //! This is the internal layout.
+    //! This is the internal layout, NULL if a model is set.
     LayoutBase* _layout;
+    //! This is used instead of layout if a model is set.
+    ItemView* _view;
     //! Index of current item.
     unsigned int _currentIndex;
     //! Points to current/last focused item.
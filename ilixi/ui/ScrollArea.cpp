@@ -22,10 +22,12 @@
  */
 
 #include <ui/ScrollArea.h>
+#include <ui/WindowWidget.h>
 #include <graphics/Painter.h>
 #include <lib/TweenAnimation.h>
 #include <core/Logger.h>
 #include <cmath>
+#include <stdlib.h>
 
 namespace ilixi
 {
@@ -37,9 +39,11 @@ ScrollArea::ScrollArea(Widget* parent)
           _options(HorizontalAuto | VerticalAuto | UseBars),
           _content(NULL),
           _horizontalBar(NULL),
-          _verticalBar(NULL)
+          _verticalBar(NULL),
+          _scrollSerial(0)
 {
     ILOG_TRACE_W(ILX_SCROLLAREA);
+    updateSurfaceFlags();
     setInputMethod((WidgetInputMethod) (PointerInput | PointerTracking | PointerGrabbing));
     setConstraints(NoConstraint, NoConstraint);
     sigGeometryUpdated.connect(sigc::mem_fun(this, &ScrollArea::updateScollAreaGeometry));
@@ -102,8 +106,7 @@ ScrollArea::setContent(Widget* content)
     {
         removeChild(_content);
         _content = content;
-        if (_options & SmoothScrolling)
-            surface()->setSurfaceFlag(Surface::BlitDescription);
+        updateSurfaceFlags();
         addChild(_content);
         raiseChildToFront(_content);
         doLayout();
@@ -132,15 +135,20 @@ void
 ScrollArea::setSmoothScrolling(bool smoothScroll)
 {
     if (smoothScroll)
-    {
         _options |= SmoothScrolling;
-        surface()->setSurfaceFlag(Surface::BlitDescription);
-    } else
-    {
+    else
         _options &= ~SmoothScrolling;
-        surface()->unsetSurfaceFlag(Surface::HasOwnSurface);
-        surface()->setSurfaceFlag(Surface::DefaultDescription);
-    }
+    updateSurfaceFlags();
+}
+
+void
+ScrollArea::setBlitScrolling(bool blitScroll)
+{
+    if (blitScroll)
+        _options |= BlitScrolling;
+    else
+        _options &= ~BlitScrolling;
+    updateSurfaceFlags();
 }
 
 void
@@ -233,11 +241,33 @@ ScrollArea::paint(const PaintEvent& event)
         PaintEvent evt(this, event);
         if (evt.isValid())
         {
-            compose(evt);
+#ifndef ILIXI_STEREO_OUTPUT
+            if ((_options & BlitScrolling) && _content && _rootWindow)
+            {
+                if (_scrollSerial != _rootWindow->paintSerial())
+                    prepareScroll();
 
+                // remaining pixels are blitted from own surface by parent.
+                const Region::RectangleList& rects = _scrollRepaint.rects();
+                for (Region::RectangleList::const_iterator it = rects.begin(); it != rects.end(); ++it)
+                {
+                    PaintEvent e(evt);
+                    e.rect = it->intersected(evt.rect);
+                    if (!e.rect.isValid())
+                        continue;
+
+                    ILOG_DEBUG(ILX_SCROLLAREA, " -> repaint %d, %d, %d, %d\n", e.rect.x(), e.rect.y(), e.rect.width(), e.rect.height());
+                    surface()->clip(mapToSurface(e.rect));
+                    surface()->clear(mapToSurface(e.rect));
+                    paintArea(e);
+                    drawThumbs(e);
+                }
+                return;
+            }
+#endif
             if (_options & SmoothScrolling)
             {
-
+                compose(evt);
                 if (_content->surface())
                     _content->surface()->clear();
 
@@ -245,52 +275,8 @@ ScrollArea::paint(const PaintEvent& event)
                 _content->surface()->flip();
 //                surface()->blit(_content->surface(), Rectangle(-_cx, -_cy, width(), height()), 0, 0);
             } else
-            {
-                _horizontalBar->paint(evt);
-                _verticalBar->paint(evt);
-                if (_content)
-                {
-                    if (_options & UseBars)
-                    {
-                        int w = width();
-                        int h = height();
-                        if (_options & HasVertical)
-                            w = width() - _verticalBar->width();
-                        if (_options & HasHorizontal)
-                            h = height() - _horizontalBar->height();
-                        Rectangle r(absX(), absY(), w, h);
-                        if (_options & DrawFrame)
-                            r.setRectangle(absX() + stylist()->defaultParameter(StyleHint::LineInputLeft), absY() + stylist()->defaultParameter(StyleHint::LineInputTop), w - stylist()->defaultParameter(StyleHint::LineInputLR), h - stylist()->defaultParameter(StyleHint::LineInputTB));
-                        evt.rect = evt.rect.intersected(r);
-                        _content->paint(evt);
-                    } else
-                    {
-                        if (_options & DrawFrame)
-                        {
-                            Rectangle r(absX(), absY(), width(), height());
-                            r.setRectangle(absX() + stylist()->defaultParameter(StyleHint::LineInputLeft), absY() + stylist()->defaultParameter(StyleHint::LineInputTop), width() - stylist()->defaultParameter(StyleHint::LineInputLR), height() - stylist()->defaultParameter(StyleHint::LineInputTB));
-                            evt.rect = evt.rect.intersected(r);
-                        }
-                        _content->paint(evt);
-                    }
-                }
-            }
-            if (!(_options & UseBars) && (_ani->state() == Animation::Running))
-            {
-                Painter p(this);
-                p.begin(event);
-                if (_options & HasHorizontal)
-                {
-                    int x = 1 + (width() - _thumbs.width() - 12.0) * _xTween->value() / _sMax.x();
-                    stylist()->drawScrollBar(&p, x, height() - stylist()->defaultParameter(StyleHint::ScrollBarHeight), _thumbs.width(), stylist()->defaultParameter(StyleHint::ScrollBarHeight), Horizontal);
-                }
-
-                if (_options & HasVertical)
-                {
-                    int y = 1 + (height() - _thumbs.height() - 12.0) * _yTween->value() / _sMax.y();
-                    stylist()->drawScrollBar(&p, width() - stylist()->defaultParameter(StyleHint::ScrollBarWidth), y, stylist()->defaultParameter(StyleHint::ScrollBarWidth), _thumbs.height(), Vertical);
-                }
-            }
+                paintArea(evt);
+            drawThumbs(event);
         }
     }
 }
@@ -479,6 +465,7 @@ ScrollArea::updateScollAreaGeometry()
 
     int w = width();
     int h = height();
+    _options &= ~ScrollPixelsValid;
 
     if (!(_options & ContentWasScrolled))
     {
@@ -566,7 +553,7 @@ ScrollArea::updateScrollArea()
     {
     }
 
-    update();
+    scrollUpdate();
 }
 
 void
@@ -576,7 +563,7 @@ ScrollArea::barScrollX(int x)
         _content->setX(-x + stylist()->defaultParameter(StyleHint::LineInputLeft));
     else
         _content->setX(-x);
-    update();
+    scrollUpdate();
 }
 
 void
@@ -586,7 +573,151 @@ ScrollArea::barScrollY(int y)
         _content->setY(-y + stylist()->defaultParameter(StyleHint::LineInputTop));
     else
         _content->setY(-y);
+    scrollUpdate();
+}
+
+void
+ScrollArea::updateSurfaceFlags()
+{
+    _options &= ~ScrollPixelsValid;
+    if (_options & BlitScrolling)
+    {
+        // pixels are kept between paints, so surface can not be flipped.
+        surface()->unsetSurfaceFlag(Surface::SharedSurface);
+        surface()->setSurfaceFlag((Surface::SurfaceFlags) (Surface::BlitDescription | Surface::ForceSingleSurface));
+    } else if (_options & SmoothScrolling)
+    {
+        surface()->unsetSurfaceFlag(Surface::ForceSingleSurface);
+        surface()->setSurfaceFlag(Surface::BlitDescription);
+    } else
+    {
+        surface()->unsetSurfaceFlag((Surface::SurfaceFlags) (Surface::HasOwnSurface | Surface::ForceSingleSurface));
+        surface()->setSurfaceFlag(Surface::DefaultDescription);
+    }
+}
+
+Rectangle
+ScrollArea::viewRect() const
+{
+    int w = width();
+    int h = height();
+    if (_options & UseBars)
+    {
+        if (_options & HasVertical)
+            w -= _verticalBar->width();
+        if (_options & HasHorizontal)
+            h -= _horizontalBar->height();
+    }
+
+    if (_options & DrawFrame)
+        return Rectangle(absX() + stylist()->defaultParameter(StyleHint::LineInputLeft), absY() + stylist()->defaultParameter(StyleHint::LineInputTop), w - stylist()->defaultParameter(StyleHint::LineInputLR), h - stylist()->defaultParameter(StyleHint::LineInputTB));
+    return Rectangle(absX(), absY(), w, h);
+}
+
+void
+ScrollArea::scrollUpdate()
+{
+    if ((_options & BlitScrolling) && (_options & ScrollPixelsValid) && _rootWindow && visible())
+    {
+        Rectangle view = viewRect();
+        if (abs(_content->x() - _scrollPos.x()) < view.width() && abs(_content->y() - _scrollPos.y()) < view.height())
+        {
+            // prepareScroll() moves pixels and repaints exposed strips.
+            _rootWindow->expose(frameGeometry());
+            return;
+        }
+    }
     update();
 }
 
+void
+ScrollArea::prepareScroll()
+{
+    ILOG_TRACE_W(ILX_SCROLLAREA);
+    _scrollSerial = _rootWindow->paintSerial();
+    _scrollRepaint.clear();
+
+    Rectangle view = viewRect();
+    int dx = _content->x() - _scrollPos.x();
+    int dy = _content->y() - _scrollPos.y();
+    _scrollPos = Point(_content->x(), _content->y());
+
+    // damaged pixels are moved with content, so they are repainted at both positions.
+    const Region::RectangleList& damage = _rootWindow->damagedRegion().rects();
+    for (Region::RectangleList::const_iterator it = damage.begin(); it != damage.end(); ++it)
+    {
+        _scrollRepaint.add(it->intersected(frameGeometry()));
+        if (dx || dy)
+        {
+            Rectangle r = *it;
+            r.translate(dx, dy);
+            _scrollRepaint.add(r.intersected(view));
+        }
+    }
+
+    if (dx || dy)
+    {
+        if ((_options & ScrollPixelsValid) && abs(dx) < view.width() && abs(dy) < view.height())
+        {
+            ILOG_DEBUG(ILX_SCROLLAREA, " -> scroll by %d, %d\n", dx, dy);
+            surface()->scroll(mapToSurface(view), dx, dy);
+
+            Rectangle moved = view;
+            moved.translate(dx, dy);
+            Region exposed;
+            exposed.add(view);
+            exposed.subtract(moved);
+            _scrollRepaint.add(exposed);
+        } else
+            _scrollRepaint.add(view);
+
+        // thumbs are drawn over content and move with it.
+        if (!(_options & UseBars))
+        {
+            int sw = stylist()->defaultParameter(StyleHint::ScrollBarWidth);
+            int sh = stylist()->defaultParameter(StyleHint::ScrollBarHeight);
+            _scrollRepaint.add(Rectangle(absX() + width() - sw, absY(), sw, height()));
+            _scrollRepaint.add(Rectangle(absX(), absY() + height() - sh, width(), sh));
+        }
+    }
+
+    if (_scrollRepaint.contains(view))
+        _options |= ScrollPixelsValid;
+}
+
+void
+ScrollArea::paintArea(const PaintEvent& event)
+{
+    compose(event);
+    _horizontalBar->paint(event);
+    _verticalBar->paint(event);
+    if (_content)
+    {
+        PaintEvent evt(event);
+        evt.rect = event.rect.intersected(viewRect());
+        _content->paint(evt);
+    }
+}
+
+void
+ScrollArea::drawThumbs(const PaintEvent& event)
+{
+    if (!(_options & UseBars) && (_ani->state() == Animation::Running))
+    {
+        Painter p(this);
+        p.begin(event);
+        if (_options & HasHorizontal)
+        {
+            int x = 1 + (width() - _thumbs.width() - 12.0) * _xTween->value() / _sMax.x();
+            stylist()->drawScrollBar(&p, x, height() - stylist()->defaultParameter(StyleHint::ScrollBarHeight), _thumbs.width(), stylist()->defaultParameter(StyleHint::ScrollBarHeight), Horizontal);
+        }
+
+        if (_options & HasVertical)
+        {
+            int y = 1 + (height() - _thumbs.height() - 12.0) * _yTween->value() / _sMax.y();
+            stylist()->drawScrollBar(&p, width() - stylist()->defaultParameter(StyleHint::ScrollBarWidth), y, stylist()->defaultParameter(StyleHint::ScrollBarWidth), _thumbs.height(), Vertical);
+        }
+    }
+}
+
 } /* namespace ilixi */
@@ -35,6 +35,11 @@ class Tween;
 /*!
  * This class provides a way to scroll over a large content using pointer.
  * By default, smooth scrolling is off.
+ *
+ * If blit scrolling is enabled using setBlitScrolling(), scroll area has its own
+ * surface and scrolling moves already rendered pixels of content inside this
+ * surface. Only the newly exposed strips and damaged areas of content are
+ * repainted. By default, blit scrolling is off and content is repainted.
  */
 class ScrollArea : public Widget
 {
@@ -94,6 +99,14 @@ public:
     void
     setSmoothScrolling(bool smoothScroll);
 
+    /*!
+     * Sets whether scrolling moves rendered pixels instead of repainting content, disabled by default.
+     *
+     * This should be set before content is added.
+     */
+    void
+    setBlitScrolling(bool blitScroll);
+
     /*!
      * Sets whether frame is drawn.
      */
@@ -173,7 +186,9 @@ private:
         VerticalAlways = 0x01000,           //!< Makes vertical thumb/bar always visible automatically.
         VerticalAuto = 0x02000,             //!< Makes vertical thumb/bar visible automatically.
         VerticalScrollEnabled = 0x04000,    //!< Whether vertical scrolling is enabled.
-        ContentWasScrolled = 0x08000
+        ContentWasScrolled = 0x08000,
+        BlitScrolling = 0x10000,            //!< Scrolling moves pixels inside own surface.
+        ScrollPixelsValid = 0x20000         //!< Own surface stores content painted at _scrollPos.
     };
 
     //! This property stores the options for ScrollArea.
@@ -200,6 +215,37 @@ private:
     //! This is used to calculate weighted average velocity.
     std::queue<PointerEvent> _events;
 
+    //! Position of content when it was last painted.
+    Point _scrollPos;
+    //! Areas repainted during current paint.
+    Region _scrollRepaint;
+    //! Window paint serial for _scrollRepaint.
+    unsigned int _scrollSerial;
+
+    //! Sets surface flags according to scrolling options.
+    void
+    updateSurfaceFlags();
+
+    //! Returns visible area of content in absolute coordinates.
+    Rectangle
+    viewRect() const;
+
+    //! Queues a paint after content is moved.
+    void
+    scrollUpdate();
+
+    //! Moves pixels of content and calculates areas to repaint in this paint.
+    void
+    prepareScroll();
+
+    //! Paints frame, bars and content inside rect.
+    void
+    paintArea(const PaintEvent& event);
+
+    //! Draws thumbs while content is animated.
+    void
+    drawThumbs(const PaintEvent& event);
+
     void
     updateHDraws(int contentWidth);
 
@@ -43,7 +43,12 @@ SurfaceView::SurfaceView(Widget* parent)
           _sourceWindow(NULL),
           _windowID(0),
           _flipCount(0),
-          _svState(SV_NONE)
+          _svState(SV_NONE),
+          _maxUpdateRate(0),
+          _scaledSurface(NULL),
+          _scaledDirty(true),
+          _scaledTime(0),
+          _scaledTimer(NULL)
 {
     ILOG_TRACE_W(ILX_SURFACEVIEW);
     setInputMethod(KeyPointerTracking);
@@ -56,6 +61,8 @@ SurfaceView::SurfaceView(Widget* parent)
 
 SurfaceView::~SurfaceView()
 {
+    delete _scaledTimer;
+    releaseScaledSurface();
     detachSourceSurface();
     if (_sourceSurface)
         _sourceSurface->Release(_sourceSurface);
@@ -101,6 +108,12 @@ SurfaceView::isBlendingEnabled() const
     return _svState & SV_CAN_BLEND;
 }
 
+unsigned int
+SurfaceView::maxUpdateRate() const
+{
+    return _maxUpdateRate;
+}
+
 void
 SurfaceView::setSourceFromSurfaceID(DFBSurfaceID sid)
 {
@@ -205,6 +218,23 @@ SurfaceView::setBlendingEnabled(bool blending)
         _svState = (SurfaceViewFlags) (_svState & ~SV_CAN_BLEND);
 }
 
+void
+SurfaceView::setMaxUpdateRate(unsigned int fps)
+{
+    if (fps == _maxUpdateRate)
+        return;
+
+    _maxUpdateRate = fps;
+    if (!_maxUpdateRate)
+    {
+        if (_scaledTimer)
+            _scaledTimer->stop();
+        releaseScaledSurface();
+    }
+    _scaledDirty = true;
+    update();
+}
+
 void
 SurfaceView::paint(const PaintEvent& event)
 {
@@ -294,7 +324,14 @@ SurfaceView::renderSource(const PaintEvent& event)
             dfbSurface->SetColor(dfbSurface, 0, 0, 0, opacity());
         }
 
-        if (hScale() == 1 && vScale() == 1)
+        if (_maxUpdateRate && (hScale() != 1 || vScale() != 1))
+        {
+            updateScaledSurface();
+            if (surface()->flags() & Surface::SharedSurface)
+                dfbSurface->Blit(dfbSurface, _scaledSurface ? _scaledSurface : _sourceSurface, NULL, absX(), absY());
+            else
+                dfbSurface->Blit(dfbSurface, _scaledSurface ? _scaledSurface : _sourceSurface, NULL, 0, 0);
+        } else if (hScale() == 1 && vScale() == 1)
         {
             if (surface()->flags() & Surface::SharedSurface)
                 dfbSurface->Blit(dfbSurface, _sourceSurface, NULL, absX(), absY());
@@ -332,6 +369,22 @@ SurfaceView::onSourceUpdate(const DFBSurfaceEvent& event)
         ILOG_DEBUG(ILX_SURFACEVIEW, " -> Set SV_READY\n");
     }
 
+    if (_maxUpdateRate)
+    {
+        // downscaled copy does not need every frame, so do not hold back client.
+        _flipCount = event.flip_count;
+        _sourceSurface->FrameAck(_sourceSurface, _flipCount);
+        ILOG_DEBUG(ILX_SURFACEVIEW, " -> FrameAck for frame %d\n", _flipCount);
+        if (visible())
+            scheduleScaledUpdate(event.update);
+        else
+        {
+            _scaledDirty = true;
+            sigSourceUpdated();
+        }
+        return true;
+    }
+
     if (_updateFlipCount)
     {
         _updateFlipCount = false;
@@ -372,6 +425,9 @@ SurfaceView::onSourceUpdate(const DFBSurfaceEvent& event)
 void
 SurfaceView::onSourceDestroyed(const DFBSurfaceEvent& event)
 {
+    if (_scaledTimer)
+        _scaledTimer->stop();
+    releaseScaledSurface();
     if (_sourceSurface)
         _sourceSurface->Release(_sourceSurface);
     if (_sourceWindow)
@@ -393,6 +449,100 @@ SurfaceView::onSVGeomUpdate()
         _hScale = (float) (0.0 + w) / width();
         _vScale = (float) (0.0 + h) / height();
     }
+    releaseScaledSurface();
+}
+
+void
+SurfaceView::updateScaledSurface()
+{
+    if (!_scaledSurface)
+    {
+        if (width() <= 0 || height() <= 0)
+            return;
+
+        DFBSurfaceDescription desc;
+        desc.flags = (DFBSurfaceDescriptionFlags) (DSDESC_WIDTH | DSDESC_HEIGHT | DSDESC_PIXELFORMAT | DSDESC_CAPS);
+        desc.width = width();
+        desc.height = height();
+        _sourceSurface->GetPixelFormat(_sourceSurface, &desc.pixelformat);
+        _sourceSurface->GetCapabilities(_sourceSurface, &desc.caps);
+        desc.caps = (DFBSurfaceCapabilities) (desc.caps & DSCAPS_PREMULTIPLIED);
+
+        DFBResult ret = PlatformManager::instance().getDFB()->CreateSurface(PlatformManager::instance().getDFB(), &desc, &_scaledSurface);
+        if (ret)
+        {
+            ILOG_ERROR(ILX_SURFACEVIEW, "Cannot create scaled surface: %s\n", DirectFBErrorString(ret));
+            _scaledSurface = NULL;
+            return;
+        }
+        _scaledDirty = true;
+    }
+
+    if (_scaledDirty)
+    {
+        ILOG_DEBUG(ILX_SURFACEVIEW_UPDATES, "[%p] Refreshing scaled copy (%d, %d)\n", this, width(), height());
+        _scaledSurface->SetBlittingFlags(_scaledSurface, DSBLIT_NOFX);
+        _scaledSurface->SetRenderOptions(_scaledSurface, DSRO_SMOOTH_DOWNSCALE);
+        _scaledSurface->StretchBlit(_scaledSurface, _sourceSurface, NULL, NULL);
+        _scaledDirty = false;
+        _scaledTime = direct_clock_get_millis();
+        _scaledDamage = Rectangle();
+    }
+}
+
+void
+SurfaceView::scheduleScaledUpdate(const DFBRegion& damage)
+{
+    Rectangle rect(damage.x1, damage.y1, damage.x2 - damage.x1 + 1, damage.y2 - damage.y1 + 1);
+    if (_scaledDamage.isNull())
+        _scaledDamage = rect;
+    else
+        _scaledDamage.unite(rect);
+
+    // small changes, e.g. a blinking cursor, are refreshed less often.
+    int w, h;
+    _sourceSurface->GetSize(_sourceSurface, &w, &h);
+    long long interval = 1000 / _maxUpdateRate;
+    if (_scaledDamage.width() * _scaledDamage.height() * 4 < w * h)
+        interval *= 4;
+
+    long long elapsed = direct_clock_get_millis() - _scaledTime;
+    if (elapsed >= interval)
+    {
+        _scaledDirty = true;
+        update();
+    } else
+    {
+        if (!_scaledTimer)
+        {
+            _scaledTimer = new Timer();
+            _scaledTimer->sigExec.connect(sigc::mem_fun(this, &SurfaceView::onScaledTimer));
+        }
+        if (!_scaledTimer->running())
+            _scaledTimer->start(interval - elapsed, 1);
+    }
+}
+
+void
+SurfaceView::onScaledTimer()
+{
+    _scaledTimer->stop();
+    if (_sourceSurface && !_scaledDamage.isNull())
+    {
+        _scaledDirty = true;
+        update();
+    }
+}
+
+void
+SurfaceView::releaseScaledSurface()
+{
+    if (_scaledSurface)
+    {
+        _scaledSurface->Release(_scaledSurface);
+        _scaledSurface = NULL;
+    }
+    _scaledDirty = true;
 }
 
 void
@@ -26,6 +26,7 @@
 
 #include <ui/Widget.h>
 #include <core/SurfaceEventListener.h>
+#include <lib/Timer.h>
 
 namespace ilixi
 {
@@ -75,6 +76,12 @@ public:
     bool
     isBlendingEnabled() const;
 
+    /*!
+     * Returns maximum number of times per second source is rendered, 0 means no limit.
+     */
+    unsigned int
+    maxUpdateRate() const;
+
     /*!
      * Sets source surface using given id.
      */
@@ -99,6 +106,17 @@ public:
     void
     setBlendingEnabled(bool blending);
 
+    /*!
+     * Limits how often a scaled source is rendered, e.g. for thumbnails.
+     *
+     * If fps is not zero, source is downscaled once into a private surface and the view
+     * draws this copy. The copy is refreshed at most fps times per second, and less often
+     * if only a small part of source is damaged. Source flips are acknowledged immediately,
+     * so client is not slowed down by this view.
+     */
+    void
+    setMaxUpdateRate(unsigned int fps);
+
     void
     paint(const PaintEvent& event);
 
@@ -166,6 +184,34 @@ private:
     bool _sourceStereo;
 #endif
     bool _updateFlipCount;
+    //! This property stores maximum update rate, 0 means no limit.
+    unsigned int _maxUpdateRate;
+    //! This property stores downscaled copy of source if update rate is limited.
+    IDirectFBSurface* _scaledSurface;
+    //! True if downscaled copy is outdated.
+    bool _scaledDirty;
+    //! This property stores the time when downscaled copy was refreshed.
+    long long _scaledTime;
+    //! This property stores source area damaged since last refresh.
+    Rectangle _scaledDamage;
+    //! This timer refreshes downscaled copy once rate limit allows.
+    Timer* _scaledTimer;
+
+    //! Refreshes downscaled copy of source if it is outdated.
+    void
+    updateScaledSurface();
+
+    //! Schedules a refresh of downscaled copy after source is damaged.
+    void
+    scheduleScaledUpdate(const DFBRegion& damage);
+
+    //! Timer slot.
+    void
+    onScaledTimer();
+
+    //! Releases downscaled copy of source.
+    void
+    releaseScaledSurface();
 
     bool
     onSourceUpdate(const DFBSurfaceEvent& event);
@@ -131,6 +131,12 @@ TabPanel::preferredSize() const
     return Size(stylist()->defaultParameter(StyleHint::FrameOffsetLR) + _margin.hSum() + w, stylist()->defaultParameter(StyleHint::FrameOffsetTB) + _margin.vSum() + h + _canvasOffsetY);
 }
 
+Rectangle
+TabPanel::opaqueGeometry() const
+{
+    return Widget::opaqueGeometry();
+}
+
 int
 TabPanel::canvasY() const
 {
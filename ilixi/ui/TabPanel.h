@@ -104,6 +104,12 @@ public:
     virtual Size
     preferredSize() const;
 
+    /*!
+     * Returns opaque area only if widget is marked as opaque.
+     */
+    virtual Rectangle
+    opaqueGeometry() const;
+
     /*!
      * Returns frame's canvas y-coordinate including the top margin.
      */
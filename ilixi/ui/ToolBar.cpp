@@ -150,6 +150,12 @@ ToolBar::preferredSize() const
     return Size(s.width() + _margin.hSum(), stylist()->defaultParameter(StyleHint::ToolBarHeight));
 }
 
+Rectangle
+ToolBar::opaqueGeometry() const
+{
+    return Widget::opaqueGeometry();
+}
+
 void
 ToolBar::compose(const PaintEvent& event)
 {
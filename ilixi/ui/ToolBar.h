@@ -116,6 +116,12 @@ public:
     Size
     preferredSize() const;
 
+    /*!
+     * Returns opaque area only if widget is marked as opaque.
+     */
+    virtual Rectangle
+    opaqueGeometry() const;
+
 protected:
     /*!
      * Draws toolbar using stylist.
@@ -196,7 +196,11 @@ ToolButton::toolButtonStyle() const
 void
 ToolButton::setToolButtonStyle(ToolButtonStyle style)
 {
-    _toolButtonStyle = style;
+    if (_toolButtonStyle != style)
+    {
+        _toolButtonStyle = style;
+        doLayout();
+    }
 }
 
 void
@@ -238,6 +242,7 @@ ToolButton::setIconSize(const Size& size)
             _icon->setSize(size);
         else
             _icon->setSize(_icon->preferredSize());
+        doLayout();
     }
 }
 
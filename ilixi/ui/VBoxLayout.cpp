@@ -67,6 +67,18 @@ VBoxLayout::insertWidget(unsigned int row, Widget* widget)
 
 int
 VBoxLayout::heightForWidth(int width) const
+{
+    return cachedHeightForWidth(width);
+}
+
+Size
+VBoxLayout::preferredSize() const
+{
+    return cachedPreferredSize();
+}
+
+int
+VBoxLayout::calculateHeightForWidth(int width) const
 {
     if (!_children.size())
         return -1;
@@ -128,7 +140,7 @@ VBoxLayout::heightForWidth(int width) const
 }
 
 Size
-VBoxLayout::preferredSize() const
+VBoxLayout::calculatePreferredSize() const
 {
     ILOG_TRACE_W(ILX_VBOX);
 
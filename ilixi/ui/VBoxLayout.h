@@ -84,6 +84,13 @@ public:
     void
     tile();
 
+protected:
+    virtual Size
+    calculatePreferredSize() const;
+
+    virtual int
+    calculateHeightForWidth(int width) const;
+
 private:
     //! This property defines how widgets are placed on x axis.
     Alignment::Horizontal _alignment;
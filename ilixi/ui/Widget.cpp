@@ -22,9 +22,12 @@
  */
 
 #include <algorithm>
+#include <vector>
 #include <core/EventFilter.h>
 #include <core/Logger.h>
 #include <core/Window.h>
+#include <lib/ImageLoader.h>
+#include <ui/HitTestGrid.h>
 #include <ui/Widget.h>
 #include <ui/WindowWidget.h>
 
@@ -42,13 +45,15 @@ Widget::Widget(Widget* parent)
           _id(_idCounter++),
           _z(0),
           _opacity(255),
+          _opaque(false),
           _parent(parent),
           _surface(new Surface(this)),
           _rootWindow(NULL),
           _preSelectedWidget(NULL),
           _xResizeConstraint(NoConstraint),
           _yResizeConstraint(NoConstraint),
-          _eventFilter(NULL)
+          _eventFilter(NULL),
+          _hitTestGrid(NULL)
 {
     _neighbours[0] = NULL;
     _neighbours[1] = NULL;
@@ -65,13 +70,15 @@ Widget::Widget(const Widget& widget)
         : _state(widget._state),
           _inputMethod(widget._inputMethod),
           _opacity(widget._opacity),
+          _opaque(widget._opaque),
           _parent(widget._parent),
           _surface(NULL),
           _rootWindow(widget._rootWindow),
           _preSelectedWidget(widget._preSelectedWidget),
           _xResizeConstraint(widget._xResizeConstraint),
           _yResizeConstraint(widget._yResizeConstraint),
-          _eventFilter(NULL)
+          _eventFilter(NULL),
+          _hitTestGrid(NULL)
 {
     _id = _idCounter++;
     _z = 0;
@@ -89,9 +96,13 @@ Widget::~Widget()
     ILOG_TRACE_W(ILX_WIDGET);
     if (eventManager())
         eventManager()->clear(this);
+    ImageLoader::instance().cancel(this);
 
     for (WidgetListIterator it = _children.begin(); it != _children.end(); ++it)
         delete *it;
+    // children may access grid while they are destroyed.
+    delete _hitTestGrid;
+    _hitTestGrid = NULL;
     delete _surface;
 }
 
@@ -247,6 +258,26 @@ Widget::opacity() const
     return _opacity;
 }
 
+bool
+Widget::opaque() const
+{
+    return _opaque;
+}
+
+Rectangle
+Widget::opaqueGeometry() const
+{
+    if (_opaque && opacity() == 255 && visible())
+        return _frameGeometry;
+    return Rectangle();
+}
+
+bool
+Widget::cached() const
+{
+    return _surface->flags() & Surface::CachedCompose;
+}
+
 bool
 Widget::hasFocus() const
 {
@@ -313,6 +344,7 @@ Widget::moveTo(int x, int y)
         _frameGeometry.setX(_parent ? _surfaceGeometry.x() + _parent->_frameGeometry.x() : _surfaceGeometry.x());
         _frameGeometry.setY(_parent ? _surfaceGeometry.y() + _parent->_frameGeometry.y() : _surfaceGeometry.y());
         _surface->setSurfaceFlag(Surface::ModifiedPosition);
+        frameGeometryChanged();
     }
 }
 
@@ -332,6 +364,7 @@ Widget::translate(int deltaX, int deltaY)
         _frameGeometry.setX(_parent ? _surfaceGeometry.x() + _parent->_frameGeometry.x() : _surfaceGeometry.x());
         _frameGeometry.setY(_parent ? _surfaceGeometry.y() + _parent->_frameGeometry.y() : _surfaceGeometry.y());
         _surface->setSurfaceFlag(Surface::ModifiedPosition);
+        frameGeometryChanged();
     }
 }
 
@@ -344,6 +377,7 @@ Widget::setX(int x)
         _dirtyFrameGeometry.setX(_frameGeometry.x());
         _frameGeometry.setX(_parent ? _surfaceGeometry.x() + _parent->_frameGeometry.x() : _surfaceGeometry.x());
         _surface->setSurfaceFlag(Surface::ModifiedPosition);
+        frameGeometryChanged();
     }
 }
 
@@ -356,6 +390,7 @@ Widget::setY(int y)
         _dirtyFrameGeometry.setY(_frameGeometry.y());
         _frameGeometry.setY(_parent ? _surfaceGeometry.y() + _parent->_frameGeometry.y() : _surfaceGeometry.y());
         _surface->setSurfaceFlag(Surface::ModifiedPosition);
+        frameGeometryChanged();
     }
 }
 
@@ -384,6 +419,7 @@ Widget::setHeight(int height)
             height = _maxSize.height();
         _frameGeometry.setHeight(height);
         _surface->setSurfaceFlag(Surface::ModifiedSize);
+        frameGeometryChanged();
     }
 }
 
@@ -400,6 +436,7 @@ Widget::setWidth(int width)
             width = _maxSize.width();
         _frameGeometry.setWidth(width);
         _surface->setSurfaceFlag(Surface::ModifiedSize);
+        frameGeometryChanged();
     }
 }
 
@@ -434,46 +471,58 @@ Widget::setGeometry(const Rectangle& rect)
 void
 Widget::setMinimumSize(const Size &size)
 {
-    _minSize = size;
+    setMinimumSize(size.width(), size.height());
 }
 
 void
 Widget::setMinimumSize(int minWidth, int minHeight)
 {
-    _minSize.setWidth(minWidth);
-    _minSize.setHeight(minHeight);
+    if (minWidth != _minSize.width() || minHeight != _minSize.height())
+    {
+        _minSize.setWidth(minWidth);
+        _minSize.setHeight(minHeight);
+        doLayout();
+    }
 }
 
 void
 Widget::setMaximumSize(const Size &size)
 {
-    _maxSize = size;
+    setMaximumSize(size.width(), size.height());
 }
 
 void
 Widget::setMaximumSize(int maxWidth, int maxHeight)
 {
-    _maxSize.setWidth(maxWidth);
-    _maxSize.setHeight(maxHeight);
+    if (maxWidth != _maxSize.width() || maxHeight != _maxSize.height())
+    {
+        _maxSize.setWidth(maxWidth);
+        _maxSize.setHeight(maxHeight);
+        doLayout();
+    }
 }
 
 void
 Widget::setXConstraint(WidgetResizeConstraint constraint)
 {
-    _xResizeConstraint = constraint;
+    setConstraints(constraint, _yResizeConstraint);
 }
 
 void
 Widget::setYConstraint(WidgetResizeConstraint constraint)
 {
-    _yResizeConstraint = constraint;
+    setConstraints(_xResizeConstraint, constraint);
 }
 
 void
 Widget::setConstraints(WidgetResizeConstraint x, WidgetResizeConstraint y)
 {
-    _xResizeConstraint = (WidgetResizeConstraint) x;
-    _yResizeConstraint = (WidgetResizeConstraint) y;
+    if (x != _xResizeConstraint || y != _yResizeConstraint)
+    {
+        _xResizeConstraint = (WidgetResizeConstraint) x;
+        _yResizeConstraint = (WidgetResizeConstraint) y;
+        doLayout();
+    }
 }
 
 void
@@ -512,6 +561,7 @@ Widget::setVisible(bool visible)
     } else if (!visible && !(_state & InvisibleState))
     {
         _state = (WidgetState) (_state | InvisibleState);
+        ImageLoader::instance().cancel(this);
         sigStateChanged(this, _state);
         doLayout();
     }
@@ -528,6 +578,30 @@ Widget::setOpacity(u8 opacity)
     }
 }
 
+void
+Widget::setOpaque(bool opaque)
+{
+    _opaque = opaque;
+}
+
+void
+Widget::setCached(bool cached)
+{
+    if (cached)
+        _surface->setSurfaceFlag(Surface::CachedCompose);
+    else
+    {
+        _surface->unsetSurfaceFlag(Surface::CachedCompose);
+        _surface->releaseCache();
+    }
+}
+
+void
+Widget::invalidateCache()
+{
+    _surface->invalidateCache();
+}
+
 void
 Widget::setFocus()
 {
@@ -567,7 +641,10 @@ Widget::setParent(Widget* parent)
         {
             WidgetListIterator it = std::find(_parent->_children.begin(), _parent->_children.end(), this);
             if (this == *it)
+            {
                 _parent->_children.erase(it);
+                _parent->invalidateHitTestGrid();
+            }
         }
 
         _parent = parent;
@@ -618,7 +695,13 @@ Widget::paint(const PaintEvent& event)
         PaintEvent evt(this, event);
         if (evt.isValid())
         {
-            compose(evt);
+            if (!coveredByChildren(evt.rect))
+            {
+                if (_surface->flags() & Surface::CachedCompose)
+                    composeCached(evt);
+                else
+                    compose(evt);
+            }
             paintChildren(evt);
         }
     }
@@ -627,6 +710,7 @@ Widget::paint(const PaintEvent& event)
 void
 Widget::repaint()
 {
+    _surface->invalidateCache();
     if (visible())
     {
         if (_parent)
@@ -639,24 +723,14 @@ Widget::repaint()
 void
 Widget::repaint(const PaintEvent& event)
 {
-    if (visible())
-    {
-        if (_parent)
-        {
-            if (_surface->flags() & Surface::HasOwnSurface)
-            {
-                _surface->clear(mapToSurface(event.rect));
-                _parent->repaint(PaintEvent(this, event));
-            } else
-                _parent->repaint(event);
-        } else
-            repaint(event);
-    }
+    _surface->invalidateCache();
+    repaintParent(event);
 }
 
 void
 Widget::update()
 {
+    _surface->invalidateCache();
     if (visible())
     {
         if (_rootWindow) // FIXME invis check
@@ -669,27 +743,74 @@ Widget::update()
 
 void
 Widget::update(const PaintEvent& event)
+{
+    _surface->invalidateCache();
+    updateParent(event);
+}
+
+void
+Widget::doLayout()
+{
+    if (_parent)
+        _parent->doLayout();
+}
+
+void
+Widget::repaintParent(const PaintEvent& event)
 {
     if (visible())
     {
         if (_parent)
         {
+            PaintEvent evt(event);
             if (_surface->flags() & Surface::HasOwnSurface)
             {
-                _surface->clear(mapToSurface(event.rect));
-                _parent->update(PaintEvent(this, event));
-            } else
-                _parent->update(event);
+                // cached surface is blitted without blending, so there is no need to clear.
+                if (!(_surface->flags() & Surface::CachedCompose))
+                    _surface->clear(mapToSurface(event.rect));
+                evt = PaintEvent(this, event);
+            }
+
+            // ancestors keep their cached compose output, window handles repaint itself.
+            if (_parent == _rootWindow)
+                _parent->repaint(evt);
+            else
+                _parent->repaintParent(evt);
         } else if ((_surface->flags() & Surface::HasOwnSurface) || (_surface->flags() & Surface::RootSurface))
             paint(event);
     }
 }
 
 void
-Widget::doLayout()
+Widget::updateParent(const PaintEvent& event)
 {
-    if (_parent)
-        _parent->doLayout();
+    if (visible())
+    {
+        if (_parent)
+        {
+            PaintEvent evt(event);
+            if (_surface->flags() & Surface::HasOwnSurface)
+            {
+                if (!(_surface->flags() & Surface::CachedCompose))
+                    _surface->clear(mapToSurface(event.rect));
+                evt = PaintEvent(this, event);
+            }
+
+            // ancestors keep their cached compose output, window queues update itself.
+            if (_parent == _rootWindow)
+                _parent->update(evt);
+            else
+                _parent->updateParent(evt);
+        } else if ((_surface->flags() & Surface::HasOwnSurface) || (_surface->flags() & Surface::RootSurface))
+            paint(event);
+    }
+}
+
+void
+Widget::frameGeometryChanged()
+{
+    if (_parent && _parent->_hitTestGrid)
+        _parent->_hitTestGrid->update(this);
 }
 
 Widget*
@@ -770,12 +891,8 @@ Widget::consumePointerEvent(const PointerEvent& pointerEvent)
             {
                 pointerWheelEvent(pointerEvent);
                 return true;
-            } else if (_children.size())
-            {
-                for (WidgetListReverseIterator it = _children.rbegin(); it != _children.rend(); ++it)
-                    if (((Widget*) *it)->consumePointerEvent(pointerEvent))
-                        return true;
-            }
+            } else if (_children.size() && consumeChildPointerEvent(pointerEvent))
+                return true;
 
             if (pointerEvent.eventType == PointerButtonDown)
             {
@@ -804,9 +921,7 @@ Widget::consumePointerEvent(const PointerEvent& pointerEvent)
         {
             if (_eventFilter && _eventFilter->pointerEventConsumer(pointerEvent))
                 return true;
-            for (WidgetListReverseIterator it = _children.rbegin(); it != _children.rend(); ++it)
-                if (((Widget*) *it)->consumePointerEvent(pointerEvent))
-                    return true;
+            return consumeChildPointerEvent(pointerEvent);
         }
     }
     return false;
@@ -928,6 +1043,7 @@ Widget::addChild(Widget* child)
 
     child->setParent(this);
     _children.push_back(child);
+    invalidateHitTestGrid();
 
     // Fixme this might be unnecessary since layout should do it.
     child->setNeighbours(getNeighbour(Up), getNeighbour(Down), getNeighbour(Left), getNeighbour(Right));
@@ -948,6 +1064,7 @@ Widget::removeChild(Widget* child, bool destroy)
         if (destroy)
             delete *it;
         _children.erase(it);
+        invalidateHitTestGrid();
         ILOG_DEBUG(ILX_WIDGET, "Removed child %p\n", child);
         return true;
     }
@@ -966,6 +1083,7 @@ Widget::insertChild(Widget* child, unsigned int index)
         ++it;
 
     _children.insert(it, child);
+    invalidateHitTestGrid();
     return false;
 }
 
@@ -983,6 +1101,7 @@ Widget::raiseChildToFront(Widget* child)
     {
         _children.erase(it);
         _children.push_back(child);
+        invalidateHitTestGrid();
         return true;
     }
     return false;
@@ -1002,6 +1121,7 @@ Widget::lowerChildToBottom(Widget* child)
     {
         _children.erase(it);
         _children.push_front(child);
+        invalidateHitTestGrid();
         return true;
     }
     return false;
@@ -1024,6 +1144,7 @@ Widget::raiseChild(Widget* child)
         if (temp != _children.end())
         {
             std::iter_swap(it, temp);
+            invalidateHitTestGrid();
             return true;
         }
         return false;
@@ -1048,6 +1169,7 @@ Widget::lowerChild(Widget* child)
         if (temp != _children.begin())
         {
             std::iter_swap(it, temp);
+            invalidateHitTestGrid();
             return true;
         }
         return false;
@@ -1055,12 +1177,103 @@ Widget::lowerChild(Widget* child)
     return false;
 }
 
+bool
+Widget::consumeChildPointerEvent(const PointerEvent& pointerEvent)
+{
+    unsigned int threshold = HitTestGrid::threshold();
+    if (!threshold || _children.size() < threshold)
+    {
+        for (WidgetListReverseIterator it = _children.rbegin(); it != _children.rend(); ++it)
+            if (((Widget*) *it)->consumePointerEvent(pointerEvent))
+                return true;
+        return false;
+    }
+
+    if (!_hitTestGrid)
+        _hitTestGrid = new HitTestGrid(this);
+
+    // candidates are copied, so children may modify list while consuming.
+    HitTestGrid::WidgetVector candidates;
+    _hitTestGrid->query(pointerEvent.x, pointerEvent.y, _rootWindow ? _rootWindow->_eventManager->grabbedWidget() : NULL, candidates);
+    for (HitTestGrid::WidgetVector::iterator it = candidates.begin(); it != candidates.end(); ++it)
+        if ((*it)->consumePointerEvent(pointerEvent))
+            return true;
+    return false;
+}
+
+void
+Widget::invalidateHitTestGrid()
+{
+    if (_hitTestGrid)
+        _hitTestGrid->invalidate();
+}
+
 void
 Widget::paintChildren(const PaintEvent& event)
 {
     // TODO Stereo blitting and flipping.
     ILOG_TRACE_W(ILX_WIDGET);
     Widget* child;
+
+#ifndef ILIXI_STEREO_OUTPUT
+    // Front to back pass removes children which are covered by opaque siblings.
+    Region covered(0, 0);
+    std::vector<Widget*> paintList;
+    std::vector<Rectangle> damageList;
+    for (WidgetListReverseIterator it = _children.rbegin(); it != _children.rend(); ++it)
+    {
+        child = ((Widget*) *it);
+        if (!child->visible())
+            continue;
+
+        child->_surface->updateSurface(event);
+        Rectangle r = child->frameGeometry().intersected(event.rect);
+        if (!r.isValid())
+            continue;
+
+        if (covered.isEmpty())
+            damageList.push_back(r);
+        else if (covered.contains(r))
+        {
+            ILOG_DEBUG(ILX_WIDGET, " -> widget [%d:%p] is occluded\n", child->id(), child);
+            continue;
+        } else
+        {
+            Region damage;
+            damage.add(r);
+            for (Region::RectangleList::const_iterator c = covered.rects().begin(); c != covered.rects().end(); ++c)
+                damage.subtract(*c);
+            damageList.push_back(damage.bounds());
+        }
+
+        paintList.push_back(child);
+        if (covered.count() < 16)
+            covered.add(child->opaqueGeometry().intersected(event.rect));
+    }
+
+    for (int i = paintList.size() - 1; i >= 0; --i)
+    {
+        child = paintList[i];
+        PaintEvent evt(event);
+        evt.rect = damageList[i];
+        child->paint(evt);
+        if ((child->_surface->flags() & Surface::HasOwnSurface)) // && !(child->_surface->flags() & Surface::DisableAutoFlip))
+        {
+            ILOG_DEBUG(ILX_WIDGET, " -> blitting widget [%d:%p]\n", child->id(), child);
+            // crop is placed at its own position inside child.
+            Rectangle crop = child->mapToSurface(evt.rect);
+            int x = child->x() + crop.x();
+            int y = child->y() + crop.y();
+            if(surface()->flags() & Surface::SharedSurface)
+            {
+                x += _surface->xOffset();
+                y += _surface->yOffset();
+            }
+            _surface->setBlittingFlags(DSBLIT_BLEND_ALPHACHANNEL);
+            _surface->blit(child->_surface, crop, x, y);
+        }
+    }
+#else
     for (WidgetListIterator it = _children.begin(); it != _children.end(); ++it)
     {
         child = ((Widget*) *it);
@@ -1071,14 +1284,20 @@ Widget::paintChildren(const PaintEvent& event)
             if ((child->_surface->flags() & Surface::HasOwnSurface)) // && !(child->_surface->flags() & Surface::DisableAutoFlip))
             {
                 ILOG_DEBUG(ILX_WIDGET, " -> blitting widget [%d:%p]\n", child->id(), child);
-                _surface->setBlittingFlags(DSBLIT_BLEND_ALPHACHANNEL);
+                Rectangle crop = child->mapToSurface(r);
+                int x = child->x() + crop.x();
+                int y = child->y() + crop.y();
                 if(surface()->flags() & Surface::SharedSurface)
-                    _surface->blit(child->_surface, child->mapToSurface(r), child->absX(), child->absY());
-                else
-                    _surface->blit(child->_surface, child->mapToSurface(r), child->x(), child->y());
+                {
+                    x += _surface->xOffset();
+                    y += _surface->yOffset();
+                }
+                _surface->setBlittingFlags(DSBLIT_BLEND_ALPHACHANNEL);
+                _surface->blit(child->_surface, crop, x, y);
             }
         }
     }
+#endif
 
     if ((_surface->flags() & Surface::HasOwnSurface) && !(_surface->flags() & Surface::DisableAutoFlip)) {
         Rectangle rect = mapToSurface(event.rect);
@@ -1087,6 +1306,38 @@ Widget::paintChildren(const PaintEvent& event)
     ILOG_DEBUG(ILX_WIDGET, " -> paintChildren ends.\n");
 }
 
+bool
+Widget::coveredByChildren(const Rectangle& rect)
+{
+#ifdef ILIXI_STEREO_OUTPUT
+    return false;
+#else
+    // same rule as paintChildren(), only children with a valid opaqueGeometry() cover.
+    Region covered(0, 0);
+    for (WidgetListReverseIterator it = _children.rbegin(); it != _children.rend() && covered.count() < 16; ++it)
+    {
+        Widget* child = ((Widget*) *it);
+        if (!child->visible())
+            continue;
+
+        child->_surface->updateSurface(PaintEvent(rect, PaintEvent::BothEyes));
+        Rectangle opaque = child->opaqueGeometry().intersected(rect);
+        if (opaque.isValid())
+            covered.add(opaque);
+    }
+    return !covered.isEmpty() && covered.contains(rect);
+#endif
+}
+
+void
+Widget::composeCached(const PaintEvent& event)
+{
+    if (!_surface->cacheValid(width(), height(), _state) && !_surface->renderCache(_state))
+        compose(event);
+    else
+        _surface->blitCache(mapToSurface(event.rect));
+}
+
 void
 Widget::updateFrameGeometry()
 {
@@ -1095,6 +1346,8 @@ Widget::updateFrameGeometry()
     _frameGeometry.setY(_parent ? _surfaceGeometry.y() + _parent->_frameGeometry.y() : _surfaceGeometry.y());
 
     ILOG_DEBUG(ILX_WIDGET, "Widget %d updateFrameGeometry( %d, %d)\n", _id, _frameGeometry.x(), _frameGeometry.y());
+    if (_frameGeometry.x() != _dirtyFrameGeometry.x() || _frameGeometry.y() != _dirtyFrameGeometry.y())
+        frameGeometryChanged();
 
     Surface::SurfaceFlags flags = (Surface::SurfaceFlags) ((_surface->flags() & Surface::ModifiedPosition) | (_surface->flags() & Surface::ModifiedSize));
     _surface->unsetSurfaceFlag(Surface::ModifiedGeometry);
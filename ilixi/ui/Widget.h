@@ -37,6 +37,7 @@ namespace ilixi
 {
 class EventFilter;
 class EventManager;
+class HitTestGrid;
 class Window;
 class WindowWidget;
 
@@ -48,6 +49,7 @@ class WindowWidget;
 class Widget : virtual public sigc::trackable
 {
     friend class Surface;
+    friend class HitTestGrid; // _children and _frameGeometry
     friend class Application; // sets _stylist.
     friend class WindowWidget; // sets RootWindow.
     friend class EventManager;
@@ -55,6 +57,7 @@ class Widget : virtual public sigc::trackable
     friend class ScrollArea; // Blit
     friend class PaintEvent;
     friend class AppBase; // UniversalEvents
+    friend class Engine; // UniversalEvents
 
     friend bool
     compareZ(Widget* first, Widget* second);
@@ -270,6 +273,32 @@ public:
     u8
     opacity() const;
 
+    /*!
+     * Returns true if widget is marked as opaque.
+     *
+     * @sa setOpaque()
+     */
+    bool
+    opaque() const;
+
+    /*!
+     * Returns the area which is painted with opaque pixels by widget, in absolute coordinates.
+     *
+     * Siblings and parent area below this rectangle are not painted. Default implementation
+     * returns frame geometry if widget is opaque, visible and does not use opacity.
+     * Returns an empty rectangle otherwise.
+     */
+    virtual Rectangle
+    opaqueGeometry() const;
+
+    /*!
+     * Returns true if widget's compose() output is cached.
+     *
+     * @sa setCached()
+     */
+    bool
+    cached() const;
+
     /*!
      * Returns true if widget has focus.
      *
@@ -529,6 +558,33 @@ public:
     void
     setOpacity(u8 opacity);
 
+    /*!
+     * Sets whether widget fills its frame with opaque pixels.
+     *
+     * Widgets which are fully covered by opaque siblings are not painted.
+     */
+    void
+    setOpaque(bool opaque);
+
+    /*!
+     * Sets whether widget renders its compose() output once into a private surface.
+     *
+     * A cached widget is only blitted while painting. Cache is rendered again if widget
+     * size or state changes, update() is called or style is modified. Memory used by
+     * cached widgets is limited by SurfaceCache and least recently painted ones are
+     * released first. Use for widgets which are expensive to draw and rarely change.
+     */
+    void
+    setCached(bool cached);
+
+    /*!
+     * Marks cached compose() output as outdated.
+     *
+     * Call this method if widget's appearance changes without calling update().
+     */
+    void
+    invalidateCache();
+
     /*!
      * Assigns key input focus to widget if the widget accepts key inputs.
      *
@@ -618,6 +674,8 @@ public:
     /*!
      * Repaints widget immediately using clipping.
      *
+     * Cached compose output of this widget is invalidated, but not of its ancestors.
+     *
      * @param event contains a rectangle to update.
      */
     virtual void
@@ -636,6 +694,8 @@ public:
     /*!
      * This method will repaint inside given rectangle.
      *
+     * Cached compose output of this widget is invalidated, but not of its ancestors.
+     *
      * @param event contains a rectangle to update.
      */
     virtual void
@@ -917,6 +977,22 @@ protected:
     bool
     lowerChild(Widget* child);
 
+    /*!
+     * Passes a pointer event to children under pointer, starting from top most child.
+     *
+     * Uses a HitTestGrid if widget has many children.
+     *
+     * @param pointerEvent in frame (absolute) coordinates.
+     *
+     * @return True if event is consumed by a child, false otherwise.
+     */
+    bool
+    consumeChildPointerEvent(const PointerEvent& pointerEvent);
+
+    //! Rebuilds HitTestGrid on next pointer event, must be called if _children is modified.
+    void
+    invalidateHitTestGrid();
+
     /*!
      * Paints children.
      *
@@ -925,6 +1001,20 @@ protected:
     virtual void
     paintChildren(const PaintEvent& event);
 
+    /*!
+     * Returns true if given rectangle is covered by opaque children.
+     *
+     * @param rect in absolute coordinates.
+     */
+    bool
+    coveredByChildren(const Rectangle& rect);
+
+    /*!
+     * Blits cached compose() output, cache is rendered first if it is outdated.
+     */
+    void
+    composeCached(const PaintEvent& event);
+
     /*!
      * This method updates widget's absolute geometry and it is called when
      * sigGeometryUpdated is triggered.
@@ -1063,6 +1153,8 @@ private:
     int _z;
     //! This property stores the widget's opacity.
     u8 _opacity;
+    //! This property specifies whether widget fills its frame with opaque pixels.
+    bool _opaque;
     //! This property stores the widget's parent.
     Widget* _parent;
     //! This property stores the widget's surface.
@@ -1082,6 +1174,8 @@ private:
 
     //! Stores event filter if any.
     EventFilter* _eventFilter;
+    //! Index of children frames, created by consumeChildPointerEvent().
+    HitTestGrid* _hitTestGrid;
 
     /*!
      * This property holds the widget's minimum allowed size that is specified by the user.
@@ -1128,6 +1222,18 @@ private:
      */
     void
     setRootWindow(WindowWidget* rootWindow);
+
+    //! Passes repaint of given rectangle to parent without invalidating caches.
+    void
+    repaintParent(const PaintEvent& event);
+
+    //! Passes update of given rectangle to parent without invalidating caches.
+    void
+    updateParent(const PaintEvent& event);
+
+    //! Updates parent's HitTestGrid after frame geometry is changed.
+    void
+    frameGeometryChanged();
 };
 }
 
@@ -27,6 +27,7 @@
 #include <core/EventFilter.h>
 #include <core/Logger.h>
 #include <core/PlatformManager.h>
+#include <lib/FrameStats.h>
 
 namespace ilixi
 {
@@ -48,6 +49,7 @@ WindowWidget::WindowWidget(Widget* parent)
     pthread_mutex_init(&_updates._listLock, NULL);
     sem_init(&_updates._updateReady, 0, 0);
     sem_init(&_updates._paintReady, 0, 1);
+    _updates._serial = 0;
 
     _surface->setSurfaceFlag(Surface::WindowDescription);
     setMargins(5, 5, 5, 5);
@@ -87,6 +89,7 @@ WindowWidget::update()
         pthread_mutex_lock(&_updates._listLock);
         ILOG_DEBUG(ILX_WINDOWWIDGET_UPDATES, " -> using frameGeometry.\n");
         _updates._updateQueue.add(frameGeometry());
+        _updates._damageQueue.add(frameGeometry());
 #ifdef ILIXI_STEREO_OUTPUT
         _updates._updateQueueRight.add(frameGeometry());
 #endif
@@ -103,6 +106,7 @@ WindowWidget::update(const PaintEvent& event)
         pthread_mutex_lock(&_updates._listLock);
         ILOG_DEBUG(ILX_WINDOWWIDGET_UPDATES, " -> left %d, %d, %d, %d.\n", event.rect.x(), event.rect.y(), event.rect.width(), event.rect.height());
         _updates._updateQueue.add(event.rect);
+        _updates._damageQueue.add(event.rect);
 #ifdef ILIXI_STEREO_OUTPUT
         ILOG_DEBUG(ILX_WINDOWWIDGET_UPDATES, " -> right %d, %d, %d, %d.\n", event.right.x(), event.right.y(), event.right.width(), event.right.height());
         _updates._updateQueueRight.add(event.right);
@@ -111,6 +115,35 @@ WindowWidget::update(const PaintEvent& event)
     }
 }
 
+void
+WindowWidget::expose(const Rectangle& rect)
+{
+    ILOG_TRACE_W(ILX_WINDOWWIDGET_UPDATES);
+    if (!(_state & InvisibleState))
+    {
+        pthread_mutex_lock(&_updates._listLock);
+        ILOG_DEBUG(ILX_WINDOWWIDGET_UPDATES, " -> expose %d, %d, %d, %d.\n", rect.x(), rect.y(), rect.width(), rect.height());
+        _updates._updateQueue.add(rect);
+#ifdef ILIXI_STEREO_OUTPUT
+        _updates._damageQueue.add(rect);
+        _updates._updateQueueRight.add(rect);
+#endif
+        pthread_mutex_unlock(&_updates._listLock);
+    }
+}
+
+const Region&
+WindowWidget::damagedRegion() const
+{
+    return _updates._damageRegion;
+}
+
+unsigned int
+WindowWidget::paintSerial() const
+{
+    return _updates._serial;
+}
+
 void
 WindowWidget::doLayout()
 {
@@ -130,17 +163,14 @@ WindowWidget::paint(const PaintEvent& event)
         {
             sem_wait(&_updates._updateReady);
 
+            FrameStats& stats = FrameStats::instance();
+            stats.begin(FrameStats::Compose);
             _surface->updateSurface(event);
 
 #ifdef ILIXI_STEREO_OUTPUT
-            PaintEvent evt(_frameGeometry.intersected(_updates._updateRegion), _frameGeometry.intersected(_updates._updateRegionRight));
-#else
-            PaintEvent evt(_frameGeometry.intersected(_updates._updateRegion));
-#endif
+            PaintEvent evt(_frameGeometry.intersected(_updates._updateRegion.bounds()), _frameGeometry.intersected(_updates._updateRegionRight));
             if (evt.isValid())
             {
-
-#ifdef ILIXI_STEREO_OUTPUT
                 // Left eye
                 ILOG_DEBUG(ILX_WINDOWWIDGET_UPDATES, "  -> Left eye\n");
                 evt.eye = PaintEvent::LeftEye;
@@ -170,21 +200,47 @@ WindowWidget::paint(const PaintEvent& event)
                 paintChildren(evt);
                 // FIXME render cursor for stereo.
                 PlatformManager::instance().renderCursor(AppBase::cursorPosition());
+                stats.end(FrameStats::Compose);
+                stats.addDamage((long long) evt.rect.width() * evt.rect.height() + (long long) evt.right.width() * evt.right.height(), 2);
 
+                stats.begin(FrameStats::Flip);
                 surface()->flipStereo(evt.rect, evt.right);
+                stats.end(FrameStats::Flip);
+            } else
+                stats.end(FrameStats::Compose);
 #else
+            _updates._updateRegion.intersect(_frameGeometry);
+            const Region::RectangleList& rects = _updates._updateRegion.rects();
+            for (Region::RectangleList::const_iterator it = rects.begin(); it != rects.end(); ++it)
+            {
+                PaintEvent evt(*it, PaintEvent::BothEyes);
+#if ILIXI_HAS_GETFRAMETIME
+                evt.micros = event.micros;
+#endif
+                ILOG_DEBUG(ILX_WINDOWWIDGET_UPDATES, "  -> Rect(%d, %d, %d, %d)\n", it->x(), it->y(), it->width(), it->height());
                 surface()->clip(evt.rect);
-                if (_backgroundFlags & BGFClear)
-                    surface()->clear(evt.rect);
+                if (!coveredByChildren(evt.rect))
+                {
+                    if (_backgroundFlags & BGFClear)
+                        surface()->clear(evt.rect);
 
-                if (_backgroundFlags & BGFFill)
-                    compose(evt);
+                    if (_backgroundFlags & BGFFill)
+                        compose(evt);
+                }
 
                 paintChildren(evt);
+            }
 
-                surface()->flip(evt.rect);
-#endif
+            stats.end(FrameStats::Compose);
+            stats.addDamage(_updates._updateRegion.area(), _updates._updateRegion.count());
+
+            if (!_updates._updateRegion.isEmpty())
+            {
+                stats.begin(FrameStats::Flip);
+                surface()->flip(_updates._updateRegion);
+                stats.end(FrameStats::Flip);
             }
+#endif
             sem_post(&_updates._paintReady);
         }
     }
@@ -196,12 +252,15 @@ WindowWidget::repaint(const PaintEvent& event)
     if (visible())
     {
         sem_wait(&_updates._paintReady);
-        _updates._updateRegion = event.rect;
+        _updates._updateRegion.clear();
+        _updates._updateRegion.add(event.rect);
+        _updates._damageRegion = _updates._updateRegion;
+        ++_updates._serial;
 #ifdef ILIXI_STEREO_OUTPUT
         _updates._updateRegionRight = event.right;
 #endif
         sem_post(&_updates._updateReady);
-        paint(PaintEvent(_updates._updateRegion, PaintEvent::BothEyes));
+        paint(PaintEvent(event.rect, PaintEvent::BothEyes));
     }
 }
 
@@ -258,12 +317,8 @@ WindowWidget::consumePointerEvent(const PointerEvent& pointerEvent)
         if (_eventFilter && _eventFilter->pointerEventConsumer(event))
             return true;
 
-        if (_children.size())
-        {
-            for (WidgetListReverseIterator it = _children.rbegin(); it != _children.rend(); ++it)
-                if (((Widget*) *it)->consumePointerEvent(event))
-                    return true;
-        }
+        if (_children.size() && consumeChildPointerEvent(event))
+            return true;
 
         _eventManager->setExposedWidget(NULL, event);
 
@@ -590,40 +645,48 @@ WindowWidget::updateWindow()
     }
     ILOG_TRACE_W(ILX_WINDOWWIDGET_UPDATES);
 
-    Rectangle updateTemp = _updates._updateQueue.rect;
+    Region updateTemp = _updates._updateQueue.region;
+    Region damageTemp = _updates._damageQueue.region;
 
     _updates._updateQueue.reset();
+    _updates._damageQueue.reset();
 
 #ifdef ILIXI_STEREO_OUTPUT
-    Rectangle updateTempRight = _updates._updateQueueRight.rect;
+    Rectangle updateTempRight = _updates._updateQueueRight.region.bounds();
 
     _updates._updateQueueRight.reset();
 #endif
     pthread_mutex_unlock(&_updates._listLock);
 
-    if (!updateTemp.isNull())
+    if (!updateTemp.isEmpty())
     {
         sem_wait(&_updates._paintReady);
 #ifdef ILIXI_STEREO_OUTPUT
-        if (PlatformManager::instance().useFSU(_layerName))
+        if (PlatformManager::instance().useFSU(_window->_layerName))
         {
-            _updates._updateRegion = frameGeometry();
+            _updates._updateRegion.clear();
+            _updates._updateRegion.add(frameGeometry());
             _updates._updateRegionRight = frameGeometry();
         } else
         {
             _updates._updateRegion = updateTemp;
             _updates._updateRegionRight = updateTempRight;
         }
+        _updates._damageRegion = _updates._updateRegion;
 #else
         if (PlatformManager::instance().useFSU(_window->_layerName))
-            _updates._updateRegion = frameGeometry();
-        else
+        {
+            _updates._updateRegion.clear();
+            _updates._updateRegion.add(frameGeometry());
+        } else
             _updates._updateRegion = updateTemp;
+        _updates._damageRegion = damageTemp;
 #endif
+        ++_updates._serial;
 
         sem_post(&_updates._updateReady);
 
-        ILOG_DEBUG( ILX_WINDOWWIDGET_UPDATES, " -> UpdateRegion(%d, %d, %d, %d)\n", _updates._updateRegion.x(), _updates._updateRegion.y(), _updates._updateRegion.width(), _updates._updateRegion.height());
+        ILOG_DEBUG( ILX_WINDOWWIDGET_UPDATES, " -> UpdateRegion(%d, %d, %d, %d) in %u rects\n", _updates._updateRegion.bounds().x(), _updates._updateRegion.bounds().y(), _updates._updateRegion.bounds().width(), _updates._updateRegion.bounds().height(), _updates._updateRegion.count());
 
 #if ILIXI_HAS_GETFRAMETIME
         long long micros = 0;
@@ -637,13 +700,13 @@ WindowWidget::updateWindow()
 #endif
 
 #ifdef ILIXI_STEREO_OUTPUT
-        PaintEvent p(_updates._updateRegion, _updates._updateRegionRight);
+        PaintEvent p(_updates._updateRegion.bounds(), _updates._updateRegionRight);
 #if ILIXI_HAS_GETFRAMETIME
         p.micros = micros;
 #endif
         paint( p );
 #else
-        PaintEvent p(_updates._updateRegion, PaintEvent::BothEyes);
+        PaintEvent p(_updates._updateRegion.bounds(), PaintEvent::BothEyes);
 #if ILIXI_HAS_GETFRAMETIME
         p.micros = micros;
 #endif
@@ -28,6 +28,7 @@
 #include <core/Window.h>
 #include <core/EventManager.h>
 #include <lib/Timer.h>
+#include <types/Region.h>
 #include <ui/Frame.h>
 #include <semaphore.h>
 #include <vector>
@@ -81,6 +82,29 @@ public:
     virtual void
     update(const PaintEvent& event);
 
+    /*!
+     * Queues given rectangle for compositing without marking it damaged.
+     *
+     * Use this if pixels of a widget with its own surface are still valid but
+     * have moved, e.g. after ScrollArea scrolls its content in place.
+     */
+    void
+    expose(const Rectangle& rect);
+
+    /*!
+     * Returns region damaged using update() for current paint.
+     *
+     * This region does not include rectangles queued using expose().
+     */
+    const Region&
+    damagedRegion() const;
+
+    /*!
+     * Returns a number which is incremented each time window is painted.
+     */
+    unsigned int
+    paintSerial() const;
+
     /*!
      * This method executes update().
      */
@@ -90,8 +114,9 @@ public:
     /*!
      * Paints inside given rectangle.
      *
-     * Actual painting takes place once a union rectangle is
-     * formed by updateWindow or repaint methods.
+     * Actual painting takes place once a damaged region is
+     * formed by updateWindow or repaint methods. Each rectangle of
+     * region is clipped, painted and flipped separately.
      */
     virtual void
     paint(const PaintEvent& event);
@@ -201,7 +226,7 @@ private:
     class UpdateQueue
     {
     public:
-        Rectangle rect;
+        Region region;
 
         bool valid;
 
@@ -213,19 +238,14 @@ private:
         void
         add(const Rectangle &ext)
         {
-            if (valid)
-            {
-                rect = rect.united(ext);
-            } else
-            {
-                rect = ext;
-                valid = true;
-            }
+            region.add(ext);
+            valid = !region.isEmpty();
         }
 
         void
         reset()
         {
+            region.clear();
             valid = false;
         }
     };
@@ -236,17 +256,22 @@ private:
         pthread_mutex_t _listLock;
         sem_t _updateReady;
         sem_t _paintReady;
-        Rectangle _updateRegion;
+        Region _updateRegion;
+        //! Part of _updateRegion which is damaged, see expose().
+        Region _damageRegion;
+        //! Incremented each time _updateRegion is painted.
+        unsigned int _serial;
 #ifdef ILIXI_STEREO_OUTPUT
         Rectangle _updateRegionRight;
         UpdateQueue _updateQueueRight;
 #endif
         UpdateQueue _updateQueue;
+        UpdateQueue _damageQueue;
     } _updates;
 
     /*!
-     * Creates a united rectangle from a list of dirty regions and
-     * performs a paint operation on this united rectangle.
+     * Takes the damaged region from update queue and
+     * performs a paint operation on its rectangles.
      */
     virtual void
     updateWindow();